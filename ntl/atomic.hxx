@@ -576,6 +576,39 @@ namespace atomic {
     }
   };
 
+  template<typename T>
+  static inline
+    T* exchange(T* volatile & dest, T* val)
+  {
+    return generic_op::exchange(dest, val);
+  }
+
+  template<typename T>
+  static inline
+    T* compare_exchange(T* volatile & dest, T* exchange, T* comparand)
+  {
+    return generic_op::compare_exchange(dest, exchange, comparand);
+  }
+
+  /** Loads the \p src, the subsequent memory accesses are not moved before the load (x86 and x64 don't reorder the loads) */
+  template<typename T>
+  static inline
+    T load_acquire(const volatile T & src)
+  {
+    const T v = src;
+    intrinsic::_ReadWriteBarrier();
+    return v;
+  }
+
+  /** Stores the \p val to the \p dest, the preceding memory accesses are not moved after the store */
+  template<typename T>
+  static inline
+    void store_release(volatile T & dest, T val)
+  {
+    intrinsic::_ReadWriteBarrier();
+    dest = val;
+  }
+
 #pragma warning(pop)
 }//namespace atomic
 
@@ -654,6 +687,35 @@ namespace atomic {
     return __sync_val_compare_and_swap(&dest, comparand, exchange);
   }
 
+#ifdef __x86_64__
+  /** 128-bit compare and exchange (requires -mcx16), the \p comparand receives the original value */
+  static inline
+    uint8_t
+    compare_exchange(volatile uint64_t & dest, uint64_t exchange_high, uint64_t exchange_low, uint64_t* comparand)
+  {
+    typedef unsigned __int128 uint128_t;
+    const uint128_t expected = (uint128_t(comparand[1]) << 64) | comparand[0];
+    const uint128_t original = __sync_val_compare_and_swap(reinterpret_cast<volatile uint128_t*>(&dest), expected, (uint128_t(exchange_high) << 64) | exchange_low);
+    comparand[0] = static_cast<uint64_t>(original);
+    comparand[1] = static_cast<uint64_t>(original >> 64);
+    return original == expected;
+  }
+#endif
+
+  template<typename T>
+  static inline
+    T load_acquire(const volatile T & src)
+  {
+    return __atomic_load_n(&src, __ATOMIC_ACQUIRE);
+  }
+
+  template<typename T>
+  static inline
+    void store_release(volatile T & dest, T val)
+  {
+    __atomic_store_n(&dest, val, __ATOMIC_RELEASE);
+  }
+
 }//namespace atomic
 
 
@@ -63,6 +63,8 @@
   #define NTL_CXX_LAMBDA   11
   // rvalue references v3.0
   #define NTL_CXX_RV       30
+  // rvalue references for *this (ref-qualified member functions)
+  #define NTL_CXX_RVTHIS
   // template typedef ( = using)
   #define NTL_CXX_TT
   // variadic templates (implies rvalue references support)
@@ -146,6 +148,7 @@
 # define NTL_CXX_EF
 # define NTL_CXX_NS
 # define NTL_CXX_UDL
+# define NTL_CXX_RVTHIS
 #endif
 
 
@@ -0,0 +1,1074 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  B-tree map and set
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__BTREE
+#define NTL__BTREE
+#pragma once
+
+#include "stlx/memory.hxx"
+#include "stlx/vector.hxx"
+#include "stlx/functional.hxx"
+#include "stlx/stdexcept_fwd.hxx"
+
+namespace ntl {
+
+/**\addtogroup  lib_containers
+ *@{*/
+
+namespace __
+{
+  /** Mapped type of the btree_set */
+  struct btree_no_value {};
+
+  /** Raw storage of N objects of T in the node */
+  template<class T, size_t N>
+  struct btree_slots
+  {
+    typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type raw;
+
+    T* at(size_t i) { return reinterpret_cast<T*>(&raw) + i; }
+    const T* at(size_t i) const { return reinterpret_cast<const T*>(&raw) + i; }
+  };
+
+  template<size_t N>
+  struct btree_slots<btree_no_value, N>
+  {
+    // the set has no values, but the slot may be dereferenced like the map's one
+    btree_no_value* at(size_t) const { static btree_no_value none; return &none; }
+  };
+
+  /** Operations on the raw slots, the trivially relocatable objects are moved by memmove() */
+  template<class T>
+  struct btree_slot_ops
+  {
+    typedef std::__::bool_type<std::__::is_trivially_relocatable<T>::value> relocatable;
+
+    /** Moves \p n objects from \p src to the raw memory at \p dest, the ranges may overlap */
+    static void move(T* dest, T* src, size_t n) { move(dest, src, n, relocatable()); }
+
+    static void move(T* dest, T* src, size_t n, std::true_type)
+    {
+      if(n)
+        std::memmove(dest, src, n * sizeof(T));
+    }
+
+    static void move(T* dest, T* src, size_t n, std::false_type)
+    {
+      if(dest < src){
+        for(size_t i = 0; i < n; i++)
+          relocate(dest + i, src + i);
+      }else{
+        for(size_t i = n; i; i--)
+          relocate(dest + i - 1, src + i - 1);
+      }
+    }
+
+    static void relocate(T* dest, T* src)
+    {
+    #ifdef NTL_CXX_RV
+      ::new(static_cast<void*>(dest)) T(std::move(*src));
+    #else
+      ::new(static_cast<void*>(dest)) T(*src);
+    #endif
+      src->~T();
+    }
+
+  #ifdef NTL_CXX_RV
+    template<class V>
+    static void construct(T* dest, V&& v) { ::new(static_cast<void*>(dest)) T(std::forward<V>(v)); }
+  #else
+    template<class V>
+    static void construct(T* dest, const V& v) { ::new(static_cast<void*>(dest)) T(v); }
+  #endif
+
+    static void destroy(T* p, size_t n = 1)
+    {
+      if(!std::__::no_dtor<T>::value)
+        for(size_t i = 0; i < n; i++)
+          p[i].~T();
+    }
+  };
+
+  template<>
+  struct btree_slot_ops<btree_no_value>
+  {
+    static void move(btree_no_value*, btree_no_value*, size_t) {}
+    static void construct(btree_no_value*, const btree_no_value&) {}
+    static void destroy(btree_no_value*, size_t = 1) {}
+  };
+
+  /**
+   *	@brief Index of the first of the \p n sorted keys which is not less than \p k
+   *
+   *  The branchless binary search: the number of steps depends on \p n only and every step is a conditional move,
+   *  so the search in the node doesn't mispredict.
+   **/
+  template<class Key, class K, class Compare>
+  inline size_t btree_lower_bound(const Key* keys, size_t n, const K& k, const Compare& comp)
+  {
+    if(!n)
+      return 0;
+    const Key* base = keys;
+    while(n > 1){
+      const size_t half = n / 2;
+      base = comp(base[half - 1], k) ? base + half : base;
+      n -= half;
+    }
+    return static_cast<size_t>(base - keys) + (comp(*base, k) ? 1 : 0);
+  }
+
+  /** Index of the first of the \p n sorted keys which is greater than \p k */
+  template<class Key, class K, class Compare>
+  inline size_t btree_upper_bound(const Key* keys, size_t n, const K& k, const Compare& comp)
+  {
+    if(!n)
+      return 0;
+    const Key* base = keys;
+    while(n > 1){
+      const size_t half = n / 2;
+      base = comp(k, base[half - 1]) ? base : base + half;
+      n -= half;
+    }
+    return static_cast<size_t>(base - keys) + (comp(k, *base) ? 0 : 1);
+  }
+
+  /** Reference to the element of the btree_map: the keys and the mapped values are stored apart */
+  template<class Key, class T>
+  struct btree_pair_ref
+  {
+    const Key& first;
+    T& second;
+
+    btree_pair_ref(const Key& k, T& v)
+      :first(k), second(v)
+    {}
+
+    operator std::pair<Key, typename std::remove_const<T>::type>() const
+    {
+      return std::pair<Key, typename std::remove_const<T>::type>(first, second);
+    }
+
+    /** The iterator's operator-> returns the reference itself */
+    const btree_pair_ref* operator->() const { return this; }
+
+  private:
+    btree_pair_ref& operator=(const btree_pair_ref&) __deleted;
+  };
+
+  template<class Key, class T>
+  struct btree_value_traits
+  {
+    typedef std::pair<Key, T>           value_type;
+    typedef btree_pair_ref<Key, T>       reference;
+    typedef btree_pair_ref<Key, const T> const_reference;
+    typedef reference                   pointer;
+    typedef const_reference             const_pointer;
+
+    static reference get(const Key* k, T* v) { return reference(*k, *v); }
+    static const_reference get(const Key* k, const T* v) { return const_reference(*k, *v); }
+    static pointer address(reference r) { return r; }
+    static const_pointer address(const_reference r) { return r; }
+
+    static const Key& key(const value_type& x) { return x.first; }
+    static const T& value(const value_type& x) { return x.second; }
+
+    static bool equal(const Key* k1, const T* v1, const Key* k2, const T* v2) { return *k1 == *k2 && *v1 == *v2; }
+  };
+
+  template<class Key>
+  struct btree_value_traits<Key, btree_no_value>
+  {
+    typedef Key         value_type;
+    typedef const Key&  reference;
+    typedef const Key&  const_reference;
+    typedef const Key*  pointer;
+    typedef const Key*  const_pointer;
+
+    static const Key& get(const Key* k, const btree_no_value*) { return *k; }
+    static const Key* address(const Key& r) { return &r; }
+
+    static const Key& key(const value_type& x) { return x; }
+    static btree_no_value value(const value_type&) { return btree_no_value(); }
+
+    static bool equal(const Key* k1, const btree_no_value*, const Key* k2, const btree_no_value*) { return *k1 == *k2; }
+  };
+
+
+  /**
+   *	@brief B+ tree of the unique keys, the common part of the btree_map and btree_set
+   *
+   *  The elements are kept in the leaves of about \c NodeSize bytes: the keys contiguously, so the node is searched
+   *  within a few cache lines, and the mapped values in the separate array. The leaves are linked to the list
+   *  which the iterators walk. The inner nodes hold the copies of the separating keys: the keys of the child \c i
+   *  are not less than the key <tt>i-1</tt> and are less than the key \c i.
+   *
+   *  The full nodes are split on the way down by insertion, the leaf filled by the increasing keys is split unevenly
+   *  so the sorted input fills the leaves up. The erased elements leave the nodes underfull, the node is removed
+   *  when it becomes empty. Any insertion or erasure invalidates the iterators.
+   **/
+  template<class Key, class T, class Compare, class Allocator, size_t NodeSize>
+  class btree
+  {
+    typedef btree_value_traits<Key, T> traits;
+    typedef btree_slot_ops<Key> key_ops;
+    typedef btree_slot_ops<T>   value_ops;
+
+    static_assert(NodeSize >= 64, "the node is too small");
+
+  public:
+    typedef Key                               key_type;
+    typedef typename traits::value_type       value_type;
+    typedef Compare                           key_compare;
+    typedef Allocator                         allocator_type;
+    typedef typename traits::reference        reference;
+    typedef typename traits::const_reference  const_reference;
+    typedef typename traits::pointer          pointer;
+    typedef typename traits::const_pointer    const_pointer;
+    typedef size_t                            size_type;
+    typedef ptrdiff_t                         difference_type;
+
+  protected:
+    struct node
+    {
+      uint16_t count;   // number of the keys
+      uint16_t leaf;
+    };
+
+    enum
+    {
+      value_size = std::is_same<T, btree_no_value>::value ? 0 : sizeof(T),
+      leaf_fit   = (NodeSize - sizeof(void*) * 3) / (sizeof(Key) + value_size),
+      inner_fit  = (NodeSize - sizeof(void*) * 2) / (sizeof(Key) + sizeof(void*))
+    };
+
+  public:
+    /** Number of the elements in the leaf */
+    static const size_type leaf_capacity  = leaf_fit < 4 ? 4 : leaf_fit > 0xFFFF ? 0xFFFF : leaf_fit;
+    /** Number of the keys in the inner node, it has one child more */
+    static const size_type inner_capacity = inner_fit < 4 ? 4 : inner_fit > 0xFFFF ? 0xFFFF : inner_fit;
+
+  protected:
+    struct leaf_node: node
+    {
+      leaf_node *prev, *next;
+      btree_slots<Key, leaf_capacity> keys;
+      btree_slots<T, leaf_capacity>   values;
+    };
+
+    struct inner_node: node
+    {
+      btree_slots<Key, inner_capacity> keys;
+      node* children[inner_capacity + 1];
+    };
+
+    template<bool Const>
+    class iterator_impl:
+      public std::iterator<std::bidirectional_iterator_tag, value_type, difference_type,
+        typename std::conditional<Const, typename traits::const_pointer, typename traits::pointer>::type,
+        typename std::conditional<Const, typename traits::const_reference, typename traits::reference>::type>
+    {
+      typedef typename std::conditional<Const, const T*, T*>::type value_ptr;
+    public:
+      typedef typename std::conditional<Const, typename traits::const_reference, typename traits::reference>::type reference;
+      typedef typename std::conditional<Const, typename traits::const_pointer, typename traits::pointer>::type     pointer;
+
+      iterator_impl()
+        :leaf(), pos()
+      {}
+
+      /** The iterator converts to the const_iterator */
+      template<bool C>
+      iterator_impl(const iterator_impl<C>& i, typename std::enable_if<Const || !C>::type* = 0)
+        :leaf(i.leaf), pos(i.pos)
+      {}
+
+      reference operator*() const { return traits::get(leaf->keys.at(pos), static_cast<value_ptr>(leaf->values.at(pos))); }
+      pointer operator->() const { return traits::address(traits::get(leaf->keys.at(pos), static_cast<value_ptr>(leaf->values.at(pos)))); }
+
+      iterator_impl& operator++()
+      {
+        if(++pos == leaf->count && leaf->next){
+          leaf = leaf->next;
+          pos = 0;
+        }
+        return *this;
+      }
+
+      iterator_impl& operator--()
+      {
+        if(!pos){
+          leaf = leaf->prev;
+          pos = leaf->count;
+        }
+        --pos;
+        return *this;
+      }
+
+      iterator_impl operator++(int) { iterator_impl tmp(*this); ++*this; return tmp; }
+      iterator_impl operator--(int) { iterator_impl tmp(*this); --*this; return tmp; }
+
+      friend bool operator==(const iterator_impl& x, const iterator_impl& y) { return x.leaf == y.leaf && x.pos == y.pos; }
+      friend bool operator!=(const iterator_impl& x, const iterator_impl& y) { return !(x == y); }
+
+    private:
+      template<bool> friend class iterator_impl;
+      friend class btree;
+
+      iterator_impl(leaf_node* leaf, size_type pos)
+        :leaf(leaf), pos(pos)
+      {}
+
+      leaf_node* leaf;
+      size_type pos;
+    };
+
+  public:
+    typedef iterator_impl<false>                  iterator;
+    typedef iterator_impl<true>                   const_iterator;
+    typedef std::reverse_iterator<iterator>       reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    explicit btree(const Compare& comp, const Allocator& a)
+      :root_(), first_(), last_(), size_(), height_(), leaves_(), inners_(),
+      comp_(comp), leaf_allocator(a), inner_allocator(a)
+    {}
+
+    btree(const btree& x)
+      :root_(), first_(), last_(), size_(), height_(), leaves_(), inners_(),
+      comp_(x.comp_), leaf_allocator(x.leaf_allocator), inner_allocator(x.inner_allocator)
+    {
+      copy(x);
+    }
+
+#ifdef NTL_CXX_RV
+    btree(btree&& x)
+      :root_(), first_(), last_(), size_(), height_(), leaves_(), inners_(),
+      comp_(x.comp_), leaf_allocator(x.leaf_allocator), inner_allocator(x.inner_allocator)
+    {
+      swap(x);
+    }
+#endif
+
+    ~btree()
+    {
+      clear();
+    }
+
+    btree& operator=(const btree& x)
+    {
+      if(this != &x){
+        clear();
+        comp_ = x.comp_;
+        copy(x);
+      }
+      return *this;
+    }
+
+#ifdef NTL_CXX_RV
+    btree& operator=(btree&& x)
+    {
+      if(this != &x){
+        clear();
+        swap(x);
+      }
+      return *this;
+    }
+#endif
+
+    allocator_type get_allocator() const { return allocator_type(leaf_allocator); }
+
+    ///\name iterators
+    iterator        begin()        { return iterator(first_, 0); }
+    const_iterator  begin()  const { return const_iterator(first_, 0); }
+    iterator        end()          { return iterator(last_, last_ ? last_->count : 0); }
+    const_iterator  end()    const { return const_iterator(last_, last_ ? last_->count : 0); }
+    const_iterator  cbegin() const { return begin(); }
+    const_iterator  cend()   const { return end(); }
+
+    reverse_iterator        rbegin()        { return reverse_iterator(end()); }
+    const_reverse_iterator  rbegin()  const { return const_reverse_iterator(end()); }
+    reverse_iterator        rend()          { return reverse_iterator(begin()); }
+    const_reverse_iterator  rend()    const { return const_reverse_iterator(begin()); }
+    const_reverse_iterator  crbegin() const { return rbegin(); }
+    const_reverse_iterator  crend()   const { return rend(); }
+
+    ///\name capacity
+    bool      empty()    const { return size_ == 0; }
+    size_type size()     const { return size_; }
+    size_type max_size() const { return size_type(-1) / (sizeof(Key) + value_size); }
+
+    /** Levels of the tree including the leaves */
+    size_type height() const { return height_; }
+
+    /** Bytes allocated for the nodes (NTL extension) */
+    size_type memory_footprint() const { return leaves_ * sizeof(leaf_node) + inners_ * sizeof(inner_node); }
+
+    ///\name modifiers
+
+    /** Inserts the range, the strictly increasing range is loaded to the empty tree in O(n) */
+    template<class InputIterator>
+    void insert(InputIterator first, InputIterator last)
+    {
+      insert_range(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+    }
+
+    iterator erase(const_iterator position)
+    {
+      leaf_node* const leaf = position.leaf;
+      const size_type pos = position.pos;
+      --size_;
+      if(leaf->count == 1){
+        if(leaf == root_){
+          clear();
+          return end();
+        }
+        leaf_node* const next = leaf->next;
+        remove_leaf(leaf);
+        return next ? iterator(next, 0) : end();
+      }
+      key_ops::destroy(leaf->keys.at(pos));
+      value_ops::destroy(leaf->values.at(pos));
+      const size_type tail = leaf->count - pos - 1;
+      key_ops::move(leaf->keys.at(pos), leaf->keys.at(pos + 1), tail);
+      value_ops::move(leaf->values.at(pos), leaf->values.at(pos + 1), tail);
+      --leaf->count;
+      return make_iterator(leaf, pos);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+      // the erasure moves the elements in the leaf, so the last iterator doesn't stay valid
+      for(difference_type n = std::distance(first, last); n; --n)
+        first = erase(first);
+      return iterator(first.leaf, first.pos);
+    }
+
+    size_type erase(const key_type& k)
+    {
+      const iterator i = find(k);
+      if(i == end())
+        return 0;
+      erase(i);
+      return 1;
+    }
+
+    void clear()
+    {
+      if(root_)
+        free_node(root_);
+      root_ = nullptr;
+      first_ = last_ = nullptr;
+      size_ = height_ = 0;
+    }
+
+    void swap(btree& x)
+    {
+      using std::swap;
+      swap(root_, x.root_);
+      swap(first_, x.first_);
+      swap(last_, x.last_);
+      swap(size_, x.size_);
+      swap(height_, x.height_);
+      swap(leaves_, x.leaves_);
+      swap(inners_, x.inners_);
+      swap(comp_, x.comp_);
+      swap(leaf_allocator, x.leaf_allocator);
+      swap(inner_allocator, x.inner_allocator);
+    }
+
+    ///\name observers
+    key_compare key_comp() const { return comp_; }
+
+    ///\name operations
+    iterator find(const key_type& k)
+    {
+      const iterator i = lower_bound(k);
+      return i == end() || comp_(k, *i.leaf->keys.at(i.pos)) ? end() : i;
+    }
+
+    const_iterator find(const key_type& k) const { return const_cast<btree*>(this)->find(k); }
+
+    size_type count(const key_type& k) const { return find(k) != end() ? 1 : 0; }
+
+    iterator lower_bound(const key_type& k)
+    {
+      if(!root_)
+        return end();
+      leaf_node* const leaf = descend(k);
+      return make_iterator(leaf, btree_lower_bound(leaf->keys.at(0), leaf->count, k, comp_));
+    }
+
+    const_iterator lower_bound(const key_type& k) const { return const_cast<btree*>(this)->lower_bound(k); }
+
+    iterator upper_bound(const key_type& k)
+    {
+      if(!root_)
+        return end();
+      leaf_node* const leaf = descend(k);
+      return make_iterator(leaf, btree_upper_bound(leaf->keys.at(0), leaf->count, k, comp_));
+    }
+
+    const_iterator upper_bound(const key_type& k) const { return const_cast<btree*>(this)->upper_bound(k); }
+
+    std::pair<iterator, iterator> equal_range(const key_type& k)
+    {
+      const iterator i = find(k);
+      if(i == end())
+        return std::make_pair(lower_bound(k), lower_bound(k));
+      iterator j = i;
+      return std::make_pair(i, ++j);
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const key_type& k) const
+    {
+      const std::pair<iterator, iterator> r = const_cast<btree*>(this)->equal_range(k);
+      return std::pair<const_iterator, const_iterator>(r.first, r.second);
+    }
+    ///\}
+
+    friend bool operator==(const btree& x, const btree& y)
+    {
+      if(x.size() != y.size())
+        return false;
+      return x.equal(y);
+    }
+
+    friend bool operator!=(const btree& x, const btree& y) { return !(x == y); }
+
+  protected:
+#ifdef NTL_CXX_RV
+    template<class V>
+    std::pair<iterator, bool> insert_unique(const Key& k, V&& v)
+    {
+      const std::pair<iterator, bool> r = insert_key(k);
+      if(r.second){
+        __ntl_try {
+          value_ops::construct(r.first.leaf->values.at(r.first.pos), std::forward<V>(v));
+        }
+        __ntl_catch(...) {
+          discard_key(r.first);
+          __ntl_rethrow;
+        }
+      }
+      return r;
+    }
+#else
+    template<class V>
+    std::pair<iterator, bool> insert_unique(const Key& k, const V& v)
+    {
+      const std::pair<iterator, bool> r = insert_key(k);
+      if(r.second){
+        __ntl_try {
+          value_ops::construct(r.first.leaf->values.at(r.first.pos), v);
+        }
+        __ntl_catch(...) {
+          discard_key(r.first);
+          __ntl_rethrow;
+        }
+      }
+      return r;
+    }
+#endif
+
+  private:
+    bool equal(const btree& x) const
+    {
+      for(const_iterator i = begin(), j = x.begin(); i != end(); ++i, ++j)
+        if(!traits::equal(i.leaf->keys.at(i.pos), i.leaf->values.at(i.pos), j.leaf->keys.at(j.pos), j.leaf->values.at(j.pos)))
+          return false;
+      return true;
+    }
+
+    bool full(const node* n) const
+    {
+      return n->count == (n->leaf ? leaf_capacity : inner_capacity);
+    }
+
+    template<class K>
+    leaf_node* descend(const K& k) const
+    {
+      node* n = root_;
+      while(!n->leaf){
+        inner_node* const in = static_cast<inner_node*>(n);
+        n = in->children[btree_upper_bound(in->keys.at(0), in->count, k, comp_)];
+      }
+      return static_cast<leaf_node*>(n);
+    }
+
+    iterator make_iterator(leaf_node* leaf, size_type pos) const
+    {
+      if(pos == leaf->count && leaf->next)
+        return iterator(leaf->next, 0);
+      return iterator(leaf, pos);
+    }
+
+    /** Finds the place of \p k and, if there is no such key, constructs it there; the value slot is left raw */
+    std::pair<iterator, bool> insert_key(const Key& k)
+    {
+      if(!root_){
+        root_ = first_ = last_ = new_leaf();
+        height_ = 1;
+      }else if(full(root_)){
+        inner_node* const r = new_inner();
+        r->children[0] = root_;
+        root_ = r;
+        ++height_;
+        split_child(r, 0, k);
+      }
+
+      node* n = root_;
+      while(!n->leaf){
+        inner_node* const in = static_cast<inner_node*>(n);
+        size_type i = btree_upper_bound(in->keys.at(0), in->count, k, comp_);
+        if(full(in->children[i])){
+          split_child(in, i, k);
+          if(!comp_(k, *in->keys.at(i)))
+            ++i;
+        }
+        n = in->children[i];
+      }
+
+      leaf_node* const leaf = static_cast<leaf_node*>(n);
+      const size_type pos = btree_lower_bound(leaf->keys.at(0), leaf->count, k, comp_);
+      if(pos < leaf->count && !comp_(k, *leaf->keys.at(pos)))
+        return std::make_pair(iterator(leaf, pos), false);
+
+      const size_type tail = leaf->count - pos;
+      key_ops::move(leaf->keys.at(pos + 1), leaf->keys.at(pos), tail);
+      value_ops::move(leaf->values.at(pos + 1), leaf->values.at(pos), tail);
+      key_ops::construct(leaf->keys.at(pos), k);
+      ++leaf->count;
+      ++size_;
+      return std::make_pair(iterator(leaf, pos), true);
+    }
+
+    /** Removes the key placed by insert_key() whose value slot is still raw */
+    void discard_key(iterator i)
+    {
+      leaf_node* const leaf = i.leaf;
+      const size_type pos = i.pos;
+      key_ops::destroy(leaf->keys.at(pos));
+      const size_type tail = leaf->count - pos - 1;
+      key_ops::move(leaf->keys.at(pos), leaf->keys.at(pos + 1), tail);
+      value_ops::move(leaf->values.at(pos), leaf->values.at(pos + 1), tail);
+      --leaf->count;
+      --size_;
+      // only the new root leaf was empty before the key
+      if(!leaf->count)
+        clear();
+    }
+
+    /** Splits the full child \p i of the \p parent which has room for one more key, \p k is the key being inserted */
+    void split_child(inner_node* parent, size_type i, const Key& k)
+    {
+      node* const c = parent->children[i];
+      node* right;
+      Key* separator;
+      if(c->leaf){
+        leaf_node* const l = static_cast<leaf_node*>(c);
+        leaf_node* const r = new_leaf();
+        // the increasing keys leave the full leaves behind, the others split them in halves
+        const size_type keep = comp_(*l->keys.at(l->count - 1), k) ? l->count - 1 : l->count / 2;
+        key_ops::move(r->keys.at(0), l->keys.at(keep), l->count - keep);
+        value_ops::move(r->values.at(0), l->values.at(keep), l->count - keep);
+        r->count = static_cast<uint16_t>(l->count - keep);
+        l->count = static_cast<uint16_t>(keep);
+        r->prev = l;
+        r->next = l->next;
+        if(l->next)
+          l->next->prev = r;
+        else
+          last_ = r;
+        l->next = r;
+        right = r;
+        separator = r->keys.at(0);
+      }else{
+        inner_node* const l = static_cast<inner_node*>(c);
+        inner_node* const r = new_inner();
+        // the middle key goes up, the greater ones go right
+        const size_type mid = l->count / 2;
+        r->count = static_cast<uint16_t>(l->count - mid - 1);
+        key_ops::move(r->keys.at(0), l->keys.at(mid + 1), r->count);
+        for(size_type j = 0; j <= r->count; j++)
+          r->children[j] = l->children[mid + 1 + j];
+        l->count = static_cast<uint16_t>(mid);
+        right = r;
+        separator = l->keys.at(mid);
+      }
+
+      key_ops::move(parent->keys.at(i + 1), parent->keys.at(i), parent->count - i);
+      for(size_type j = parent->count + 1; j > i + 1; j--)
+        parent->children[j] = parent->children[j - 1];
+      if(c->leaf)
+        key_ops::construct(parent->keys.at(i), *separator);
+      else
+        key_ops::move(parent->keys.at(i), separator, 1);
+      parent->children[i + 1] = right;
+      ++parent->count;
+    }
+
+    /** Removes the leaf with the single element left */
+    void remove_leaf(leaf_node* leaf)
+    {
+      // the path to the leaf is found by its key
+      inner_node* path[64];
+      size_type index[64];
+      size_type depth = 0;
+      for(node* n = root_; !n->leaf; depth++){
+        inner_node* const in = static_cast<inner_node*>(n);
+        path[depth] = in;
+        index[depth] = btree_upper_bound(in->keys.at(0), in->count, *leaf->keys.at(0), comp_);
+        n = in->children[index[depth]];
+      }
+
+      if(leaf->prev)
+        leaf->prev->next = leaf->next;
+      else
+        first_ = leaf->next;
+      if(leaf->next)
+        leaf->next->prev = leaf->prev;
+      else
+        last_ = leaf->prev;
+      free_node(leaf);
+
+      // the parents left without children are removed too
+      while(depth--){
+        inner_node* const p = path[depth];
+        const size_type i = index[depth];
+        if(!p->count){
+          inner_allocator.deallocate(p, 1);
+          --inners_;
+          continue;
+        }
+        const size_type k = i ? i - 1 : 0;
+        key_ops::destroy(p->keys.at(k));
+        key_ops::move(p->keys.at(k), p->keys.at(k + 1), p->count - k - 1);
+        for(size_type j = i; j < p->count; j++)
+          p->children[j] = p->children[j + 1];
+        --p->count;
+        break;
+      }
+
+      // the root with the single child is replaced by it
+      while(!root_->leaf && !root_->count){
+        inner_node* const r = static_cast<inner_node*>(root_);
+        root_ = r->children[0];
+        --height_;
+        inner_allocator.deallocate(r, 1);
+        --inners_;
+      }
+    }
+
+    leaf_node* new_leaf()
+    {
+      leaf_node* const l = leaf_allocator.allocate(1);
+      l->count = 0;
+      l->leaf = 1;
+      l->prev = l->next = nullptr;
+      ++leaves_;
+      return l;
+    }
+
+    inner_node* new_inner()
+    {
+      inner_node* const in = inner_allocator.allocate(1);
+      in->count = 0;
+      in->leaf = 0;
+      ++inners_;
+      return in;
+    }
+
+    /** Destroys the subtree */
+    void free_node(node* n)
+    {
+      if(n->leaf){
+        leaf_node* const l = static_cast<leaf_node*>(n);
+        key_ops::destroy(l->keys.at(0), l->count);
+        value_ops::destroy(l->values.at(0), l->count);
+        leaf_allocator.deallocate(l, 1);
+        --leaves_;
+      }else{
+        inner_node* const in = static_cast<inner_node*>(n);
+        for(size_type i = 0; i <= in->count; i++)
+          free_node(in->children[i]);
+        key_ops::destroy(in->keys.at(0), in->count);
+        inner_allocator.deallocate(in, 1);
+        --inners_;
+      }
+    }
+
+    template<class InputIterator>
+    void insert_range(InputIterator first, InputIterator last, std::input_iterator_tag)
+    {
+      for(; first != last; ++first){
+        const value_type& x = *first;
+        insert_unique(traits::key(x), traits::value(x));
+      }
+    }
+
+    template<class ForwardIterator>
+    void insert_range(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+    {
+      if(empty() && first != last){
+        ForwardIterator prev = first, i = first;
+        for(++i; i != last && comp_(traits::key(*prev), traits::key(*i)); prev = i, ++i)
+          ;
+        if(i == last){
+          __ntl_try {
+            for(; first != last; ++first){
+              const value_type& x = *first;
+              append(traits::key(x), traits::value(x));
+            }
+          }
+          __ntl_catch(...) {
+            // the elements appended so far stay in the tree
+            build_index();
+            __ntl_rethrow;
+          }
+          build_index();
+          return;
+        }
+      }
+      insert_range(first, last, std::input_iterator_tag());
+    }
+
+    void copy(const btree& x)
+    {
+      __ntl_try {
+        for(const leaf_node* l = x.first_; l; l = l->next)
+          for(size_type i = 0; i < l->count; i++)
+            append(*l->keys.at(i), *l->values.at(i));
+      }
+      __ntl_catch(...) {
+        // the copy constructor has no destructor to free the part copied
+        build_index();
+        clear();
+        __ntl_rethrow;
+      }
+      build_index();
+    }
+
+    /**
+     *	@brief Appends the element with the key greater than all others to the chain of the leaves, the inner nodes
+     *  are built by build_index(). The chain is left as is if the key or the value constructor throws.
+     **/
+    template<class V>
+    void append(const Key& k, const V& v)
+    {
+      leaf_node* l = last_;
+      if(!l || l->count == leaf_capacity){
+        leaf_node* const r = new_leaf();
+        r->prev = l;
+        if(l)
+          l->next = r;
+        else
+          first_ = r;
+        last_ = l = r;
+      }
+      __ntl_try {
+        key_ops::construct(l->keys.at(l->count), k);
+        __ntl_try {
+          value_ops::construct(l->values.at(l->count), v);
+        }
+        __ntl_catch(...) {
+          key_ops::destroy(l->keys.at(l->count));
+          __ntl_rethrow;
+        }
+      }
+      __ntl_catch(...) {
+        if(!l->count){
+          last_ = l->prev;
+          if(last_)
+            last_->next = nullptr;
+          else
+            first_ = nullptr;
+          free_node(l);
+        }
+        __ntl_rethrow;
+      }
+      ++l->count;
+      ++size_;
+    }
+
+    /** Builds the full inner nodes over the chain of the leaves */
+    void build_index()
+    {
+      if(!first_)
+        return;
+      std::vector<node*> level;
+      level.reserve(leaves_);
+      for(leaf_node* l = first_; l; l = l->next)
+        level.push_back(l);
+
+      height_ = 1;
+      while(level.size() > 1){
+        std::vector<node*> up;
+        up.reserve(level.size() / inner_capacity + 1);
+        for(size_type i = 0; i < level.size(); ){
+          // don't leave the single child to the last node
+          size_type n = level.size() - i;
+          if(n > inner_capacity + 1)
+            n = n - (inner_capacity + 1) == 1 ? inner_capacity : inner_capacity + 1;
+          inner_node* const in = new_inner();
+          in->children[0] = level[i];
+          for(size_type j = 1; j < n; j++){
+            in->children[j] = level[i + j];
+            key_ops::construct(in->keys.at(j - 1), min_key(level[i + j]));
+          }
+          in->count = static_cast<uint16_t>(n - 1);
+          up.push_back(in);
+          i += n;
+        }
+        level.swap(up);
+        ++height_;
+      }
+      root_ = level[0];
+    }
+
+    static const Key& min_key(const node* n)
+    {
+      while(!n->leaf)
+        n = static_cast<const inner_node*>(n)->children[0];
+      return *static_cast<const leaf_node*>(n)->keys.at(0);
+    }
+
+  private:
+    node* root_;
+    leaf_node *first_, *last_;
+    size_type size_, height_;
+    size_type leaves_, inners_;
+    key_compare comp_;
+    typename Allocator::template rebind<leaf_node>::other  leaf_allocator;
+    typename Allocator::template rebind<inner_node>::other inner_allocator;
+  };
+} // __
+
+
+/**
+ *	@brief Ordered map of the unique keys stored in the B+ tree
+ *
+ *  The interface follows std::map, but the keys and the mapped values are stored apart, so the iterator
+ *  refers to the pair of references (\c first and \c second) rather than to the \c pair object.
+ *  Any insertion or erasure invalidates the iterators. The \c NodeSize is the size of the node in bytes.
+ **/
+template<class Key, class T, class Compare = std::less<Key>, class Allocator = std::allocator<std::pair<const Key, T> >, size_t NodeSize = 256>
+class btree_map:
+  public __::btree<Key, T, Compare, Allocator, NodeSize>
+{
+  typedef __::btree<Key, T, Compare, Allocator, NodeSize> base;
+public:
+  typedef T                             mapped_type;
+  typedef typename base::value_type     value_type;
+  typedef typename base::iterator       iterator;
+  typedef typename base::const_iterator const_iterator;
+  typedef typename base::size_type      size_type;
+
+  explicit btree_map(const Compare& comp = Compare(), const Allocator& a = Allocator())
+    :base(comp, a)
+  {}
+
+  template<class InputIterator>
+  btree_map(InputIterator first, InputIterator last, const Compare& comp = Compare(), const Allocator& a = Allocator())
+    :base(comp, a)
+  {
+    base::insert(first, last);
+  }
+
+  using base::insert;
+
+  std::pair<iterator, bool> insert(const value_type& x)
+  {
+    return this->insert_unique(x.first, x.second);
+  }
+
+  /** The hint is not used: the search from the root costs a few nodes */
+  iterator insert(const_iterator, const value_type& x)
+  {
+    return insert(x).first;
+  }
+
+#ifdef NTL_CXX_RV
+  std::pair<iterator, bool> insert(value_type&& x)
+  {
+    return this->insert_unique(x.first, std::move(x.second));
+  }
+#endif
+
+#ifdef NTL_CXX_VT
+  template<class... Args>
+  std::pair<iterator, bool> emplace(Args&&... args)
+  {
+    return insert(value_type(std::forward<Args>(args)...));
+  }
+#endif
+
+  T& operator[](const Key& k)
+  {
+    const iterator i = this->find(k);
+    if(i != this->end())
+      return (*i).second;
+    return (*this->insert_unique(k, T()).first).second;
+  }
+
+  T& at(const Key& k)
+  {
+    const iterator i = this->find(k);
+    if(i == this->end())
+      std::__throw_out_of_range("btree_map::at: no such key");
+    return (*i).second;
+  }
+
+  const T& at(const Key& k) const
+  {
+    return const_cast<btree_map*>(this)->at(k);
+  }
+};
+
+
+/**
+ *	@brief Ordered set of the unique keys stored in the B+ tree
+ *
+ *  The interface follows std::set. Any insertion or erasure invalidates the iterators.
+ **/
+template<class Key, class Compare = std::less<Key>, class Allocator = std::allocator<Key>, size_t NodeSize = 256>
+class btree_set:
+  public __::btree<Key, __::btree_no_value, Compare, Allocator, NodeSize>
+{
+  typedef __::btree<Key, __::btree_no_value, Compare, Allocator, NodeSize> base;
+public:
+  typedef typename base::value_type     value_type;
+  typedef typename base::iterator       iterator;
+  typedef typename base::const_iterator const_iterator;
+
+  explicit btree_set(const Compare& comp = Compare(), const Allocator& a = Allocator())
+    :base(comp, a)
+  {}
+
+  template<class InputIterator>
+  btree_set(InputIterator first, InputIterator last, const Compare& comp = Compare(), const Allocator& a = Allocator())
+    :base(comp, a)
+  {
+    base::insert(first, last);
+  }
+
+  using base::insert;
+
+  std::pair<iterator, bool> insert(const value_type& x)
+  {
+    return this->insert_unique(x, __::btree_no_value());
+  }
+
+  iterator insert(const_iterator, const value_type& x)
+  {
+    return insert(x).first;
+  }
+};
+
+/**@} lib_containers */
+
+} // ntl
+
+#endif // NTL__BTREE
@@ -0,0 +1,354 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Bitset of the runtime size
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__DYNAMIC_BITSET
+#define NTL__DYNAMIC_BITSET
+#pragma once
+
+#include "stlx/vector.hxx"
+#include "stlx/stdexcept.hxx"
+#include "stlx/cassert.hxx"
+#include "stlx/ext/bitops.hxx"
+
+namespace ntl {
+
+/**\addtogroup  lib_containers
+ *@{*/
+
+/**
+ *	@brief Bitset which size is given at runtime
+ *
+ *  The interface follows std::bitset, the bits are kept in the vector of the machine words
+ *  and processed by the same word kernels. The binary operations require the equal sizes.
+ *  The set bits are iterated by find_first() and find_next():
+ *  \code
+ *  for(size_t cpu = mask.find_first(); cpu != mask.npos; cpu = mask.find_next(cpu))
+ *  \endcode
+ **/
+template<class Allocator = std::allocator<std::ext::bitops::word_type> >
+class dynamic_bitset
+{
+  typedef std::ext::bitops::word_type word_type;
+  typedef std::vector<word_type, Allocator> storage_type;
+  static const size_t word_bits = std::ext::bitops::word_bits;
+public:
+  typedef Allocator allocator_type;
+  typedef size_t    size_type;
+
+  static const size_type npos = static_cast<size_type>(-1);
+
+  /// bit reference
+  class reference
+  {
+    friend class dynamic_bitset;
+    reference(dynamic_bitset& b, size_t pos)
+      :bitset_(b), pos_(pos)
+    {}
+  public:
+    reference& operator=(bool x)
+    {
+      bitset_.set(pos_, x);
+      return *this;
+    }
+
+    reference& operator=(const reference& rhs)
+    {
+      bitset_.set(pos_, rhs);
+      return *this;
+    }
+
+    bool operator~() const { return !bitset_.test(pos_); }
+    operator bool() const { return bitset_.test(pos_); }
+
+    reference& flip()
+    {
+      bitset_.flip(pos_);
+      return *this;
+    }
+
+  private:
+    dynamic_bitset& bitset_;
+    const size_t pos_;
+  };
+
+  ///\name construct/copy/destroy
+  explicit dynamic_bitset(const Allocator& a = Allocator())
+    :bits_(0), storage_(a)
+  {}
+
+  /** Makes \p n bits, the lower bits are taken from \p value */
+  explicit dynamic_bitset(size_type n, unsigned long long value = 0, const Allocator& a = Allocator())
+    :bits_(n), storage_(std::ext::bitops::words(n), 0, a)
+  {
+    for(size_t i = 0; i < storage_.size() && i * word_bits < sizeof(value) * 8; ++i)
+      storage_[i] = static_cast<word_type>(value >> (i * word_bits));
+    trim();
+  }
+
+  dynamic_bitset(const dynamic_bitset& x)
+    :bits_(x.bits_), storage_(x.storage_)
+  {}
+
+#ifdef NTL_CXX_RV
+  dynamic_bitset(dynamic_bitset&& x)
+    :bits_(x.bits_), storage_(std::move(x.storage_))
+  {
+    x.bits_ = 0;
+  }
+#endif
+
+  dynamic_bitset& operator=(const dynamic_bitset& x)
+  {
+    bits_ = x.bits_;
+    storage_ = x.storage_;
+    return *this;
+  }
+
+#ifdef NTL_CXX_RV
+  dynamic_bitset& operator=(dynamic_bitset&& x)
+  {
+    swap(x);
+    return *this;
+  }
+#endif
+
+  void swap(dynamic_bitset& x)
+  {
+    std::swap(bits_, x.bits_);
+    storage_.swap(x.storage_);
+  }
+
+  allocator_type get_allocator() const { return storage_.get_allocator(); }
+
+  ///\name size
+  size_type size() const { return bits_; }
+  size_type num_blocks() const { return storage_.size(); }
+  bool empty() const { return bits_ == 0; }
+
+  /** Changes the number of bits, the new bits are set to \p value */
+  void resize(size_type n, bool value = false)
+  {
+    const size_t old = bits_;
+    storage_.resize(std::ext::bitops::words(n), value ? ~word_type(0) : 0);
+    bits_ = n;
+    if(value && n > old && old % word_bits)
+      // the unused bits of the former last word are zero
+      storage_[old / word_bits] |= ~word_type(0) << (old % word_bits);
+    trim();
+  }
+
+  void clear()
+  {
+    storage_.clear();
+    bits_ = 0;
+  }
+
+  void push_back(bool value)
+  {
+    resize(bits_ + 1);
+    set(bits_ - 1, value);
+  }
+
+  ///\name bit access
+  bool test(size_t pos) const __ntl_throws(std::out_of_range)
+  {
+    check_bounds(pos);
+    return (storage_[pos / word_bits] >> (pos % word_bits)) & 1;
+  }
+
+  bool operator[](size_t pos) const
+  {
+    assert(pos < bits_);
+    return (storage_[pos / word_bits] >> (pos % word_bits)) & 1;
+  }
+
+  reference operator[](size_t pos)
+  {
+    return reference(*this, pos);
+  }
+
+  ///\name modifiers
+  dynamic_bitset& set()
+  {
+    std::ext::bitops::fill(storage_.data(), storage_.size(), ~word_type(0));
+    trim();
+    return *this;
+  }
+
+  dynamic_bitset& set(size_t pos, bool value = true) __ntl_throws(std::out_of_range)
+  {
+    check_bounds(pos);
+    word_type& w = storage_[pos / word_bits];
+    const word_type bit = word_type(1) << (pos % word_bits);
+    w = value ? (w | bit) : (w & ~bit);
+    return *this;
+  }
+
+  dynamic_bitset& reset()
+  {
+    std::ext::bitops::fill(storage_.data(), storage_.size(), 0);
+    return *this;
+  }
+
+  dynamic_bitset& reset(size_t pos) __ntl_throws(std::out_of_range)
+  {
+    return set(pos, false);
+  }
+
+  dynamic_bitset& flip()
+  {
+    std::ext::bitops::flip(storage_.data(), storage_.size());
+    trim();
+    return *this;
+  }
+
+  dynamic_bitset& flip(size_t pos) __ntl_throws(std::out_of_range)
+  {
+    check_bounds(pos);
+    storage_[pos / word_bits] ^= word_type(1) << (pos % word_bits);
+    return *this;
+  }
+
+  ///\name bitset operations
+  dynamic_bitset& operator&=(const dynamic_bitset& rhs)
+  {
+    assert(bits_ == rhs.bits_);
+    std::ext::bitops::assign_and(storage_.data(), rhs.storage_.data(), storage_.size());
+    return *this;
+  }
+
+  dynamic_bitset& operator|=(const dynamic_bitset& rhs)
+  {
+    assert(bits_ == rhs.bits_);
+    std::ext::bitops::assign_or(storage_.data(), rhs.storage_.data(), storage_.size());
+    return *this;
+  }
+
+  dynamic_bitset& operator^=(const dynamic_bitset& rhs)
+  {
+    assert(bits_ == rhs.bits_);
+    std::ext::bitops::assign_xor(storage_.data(), rhs.storage_.data(), storage_.size());
+    return *this;
+  }
+
+  dynamic_bitset& operator<<=(size_t pos)
+  {
+    if(pos >= bits_)
+      return reset();
+    std::ext::bitops::shift_left(storage_.data(), storage_.size(), pos);
+    trim();
+    return *this;
+  }
+
+  dynamic_bitset& operator>>=(size_t pos)
+  {
+    if(pos >= bits_)
+      return reset();
+    std::ext::bitops::shift_right(storage_.data(), storage_.size(), pos);
+    return *this;
+  }
+
+  dynamic_bitset operator~() const
+  {
+    return dynamic_bitset(*this).flip();
+  }
+
+  dynamic_bitset operator<<(size_t pos) const
+  {
+    return dynamic_bitset(*this) <<= pos;
+  }
+
+  dynamic_bitset operator>>(size_t pos) const
+  {
+    return dynamic_bitset(*this) >>= pos;
+  }
+
+  ///\name observers
+  size_type count() const
+  {
+    return std::ext::bitops::count(storage_.data(), storage_.size());
+  }
+
+  bool any()  const { return std::ext::bitops::any(storage_.data(), storage_.size()); }
+  bool none() const { return !any(); }
+  bool all()  const { return count() == bits_; }
+
+  /** Position of the first set bit or npos if there is none */
+  size_type find_first() const
+  {
+    return found(std::ext::bitops::find_next(storage_.data(), storage_.size(), 0));
+  }
+
+  /** Position of the first set bit after \p prev or npos if there is none */
+  size_type find_next(size_type prev) const
+  {
+    return prev + 1 >= bits_ ? npos : found(std::ext::bitops::find_next(storage_.data(), storage_.size(), prev + 1));
+  }
+
+  bool operator==(const dynamic_bitset& rhs) const
+  {
+    return bits_ == rhs.bits_ && storage_ == rhs.storage_;
+  }
+
+  bool operator!=(const dynamic_bitset& rhs) const
+  {
+    return !(*this == rhs);
+  }
+  ///\}
+
+private:
+  void check_bounds(size_t pos) const __ntl_throws(std::out_of_range)
+  {
+    if(pos >= bits_)
+      __ntl_throw(std::out_of_range(__FUNCTION__));
+  }
+
+  // the unused bits of the last word are kept zero
+  void trim()
+  {
+    if(!storage_.empty())
+      storage_.back() &= std::ext::bitops::tail_mask(bits_);
+  }
+
+  size_type found(size_t pos) const
+  {
+    return pos < bits_ ? pos : npos;
+  }
+
+private:
+  size_type bits_;
+  storage_type storage_;
+};
+
+template<class Allocator>
+inline dynamic_bitset<Allocator> operator&(const dynamic_bitset<Allocator>& lhs, const dynamic_bitset<Allocator>& rhs)
+{
+  return dynamic_bitset<Allocator>(lhs) &= rhs;
+}
+
+template<class Allocator>
+inline dynamic_bitset<Allocator> operator|(const dynamic_bitset<Allocator>& lhs, const dynamic_bitset<Allocator>& rhs)
+{
+  return dynamic_bitset<Allocator>(lhs) |= rhs;
+}
+
+template<class Allocator>
+inline dynamic_bitset<Allocator> operator^(const dynamic_bitset<Allocator>& lhs, const dynamic_bitset<Allocator>& rhs)
+{
+  return dynamic_bitset<Allocator>(lhs) ^= rhs;
+}
+
+template<class Allocator>
+inline void swap(dynamic_bitset<Allocator>& x, dynamic_bitset<Allocator>& y)
+{
+  x.swap(y);
+}
+
+/**@} lib_containers */
+
+} // namespace ntl
+
+#endif // NTL__DYNAMIC_BITSET
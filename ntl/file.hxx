@@ -120,6 +120,7 @@ class basic_file : public traits
       return success(f.rename(new_name, replace_if_exists));
     }
 
+    /** Reads the whole file of up to 4 GB into the memory, nt::mapped_view gives the file bytes without the copy */
     __forceinline
     raw_data get_data() __ntl_throws(std::bad_alloc)
     {
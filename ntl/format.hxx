@@ -1,6 +1,6 @@
 /**\file*********************************************************************
  *                                                                     \brief
- *
+ *  Integer to string conversions and type-safe format strings
  *
  ****************************************************************************
  */
@@ -8,7 +8,9 @@
 #define NTL__FORMAT
 #pragma once
 
-#include "base.hxx"
+#include "basedef.hxx"
+#include "stlx/string_ref.hxx"
+#include "spp/args.hxx"
 
 namespace ntl {
 namespace fmt {
@@ -43,18 +45,18 @@ char_t * to_hex(int_t v, char_t * const p)
 template<typename char_t = char>
 struct hex_str_cast
 {
-    hex_str_cast(int8 v)    { to_hex(v, buf); }
-    hex_str_cast(int16 v)   { to_hex(v, buf); }
-    hex_str_cast(int32 v)   { to_hex(v, buf); }
-    hex_str_cast(int64 v)   { to_hex(v, buf); }
-    hex_str_cast(uint8 v)   { to_hex(v, buf); }
-    hex_str_cast(uint16 v)  { to_hex(v, buf); }
-    hex_str_cast(uint32 v)  { to_hex(v, buf); }
-    hex_str_cast(uint64 v)  { to_hex(v, buf); }
+    hex_str_cast(int8_t v)    { to_hex(v, buf); }
+    hex_str_cast(int16_t v)   { to_hex(v, buf); }
+    hex_str_cast(int32_t v)   { to_hex(v, buf); }
+    hex_str_cast(int64_t v)   { to_hex(v, buf); }
+    hex_str_cast(uint8_t v)   { to_hex(v, buf); }
+    hex_str_cast(uint16_t v)  { to_hex(v, buf); }
+    hex_str_cast(uint32_t v)  { to_hex(v, buf); }
+    hex_str_cast(uint64_t v)  { to_hex(v, buf); }
     operator const char_t * () { return buf; }
 
   private:
-    char_t    buf[sizeof(uint64) * 2 + sizeof("0x")];
+    char_t    buf[sizeof(uint64_t) * 2 + sizeof("0x")];
 };//struct hex_str_cast
 
 
@@ -86,14 +88,14 @@ char_t * to_dec(int_t v, char_t * const p)
 template<typename char_t = char>
 struct str_cast
 {
-    str_cast(int8 v)    { to_dec(v, buf); }
-    str_cast(int16 v)   { to_dec(v, buf); }
-    str_cast(int32 v)   { to_dec(v, buf); }
-    str_cast(int64 v)   { to_dec(v, buf); }
-    str_cast(uint8 v)   { to_dec(v, buf); }
-    str_cast(uint16 v)  { to_dec(v, buf); }
-    str_cast(uint32 v)  { to_dec(v, buf); }
-    str_cast(uint64 v)  { to_dec(v, buf); }
+    str_cast(int8_t v)    { to_dec(v, buf); }
+    str_cast(int16_t v)   { to_dec(v, buf); }
+    str_cast(int32_t v)   { to_dec(v, buf); }
+    str_cast(int64_t v)   { to_dec(v, buf); }
+    str_cast(uint8_t v)   { to_dec(v, buf); }
+    str_cast(uint16_t v)  { to_dec(v, buf); }
+    str_cast(uint32_t v)  { to_dec(v, buf); }
+    str_cast(uint64_t v)  { to_dec(v, buf); }
     operator const char_t * () { return buf; }
 
   private:
@@ -101,6 +103,1368 @@ struct str_cast
 };//struct str_cast
 
 
+/**\defgroup format_string Type-safe format strings
+ *
+ *  The replacement fields are <tt>{}</tt> or <tt>{:spec}</tt>, taking the arguments in order;
+ *  <tt>{{</tt> and <tt>}}</tt> are the literal braces. The spec is <tt>[[fill]align][sign][#][0][width][.precision][type]</tt>:
+ *  - align: \c < left, \c > right, \c ^ center; strings and characters are left aligned by default, numbers right
+ *  - sign: \c + for every number, \c - for the negative ones only (default), space for the space before the positive ones
+ *  - \c #: \c 0x, \c 0b, \c 0 prefix of the integers; the decimal point of the floats is always written
+ *  - \c 0: pads the numbers with zeros after the sign and the prefix
+ *  - precision: digits after the decimal point (\c f, \c e), significant digits (\c g) or the maximal length of the strings
+ *  - type: \c d, \c x, \c X, \c b, \c o, \c c of the integers; \c f, \c F, \c e, \c E, \c g, \c G of the floats;
+ *    \c s of the strings and \c p of the pointers. The floats are formatted as \c g with 6 digits by default.
+ *
+ *  The formatting allocates nothing (only basic_memory_buffer grows) and consults no locale: the integers are converted
+ *  by the two-digit table, the floats get at most 17 significant digits rounded as printf does them and the zeros after them,
+ *  the fixed notation of the values above 1e19 falls back to the exponent.
+ *  In the kernel mode the caller formatting the floats on x86 must save the floating point state.
+ *
+ *  The format string wrapped by the NTL_FMT is parsed at compile time (where the compiler supports constexpr):
+ *  the invalid string, the wrong number of the arguments or the type spec not suitable for the argument fail the compilation.
+ *  The plain string is parsed as is: the invalid replacement fields and the fields without arguments are written literally,
+ *  the excess arguments are ignored and the type spec not suitable for the argument is replaced by its default.
+ *  The strings of the other character width and the wide characters in the narrow format fail the compilation in both cases.
+ *
+ *  \code
+ *  char buf[128];
+ *  const fmt::format_to_n_result<char*> r = fmt::format_to_n(buf, _countof(buf)-1, NTL_FMT("{}: {:#010x}"), name, status);
+ *  *r.out = 0;
+ *
+ *  fmt::memory_buffer mb;
+ *  fmt::format_to(mb, "{:>8.3f} ms", elapsed);
+ *  \endcode
+ *@{*/
+
+/**
+ *	@brief Output buffer of the formatting functions
+ *
+ *  The storage is provided by the derived class, which makes the room by reallocation or by flushing
+ *  of the written characters. The characters which don't fit are discarded and counted.
+ **/
+template<typename charT>
+class basic_buffer
+{
+  basic_buffer(const basic_buffer&) __deleted;
+  basic_buffer& operator=(const basic_buffer&) __deleted;
+public:
+  typedef charT   value_type;
+  typedef size_t  size_type;
+
+  charT* data() { return ptr_; }
+  const charT* data() const { return ptr_; }
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+
+  /** Number of the characters discarded because the buffer could not grow */
+  size_t truncated() const { return dropped_; }
+
+  void clear() { size_ = dropped_ = 0; }
+
+  void push_back(charT c)
+  {
+    if(size_ == capacity_){
+      grow(size_ + 1);
+      if(size_ == capacity_){
+        ++dropped_;
+        return;
+      }
+    }
+    ptr_[size_++] = c;
+  }
+
+  void append(const charT* s, size_t n)
+  {
+    if(n > capacity_ - size_)
+      grow(size_ + n);
+    while(n){
+      if(size_ == capacity_){
+        grow(size_ + n);
+        if(size_ == capacity_){
+          dropped_ += n;
+          return;
+        }
+      }
+      const size_t k = n < capacity_ - size_ ? n : capacity_ - size_;
+      std::char_traits<charT>::copy(ptr_ + size_, s, k);
+      size_ += k, s += k, n -= k;
+    }
+  }
+
+  /** Appends \p n copies of the \p c */
+  void fill(charT c, size_t n)
+  {
+    if(n > capacity_ - size_)
+      grow(size_ + n);
+    while(n){
+      if(size_ == capacity_){
+        grow(size_ + n);
+        if(size_ == capacity_){
+          dropped_ += n;
+          return;
+        }
+      }
+      const size_t k = n < capacity_ - size_ ? n : capacity_ - size_;
+      std::char_traits<charT>::assign(ptr_ + size_, k, c);
+      size_ += k, n -= k;
+    }
+  }
+
+protected:
+  basic_buffer(charT* p, size_t capacity)
+    :ptr_(p), size_(), capacity_(capacity), dropped_()
+  {}
+  ~basic_buffer()
+  {}
+
+  /** Makes the room for the \p capacity characters, it is not an error to leave the buffer full */
+  virtual void grow(size_t capacity) = 0;
+
+  charT* ptr_;
+  size_t size_, capacity_, dropped_;
+};
+
+/**
+ *	@brief Growable buffer: the first \p N characters are stored inline, the rest in the memory of the \p Allocator
+ *
+ *  Failure of the allocation (which doesn't throw in the kernel mode) truncates the output.
+ **/
+template<typename charT, size_t N = 256, class Allocator = std::allocator<charT> >
+class basic_memory_buffer:
+  public basic_buffer<charT>
+{
+  static_assert(N > 0, "the inline storage is required");
+public:
+  typedef Allocator allocator_type;
+
+  explicit basic_memory_buffer(const Allocator& a = Allocator())
+    :basic_buffer<charT>(store, N), alloc(a)
+  {}
+
+  ~basic_memory_buffer()
+  {
+    if(this->ptr_ != store)
+      alloc.deallocate(this->ptr_, this->capacity_);
+  }
+
+  std::basic_string_ref<charT> str() const { return std::basic_string_ref<charT>(this->ptr_, this->size_); }
+
+  /** The contents terminated by the null character (the last character is dropped if the terminator doesn't fit) */
+  const charT* c_str()
+  {
+    if(this->size_ == this->capacity_)
+      grow(this->size_ + 1);
+    if(this->size_ == this->capacity_)
+      --this->size_, ++this->dropped_;
+    this->ptr_[this->size_] = charT();
+    return this->ptr_;
+  }
+
+protected:
+  void grow(size_t capacity)
+  {
+    size_t n = this->capacity_ + this->capacity_ / 2;
+    if(n < capacity)
+      n = capacity;
+    charT* const p = alloc.allocate(n);
+    if(!p)
+      return;
+    std::char_traits<charT>::copy(p, this->ptr_, this->size_);
+    if(this->ptr_ != store)
+      alloc.deallocate(this->ptr_, this->capacity_);
+    this->ptr_ = p;
+    this->capacity_ = n;
+  }
+
+private:
+  Allocator alloc;
+  charT store[N];
+};
+
+typedef basic_memory_buffer<char>     memory_buffer;
+typedef basic_memory_buffer<wchar_t>  wmemory_buffer;
+
+
+/** Type-erased argument of the vformat_to() */
+template<typename charT>
+struct basic_format_arg
+{
+  enum type_t { none_type, int_type, uint_type, bool_type, char_type, float_type, string_type, pointer_type };
+  typedef typename std::conditional<std::is_same<charT, char>::value, wchar_t, char>::type other_char_type;
+
+  struct string_value
+  {
+    const charT* data;
+    size_t size;
+  };
+
+  type_t type;
+  union
+  {
+    int64_t       i;
+    uint64_t      u;
+    bool          b;
+    charT         c;
+    double        d;
+    const void*   p;
+    string_value  s;
+  } value;
+
+  basic_format_arg()                    :type(none_type) {}
+  basic_format_arg(signed char v)       :type(int_type)  { value.i = v; }
+  basic_format_arg(short v)             :type(int_type)  { value.i = v; }
+  basic_format_arg(int v)               :type(int_type)  { value.i = v; }
+  basic_format_arg(long v)              :type(int_type)  { value.i = v; }
+  basic_format_arg(long long v)         :type(int_type)  { value.i = v; }
+  basic_format_arg(unsigned char v)     :type(uint_type) { value.u = v; }
+  basic_format_arg(unsigned short v)    :type(uint_type) { value.u = v; }
+  basic_format_arg(unsigned int v)      :type(uint_type) { value.u = v; }
+  basic_format_arg(unsigned long v)     :type(uint_type) { value.u = v; }
+  basic_format_arg(unsigned long long v):type(uint_type) { value.u = v; }
+  basic_format_arg(bool v)              :type(bool_type) { value.b = v; }
+  basic_format_arg(char v)              :type(char_type) { value.c = static_cast<charT>(v); }
+  basic_format_arg(wchar_t v)           :type(char_type)
+  {
+    static_assert(sizeof(charT) >= sizeof(wchar_t), "the wide character doesn't fit the narrow format");
+    value.c = static_cast<charT>(v);
+  }
+  basic_format_arg(float v)             :type(float_type) { value.d = v; }
+  basic_format_arg(double v)            :type(float_type) { value.d = v; }
+  basic_format_arg(long double v)       :type(float_type) { value.d = static_cast<double>(v); }
+  basic_format_arg(const void* v)       :type(pointer_type) { value.p = v; }
+  template<typename T>
+  basic_format_arg(const T* v)          :type(pointer_type) { value.p = v; }
+  basic_format_arg(const charT* v)      :type(string_type) { set(v, v ? std::char_traits<charT>::length(v) : 0); }
+  basic_format_arg(charT* v)            :type(string_type) { set(v, v ? std::char_traits<charT>::length(v) : 0); }
+  // the strings of the other width are not converted and not printed as the pointers
+  basic_format_arg(const other_char_type*):type(none_type) { static_assert(sizeof(charT) == 0, "the string of the other character width is not formatted"); }
+  basic_format_arg(other_char_type*)      :type(none_type) { static_assert(sizeof(charT) == 0, "the string of the other character width is not formatted"); }
+  template<class traits>
+  basic_format_arg(const std::basic_string_ref<charT, traits>& v):type(string_type) { set(v.data(), v.size()); }
+  template<class traits, class Allocator>
+  basic_format_arg(const std::basic_string<charT, traits, Allocator>& v):type(string_type) { set(v.data(), v.size()); }
+
+private:
+  void set(const charT* data, size_t size)
+  {
+    value.s.data = data;
+    value.s.size = size;
+  }
+};
+
+/** Base of the format strings parsed at compile time, see NTL_FMT */
+struct compile_string {};
+
+template<class OutputIt>
+struct format_to_n_result
+{
+  /** End of the written characters */
+  OutputIt out;
+  /** Length of the whole formatted string, which is larger than written if the output was truncated */
+  size_t size;
+};
+
+
+namespace __
+{
+  // format spec grammar, shared by the compile time validation and the runtime parser
+  template<typename charT>
+  constexpr bool fmt_is_digit(charT c) { return c >= '0' && c <= '9'; }
+  template<typename charT>
+  constexpr bool fmt_is_align(charT c) { return c == '<' || c == '>' || c == '^'; }
+  template<typename charT>
+  constexpr bool fmt_is_sign(charT c) { return c == '+' || c == '-' || c == ' '; }
+  template<typename charT>
+  constexpr bool fmt_is_int_type(charT c) { return c == 'd' || c == 'x' || c == 'X' || c == 'b' || c == 'o'; }
+  template<typename charT>
+  constexpr bool fmt_is_float_type(charT c) { return c == 'f' || c == 'F' || c == 'e' || c == 'E' || c == 'g' || c == 'G'; }
+  template<typename charT>
+  constexpr bool fmt_is_type(charT c) { return fmt_is_int_type(c) || fmt_is_float_type(c) || c == 'c' || c == 's' || c == 'p'; }
+
+  template<typename charT>
+  constexpr const charT* fmt_skip_fill_align(const charT* p)
+  {
+    return p[0] && p[0] != '{' && p[0] != '}' && fmt_is_align(p[1]) ? p + 2 : fmt_is_align(p[0]) ? p + 1 : p;
+  }
+  template<typename charT>
+  constexpr const charT* fmt_skip_if(const charT* p, bool cond) { return cond ? p + 1 : p; }
+  template<typename charT>
+  constexpr const charT* fmt_skip_digits(const charT* p) { return fmt_is_digit(*p) ? fmt_skip_digits(p + 1) : p; }
+  template<typename charT>
+  constexpr const charT* fmt_skip_precision(const charT* p)
+  {
+    return *p != '.' ? p : fmt_is_digit(p[1]) ? fmt_skip_digits(p + 1) : nullptr;
+  }
+  template<typename charT>
+  constexpr const charT* fmt_skip_flags(const charT* p)
+  {
+    return fmt_skip_if(fmt_skip_if(p, *p == '#'), *fmt_skip_if(p, *p == '#') == '0');
+  }
+
+  /** Position of the type in the spec which starts at \p p (after ':'), null if the spec is invalid */
+  template<typename charT>
+  constexpr const charT* fmt_spec_type(const charT* p)
+  {
+    return fmt_skip_precision(fmt_skip_digits(fmt_skip_flags(fmt_skip_if(fmt_skip_fill_align(p), fmt_is_sign(*fmt_skip_fill_align(p))))));
+  }
+  template<typename charT>
+  constexpr const charT* fmt_spec_end(const charT* t)
+  {
+    return !t ? nullptr : *t == '}' ? t + 1 : fmt_is_type(*t) && t[1] == '}' ? t + 2 : nullptr;
+  }
+
+  /** End of the replacement field which starts at \p p (after '{'), null if the field is invalid */
+  template<typename charT>
+  constexpr const charT* fmt_field_end(const charT* p)
+  {
+    return *p == '}' ? p + 1 : *p == ':' ? fmt_spec_end(fmt_spec_type(p + 1)) : nullptr;
+  }
+  template<typename charT>
+  constexpr charT fmt_field_type(const charT* p)
+  {
+    return *p == '}' || *fmt_spec_type(p + 1) == '}' ? charT() : *fmt_spec_type(p + 1);
+  }
+
+  /** Whether the \p n characters at \p p are the text, stops at the first brace or the end of the string */
+  template<typename charT>
+  constexpr bool fmt_is_text(const charT* p, size_t n)
+  {
+    return n == 1 ? *p && *p != '{' && *p != '}' : fmt_is_text(p, n / 2) && fmt_is_text(p + n / 2, n / 2);
+  }
+  template<typename charT>
+  constexpr const charT* fmt_skip_text_tail(const charT* p, size_t n)
+  {
+    return n == 0 ? p : fmt_is_text(p, n) ? fmt_skip_text_tail(p + n, n / 2) : fmt_skip_text_tail(p, n / 2);
+  }
+  /** Position of the first brace or the end of the string: the text is skipped by the growing power of 2 blocks,
+    so the recursion is logarithmic in the length of the text rather than linear */
+  template<typename charT>
+  constexpr const charT* fmt_skip_text(const charT* p, size_t n = 1)
+  {
+    return fmt_is_text(p, n) ? fmt_skip_text(p + n, n * 2) : fmt_skip_text_tail(p, n / 2);
+  }
+
+  template<typename charT>
+  constexpr int fmt_count_fields_at(const charT* p, int n);
+  /** Number of the replacement fields, -1 if the format string is invalid */
+  template<typename charT>
+  constexpr int fmt_count_fields(const charT* p, int n = 0)
+  {
+    return fmt_count_fields_at(fmt_skip_text(p), n);
+  }
+  template<typename charT>
+  constexpr int fmt_count_fields_at(const charT* p, int n)
+  {
+    return !*p ? n
+      : *p == '{' ? (p[1] == '{' ? fmt_count_fields(p + 2, n) : fmt_field_end(p + 1) ? fmt_count_fields(fmt_field_end(p + 1), n + 1) : -1)
+      : p[1] == '}' ? fmt_count_fields(p + 2, n) : -1;
+  }
+
+  template<typename charT>
+  constexpr charT fmt_nth_type_at(const charT* p, unsigned i);
+  /** Type of the \p i-th replacement field, zero if it has none */
+  template<typename charT>
+  constexpr charT fmt_nth_type(const charT* p, unsigned i)
+  {
+    return fmt_nth_type_at(fmt_skip_text(p), i);
+  }
+  template<typename charT>
+  constexpr charT fmt_nth_type_at(const charT* p, unsigned i)
+  {
+    return !*p ? charT()
+      : *p == '{' ? (p[1] == '{' ? fmt_nth_type(p + 2, i) : !fmt_field_end(p + 1) ? charT()
+        : i == 0 ? fmt_field_type(p + 1) : fmt_nth_type(fmt_field_end(p + 1), i - 1))
+      : p[1] == '}' ? fmt_nth_type(p + 2, i) : charT();
+  }
+
+  /** Whether the argument of the \p kind can be formatted by the type \p t */
+  template<typename charT>
+  constexpr bool fmt_accepts(int kind, charT t)
+  {
+    typedef basic_format_arg<charT> arg;
+    return !t
+      || ((kind == arg::int_type || kind == arg::uint_type || kind == arg::char_type) && (fmt_is_int_type(t) || t == 'c'))
+      || (kind == arg::bool_type && (fmt_is_int_type(t) || t == 's'))
+      || (kind == arg::float_type && fmt_is_float_type(t))
+      || (kind == arg::string_type && t == 's')
+      || (kind == arg::pointer_type && t == 'p');
+  }
+
+  template<class S, bool = std::is_base_of<compile_string, S>::value>
+  struct format_string
+  {
+    typedef typename S::char_type char_type;
+    static const char_type* data(const S&) { return S::data(); }
+  };
+  template<typename charT, size_t N>
+  struct format_string<charT[N], false>
+  {
+    typedef charT char_type;
+    static const charT* data(const charT* s) { return s; }
+  };
+  template<typename charT>
+  struct format_string<const charT*, false>
+  {
+    typedef charT char_type;
+    static const charT* data(const charT* s) { return s; }
+  };
+  template<typename charT>
+  struct format_string<charT*, false>:
+    format_string<const charT*, false>
+  {};
+
+#if defined(NTL_CXX_CONSTEXPR) && defined(NTL_CXX_VT)
+  /** Kind of the basic_format_arg constructed from \c T */
+  template<typename charT>
+  struct format_arg_kind
+  {
+    typedef basic_format_arg<charT> arg;
+    template<int k> struct kind { char x[k]; };
+    static kind<arg::int_type> test(signed char);
+    static kind<arg::int_type> test(short);
+    static kind<arg::int_type> test(int);
+    static kind<arg::int_type> test(long);
+    static kind<arg::int_type> test(long long);
+    static kind<arg::uint_type> test(unsigned char);
+    static kind<arg::uint_type> test(unsigned short);
+    static kind<arg::uint_type> test(unsigned int);
+    static kind<arg::uint_type> test(unsigned long);
+    static kind<arg::uint_type> test(unsigned long long);
+    static kind<arg::bool_type> test(bool);
+    static kind<arg::char_type> test(char);
+    static kind<arg::char_type> test(wchar_t);
+    static kind<arg::float_type> test(float);
+    static kind<arg::float_type> test(double);
+    static kind<arg::float_type> test(long double);
+    static kind<arg::pointer_type> test(const void*);
+    template<typename T>
+    static kind<arg::pointer_type> test(const T*);
+    static kind<arg::string_type> test(const charT*);
+    static kind<arg::string_type> test(charT*);
+    template<class traits>
+    static kind<arg::string_type> test(const std::basic_string_ref<charT, traits>&);
+    template<class traits, class Allocator>
+    static kind<arg::string_type> test(const std::basic_string<charT, traits, Allocator>&);
+  };
+
+  template<class S, unsigned I, class... Args>
+  struct format_args_check
+  {
+    static const bool value = true;
+  };
+  template<class S, unsigned I, class A, class... Args>
+  struct format_args_check<S, I, A, Args...>
+  {
+    typedef typename S::char_type charT;
+    static const bool value = fmt_accepts(sizeof(format_arg_kind<charT>::test(std::declval<const A&>())), fmt_nth_type(S::data(), I))
+      && format_args_check<S, I + 1, Args...>::value;
+  };
+
+  template<class S, class... Args>
+  inline void check_format(const S&, std::true_type)
+  {
+    static_assert(fmt_count_fields(S::data()) >= 0, "invalid format string");
+    static_assert(fmt_count_fields(S::data()) == sizeof...(Args), "number of the arguments doesn't match the format string");
+    static_assert(format_args_check<S, 0, Args...>::value, "type of the argument doesn't match its replacement field");
+  }
+  template<class S, class... Args>
+  inline void check_format(const S&, std::false_type)
+  {}
+#endif
+
+  template<typename charT>
+  struct format_spec
+  {
+    charT fill;
+    char align, sign, type;
+    bool alt, zero;
+    unsigned width;
+    int precision;
+
+    format_spec()
+      :fill(' '), align(), sign(), type(), alt(), zero(), width(), precision(-1)
+    {}
+  };
+
+  /** Parses the spec which starts at \p p (after ':'), the spec must be valid (see fmt_field_end) */
+  template<typename charT>
+  inline void fmt_parse_spec(const charT* p, format_spec<charT>& sp)
+  {
+    static const unsigned max_width = 0xFFFF;
+    if(p[0] && p[0] != '{' && p[0] != '}' && fmt_is_align(p[1])){
+      sp.fill = p[0];
+      sp.align = static_cast<char>(p[1]);
+      p += 2;
+    }else if(fmt_is_align(*p)){
+      sp.align = static_cast<char>(*p++);
+    }
+    if(fmt_is_sign(*p))
+      sp.sign = static_cast<char>(*p++);
+    if(*p == '#')
+      sp.alt = true, ++p;
+    if(*p == '0')
+      sp.zero = true, ++p;
+    for(; fmt_is_digit(*p); ++p)
+      if(sp.width < max_width)
+        sp.width = sp.width * 10 + static_cast<unsigned>(*p - '0');
+    if(*p == '.'){
+      unsigned precision = 0;
+      for(++p; fmt_is_digit(*p); ++p)
+        if(precision < max_width)
+          precision = precision * 10 + static_cast<unsigned>(*p - '0');
+      sp.precision = static_cast<int>(precision);
+    }
+    if(*p != '}')
+      sp.type = static_cast<char>(*p);
+  }
+
+  inline const char* fmt_decimal_pairs()
+  {
+    static const char pairs[] =
+      "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+      "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+      "8081828384858687888990919293949596979899";
+    return pairs;
+  }
+
+  inline uint64_t fmt_pow10(unsigned n)
+  {
+    static const uint64_t p[] = {
+      1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+      10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+      1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+    };
+    return p[n];
+  }
+
+  /** Writes the decimal digits of \p v two at once backwards from \p end, returns the first digit */
+  template<typename charT>
+  inline charT* fmt_format_decimal(charT* end, uint64_t v)
+  {
+    const char* const pairs = fmt_decimal_pairs();
+    // the 64-bit division is a library call on x86, so it is used only while the value is larger than 32 bits
+    while(v >> 32){
+      const uint32_t r = static_cast<uint32_t>(v % 100) * 2;
+      v /= 100;
+      *--end = static_cast<charT>(pairs[r + 1]);
+      *--end = static_cast<charT>(pairs[r]);
+    }
+    uint32_t u = static_cast<uint32_t>(v);
+    while(u >= 100){
+      const uint32_t r = (u % 100) * 2;
+      u /= 100;
+      *--end = static_cast<charT>(pairs[r + 1]);
+      *--end = static_cast<charT>(pairs[r]);
+    }
+    if(u < 10){
+      *--end = static_cast<charT>('0' + u);
+    }else{
+      *--end = static_cast<charT>(pairs[u * 2 + 1]);
+      *--end = static_cast<charT>(pairs[u * 2]);
+    }
+    return end;
+  }
+
+  /** Writes the digits of \p v in the power of two base backwards from \p end */
+  template<typename charT>
+  inline charT* fmt_format_bits(charT* end, uint64_t v, unsigned shift, bool upper)
+  {
+    const char* const digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    const unsigned mask = (1u << shift) - 1;
+    do *--end = static_cast<charT>(digits[static_cast<unsigned>(v) & mask]);
+    while(v >>= shift);
+    return end;
+  }
+
+  template<typename charT>
+  inline void fmt_write_padded(basic_buffer<charT>& out, const format_spec<charT>& sp, char default_align,
+    const charT* prefix, size_t prefix_size, const charT* body, size_t body_size, bool numeric)
+  {
+    const size_t size = prefix_size + body_size;
+    const size_t pad = sp.width > size ? sp.width - size : 0;
+    if(numeric && sp.zero && !sp.align){
+      out.append(prefix, prefix_size);
+      out.fill('0', pad);
+      out.append(body, body_size);
+      return;
+    }
+    const char align = sp.align ? sp.align : default_align;
+    const size_t left = align == '>' ? pad : align == '^' ? pad / 2 : 0;
+    out.fill(sp.fill, left);
+    out.append(prefix, prefix_size);
+    out.append(body, body_size);
+    out.fill(sp.fill, pad - left);
+  }
+
+  template<typename charT>
+  inline void fmt_write_ascii(basic_buffer<charT>& out, const format_spec<charT>& sp, const char* s, bool numeric)
+  {
+    charT body[8];
+    size_t n = 0;
+    while(s[n])
+      body[n] = static_cast<charT>(s[n]), ++n;
+    fmt_write_padded(out, sp, numeric ? '>' : '<', static_cast<const charT*>(nullptr), 0, body, n, false);
+  }
+
+  template<typename charT>
+  inline void fmt_write_char(basic_buffer<charT>& out, const format_spec<charT>& sp, charT c)
+  {
+    fmt_write_padded(out, sp, '<', static_cast<const charT*>(nullptr), 0, &c, 1, false);
+  }
+
+  template<typename charT>
+  inline void fmt_format_integer(basic_buffer<charT>& out, const format_spec<charT>& sp, uint64_t v, bool negative)
+  {
+    charT prefix[4];
+    size_t np = 0;
+    if(negative)
+      prefix[np++] = '-';
+    else if(sp.sign == '+' || sp.sign == ' ')
+      prefix[np++] = static_cast<charT>(sp.sign);
+
+    charT digits[64];
+    charT* const end = digits + _countof(digits);
+    const charT* p;
+    switch(sp.type){
+    case 'x':
+    case 'X':
+      if(sp.alt)
+        prefix[np++] = '0', prefix[np++] = static_cast<charT>(sp.type);
+      p = fmt_format_bits(end, v, 4, sp.type == 'X');
+      break;
+    case 'b':
+      if(sp.alt)
+        prefix[np++] = '0', prefix[np++] = 'b';
+      p = fmt_format_bits(end, v, 1, false);
+      break;
+    case 'o':
+      if(sp.alt && v)
+        prefix[np++] = '0';
+      p = fmt_format_bits(end, v, 3, false);
+      break;
+    default:
+      p = fmt_format_decimal(end, v);
+      break;
+    }
+    fmt_write_padded(out, sp, '>', prefix, np, p, static_cast<size_t>(end - p), true);
+  }
+
+  /** Scales \p m > 0 into [1, 10), \p e receives the decimal exponent */
+  inline double fmt_normalize(double m, int& e)
+  {
+    static const double p[] = { 1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256 };
+    e = 0;
+    if(m >= 10){
+      for(int i = _countof(p) - 1; i >= 0; --i)
+        if(m >= p[i])
+          m /= p[i], e += 1 << i;
+    }else if(m < 1){
+      for(int i = _countof(p) - 1; i >= 0; --i)
+        if(m * p[i] < 10)
+          m *= p[i], e -= 1 << i;
+    }
+    return m;
+  }
+
+  /** Rounding error of the product \p p = \p a * \p b (Dekker's multiplication, the FMA is not available everywhere) */
+  inline double fmt_product_error(double a, double b, double p)
+  {
+    const double split = 134217729.0; // 2^27 + 1
+    const double ca = split * a, ah = ca - (ca - a), al = a - ah;
+    const double cb = split * b, bh = cb - (cb - b), bl = b - bh;
+    return ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+  }
+
+  /**
+   *	@brief Rounds the product \p a * \p b < 2^64 to the nearest integer and adds \p base to it
+   *
+   *  The ties are rounded to even as printf does, the product which is rounded to the tie itself is decided by its exact value.
+   *  The product above 2^53 is rounded to the integer already, its exact fraction is the rounding error.
+   **/
+  inline uint64_t fmt_round_product(double a, double b, uint64_t base = 0)
+  {
+    const double f = a * b;
+    const uint64_t t = static_cast<uint64_t>(f);
+    if(f >= 9007199254740992.0){
+      const double error = fmt_product_error(a, b, f);
+      int64_t ie = static_cast<int64_t>(error);
+      if(static_cast<double>(ie) > error)
+        --ie;
+      const double d = error - static_cast<double>(ie);
+      const uint64_t r = base + t + static_cast<uint64_t>(ie);
+      return d > 0.5 || (d == 0.5 && (r & 1)) ? r + 1 : r;
+    }
+    const uint64_t r = base + t;
+    const double d = f - static_cast<double>(t);
+    if(d != 0.5)
+      return d > 0.5 ? r + 1 : r;
+    const double error = fmt_product_error(a, b, f);
+    return error > 0 || (error == 0 && (r & 1)) ? r + 1 : r;
+  }
+
+  /** Unsigned integer of the fixed size which holds the exact value of any double scaled by 10^9 */
+  struct fmt_bigint
+  {
+    uint32_t w[40];
+    unsigned n;
+
+    explicit fmt_bigint(uint64_t v)
+      :n(0)
+    {
+      for(; v; v >>= 32)
+        w[n++] = static_cast<uint32_t>(v);
+    }
+
+    bool zero() const { return n == 0; }
+
+    void shift_left(unsigned s)
+    {
+      if(!n)
+        return;
+      const unsigned q = s / 32, r = s % 32, m = n + q + 1;
+      for(unsigned i = m; i-- > q; ){
+        const unsigned j = i - q;
+        uint32_t x = j < n ? w[j] << r : 0;
+        if(r && j > 0)
+          x |= w[j - 1] >> (32 - r);
+        w[i] = x;
+      }
+      for(unsigned i = 0; i < q; i++)
+        w[i] = 0;
+      n = m;
+      trim();
+    }
+
+    void mul(uint32_t m)
+    {
+      uint64_t c = 0;
+      for(unsigned i = 0; i < n; i++){
+        c += static_cast<uint64_t>(w[i]) * m;
+        w[i] = static_cast<uint32_t>(c);
+        c >>= 32;
+      }
+      if(c)
+        w[n++] = static_cast<uint32_t>(c);
+    }
+
+    /** Divides by \p d and returns the remainder */
+    uint32_t div(uint32_t d)
+    {
+      uint64_t r = 0;
+      for(unsigned i = n; i--; ){
+        r = (r << 32) | w[i];
+        w[i] = static_cast<uint32_t>(r / d);
+        r %= d;
+      }
+      trim();
+      return static_cast<uint32_t>(r);
+    }
+
+    /** Removes and returns the bits from \p s up, the value must be less than 2^(s+32) */
+    uint32_t split(unsigned s)
+    {
+      const unsigned q = s / 32, r = s % 32;
+      if(q >= n)
+        return 0;
+      uint32_t hi = w[q] >> r;
+      if(r && q + 1 < n)
+        hi |= w[q + 1] << (32 - r);
+      w[q] &= r ? (1u << r) - 1 : 0;
+      n = q + 1;
+      trim();
+      return hi;
+    }
+
+  private:
+    void trim()
+    {
+      while(n && !w[n - 1])
+        --n;
+    }
+  };
+
+  /** The first significant decimal digits of the number and whether any nonzero digit follows them */
+  struct fmt_digits
+  {
+    unsigned char d[19];
+    unsigned count, limit, total;
+    bool sticky;
+
+    explicit fmt_digits(unsigned limit)
+      :count(), limit(limit), total(), sticky()
+    {}
+
+    void put(unsigned digit)
+    {
+      ++total;
+      if(count < limit)
+        d[count++] = static_cast<unsigned char>(digit);
+      else if(digit)
+        sticky = true;
+    }
+    /** Puts the \p width digits of \p v, the leading zeros are skipped if \p lead is set */
+    void put(uint32_t v, unsigned width, bool lead)
+    {
+      unsigned char t[10];
+      for(unsigned i = width; i--; v /= 10)
+        t[i] = static_cast<unsigned char>(v % 10);
+      for(unsigned i = 0; i < width; i++)
+        if(!lead || t[i] || total)
+          put(t[i]);
+    }
+  };
+
+  /**
+   *	@brief Significand of \p a > 0 rounded to the <tt>n+1</tt> digits (\p n <= 17) and its decimal exponent
+   *
+   *  The digits are taken from the exact binary value, so the result is correct when the scaled product of the doubles is not.
+   **/
+  inline uint64_t fmt_decompose_exact(double a, unsigned n, int& e)
+  {
+    union { double d; uint64_t u; } bits;
+    bits.d = a;
+    const int be = static_cast<int>((bits.u >> 52) & 0x7FF);
+    uint64_t m = bits.u & ((1ULL << 52) - 1);
+    int s = -1074;
+    if(be)
+      m |= 1ULL << 52, s = be - 1075;
+
+    // the digits after the rounding one tell only the direction of the tie
+    fmt_digits digits(n + 2);
+    if(s >= 0){
+      fmt_bigint x(m);
+      x.shift_left(static_cast<unsigned>(s));
+      uint32_t chunks[40];
+      unsigned nc = 0;
+      while(!x.zero())
+        chunks[nc++] = x.div(1000000000);
+      digits.put(chunks[nc - 1], 10, true);
+      e = static_cast<int>(digits.total) - 1 + static_cast<int>(nc - 1) * 9;
+      for(unsigned i = nc - 1; i--; )
+        digits.put(chunks[i], 9, false);
+    }else{
+      const unsigned fs = static_cast<unsigned>(-s);
+      const uint64_t ip = fs < 64 ? m >> fs : 0;
+      fmt_bigint x(fs < 64 ? m & ((1ULL << fs) - 1) : m);
+      e = -1;
+      if(ip){
+        digits.put(static_cast<uint32_t>(ip / 1000000000), 10, true);
+        digits.put(static_cast<uint32_t>(ip % 1000000000), 9, digits.total == 0);
+        e = static_cast<int>(digits.total) - 1;
+      }
+      while(!x.zero() && digits.count < digits.limit){
+        x.mul(1000000000);
+        const uint32_t chunk = x.split(fs);
+        if(!digits.total){
+          unsigned lead = 9;
+          for(uint32_t c = chunk; c; c /= 10)
+            --lead;
+          e -= static_cast<int>(lead);
+        }
+        digits.put(chunk, 9, true);
+      }
+      if(!x.zero())
+        digits.sticky = true;
+    }
+
+    uint64_t r = 0;
+    for(unsigned i = 0; i <= n; i++)
+      r = r * 10 + (i < digits.count ? digits.d[i] : 0);
+    const unsigned g = n + 1 < digits.count ? digits.d[n + 1] : 0;
+    if(g > 5 || (g == 5 && (digits.sticky || (r & 1))))
+      ++r;
+    if(r >= fmt_pow10(n + 1))
+      r /= 10, ++e;
+    return r;
+  }
+
+  /** Significand of \p a >= 0 rounded to the <tt>n+1</tt> digits (\p n <= 17) and its decimal exponent */
+  inline uint64_t fmt_decompose(double a, unsigned n, int& e)
+  {
+    e = 0;
+    if(a == 0)
+      return 0;
+    fmt_normalize(a, e);
+    // the integer part is scaled exactly where it fits
+    const int k = static_cast<int>(n) - e;
+    uint64_t r;
+    if(k >= 0 && k <= 19){
+      const uint64_t ip = static_cast<uint64_t>(a), p = fmt_pow10(static_cast<unsigned>(k));
+      r = fmt_round_product(a - static_cast<double>(ip), static_cast<double>(p), ip * p);
+    }else if(k < 0 && a < 1e19){
+      const uint64_t ip = static_cast<uint64_t>(a), p = fmt_pow10(static_cast<unsigned>(-k));
+      const uint64_t rem = ip % p;
+      r = ip / p;
+      if(rem > p - rem || (rem == p - rem && ((r & 1) || a != static_cast<double>(ip))))
+        ++r;
+    }else{
+      // the normalized value is rounded too many times
+      return fmt_decompose_exact(a, n, e);
+    }
+    if(r >= fmt_pow10(n + 1))
+      r /= 10, ++e;
+    return r;
+  }
+
+  /** Removes the trailing zeros of the fraction and the decimal point if nothing left after it */
+  template<typename charT>
+  inline charT* fmt_trim_fraction(charT* point, charT* p)
+  {
+    while(p > point + 1 && p[-1] == '0')
+      --p;
+    return p == point + 1 ? point : p;
+  }
+
+  /** Writes <tt>0 < \p a < 1</tt> in the fixed notation with \p prec > 17 digits after the point:
+    the leading zeros of the fraction are not counted, the digits after the 17th significant are zeros */
+  template<typename charT>
+  inline charT* fmt_fixed_fraction(charT* p, double a, unsigned prec, bool trim)
+  {
+    int e;
+    const uint64_t m = fmt_decompose(a, 16, e);
+    // the fraction digits from the first significant one
+    const int avail = static_cast<int>(prec) + e + 1;
+    uint64_t r = 0;
+    unsigned n = 0;
+    if(avail > 0){
+      n = avail < 17 ? static_cast<unsigned>(avail) : 17;
+      r = fmt_decompose(a, n - 1, e);
+    }else if(avail == 0 && m >= 50000000000000000ULL){
+      // the last digit rounds up, the exact tie is not representable
+      r = 1, n = 1, e = -static_cast<int>(prec);
+    }
+
+    *p++ = '0';
+    charT* const point = p;
+    *p++ = '.';
+    const unsigned z = n ? static_cast<unsigned>(-e - 1) : prec;
+    for(unsigned i = z; i; --i)
+      *p++ = '0';
+    if(n){
+      charT digits[24];
+      charT* const end = digits + _countof(digits);
+      for(const charT* d = fmt_format_decimal(end, r); d != end; ++d)
+        *p++ = *d;
+    }
+    for(unsigned i = prec - z - n; i; --i)
+      *p++ = '0';
+    return trim ? fmt_trim_fraction(point, p) : p;
+  }
+
+  /** Writes \p a in the fixed notation with \p prec digits after the point, \p a must be less than 1e19 */
+  template<typename charT>
+  inline charT* fmt_fixed(charT* p, double a, unsigned prec, bool alt, bool trim)
+  {
+    if(prec > 17 && a < 1 && a != 0)
+      return fmt_fixed_fraction(p, a, prec, trim);
+    const unsigned n = prec < 17 ? prec : 17;
+    uint64_t ip = static_cast<uint64_t>(a), fp = 0;
+    const double fraction = a - static_cast<double>(ip);
+    if(n){
+      const uint64_t scale = fmt_pow10(n);
+      fp = fmt_round_product(fraction, static_cast<double>(scale));
+      if(fp >= scale)
+        fp -= scale, ++ip;
+    }else{
+      ip = fmt_round_product(fraction, 1, ip);
+    }
+
+    charT digits[24];
+    charT* const end = digits + _countof(digits);
+    for(const charT* d = fmt_format_decimal(end, ip); d != end; ++d)
+      *p++ = *d;
+    if(!prec && !alt)
+      return p;
+    charT* const point = p;
+    *p++ = '.';
+    if(n){
+      const charT* d = fmt_format_decimal(end, fp);
+      for(size_t z = n - static_cast<size_t>(end - d); z; --z)
+        *p++ = '0';
+      for(; d != end; ++d)
+        *p++ = *d;
+    }
+    for(unsigned z = prec - n; z; --z)
+      *p++ = '0';
+    return trim ? fmt_trim_fraction(point, p) : p;
+  }
+
+  /** Writes \p a in the exponent notation with \p prec digits after the point */
+  template<typename charT>
+  inline charT* fmt_exponent(charT* p, double a, unsigned prec, bool alt, bool trim, bool upper)
+  {
+    const unsigned n = prec < 17 ? prec : 17;
+    int e;
+    const uint64_t r = fmt_decompose(a, n, e);
+
+    charT digits[24];
+    charT* const end = digits + _countof(digits);
+    charT* d = fmt_format_decimal(end, r);
+    for(size_t z = n + 1 - static_cast<size_t>(end - d); z; --z) // zero value
+      *--d = '0';
+    *p++ = *d++;
+    if(prec || alt){
+      charT* const point = p;
+      *p++ = '.';
+      for(; d != end; ++d)
+        *p++ = *d;
+      for(unsigned z = prec - n; z; --z)
+        *p++ = '0';
+      if(trim)
+        p = fmt_trim_fraction(point, p);
+    }
+    *p++ = upper ? 'E' : 'e';
+    *p++ = e < 0 ? '-' : '+';
+    const unsigned ue = static_cast<unsigned>(e < 0 ? -e : e);
+    if(ue < 10)
+      *p++ = '0';
+    for(d = fmt_format_decimal(end, ue); d != end; ++d)
+      *p++ = *d;
+    return p;
+  }
+
+  template<typename charT>
+  inline void fmt_format_float(basic_buffer<charT>& out, const format_spec<charT>& sp, double v)
+  {
+    union { double d; uint64_t u; } bits;
+    bits.d = v;
+    const bool negative = (bits.u >> 63) != 0;
+    const bool upper = sp.type == 'F' || sp.type == 'E' || sp.type == 'G';
+    charT prefix[1];
+    size_t np = 0;
+    if(negative)
+      prefix[np++] = '-';
+    else if(sp.sign == '+' || sp.sign == ' ')
+      prefix[np++] = static_cast<charT>(sp.sign);
+
+    charT body[96];
+    charT* p = body;
+    if(((bits.u >> 52) & 0x7FF) == 0x7FF){
+      const char* s = (bits.u << 12) ? (upper ? "NAN" : "nan") : (upper ? "INF" : "inf");
+      while(*s)
+        *p++ = static_cast<charT>(*s++);
+      fmt_write_padded(out, sp, '>', prefix, np, body, static_cast<size_t>(p - body), false);
+      return;
+    }
+
+    const double a = negative ? -v : v;
+    // the fraction is limited by the body size, only the first 17 significant digits are produced and the rest are zeros
+    const unsigned prec = sp.precision < 0 ? 6 : sp.precision > 60 ? 60 : static_cast<unsigned>(sp.precision);
+    switch(sp.type){
+    case 'f':
+    case 'F':
+      p = a < 1e19 ? fmt_fixed(p, a, prec, sp.alt, false) : fmt_exponent(p, a, prec, sp.alt, false, upper);
+      break;
+    case 'e':
+    case 'E':
+      p = fmt_exponent(p, a, prec, sp.alt, false, upper);
+      break;
+    default:
+      {
+        // %g: the exponent notation only if the exponent is less than -4 or not less than the precision
+        const unsigned digits = prec == 0 ? 1 : prec > 17 ? 17 : prec;
+        int e;
+        fmt_decompose(a, digits - 1, e);
+        if(e >= -4 && e < static_cast<int>(digits))
+          p = fmt_fixed(p, a, static_cast<unsigned>(static_cast<int>(digits) - 1 - e), sp.alt, !sp.alt);
+        else
+          p = fmt_exponent(p, a, digits - 1, sp.alt, !sp.alt, upper);
+      }
+      break;
+    }
+    fmt_write_padded(out, sp, '>', prefix, np, body, static_cast<size_t>(p - body), true);
+  }
+
+  template<typename charT>
+  inline void fmt_format_arg(basic_buffer<charT>& out, const format_spec<charT>& sp, const basic_format_arg<charT>& a)
+  {
+    typedef basic_format_arg<charT> arg;
+    switch(a.type){
+    case arg::int_type:
+      if(sp.type == 'c')
+        return fmt_write_char(out, sp, static_cast<charT>(a.value.i));
+      return fmt_format_integer(out, sp, a.value.i < 0 ? 0 - static_cast<uint64_t>(a.value.i) : static_cast<uint64_t>(a.value.i), a.value.i < 0);
+    case arg::uint_type:
+      if(sp.type == 'c')
+        return fmt_write_char(out, sp, static_cast<charT>(a.value.u));
+      return fmt_format_integer(out, sp, a.value.u, false);
+    case arg::bool_type:
+      if(fmt_is_int_type(sp.type))
+        return fmt_format_integer(out, sp, a.value.b, false);
+      return fmt_write_ascii(out, sp, a.value.b ? "true" : "false", false);
+    case arg::char_type:
+      if(fmt_is_int_type(sp.type)){
+        const int64_t c = static_cast<int64_t>(a.value.c);
+        return fmt_format_integer(out, sp, c < 0 ? 0 - static_cast<uint64_t>(c) : static_cast<uint64_t>(c), c < 0);
+      }
+      return fmt_write_char(out, sp, a.value.c);
+    case arg::float_type:
+      return fmt_format_float(out, sp, a.value.d);
+    case arg::string_type:
+      {
+        size_t n = a.value.s.size;
+        if(sp.precision >= 0 && static_cast<size_t>(sp.precision) < n)
+          n = static_cast<size_t>(sp.precision);
+        return fmt_write_padded(out, sp, '<', static_cast<const charT*>(nullptr), 0, a.value.s.data, n, false);
+      }
+    case arg::pointer_type:
+      {
+        format_spec<charT> ps = sp;
+        ps.type = 'x';
+        ps.alt = true;
+        return fmt_format_integer(out, ps, reinterpret_cast<uintptr_t>(a.value.p), false);
+      }
+    default:
+      break;
+    }
+  }
+
+  /** Buffer flushed to the output iterator */
+  template<class OutputIt, typename charT>
+  class iterator_buffer:
+    public basic_buffer<charT>
+  {
+  public:
+    explicit iterator_buffer(OutputIt out)
+      :basic_buffer<charT>(data_, _countof(data_)), out(out)
+    {}
+
+    OutputIt flush()
+    {
+      for(const charT* p = data_, * const end = data_ + this->size_; p != end; ++p)
+        *out++ = *p;
+      this->size_ = 0;
+      return out;
+    }
+
+  protected:
+    void grow(size_t) { flush(); }
+
+  private:
+    OutputIt out;
+    charT data_[256];
+  };
+
+  /** The pointer is written directly */
+  template<typename charT>
+  class iterator_buffer<charT*, charT>:
+    public basic_buffer<charT>
+  {
+  public:
+    explicit iterator_buffer(charT* out)
+      :basic_buffer<charT>(out, static_cast<size_t>(-1) / 2 / sizeof(charT))
+    {}
+
+    charT* flush() { return this->ptr_ + this->size_; }
+
+  protected:
+    void grow(size_t) {}
+  };
+
+  /** Buffer of the fixed size, the rest is counted only */
+  template<typename charT>
+  class fixed_buffer:
+    public basic_buffer<charT>
+  {
+  public:
+    fixed_buffer(charT* p, size_t n)
+      :basic_buffer<charT>(p, n)
+    {}
+
+  protected:
+    void grow(size_t) {}
+  };
+} // __
+
+
+/**
+ *	@brief Formats the \p args by the format string \p fmt to the buffer
+ *  @param[in] args the array of \p nargs arguments
+ **/
+template<typename charT>
+inline void vformat_to(basic_buffer<charT>& out, const charT* fmt, const basic_format_arg<charT>* args, size_t nargs)
+{
+  size_t next = 0;
+  const charT* text = fmt;
+  const charT* p = fmt;
+  while(*p){
+    if(*p != '{' && *p != '}'){
+      ++p;
+      continue;
+    }
+    out.append(text, static_cast<size_t>(p - text));
+    if(p[0] == p[1]){
+      // escaped brace
+      out.push_back(*p);
+      text = p += 2;
+      continue;
+    }
+    const charT* const end = *p == '{' ? __::fmt_field_end(p + 1) : nullptr;
+    if(!end || next == nargs){
+      // written as is
+      text = p++;
+      continue;
+    }
+    __::format_spec<charT> sp;
+    if(p[1] == ':')
+      __::fmt_parse_spec(p + 2, sp);
+    __::fmt_format_arg(out, sp, args[next++]);
+    text = p = end;
+  }
+  out.append(text, static_cast<size_t>(p - text));
+}
+
+/** Formats the \p args by the format string \p fmt to the output iterator */
+template<class OutputIt, typename charT>
+inline OutputIt vformat_to(OutputIt out, const charT* fmt, const basic_format_arg<charT>* args, size_t nargs)
+{
+  __::iterator_buffer<OutputIt, charT> buf(out);
+  vformat_to(static_cast<basic_buffer<charT>&>(buf), fmt, args, nargs);
+  return buf.flush();
+}
+
+
+#if defined(NTL_CXX_VT) || defined(NTL_DOC)
+
+# if defined(NTL_CXX_CONSTEXPR) && defined(NTL_CXX_LAMBDA)
+/** The format string \p s parsed and checked against the arguments at compile time */
+#  define NTL_FMT(s) ([]{ \
+    struct __ntl_fmt_string: ::ntl::fmt::compile_string { \
+      typedef ::std::remove_const< ::std::remove_reference<decltype(*(s))>::type>::type char_type; \
+      static constexpr const char_type* data() { return s; } \
+    }; return __ntl_fmt_string(); }())
+#  define NTL__FMT_CHECK(S, Args) __::check_format<S, Args...>(fmt, std::is_base_of<compile_string, S>())
+# else
+#  define NTL__FMT_CHECK(S, Args)
+# endif
+
+/**
+ *	@brief Formats the \p args by the format string \p fmt to the output iterator \p out
+ *  @return the iterator past the last written character
+ **/
+template<class OutputIt, class S, class... Args>
+inline OutputIt format_to(OutputIt out, const S& fmt, const Args&... args)
+{
+  typedef typename __::format_string<S>::char_type charT;
+  NTL__FMT_CHECK(S, Args);
+  const basic_format_arg<charT> a[] = { basic_format_arg<charT>(args)..., basic_format_arg<charT>() };
+  return vformat_to(out, __::format_string<S>::data(fmt), a, sizeof...(Args));
+}
+
+/** Appends the \p args formatted by the format string \p fmt to the \p buf */
+template<typename charT, size_t N, class Allocator, class S, class... Args>
+inline void format_to(basic_memory_buffer<charT, N, Allocator>& buf, const S& fmt, const Args&... args)
+{
+  NTL__FMT_CHECK(S, Args);
+  const basic_format_arg<charT> a[] = { basic_format_arg<charT>(args)..., basic_format_arg<charT>() };
+  vformat_to(static_cast<basic_buffer<charT>&>(buf), __::format_string<S>::data(fmt), a, sizeof...(Args));
+}
+
+/**
+ *	@brief Formats the \p args by the format string \p fmt to the fixed buffer of \p n characters, the rest is discarded
+ *  @note the output is not terminated by null
+ **/
+template<typename charT, class S, class... Args>
+inline format_to_n_result<charT*> format_to_n(charT* out, size_t n, const S& fmt, const Args&... args)
+{
+  NTL__FMT_CHECK(S, Args);
+  const basic_format_arg<charT> a[] = { basic_format_arg<charT>(args)..., basic_format_arg<charT>() };
+  __::fixed_buffer<charT> buf(out, n);
+  vformat_to(static_cast<basic_buffer<charT>&>(buf), __::format_string<S>::data(fmt), a, sizeof...(Args));
+  const format_to_n_result<charT*> r = { out + buf.size(), buf.size() + buf.truncated() };
+  return r;
+}
+
+/** Length of the \p args formatted by the format string \p fmt */
+template<class S, class... Args>
+inline size_t formatted_size(const S& fmt, const Args&... args)
+{
+  typedef typename __::format_string<S>::char_type charT;
+  NTL__FMT_CHECK(S, Args);
+  const basic_format_arg<charT> a[] = { basic_format_arg<charT>(args)..., basic_format_arg<charT>() };
+  __::fixed_buffer<charT> buf(nullptr, 0);
+  vformat_to(static_cast<basic_buffer<charT>&>(buf), __::format_string<S>::data(fmt), a, sizeof...(Args));
+  return buf.truncated();
+}
+
+/** The \p args formatted by the format string \p fmt */
+template<class S, class... Args>
+inline std::basic_string<typename __::format_string<S>::char_type> format(const S& fmt, const Args&... args)
+{
+  typedef typename __::format_string<S>::char_type charT;
+  NTL__FMT_CHECK(S, Args);
+  const basic_format_arg<charT> a[] = { basic_format_arg<charT>(args)..., basic_format_arg<charT>() };
+  basic_memory_buffer<charT> buf;
+  vformat_to(static_cast<basic_buffer<charT>&>(buf), __::format_string<S>::data(fmt), a, sizeof...(Args));
+  return std::basic_string<charT>(buf.data(), buf.size());
+}
+
+#undef NTL__FMT_CHECK
+
+#else // NTL_CXX_VT
+
+#define NTL_X(n,p) basic_format_arg<charT>(NTL_SPP_CAT(p,n)) NTL_SPP_COMMA
+#define NTL_DEFINE_FORMAT(n,aux) \
+template<class OutputIt, class S NTL_SPP_COMMA_IF(n) NTL_SPP_ARGS(1,n,class A)> \
+inline OutputIt format_to(OutputIt out, const S& fmt NTL_SPP_COMMA_IF(n) NTL_SPP_AARGS(1,n,const& a)) \
+{ \
+  typedef typename __::format_string<S>::char_type charT; \
+  const basic_format_arg<charT> args[] = { NTL_SPP_LOOP(1,n,NTL_X,a) basic_format_arg<charT>() }; \
+  return vformat_to(out, __::format_string<S>::data(fmt), args, n); \
+} \
+template<typename charT, size_t N, class Allocator, class S NTL_SPP_COMMA_IF(n) NTL_SPP_ARGS(1,n,class A)> \
+inline void format_to(basic_memory_buffer<charT, N, Allocator>& buf, const S& fmt NTL_SPP_COMMA_IF(n) NTL_SPP_AARGS(1,n,const& a)) \
+{ \
+  const basic_format_arg<charT> args[] = { NTL_SPP_LOOP(1,n,NTL_X,a) basic_format_arg<charT>() }; \
+  vformat_to(static_cast<basic_buffer<charT>&>(buf), __::format_string<S>::data(fmt), args, n); \
+} \
+template<typename charT, class S NTL_SPP_COMMA_IF(n) NTL_SPP_ARGS(1,n,class A)> \
+inline format_to_n_result<charT*> format_to_n(charT* out, size_t size, const S& fmt NTL_SPP_COMMA_IF(n) NTL_SPP_AARGS(1,n,const& a)) \
+{ \
+  const basic_format_arg<charT> args[] = { NTL_SPP_LOOP(1,n,NTL_X,a) basic_format_arg<charT>() }; \
+  __::fixed_buffer<charT> buf(out, size); \
+  vformat_to(static_cast<basic_buffer<charT>&>(buf), __::format_string<S>::data(fmt), args, n); \
+  const format_to_n_result<charT*> r = { out + buf.size(), buf.size() + buf.truncated() }; \
+  return r; \
+} \
+template<class S NTL_SPP_COMMA_IF(n) NTL_SPP_ARGS(1,n,class A)> \
+inline size_t formatted_size(const S& fmt NTL_SPP_COMMA_IF(n) NTL_SPP_AARGS(1,n,const& a)) \
+{ \
+  typedef typename __::format_string<S>::char_type charT; \
+  const basic_format_arg<charT> args[] = { NTL_SPP_LOOP(1,n,NTL_X,a) basic_format_arg<charT>() }; \
+  __::fixed_buffer<charT> buf(nullptr, 0); \
+  vformat_to(static_cast<basic_buffer<charT>&>(buf), __::format_string<S>::data(fmt), args, n); \
+  return buf.truncated(); \
+} \
+template<class S NTL_SPP_COMMA_IF(n) NTL_SPP_ARGS(1,n,class A)> \
+inline std::basic_string<typename __::format_string<S>::char_type> format(const S& fmt NTL_SPP_COMMA_IF(n) NTL_SPP_AARGS(1,n,const& a)) \
+{ \
+  typedef typename __::format_string<S>::char_type charT; \
+  const basic_format_arg<charT> args[] = { NTL_SPP_LOOP(1,n,NTL_X,a) basic_format_arg<charT>() }; \
+  basic_memory_buffer<charT> buf; \
+  vformat_to(static_cast<basic_buffer<charT>&>(buf), __::format_string<S>::data(fmt), args, n); \
+  return std::basic_string<charT>(buf.data(), buf.size()); \
+}
+
+NTL_DEFINE_FORMAT(0,)
+NTL_DEFINE_FORMAT(1,)
+NTL_DEFINE_FORMAT(2,)
+NTL_DEFINE_FORMAT(3,)
+NTL_DEFINE_FORMAT(4,)
+NTL_DEFINE_FORMAT(5,)
+#undef NTL_X
+#undef NTL_DEFINE_FORMAT
+
+#endif // NTL_CXX_VT
+
+#ifndef NTL_FMT
+/** The format string, parsed at runtime by this compiler */
+# define NTL_FMT(s) (s)
+#endif
+
+/**@} format_string */
+
+
 }//namespace fmt
 
 namespace format = fmt;
@@ -0,0 +1,322 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Parallel directory tree walker
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__FS_WALK
+#define NTL__FS_WALK
+#pragma once
+
+#include "nt/file.hxx"
+#include "stlx/stdstring.hxx"
+#include "stlx/vector.hxx"
+#include "stlx/thread.hxx"
+#include "stlx/mutex.hxx"
+#include "stlx/condition_variable.hxx"
+
+namespace ntl {
+
+/// File system utilities
+namespace fs {
+
+/** Options of the parallel_walk() */
+struct walk_options
+{
+  /** Number of the worker threads, zero means std::thread::hardware_concurrency() */
+  unsigned threads;
+  /** Deliver the entries in the order of the serial depth-first walk (in the calling thread) */
+  bool ordered;
+  /** Descend into the directories which are reparse points (junctions, symbolic links) */
+  bool follow_reparse_points;
+  /** Maximal depth of the entries to visit, the entries of the root directory have the depth 0 */
+  uint32_t max_depth;
+  /** Size of the directory query buffer of every worker */
+  uint32_t chunk_size;
+
+  walk_options()
+    :threads(), ordered(false), follow_reparse_points(false), max_depth(~0u),
+    chunk_size(nt::directory_reader::default_chunk_size)
+  {}
+};
+
+/**
+ *	@brief Directory entry passed to the parallel_walk() visitor
+ *
+ *  The metadata comes straight from the directory query buffer, so the visitor does not need to query the file.
+ *  The \c name is not null terminated and, as the \c parent, is valid only during the visitor call.
+ **/
+struct walk_entry
+{
+  /** Native path of the directory containing the entry */
+  const std::wstring* parent;
+  const wchar_t* name;
+  uint32_t name_length;
+  uint32_t depth;
+
+  uint32_t attributes;
+  int64_t  size;
+  int64_t  allocation_size;
+  int64_t  creation_time;
+  int64_t  last_access_time;
+  int64_t  last_write_time;
+  int64_t  change_time;
+
+  bool is_directory() const     { return (attributes & nt::file_attribute::directory) != 0; }
+  bool is_reparse_point() const { return (attributes & nt::file_attribute::reparse_point) != 0; }
+
+  /** Native path of the entry */
+  std::wstring path() const
+  {
+    std::wstring p(*parent);
+    if(p.empty() || p[p.length()-1] != L'\\')
+      p += L'\\';
+    return p.append(name, name_length);
+  }
+};
+
+/** Result of the parallel_walk() */
+struct walk_stats
+{
+  uint64_t files;
+  uint64_t directories;
+  /** Number of the directories which could not be read */
+  uint64_t errors;
+};
+
+/** Default descend predicate of the parallel_walk(): visits the whole tree */
+struct descend_always
+{
+  bool operator()(const walk_entry&) const { return true; }
+};
+
+namespace __
+{
+  template<class Visitor, class Descend>
+  class walker
+  {
+    walker(const walker&) __deleted;
+    walker& operator=(const walker&) __deleted;
+
+    struct dir_node;
+
+    // the entry of the ordered walk, kept until its directory is delivered
+    struct record
+    {
+      walk_entry e;
+      uint32_t name_offset;
+      dir_node* child;
+    };
+
+    struct dir_node
+    {
+      std::wstring path;
+      uint32_t depth;
+      volatile bool done;
+      std::vector<record> records;
+      std::vector<wchar_t> names;
+
+      dir_node(const std::wstring& path, uint32_t depth)
+        :path(path), depth(depth), done(false)
+      {}
+    };
+
+    typedef std::unique_lock<std::mutex> lock_guard;
+
+  public:
+    walker(Visitor& visitor, Descend& descend, const walk_options& options)
+      :visitor(visitor), descend(descend), options(options), pending(0)
+    {
+      const walk_stats zero = {};
+      stats = zero;
+    }
+
+    walk_stats run(const std::wstring& root)
+    {
+      dir_node* const top = new dir_node(root, 0);
+      queue.push_back(top);
+      pending = 1;
+
+      unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+      if(!threads)
+        threads = 1;
+
+      // the calling thread is a worker itself in the unordered walk and delivers the results in the ordered one
+      std::vector<std::thread> workers;
+      workers.reserve(threads);
+      for(unsigned i = options.ordered ? 0 : 1; i < threads; i++)
+        workers.push_back(std::thread(worker(this)));
+
+      if(options.ordered)
+        deliver(top);
+      else
+        work();
+
+      for(size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+      return stats;
+    }
+
+  private:
+    struct worker
+    {
+      walker* self;
+      explicit worker(walker* self) :self(self) {}
+      void operator()() const { self->work(); }
+    };
+
+    void work()
+    {
+      std::vector<dir_node*> subdirs;
+      for(;;){
+        dir_node* d;
+        {
+          lock_guard l(m);
+          while(queue.empty() && pending)
+            has_work.wait(l);
+          if(queue.empty())
+            break;
+          d = queue.back();
+          queue.pop_back();
+        }
+
+        walk_stats found = {};
+        scan(*d, subdirs, found);
+
+        lock_guard l(m);
+        stats.files += found.files;
+        stats.directories += found.directories;
+        stats.errors += found.errors;
+        // the first subdirectory goes to the top of the stack: the walk stays depth-first
+        for(size_t i = subdirs.size(); i; i--)
+          queue.push_back(subdirs[i-1]);
+        pending += subdirs.size();
+        pending--;
+        if(!pending || subdirs.size() > 1)
+          has_work.notify_all();
+        else if(!subdirs.empty())
+          has_work.notify_one();
+        subdirs.clear();
+        if(options.ordered){
+          d->done = true;
+          is_done.notify_all();
+        }else{
+          delete d;
+        }
+      }
+    }
+
+    void scan(dir_node& d, std::vector<dir_node*>& subdirs, walk_stats& found)
+    {
+      nt::directory_reader reader(options.chunk_size);
+      if(!nt::success(reader.open(nt::const_unicode_string(d.path)))){
+        found.errors++;
+        return;
+      }
+      for(const nt::file_directory_information* di = reader.get(); di; di = reader.next()){
+        const uint32_t length = di->FileNameLength / sizeof(wchar_t);
+        if(di->FileName[0] == L'.' && (length == 1 || (length == 2 && di->FileName[1] == L'.')))
+          continue;
+
+        walk_entry e;
+        e.parent = &d.path;
+        e.name = di->FileName;
+        e.name_length = length;
+        e.depth = d.depth;
+        e.attributes = di->FileAttributes;
+        e.size = di->EndOfFile;
+        e.allocation_size = di->AllocationSize;
+        e.creation_time = di->CreationTime;
+        e.last_access_time = di->LastAccessTime;
+        e.last_write_time = di->LastWriteTime;
+        e.change_time = di->ChangeTime;
+
+        dir_node* child = nullptr;
+        if(e.is_directory()){
+          found.directories++;
+          if(d.depth < options.max_depth && (options.follow_reparse_points || !e.is_reparse_point()) && descend(e)){
+            child = new dir_node(e.path(), d.depth + 1);
+            subdirs.push_back(child);
+          }
+        }else{
+          found.files++;
+        }
+
+        if(options.ordered){
+          const record r = { e, static_cast<uint32_t>(d.names.size()), child };
+          d.records.push_back(r);
+          d.names.insert(d.names.end(), di->FileName, di->FileName + length);
+        }else{
+          visitor(e);
+        }
+      }
+      if(nt::status::is_error(reader.last_status()) && reader.last_status() != nt::status::no_more_files)
+        found.errors++;
+    }
+
+    /** Delivers the entries of \p d and its subdirectories in the depth-first order */
+    void deliver(dir_node* d)
+    {
+      {
+        lock_guard l(m);
+        while(!d->done)
+          is_done.wait(l);
+      }
+      for(size_t i = 0; i < d->records.size(); i++){
+        record& r = d->records[i];
+        r.e.parent = &d->path;
+        r.e.name = &d->names[0] + r.name_offset;
+        visitor(r.e);
+        if(r.child)
+          deliver(r.child);
+      }
+      delete d;
+    }
+
+  private:
+    Visitor& visitor;
+    Descend& descend;
+    const walk_options& options;
+
+    std::mutex m;
+    std::condition_variable has_work, is_done;
+    std::vector<dir_node*> queue;
+    size_t pending;   // directories queued or being scanned
+    walk_stats stats;
+  };
+} // __
+
+/**
+ *	@brief Walks the directory tree by the pool of threads
+ *
+ *  Every directory is read by one of the workers with the nt::directory_reader, its subdirectories are queued
+ *  for the other workers. The \p visitor is called as <tt>visitor(const walk_entry&)</tt> for every entry except
+ *  the '.' and '..' ones:
+ *  - in the unordered walk it is called by the worker threads concurrently, as soon as the entry is read;
+ *  - in the ordered walk (walk_options::ordered) it is called by the calling thread only,
+ *  in the order of the serial depth-first walk (a directory is followed by its contents).
+ *  The entries of the ordered walk are kept in the memory until they are delivered.
+ *
+ *  The \p descend predicate is called by the worker threads for every subdirectory to visit, returning false prunes it.
+ *
+ *  @param[in] root native path of the directory to walk
+ *  @note The visitor and the predicate must not throw.
+ **/
+template<class Visitor, class Descend>
+inline walk_stats parallel_walk(const std::wstring& root, Visitor visitor, const walk_options& options, Descend descend)
+{
+  __::walker<Visitor, Descend> w(visitor, descend, options);
+  return w.run(root);
+}
+
+/** Walks the whole directory tree by the pool of threads, see parallel_walk(root, visitor, options, descend) */
+template<class Visitor>
+inline walk_stats parallel_walk(const std::wstring& root, Visitor visitor, const walk_options& options = walk_options())
+{
+  return parallel_walk(root, visitor, options, descend_always());
+}
+
+} // fs
+} // ntl
+
+#endif // NTL__FS_WALK
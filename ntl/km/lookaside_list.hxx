@@ -100,6 +100,15 @@ struct npaged_lookaside_list : public general_lookaside
     _initialize(this, Allocate, Free, Tag);
   }
 
+  /** Creates a list of the \p CellSize byte cells (e.g. for the npaged_lookaside_list<void>) */
+  explicit
+  npaged_lookaside_list(
+    size_t                  CellSize,
+    uint32_t                Tag         = NTL__POOL_TAG)
+  {
+    ExInitializeNPagedLookasideList(this, 0, 0, 0, CellSize, Tag, 0);
+  }
+
   ~npaged_lookaside_list()
   {
     _delete(this);
@@ -141,6 +150,19 @@ struct npaged_lookaside_list : public general_lookaside
     }
   }
 
+  size_t cell_size() const { return Size; }
+
+  /** Allocates a block of the arbitrary size from the backing pool */
+  void * allocate_block(size_t size)
+  {
+    return Allocate(Type, size, Tag);
+  }
+
+  void free_block(void * block)
+  {
+    Free(block);
+  }
+
 };
 
 
@@ -0,0 +1,376 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Lock-free stack and queues
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__LOCKFREE
+#define NTL__LOCKFREE
+#pragma once
+
+#include "atomic.hxx"
+#include "stlx/new.hxx"
+#include "stlx/cassert.hxx"
+
+namespace ntl {
+
+/// Lock-free data structures built on the interlocked operations
+namespace lockfree {
+
+#ifndef NTL_CACHE_LINE_SIZE
+# define NTL_CACHE_LINE_SIZE 64
+#endif
+
+/**
+ *	@brief Intrusive lock-free LIFO list (a stack) of the nt::slist_entry
+ *
+ *  The head pointer is tagged with the list depth and a sequence number which changes on every push and pop,
+ *  so the compare-exchange on the head fails if the list has been modified between the read and the exchange
+ *  (the ABA problem). On x86 the header has the layout of the nt::slist_header (pointer, depth, sequence)
+ *  and is updated with the 64-bit exchange; on x64 the header is 16 bytes long (pointer, depth, 48-bit sequence)
+ *  and is updated with the 128-bit exchange.
+ *
+ *  @note pop() reads the \c Next field of the top entry which may be concurrently popped and freed by another thread,
+ *  so the entries must come from the memory which stays accessible (a lookaside list, a pool or a free list itself).
+ **/
+class stack
+{
+  stack(const stack&) __deleted;
+  stack& operator=(const stack&) __deleted;
+
+public:
+  typedef nt::slist_entry entry;
+
+  stack()
+  {
+    const header h = make_header(0, 0, 0);
+    const_cast<header&>(head) = h;
+  }
+
+  /** Pushes the \p e on the top of the list */
+  void push(entry* e)
+  {
+    header old = read();
+    for(atomic::backoff b;; b.pause()){
+      e->Next = old.next;
+      const header h = make_header(e, depth(old)+1, sequence(old)+1);
+      if(exchange(old, h))
+        return;
+    }
+  }
+
+  /** Pushes the chain of \p count entries from \p first to \p last linked through their \c Next fields */
+  void push(entry* first, entry* last, uint16_t count)
+  {
+    header old = read();
+    for(atomic::backoff b;; b.pause()){
+      last->Next = old.next;
+      const header h = make_header(first, depth(old)+count, sequence(old)+1);
+      if(exchange(old, h))
+        return;
+    }
+  }
+
+  /** Pops the top entry or returns null if the list is empty */
+  entry* pop()
+  {
+    header old = read();
+    for(atomic::backoff b;; b.pause()){
+      entry* const top = old.next;
+      if(!top)
+        return 0;
+      const header h = make_header(top->Next, depth(old)-1, sequence(old)+1);
+      if(exchange(old, h))
+        return top;
+    }
+  }
+
+  /** Removes all entries and returns them as a chain */
+  entry* flush()
+  {
+    header old = read();
+    for(atomic::backoff b;; b.pause()){
+      if(!old.next)
+        return 0;
+      const header h = make_header(0, 0, sequence(old)+1);
+      if(exchange(old, h))
+        return old.next;
+    }
+  }
+
+  /** Number of entries in the list (a snapshot) */
+  uint16_t depth() const { return depth(read()); }
+
+  bool empty() const { return read().next == 0; }
+
+private:
+#if defined(_M_X64) || defined(__x86_64__)
+  typedef uint64_t sequence_type;
+  struct alignas(16) header
+  {
+    entry* next;
+    uint64_t tag; // depth in the low 16 bits, sequence above
+  };
+
+  static header make_header(entry* next, uint16_t depth, sequence_type sequence)
+  {
+    const header h = { next, (sequence << 16) | depth };
+    return h;
+  }
+  static uint16_t depth(const header& h) { return static_cast<uint16_t>(h.tag); }
+  static sequence_type sequence(const header& h) { return h.tag >> 16; }
+
+  header read() const
+  {
+    // a torn read is harmless: the exchange compares both halves
+    const header h = { head.next, head.tag };
+    return h;
+  }
+
+  /** Replaces the head with \p h if it is equal to \p old, otherwise loads the current head to \p old */
+  bool exchange(header& old, const header& h)
+  {
+    return atomic::compare_exchange(*reinterpret_cast<volatile uint64_t*>(&head), h.tag, reinterpret_cast<uint64_t>(h.next),
+      reinterpret_cast<uint64_t*>(&old)) != 0;
+  }
+#else
+  typedef uint16_t sequence_type;
+  struct alignas(8) header
+  {
+    entry* next;
+    uint16_t depth;
+    uint16_t sequence;
+  };
+
+  static header make_header(entry* next, uint16_t depth, sequence_type sequence)
+  {
+    const header h = { next, depth, sequence };
+    return h;
+  }
+  static uint16_t depth(const header& h) { return h.depth; }
+  static sequence_type sequence(const header& h) { return h.sequence; }
+
+  header read() const
+  {
+    const header h = { head.next, head.depth, head.sequence };
+    return h;
+  }
+
+  bool exchange(header& old, const header& h)
+  {
+    const uint64_t comparand = *reinterpret_cast<const uint64_t*>(&old);
+    const uint64_t original = atomic::compare_exchange(*reinterpret_cast<volatile uint64_t*>(&head),
+      *reinterpret_cast<const uint64_t*>(&h), comparand);
+    *reinterpret_cast<uint64_t*>(&old) = original;
+    return original == comparand;
+  }
+
+  STATIC_ASSERT(sizeof(header) == sizeof(nt::slist_header));
+#endif
+
+  volatile header head;
+};
+
+
+/**
+ *	@brief Bounded multi-producer multi-consumer FIFO queue
+ *
+ *  The ring buffer algorithm of D. Vyukov: every cell carries a sequence number which tells
+ *  whether the cell is ready for the producer of the given position or for the consumer of it,
+ *  so producers and consumers contend only on their own position counter, one interlocked operation per call.
+ *  The element is published by the release store of the cell sequence and taken after its acquire load.
+ *
+ *  @tparam T must not throw on copy (usually a pointer or a small work item).
+ **/
+template<typename T>
+class bounded_queue
+{
+  bounded_queue(const bounded_queue&) __deleted;
+  bounded_queue& operator=(const bounded_queue&) __deleted;
+
+public:
+  typedef T value_type;
+
+  /** Creates a queue of the \p capacity rounded up to the power of two, at most 2^31 */
+  explicit bounded_queue(uint32_t capacity)
+    :mask(round_up(capacity) - 1),
+    cells(static_cast<cell*>(::operator new(sizeof(cell) * (mask + 1)))),
+    enqueue_pos(0), dequeue_pos(0)
+  {
+    for(uint32_t i = 0; i <= mask; ++i)
+      cells[i].sequence = i;
+  }
+
+  ~bounded_queue()
+  {
+    for(uint32_t pos = dequeue_pos; pos != enqueue_pos; ++pos)
+      reinterpret_cast<T*>(cells[pos & mask].storage)->~T();
+    ::operator delete(cells);
+  }
+
+  /** Appends the \p value to the queue, returns false if the queue is full */
+  bool push(const T& value)
+  {
+    uint32_t pos = atomic::load_acquire(enqueue_pos);
+    for(atomic::backoff b;;){
+      cell& c = cells[pos & mask];
+      const int32_t diff = static_cast<int32_t>(atomic::load_acquire(c.sequence) - pos);
+      if(diff == 0){
+        const uint32_t cur = atomic::compare_exchange(enqueue_pos, pos + 1, pos);
+        if(cur == pos){
+          new (c.storage) T(value);
+          atomic::store_release(c.sequence, pos + 1);
+          return true;
+        }
+        pos = cur;
+        b.pause();
+      }else if(diff < 0){
+        return false;
+      }else{
+        pos = atomic::load_acquire(enqueue_pos);
+      }
+    }
+  }
+
+  /** Removes the first element to the \p value, returns false if the queue is empty */
+  bool pop(T& value)
+  {
+    uint32_t pos = atomic::load_acquire(dequeue_pos);
+    for(atomic::backoff b;;){
+      cell& c = cells[pos & mask];
+      const int32_t diff = static_cast<int32_t>(atomic::load_acquire(c.sequence) - (pos + 1));
+      if(diff == 0){
+        const uint32_t cur = atomic::compare_exchange(dequeue_pos, pos + 1, pos);
+        if(cur == pos){
+          T* const p = reinterpret_cast<T*>(c.storage);
+          value = *p;
+          p->~T();
+          atomic::store_release(c.sequence, pos + mask + 1);
+          return true;
+        }
+        pos = cur;
+        b.pause();
+      }else if(diff < 0){
+        return false;
+      }else{
+        pos = atomic::load_acquire(dequeue_pos);
+      }
+    }
+  }
+
+  uint32_t capacity() const { return mask + 1; }
+
+private:
+  struct cell
+  {
+    volatile uint32_t sequence;
+    union
+    {
+      char storage[sizeof(T)];
+      uint64_t align_;
+      void* palign_;
+    };
+  };
+
+  static uint32_t round_up(uint32_t n)
+  {
+    // the positions are compared by the signed 32-bit difference
+    assert(n <= 0x80000000u);
+    if(n <= 2)
+      return 2;
+    --n;
+    n |= n >> 1;
+    n |= n >> 2;
+    n |= n >> 4;
+    n |= n >> 8;
+    n |= n >> 16;
+    return n + 1;
+  }
+
+  // producers and consumers positions are kept on the different cache lines
+  const uint32_t mask;
+  cell* const cells;
+  alignas(NTL_CACHE_LINE_SIZE) volatile uint32_t enqueue_pos;
+  alignas(NTL_CACHE_LINE_SIZE) volatile uint32_t dequeue_pos;
+};
+
+
+/**
+ *	@brief Intrusive unbounded multi-producer single-consumer FIFO queue of the nt::slist_entry
+ *
+ *  The algorithm of D. Vyukov: push() is a single interlocked exchange and never waits;
+ *  pop() is called by one consumer thread only and does not use interlocked operations.
+ *  The entries are not copied, so they may be freed right after pop() returns them.
+ *
+ *  @note pop() may return null while a producer is in the middle of push(),
+ *  the entry becomes available as soon as that push() completes.
+ **/
+class mpsc_queue
+{
+  mpsc_queue(const mpsc_queue&) __deleted;
+  mpsc_queue& operator=(const mpsc_queue&) __deleted;
+
+public:
+  typedef nt::slist_entry entry;
+
+  mpsc_queue()
+    :head(&stub), tail(&stub)
+  {
+    stub.Next = 0;
+  }
+
+  /** Appends the \p e to the queue (any thread) */
+  void push(entry* e)
+  {
+    e->Next = 0;
+    entry* const prev = atomic::exchange(head, e);
+    atomic::store_release(prev->Next, e);
+  }
+
+  /** Removes the first entry or returns null if the queue is empty (consumer thread only) */
+  entry* pop()
+  {
+    entry* t = tail;
+    entry* next = next_of(t);
+    if(t == &stub){
+      if(!next)
+        return 0;
+      tail = t = next;
+      next = next_of(next);
+    }
+    if(next){
+      tail = next;
+      return t;
+    }
+    if(t != head)
+      return 0; // a producer has exchanged the head but has not linked its entry yet
+    push(&stub);
+    next = next_of(t);
+    if(next){
+      tail = next;
+      return t;
+    }
+    return 0;
+  }
+
+  /** Checks if the queue is empty (consumer thread only) */
+  bool empty() const
+  {
+    return tail == &stub && next_of(&stub) == 0;
+  }
+
+private:
+  static entry* next_of(const entry* e)
+  {
+    return atomic::load_acquire(static_cast<entry* const volatile&>(e->Next));
+  }
+
+  alignas(NTL_CACHE_LINE_SIZE) entry* volatile head;
+  alignas(NTL_CACHE_LINE_SIZE) entry* tail;
+  entry stub;
+};
+
+} // lockfree
+} // ntl
+
+#endif // NTL__LOCKFREE
@@ -13,6 +13,7 @@
 #include "object.hxx"
 #include "file_information.hxx"
 #include "virtualmem.hxx"
+#include "../stlx/new.hxx"
 
 
 namespace ntl {
@@ -693,6 +694,90 @@ class file_handler : public handle, public device_traits<file_handler>
 typedef basic_file<file_handler> file;
 
 
+/**
+ *	@brief Chunked reader of the directory entries
+ *
+ *  Opens the directory and reads its entries with ZwQueryDirectoryFile into the buffer of the fixed size,
+ *  which is refilled with the next portion of entries (without the scan restart) when the current portion is over.
+ *  So the directory of any size is read exactly once and only one chunk of it is kept in the memory.
+ **/
+class directory_reader
+{
+  directory_reader(const directory_reader&) __deleted;
+  directory_reader& operator=(const directory_reader&) __deleted;
+
+public:
+  typedef file_directory_information entry_type;
+
+#ifdef NTL_SUBSYSTEM_KM
+  static const uint32_t default_chunk_size = 4*1024;
+#else
+  static const uint32_t default_chunk_size = 64*1024;
+#endif
+
+  explicit directory_reader(uint32_t chunk_size = default_chunk_size)
+    :buf(), bufsize(chunk_size), cur(), st(status::success)
+  {}
+
+  ~directory_reader()
+  {
+    delete[] buf;
+  }
+
+  /** Opens the directory and reads the first chunk of its entries */
+  ntstatus open(const const_unicode_string& path)
+  {
+    cur = nullptr;
+    st = f.open(path, file::generic_read, file::share_valid_flags,
+      file::directory_file|file::open_for_backup_intent|file::synchronous_io_nonalert);
+    if(!success(st))
+      return st;
+    if(!buf && (buf = new (std::nothrow) char[bufsize]) == nullptr)
+      return st = status::insufficient_resources;
+    fill(true);
+    return st;
+  }
+
+  /** The current entry or null if the directory is over (or an error occured, see last_status()) */
+  const entry_type* get() const { return cur; }
+
+  /** Moves to the next entry, reading the next chunk if needed */
+  const entry_type* next()
+  {
+    if(cur){
+      if(cur->NextEntryOffset)
+        cur = reinterpret_cast<const entry_type*>(reinterpret_cast<const char*>(cur) + cur->NextEntryOffset);
+      else
+        fill(false);
+    }
+    return cur;
+  }
+
+  /** Status of the last directory query, status::no_more_files at the end of directory */
+  ntstatus last_status() const { return st; }
+
+  /** The handle of the opened directory */
+  legacy_handle handle() const { return f.get(); }
+
+private:
+  void fill(bool restart)
+  {
+    io_status_block iosb;
+    st = ZwQueryDirectoryFile(f.get(), nullptr, nullptr, nullptr, &iosb, buf, bufsize, FileDirectoryInformation, false, nullptr, restart);
+    cur = success(st) && iosb.Information ? reinterpret_cast<const entry_type*>(buf) : nullptr;
+    if(!cur)
+      f.close();
+  }
+
+private:
+  file_handler f;
+  char* buf;
+  const uint32_t bufsize;
+  const entry_type* cur;
+  ntstatus st;
+};
+
+
 class section:
   public handle,
   public device_traits<section>,
@@ -0,0 +1,277 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Pipelined file copy
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__NT_FILE_COPY
+#define NTL__NT_FILE_COPY
+#pragma once
+
+#include "file.hxx"
+#include "event.hxx"
+
+namespace ntl {
+namespace nt {
+
+/**\addtogroup  io
+ *@{*/
+
+/** Options of the copy_file() */
+struct copy_file_options
+{
+  /** Maximal number of the buffers in flight */
+  static const uint32_t max_buffers = 16;
+
+  /** Size of every buffer, rounded up to 64 KiB */
+  uint32_t buffer_size;
+  /** Number of the buffers in flight, up to max_buffers */
+  uint32_t buffers;
+  /** Reserve the disk space of the destination before the copy */
+  bool preallocate;
+  /** Files of this size or larger are copied bypassing the system cache, zero disables the unbuffered I/O */
+  uint64_t unbuffered_threshold;
+
+  copy_file_options()
+    :buffer_size(1024*1024), buffers(4), preallocate(true), unbuffered_threshold(0)
+  {}
+};
+
+/** Default progress callback of the copy_file(): never cancels */
+struct copy_progress_none
+{
+  bool operator()(uint64_t /*copied*/, uint64_t /*total*/) const { return true; }
+};
+
+namespace __
+{
+  class file_copier
+  {
+    file_copier(const file_copier&) __deleted;
+    file_copier& operator=(const file_copier&) __deleted;
+
+    // the unbuffered I/O requires the sector aligned sizes, the sector is assumed to be not larger than the page
+    static const uint32_t sector_size = 4096;
+    static const uint32_t granularity = 64*1024;
+
+    struct slot
+    {
+      enum state_type { idle, reading, writing };
+      handle event;
+      io_status_block iosb;
+      uint64_t offset;
+      uint32_t length;
+      state_type state;
+      char* buf;
+    };
+
+  public:
+    file_copier(legacy_handle from, legacy_handle to, const copy_file_options& options)
+      :from(from), to(to), base(), region(), size(), next_offset(), copied(), nslots()
+    {
+      buffer_size = (options.buffer_size + granularity - 1) & ~(granularity - 1);
+      if(!buffer_size)
+        buffer_size = granularity;
+      nslots = options.buffers ? options.buffers : 1;
+      if(nslots > copy_file_options::max_buffers)
+        nslots = copy_file_options::max_buffers;
+    }
+
+    ~file_copier()
+    {
+      if(base)
+        NtFreeVirtualMemory(current_process(), &base, &region, allocation_attributes::mem_release);
+    }
+
+    template<class Progress>
+    ntstatus run(uint64_t file_size, bool unbuffered, Progress& progress)
+    {
+      size = file_size;
+      this->unbuffered = unbuffered;
+
+      // page aligned buffers, as the unbuffered I/O requires
+      region = static_cast<size_t>(buffer_size) * nslots;
+      ntstatus st = NtAllocateVirtualMemory(current_process(), &base, 0, &region, allocation_attributes::mem_commit|allocation_attributes::mem_reserve, page_protection::page_readwrite);
+      if(!success(st))
+        return base = nullptr, st;
+
+      for(uint32_t i = 0; i < nslots; i++){
+        slot& s = slots[i];
+        s.state = slot::idle;
+        s.buf = static_cast<char*>(base) + static_cast<size_t>(buffer_size) * i;
+        st = NtCreateEvent(&s.event, user_event::all_access, nullptr, NotificationEvent, false);
+        if(!success(st))
+          return st;
+      }
+
+      // fill the pipeline with reads, then serve the slots in turn:
+      // a finished read becomes the write of the same buffer and a finished write becomes the next read
+      uint32_t active = 0;
+      for(uint32_t i = 0; i < nslots && next_offset < size; i++){
+        if(!success(st = read(slots[i]))){
+          slots[i].state = slot::idle;
+          return drain(), st;
+        }
+        active++;
+      }
+
+      bool cancelled = false;
+      for(uint32_t k = 0; active; k = (k + 1) % nslots){
+        slot& s = slots[k];
+        if(s.state == slot::idle)
+          continue;
+        st = wait(s);
+        if(s.state == slot::reading){
+          if(st == status::end_of_file || (success(st) && s.iosb.Information == 0))
+            st = status::end_of_file; // the file was truncated during the copy
+          else if(success(st))
+            st = write(s);
+        }else if(success(st)){
+          copied += s.length;
+          if(copied > size)
+            copied = size;
+          if(!progress(copied, size)){
+            cancelled = true;
+            st = status::cancelled;
+          }else if(next_offset < size){
+            st = read(s);
+          }else{
+            s.state = slot::idle;
+            active--;
+          }
+        }
+        if(!success(st)){
+          s.state = slot::idle;
+          drain();
+          return cancelled ? status::cancelled : st;
+        }
+      }
+
+      if(unbuffered){
+        // the last write was rounded up to the sector size
+        const file_end_of_file_information eof = { static_cast<int64_t>(size) };
+        file_information<file_end_of_file_information> fi(to, eof);
+        st = fi;
+      }
+      return st;
+    }
+
+  private:
+    ntstatus read(slot& s)
+    {
+      s.offset = next_offset;
+      s.length = buffer_size;
+      if(size - next_offset < buffer_size && !unbuffered)
+        s.length = static_cast<uint32_t>(size - next_offset);
+      next_offset += buffer_size;
+      s.state = slot::reading;
+      return start(NtReadFile(from, s.event.get(), nullptr, nullptr, &s.iosb, s.buf, s.length, &s.offset, nullptr));
+    }
+
+    ntstatus write(slot& s)
+    {
+      s.length = static_cast<uint32_t>(s.iosb.Information);
+      uint32_t length = s.length;
+      if(unbuffered)
+        length = (length + sector_size - 1) & ~(sector_size - 1);
+      s.state = slot::writing;
+      return start(NtWriteFile(to, s.event.get(), nullptr, nullptr, &s.iosb, s.buf, length, &s.offset, nullptr));
+    }
+
+    static ntstatus start(ntstatus st)
+    {
+      return st == status::pending ? status::success : st;
+    }
+
+    static ntstatus wait(slot& s)
+    {
+      const ntstatus st = NtWaitForSingleObject(s.event.get(), false, infinite_timeout());
+      return success(st) ? s.iosb.Status : st;
+    }
+
+    /** Waits for the operations in flight, the buffers can't be freed before */
+    void drain()
+    {
+      for(uint32_t i = 0; i < nslots; i++){
+        if(slots[i].state != slot::idle){
+          wait(slots[i]);
+          slots[i].state = slot::idle;
+        }
+      }
+    }
+
+  private:
+    legacy_handle from, to;
+    void* base;
+    size_t region;
+    uint64_t size, next_offset, copied;
+    uint32_t buffer_size, nslots;
+    bool unbuffered;
+    slot slots[copy_file_options::max_buffers];
+  };
+} // __
+
+/**
+ *	@brief Copies the file contents with the reads and writes running concurrently
+ *
+ *  Several buffers are in flight at once: while one buffer is being written, the next ones are being read,
+ *  so the source and the destination devices work in parallel. The destination is created or overwritten,
+ *  its space is reserved before the copy (copy_file_options::preallocate).
+ *  The big files can be copied bypassing the system cache (copy_file_options::unbuffered_threshold).
+ *
+ *  The \p progress is called as <tt>bool progress(uint64_t copied, uint64_t total)</tt> after every written block,
+ *  returning false cancels the copy with status::cancelled. The destination is left partially written on error or cancel.
+ *
+ *  @param[in] from native path of the source file
+ *  @param[in] to native path of the destination file
+ **/
+template<class Progress>
+inline ntstatus copy_file(const const_unicode_string& from, const const_unicode_string& to, const copy_file_options& options, Progress progress)
+{
+  file_handler src;
+  // asynchronous handles: no synchronous_io_* options
+  const file::creation_options sequential = file::non_directory_file|file::sequental_only;
+  ntstatus st = src.open(from, file::generic_read, file::share_valid_flags, sequential);
+  if(!success(st))
+    return st;
+
+  const file_information<file_standard_information> info(src.get());
+  if(!info)
+    return info;
+  const uint64_t size = static_cast<uint64_t>(info.data()->EndOfFile);
+  const bool unbuffered = options.unbuffered_threshold && size >= options.unbuffered_threshold;
+  if(unbuffered){
+    st = src.open(from, file::generic_read, file::share_valid_flags, sequential|file::no_intermediate_buffering);
+    if(!success(st))
+      return st;
+  }
+
+  file_handler dst;
+  st = dst.create(to, file::overwrite_if, file::generic_write, file::share_read,
+    unbuffered ? sequential|file::no_intermediate_buffering : sequential);
+  if(!success(st) || !size)
+    return st;
+
+  if(options.preallocate){
+    // reserves the clusters without moving the end of file, so the data is not zero-filled first
+    const file_allocation_information alloc = { static_cast<int64_t>(size) };
+    file_information<file_allocation_information> fi(dst.get(), alloc);
+    (void)fi; // the copy does not depend on the reservation
+  }
+
+  __::file_copier copier(src.get(), dst.get(), options);
+  return copier.run(size, unbuffered, progress);
+}
+
+/** Copies the file contents with the reads and writes running concurrently */
+inline ntstatus copy_file(const const_unicode_string& from, const const_unicode_string& to, const copy_file_options& options = copy_file_options())
+{
+  return copy_file(from, to, options, copy_progress_none());
+}
+
+/**@} io */
+
+} // nt
+} // ntl
+
+#endif // NTL__NT_FILE_COPY
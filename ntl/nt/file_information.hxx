@@ -491,6 +491,14 @@ struct file_position_information
 };
 
 
+///\name  FileAllocationInformation == 19
+struct file_allocation_information
+{
+  static const file_information_class info_class_type = FileAllocationInformation;
+
+  int64_t AllocationSize;
+};
+
 ///\name  FileEndOfFileInformation == 20
 struct file_end_of_file_information
 {
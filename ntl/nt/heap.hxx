@@ -484,6 +484,12 @@ public:
     return RtlFreeHeap(heap, flags, p);
   }
 
+  static __forceinline
+  void* realloc(heap_ptr heap, void* ptr, size_t size, flag flags = none)
+  {
+    return RtlReAllocateHeap(heap, flags, ptr, size);
+  }
+
   static __forceinline
   bool validate(heap_ptr heap, const void* const p = NULL, flag flags = none)
   {
@@ -543,7 +549,7 @@ public:
 
   void* realloc(void* ptr, size_t size, flag flags = none)
   {
-    return RtlReAllocateHeap(h, flags, ptr, size);
+    return realloc(h, ptr, size, flags);
   }
 
   heap_ptr get() const { return h; }
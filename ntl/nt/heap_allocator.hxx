@@ -0,0 +1,100 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Allocator for the private NT heaps
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__NT_HEAP_ALLOCATOR
+#define NTL__NT_HEAP_ALLOCATOR
+#pragma once
+
+#include "heap.hxx"
+#include "../stlx/memory.hxx"
+
+namespace ntl {
+namespace nt {
+
+/**
+ *	@brief Allocator which binds a container to the specific heap
+ *
+ *  Destroying a private heap frees all containers allocated from it at once.
+ *  A heap which is used by one thread only can be created with the heap::no_serialize flag
+ *  (or the flag can be passed to the allocator to skip the locking of a shared heap
+ *  when the caller guarantees the exclusive access).
+ *
+ *  @code
+ *  nt::heap h(nt::heap::growable|nt::heap::no_serialize);
+ *  std::list<int, nt::heap_allocator<int> > l(nt::heap_allocator<int>(h));
+ *  @endcode
+ **/
+template<class T>
+class heap_allocator:
+  public std::allocator<T>
+{
+public:
+  typedef typename std::allocator<T>::size_type  size_type;
+  typedef typename std::allocator<T>::pointer    pointer;
+  template<class U> struct rebind { typedef heap_allocator<U> other; };
+
+  explicit heap_allocator(const heap& h, heap::flag flags = heap::none) __ntl_nothrow
+    :h(h.get()), flags(flags)
+  {}
+
+  explicit heap_allocator(heap_ptr h = process_heap(), heap::flag flags = heap::none) __ntl_nothrow
+    :h(h), flags(flags)
+  {}
+
+  template<class U>
+  heap_allocator(const heap_allocator<U>& x) __ntl_nothrow
+    :h(x.get()), flags(x.get_flags())
+  {}
+
+  __noalias
+  pointer allocate(size_type n, std::allocator<void>::const_pointer = 0) __ntl_throws(std::bad_alloc)
+  {
+    if(n > this->max_size())
+      __ntl_throw(std::bad_alloc());
+    void* const p = heap::alloc(h, n * sizeof(T), flags);
+    if(!p)
+      __ntl_throw(std::bad_alloc());
+    return static_cast<pointer>(p);
+  }
+
+  void deallocate(pointer p, size_type) __ntl_nothrow
+  {
+    heap::free(h, p, flags);
+  }
+
+  /** Grows the block of \p n elements to \p new_n elements in place, the vector uses it to avoid the copying */
+  bool expand(pointer p, size_type /*n*/, size_type new_n) __ntl_nothrow
+  {
+    if(new_n > this->max_size())
+      return false;
+    const heap::flag in_place = static_cast<heap::flag>((flags & ~heap::generate_exceptions) | heap::realloc_in_place_only);
+    return heap::realloc(h, p, new_n * sizeof(T), in_place) != nullptr;
+  }
+
+  heap_ptr get() const { return h; }
+  heap::flag get_flags() const { return flags; }
+
+  template<class U>
+  friend bool operator==(const heap_allocator& x, const heap_allocator<U>& y) __ntl_nothrow
+  {
+    return x.get() == y.get();
+  }
+
+  template<class U>
+  friend bool operator!=(const heap_allocator& x, const heap_allocator<U>& y) __ntl_nothrow
+  {
+    return !(x == y);
+  }
+
+private:
+  heap_ptr    h;
+  heap::flag  flags;
+};
+
+}//namespace nt
+}//namespace ntl
+
+#endif//#ifndef NTL__NT_HEAP_ALLOCATOR
@@ -0,0 +1,129 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  User-mode lookaside lists
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__NT_LOOKASIDE_LIST
+#define NTL__NT_LOOKASIDE_LIST
+#pragma once
+
+#include "heap.hxx"
+
+namespace ntl {
+namespace nt {
+
+/**
+ *	@brief User-mode counterpart of the km::npaged_lookaside_list
+ *
+ *  Keeps up to \c Depth freed cells of the fixed size and hands them out before going to the heap.
+ *  The interface and the statistics (\c TotalAllocates, \c AllocateMisses, \c TotalFrees, \c FreeMisses)
+ *  match the kernel lookaside list, so the code written for the latter (e.g. std::ext::lookaside_allocator)
+ *  can be used and profiled in user mode as well.
+ *
+ *  @note Unlike the kernel list this one is not synchronized and must be used by one thread at a time.
+ **/
+template<typename CellType = void>
+class lookaside_list
+{
+  lookaside_list(const lookaside_list&) __deleted;
+  const lookaside_list& operator=(const lookaside_list&) __deleted;
+
+  struct entry { entry* next; };
+
+public:
+  typedef CellType  value_type;
+
+  static const uint16_t default_depth = 256;
+
+  explicit
+  lookaside_list(
+    heap_ptr  h     = process_heap(),
+    uint16_t  depth = default_depth)
+    :Depth(depth), TotalAllocates(), AllocateMisses(), TotalFrees(), FreeMisses(),
+    Size(cell(sizeof(CellType))), h(h), head(), count()
+  {}
+
+  /** Creates a list of the \p cell_size byte cells (e.g. for the lookaside_list<void>) */
+  explicit
+  lookaside_list(
+    size_t    cell_size,
+    heap_ptr  h     = process_heap(),
+    uint16_t  depth = default_depth)
+    :Depth(depth), TotalAllocates(), AllocateMisses(), TotalFrees(), FreeMisses(),
+    Size(cell(cell_size)), h(h), head(), count()
+  {}
+
+  ~lookaside_list()
+  {
+    while(head){
+      entry* const next = head->next;
+      heap::free(h, head);
+      head = next;
+    }
+  }
+
+  value_type * allocate()
+  {
+    ++TotalAllocates;
+    void * p = head;
+    if ( p ) {
+      head = head->next;
+      --count;
+    } else {
+      ++AllocateMisses;
+      p = heap::alloc(h, Size);
+    }
+    return reinterpret_cast<value_type*>(p);
+  }
+
+  void free(void * p)
+  {
+    ++TotalFrees;
+    if ( count < Depth ) {
+      entry* const e = reinterpret_cast<entry*>(p);
+      e->next = head;
+      head = e;
+      ++count;
+    } else {
+      ++FreeMisses;
+      heap::free(h, p);
+    }
+  }
+
+  size_t cell_size() const { return Size; }
+
+  /** Allocates a block of the arbitrary size from the backing heap */
+  void * allocate_block(size_t size)
+  {
+    return heap::alloc(h, size);
+  }
+
+  void free_block(void * block)
+  {
+    heap::free(h, block);
+  }
+
+public:
+  uint16_t  Depth;
+  uint32_t  TotalAllocates;
+  uint32_t  AllocateMisses;
+  uint32_t  TotalFrees;
+  uint32_t  FreeMisses;
+  uint32_t  Size;
+
+private:
+  static uint32_t cell(size_t size)
+  {
+    return static_cast<uint32_t>(size < sizeof(entry) ? sizeof(entry) : size);
+  }
+
+  heap_ptr  h;
+  entry *   head;
+  uint16_t  count;
+};
+
+}//namespace nt
+}//namespace ntl
+
+#endif//#ifndef NTL__NT_LOOKASIDE_LIST
@@ -0,0 +1,354 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Memory mapped files
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__NT_MAPPED_FILE
+#define NTL__NT_MAPPED_FILE
+#pragma once
+
+#include "file.hxx"
+#include "../stlx/range.hxx"
+#include "../stlx/string_ref.hxx"
+
+namespace ntl {
+namespace nt {
+
+/**\addtogroup  io
+ *@{*/
+
+/**
+ *	@brief File mapped to the memory by the section object
+ *
+ *  Holds the section of the file, the views of it are mapped by the mapped_view and mapped_window.
+ *  The section keeps the file referenced, so the file handle passed to open() can be closed after.
+ *  The empty file has no section (it can't be mapped), its views are empty.
+ **/
+class mapped_file:
+  public last_status_t
+{
+  mapped_file(const mapped_file&) __deleted;
+  mapped_file& operator=(const mapped_file&) __deleted;
+
+public:
+  enum mode_type
+  {
+    /** The view is read-only */
+    read_only,
+    /** The view is writable, the written pages become private to the process and never reach the file */
+    copy_on_write
+  };
+
+  /** Alignment of the view offsets in the file */
+  static const uint32_t granularity = 64*1024;
+
+  mapped_file()
+    :size_(), mode_(read_only)
+  {
+    last_status_ = status::invalid_handle;
+  }
+
+  /** Opens the file by its native path and maps it */
+  explicit mapped_file(const const_unicode_string& path, mode_type mode = read_only)
+    :size_(), mode_(mode)
+  {
+    open(path, mode);
+  }
+
+  /** Maps the opened file, the handle must have the read access */
+  explicit mapped_file(legacy_handle file, mode_type mode = read_only)
+    :size_(), mode_(mode)
+  {
+    open(file, mode);
+  }
+
+  /** Maps the opened file, the file must have the read access */
+  explicit mapped_file(const file& f, mode_type mode = read_only)
+    :size_(), mode_(mode)
+  {
+    open(f.handler().get(), mode);
+  }
+
+  ntstatus open(const const_unicode_string& path, mode_type mode = read_only)
+  {
+    file_handler f;
+    last_status_ = f.open(path, file::generic_read, file::share_read, file::non_directory_file|file::synchronous_io_nonalert);
+    if(!success(last_status_)){
+      close();
+      return last_status_;
+    }
+    return open(f.get(), mode);
+  }
+
+  ntstatus open(legacy_handle file, mode_type mode = read_only)
+  {
+    close();
+    mode_ = mode;
+    const file_information<file_standard_information> info(file);
+    if(!info)
+      return last_status_ = info;
+    size_ = static_cast<uint64_t>(info.data()->EndOfFile);
+    if(!size_)
+      return last_status_ = status::success;
+
+    last_status_ = section::create(&s, section::map_read|section::query, nullptr, nullptr,
+      mode == copy_on_write ? page_protection::page_writecopy : page_protection::page_readonly,
+      allocation_attributes::sec_commit, file);
+    if(!success(last_status_))
+      size_ = 0;
+    return last_status_;
+  }
+
+  void close()
+  {
+    s.reset();
+    size_ = 0;
+    last_status_ = status::invalid_handle;
+  }
+
+  __explicit_operator_bool() const { return __explicit_bool(success(last_status_)); }
+
+  /** Size of the file at the time it was mapped */
+  uint64_t size() const { return size_; }
+
+  mode_type mode() const { return mode_; }
+
+  /** Page protection of the views */
+  page_protection::type protection() const
+  {
+    return mode_ == copy_on_write ? page_protection::page_writecopy : page_protection::page_readonly;
+  }
+
+  legacy_handle section_handle() const { return s.get(); }
+
+private:
+  handle s;
+  uint64_t size_;
+  mode_type mode_;
+};
+
+
+/**
+ *	@brief View of the mapped_file, the contiguous range of the file bytes
+ *
+ *  The view begins at any offset of the file: the mapping itself starts at the offset rounded down
+ *  to the mapped_file::granularity, data() points to the requested byte.
+ **/
+class mapped_view:
+  public last_status_t
+{
+  mapped_view(const mapped_view&) __deleted;
+  mapped_view& operator=(const mapped_view&) __deleted;
+
+public:
+  typedef const char  value_type;
+  typedef const char* const_iterator;
+  typedef const char* iterator;
+  typedef size_t      size_type;
+
+  /** Length of the view up to the end of file */
+  static const size_t npos = static_cast<size_t>(-1);
+
+  /** Access pattern hint of the advise() */
+  enum advice
+  {
+    /** The range will be accessed soon: reads it into the memory now */
+    will_need,
+    /** The range will not be accessed soon: removes its pages from the working set */
+    dont_need
+  };
+
+  mapped_view()
+    :f(), base(), data_(), size_(), offset_()
+  {
+    last_status_ = status::success;
+  }
+
+  /** Maps \p length bytes of the file starting at \p offset, \c npos maps the rest of the file */
+  explicit mapped_view(const mapped_file& file, uint64_t offset = 0, size_t length = npos)
+    :f(), base(), data_(), size_(), offset_()
+  {
+    map(file, offset, length);
+  }
+
+  ~mapped_view()
+  {
+    unmap();
+  }
+
+  ntstatus map(const mapped_file& file, uint64_t offset = 0, size_t length = npos)
+  {
+    unmap();
+    f = &file;
+    if(!file)
+      return last_status_ = file.last_status();
+    if(offset > file.size())
+      return last_status_ = status::invalid_parameter;
+
+    const uint64_t rest = file.size() - offset;
+    if(length == npos || length > rest){
+      if(rest > npos)
+        return last_status_ = status::section_too_big; // doesn't fit into the address space, see mapped_window
+      length = static_cast<size_t>(rest);
+    }
+    offset_ = offset;
+    if(!length)
+      return last_status_ = status::success;
+
+    int64_t aligned = static_cast<int64_t>(offset & ~static_cast<uint64_t>(mapped_file::granularity - 1));
+    const size_t delta = static_cast<size_t>(offset - aligned);
+    size_t view_size = delta + length;
+    last_status_ = NtMapViewOfSection(file.section_handle(), current_process(), &base, 0, 0, &aligned, &view_size,
+      section_inherit::ViewUnmap, allocation_attributes::none, file.protection());
+    if(!success(last_status_)){
+      base = nullptr;
+      return last_status_;
+    }
+    data_ = static_cast<char*>(base) + delta;
+    size_ = length;
+    return last_status_;
+  }
+
+  /** Maps the view of the same length at the other \p offset of the file */
+  ntstatus remap(uint64_t offset)
+  {
+    if(!f)
+      return last_status_ = status::invalid_handle;
+    return map(*f, offset, size_ ? size_ : npos);
+  }
+
+  void unmap()
+  {
+    if(base)
+      NtUnmapViewOfSection(current_process(), base);
+    base = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  __explicit_operator_bool() const { return __explicit_bool(success(last_status_)); }
+
+  const char* data()  const { return data_; }
+  const char* begin() const { return data_; }
+  const char* end()   const { return data_ + size_; }
+  size_t size()       const { return size_; }
+  bool empty()        const { return size_ == 0; }
+
+  /** Offset of the view in the file */
+  uint64_t offset() const { return offset_; }
+
+  /** The writable view bytes, for the mapped_file::copy_on_write mode only */
+  char* mutable_data() const { return data_; }
+
+  std::string_ref str() const { return std::string_ref(data_, size_); }
+
+  std::range<const char*> range() const { return std::make_range(begin(), end()); }
+
+  /** Hints the access pattern of the view bytes [offset, offset+length) */
+  void advise(advice hint, size_t offset = 0, size_t length = npos) const
+  {
+    if(offset >= size_)
+      return;
+    if(length > size_ - offset)
+      length = size_ - offset;
+
+    if(hint == will_need){
+      // the page faults are clustered, so touching every page reads the range by the big blocks
+      const size_t page = 4096;
+      const volatile char* p = data_ + offset;
+      const volatile char* const last = p + length - 1;
+      for(; p < last; p += page - (reinterpret_cast<uintptr_t>(p) & (page - 1)))
+        (void)*p;
+      (void)*last;
+    }else{
+      // unlocking of the pages which are not locked removes them from the working set
+      void* start = data_ + offset;
+      size_t size = length;
+      NtUnlockVirtualMemory(current_process(), &start, &size, map_type::map_process);
+    }
+  }
+
+  void swap(mapped_view& v)
+  {
+    std::swap(f, v.f);
+    std::swap(base, v.base);
+    std::swap(data_, v.data_);
+    std::swap(size_, v.size_);
+    std::swap(offset_, v.offset_);
+    const ntstatus st = last_status_;
+    last_status_ = v.last_status_;
+    v.last_status_ = st;
+  }
+
+private:
+  const mapped_file* f;
+  void* base;
+  char* data_;
+  size_t size_;
+  uint64_t offset_;
+};
+
+
+/**
+ *	@brief Sliding window over the mapped_file
+ *
+ *  Gives the access to the files larger than the address space budget: only the window of the fixed size
+ *  is mapped at once, it is moved when the requested bytes are outside of it.
+ **/
+class mapped_window
+{
+  mapped_window(const mapped_window&) __deleted;
+  mapped_window& operator=(const mapped_window&) __deleted;
+
+public:
+#ifdef NTL_SUBSYSTEM_KM
+  static const size_t default_window_size = 1024*1024;
+#else
+  static const size_t default_window_size = 16*1024*1024;
+#endif
+
+  explicit mapped_window(const mapped_file& file, size_t window_size = default_window_size)
+    :f(file), window_size(window_size)
+  {}
+
+  /**
+   *	@brief Bytes [offset, offset+length) of the file
+   *
+   *  Remaps the window starting at \p offset if the bytes are not in the current one.
+   *  The \p length is clamped to the end of file.
+   *  @return pointer to the byte at \p offset or null on error or if the \p length exceeds the window size
+   **/
+  const char* map(uint64_t offset, size_t length)
+  {
+    if(offset >= f.size())
+      return nullptr;
+    if(length > f.size() - offset)
+      length = static_cast<size_t>(f.size() - offset);
+    if(length > window_size)
+      return nullptr;
+
+    if(!v.data() || offset < v.offset() || offset + length > v.offset() + v.size()){
+      if(!success(v.map(f, offset, window_size)))
+        return nullptr;
+    }
+    return v.data() + static_cast<size_t>(offset - v.offset());
+  }
+
+  /** The currently mapped window */
+  const mapped_view& view() const { return v; }
+
+  size_t size() const { return window_size; }
+
+private:
+  const mapped_file& f;
+  const size_t window_size;
+  mapped_view v;
+};
+
+/**@} io */
+
+} // nt
+} // ntl
+
+#endif // NTL__NT_MAPPED_FILE
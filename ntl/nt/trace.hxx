@@ -0,0 +1,425 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Binary trace ring
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__NT_TRACE
+#define NTL__NT_TRACE
+#pragma once
+
+#include "../atomic.hxx"
+#include "../format.hxx"
+#include "shared_data.hxx"
+
+#ifndef NTL_SUBSYSTEM_KM
+# include "teb.hxx"
+# include "system_information.hxx"
+#else
+# include "../km/thread.hxx"
+#endif
+
+namespace ntl {
+namespace nt {
+
+/**\addtogroup  debug
+ *@{*/
+
+/** Clock of the trace records: the processor's time stamp counter, calibrated by the trace ring */
+struct trace_tsc_clock
+{
+  static uint64_t now() { return intrinsic::rdtsc(); }
+
+  /** Ticks per second, zero if the clock has to be calibrated */
+  static uint64_t frequency() { return 0; }
+};
+
+/** Clock of the trace records: the interrupt time, the same on all processors but advancing by the timer ticks only */
+struct trace_interrupt_clock
+{
+  static uint64_t now() { return static_cast<uint64_t>(user_shared_data::instance().InterruptTime.get()); }
+
+  static uint64_t frequency() { return 10000000; }
+};
+
+
+/** Trace record as it is stored in the ring, 64 bytes */
+struct trace_record
+{
+  /** Maximal number of the arguments of the record */
+  static const uint32_t max_args = 5;
+
+  enum arg_type { none_arg, int_arg, uint_arg, float_arg, pointer_arg, string_arg, bool_arg, char_arg };
+
+  /** Position of the record in its ring plus one, zero while the record is being written */
+  volatile uint32_t sequence;
+  /** Event id, the reader maps it to the format string */
+  uint32_t event;
+  uint64_t timestamp;
+  /** Number of the arguments (3 bits) and their types (3 bits each) */
+  uint32_t info;
+  /** Low 32 bits of the writer thread id */
+  uint32_t thread;
+  uint64_t args[max_args];
+
+  uint32_t argc() const { return info & 7; }
+
+  arg_type type(uint32_t i) const { return static_cast<arg_type>((info >> (3 + i * 3)) & 7); }
+};
+
+
+namespace __
+{
+  /** Argument packed to the trace record */
+  struct trace_arg
+  {
+    uint64_t value;
+    uint32_t type;
+
+    trace_arg()                     :value(), type(trace_record::none_arg) {}
+    trace_arg(signed char v)        :value(static_cast<uint64_t>(static_cast<int64_t>(v))), type(trace_record::int_arg) {}
+    trace_arg(short v)              :value(static_cast<uint64_t>(static_cast<int64_t>(v))), type(trace_record::int_arg) {}
+    trace_arg(int v)                :value(static_cast<uint64_t>(static_cast<int64_t>(v))), type(trace_record::int_arg) {}
+    trace_arg(long v)               :value(static_cast<uint64_t>(static_cast<int64_t>(v))), type(trace_record::int_arg) {}
+    trace_arg(long long v)          :value(static_cast<uint64_t>(v)), type(trace_record::int_arg) {}
+    trace_arg(unsigned char v)      :value(v), type(trace_record::uint_arg) {}
+    trace_arg(unsigned short v)     :value(v), type(trace_record::uint_arg) {}
+    trace_arg(unsigned int v)       :value(v), type(trace_record::uint_arg) {}
+    trace_arg(unsigned long v)      :value(v), type(trace_record::uint_arg) {}
+    trace_arg(unsigned long long v) :value(v), type(trace_record::uint_arg) {}
+    trace_arg(bool v)               :value(v), type(trace_record::bool_arg) {}
+    trace_arg(char v)               :value(static_cast<unsigned char>(v)), type(trace_record::char_arg) {}
+    trace_arg(float v)              :type(trace_record::float_arg) { set(v); }
+    trace_arg(double v)             :type(trace_record::float_arg) { set(v); }
+    trace_arg(const char* v)        :value(reinterpret_cast<uintptr_t>(v)), type(trace_record::string_arg) {}
+    trace_arg(const void* v)        :value(reinterpret_cast<uintptr_t>(v)), type(trace_record::pointer_arg) {}
+    template<typename T>
+    trace_arg(const T* v)           :value(reinterpret_cast<uintptr_t>(v)), type(trace_record::pointer_arg) {}
+
+  private:
+    void set(double v)
+    {
+      union { double d; uint64_t u; } bits;
+      bits.d = v;
+      value = bits.u;
+    }
+  };
+
+  inline fmt::basic_format_arg<char> trace_format_arg(const trace_record& r, uint32_t i)
+  {
+    typedef fmt::basic_format_arg<char> arg;
+    const uint64_t v = r.args[i];
+    switch(r.type(i)){
+    case trace_record::int_arg:     return arg(static_cast<long long>(v));
+    case trace_record::uint_arg:    return arg(static_cast<unsigned long long>(v));
+    case trace_record::bool_arg:    return arg(v != 0);
+    case trace_record::char_arg:    return arg(static_cast<char>(v));
+    case trace_record::pointer_arg: return arg(reinterpret_cast<const void*>(static_cast<uintptr_t>(v)));
+    case trace_record::string_arg:  return arg(reinterpret_cast<const char*>(static_cast<uintptr_t>(v)));
+    case trace_record::float_arg:
+      {
+        union { double d; uint64_t u; } bits;
+        bits.u = v;
+        return arg(bits.d);
+      }
+    default:
+      return arg();
+    }
+  }
+
+  template<class Ring, class Formats, class Sink>
+  struct trace_text_visitor
+  {
+    const Ring& ring;
+    Formats& formats;
+    Sink& sink;
+    fmt::memory_buffer& buf;
+
+    void operator()(const trace_record& r) const
+    {
+      buf.clear();
+      ring.format(buf, r, formats(r.event));
+      buf.push_back('\n');
+      sink(buf.c_str(), buf.size());
+    }
+  private:
+    trace_text_visitor& operator=(const trace_text_visitor&) __deleted;
+  };
+} // __
+
+
+/**
+ *	@brief Lock-free ring of the binary trace records
+ *
+ *  Writing of the record takes a timestamp, an event id and up to trace_record::max_args arguments
+ *  which are stored as the raw 64-bit values; the formatting is deferred to the reader which maps the event id
+ *  to the fmt format string (see drain_text()). The ring is split into the shards selected by the writer thread id,
+ *  one shard per processor by default, so the writers rarely share the cache lines and the records of every thread
+ *  stay in order. The oldest records are overwritten when the shard is full, the reader counts them as lost.
+ *
+ *  The \c const \c char* arguments are stored as the pointers and read by the reader: they must be the static strings.
+ *  Any writer (at any IRQL if the ring memory is nonpaged) may run concurrently with the single reader.
+ *  The writer preempted for the whole lap of its shard may leave a mixed record.
+ **/
+template<class Clock = trace_tsc_clock>
+class basic_trace_ring
+{
+  basic_trace_ring(const basic_trace_ring&) __deleted;
+  basic_trace_ring& operator=(const basic_trace_ring&) __deleted;
+
+public:
+  typedef Clock clock;
+
+  /** Allocates the \p shards (the number of processors by default) of \p capacity records, both rounded up to the power of two */
+  explicit basic_trace_ring(uint32_t capacity = 4096, uint32_t shards = 0)
+    :raw(), shards_(), mask(round_up(capacity) - 1), shard_mask(round_up(shards ? shards : processors()) - 1),
+    lost_(), frequency_(), start_ticks(Clock::now()), start_time(trace_interrupt_clock::now())
+  {
+    const size_t count = static_cast<size_t>(mask + 1) * (shard_mask + 1);
+    raw = ::operator new(sizeof(shard) * (shard_mask + 1) + sizeof(trace_record) * (count + 1));
+    if(!raw)
+      return;
+    shards_ = static_cast<shard*>(raw);
+    // the records are aligned to their size which is the cache line
+    const uintptr_t p = reinterpret_cast<uintptr_t>(shards_ + shard_mask + 1) + sizeof(trace_record) - 1;
+    trace_record* const records = reinterpret_cast<trace_record*>(p & ~(sizeof(trace_record) - 1));
+    for(size_t i = 0; i < count; i++)
+      records[i].sequence = 0;
+    for(uint32_t k = 0; k <= shard_mask; k++){
+      shards_[k].head = shards_[k].tail = 0;
+      shards_[k].records = records + static_cast<size_t>(mask + 1) * k;
+    }
+  }
+
+  ~basic_trace_ring()
+  {
+    ::operator delete(raw);
+  }
+
+  __explicit_operator_bool() const { return __explicit_bool(shards_ != nullptr); }
+
+#if defined(NTL_CXX_VT) || defined(NTL_DOC)
+  /** Writes the record of the \p event with the \p args */
+  template<class... Args>
+  void write(uint32_t event, const Args&... args)
+  {
+    static_assert(sizeof...(Args) <= trace_record::max_args, "too many trace arguments");
+    const __::trace_arg a[] = { __::trace_arg(args)..., __::trace_arg() };
+    write_packed(event, a, sizeof...(Args));
+  }
+#else
+  #define NTL_X(n,p) __::trace_arg(NTL_SPP_CAT(p,n)) NTL_SPP_COMMA
+  #define NTL_DEFINE_WRITE(n,aux) \
+  template<NTL_SPP_ARGS(1,n,class A)> \
+  void write(uint32_t event, NTL_SPP_AARGS(1,n,const& a)) \
+  { \
+    const __::trace_arg args[] = { NTL_SPP_LOOP(1,n,NTL_X,a) __::trace_arg() }; \
+    write_packed(event, args, n); \
+  }
+  void write(uint32_t event)
+  {
+    write_packed(event, nullptr, 0);
+  }
+  NTL_DEFINE_WRITE(1,)
+  NTL_DEFINE_WRITE(2,)
+  NTL_DEFINE_WRITE(3,)
+  NTL_DEFINE_WRITE(4,)
+  NTL_DEFINE_WRITE(5,)
+  #undef NTL_X
+  #undef NTL_DEFINE_WRITE
+#endif
+
+  /**
+   *	@brief Visits the records written since the last drain as <tt>visit(const trace_record&)</tt>
+   *
+   *  The shards are visited one after another, the records of every thread are in order, the records of the different threads
+   *  should be merged by their timestamps. The record being written stops the visit of its shard until the next drain.
+   *  @return the number of the visited records
+   **/
+  template<class Visitor>
+  size_t drain(Visitor visit)
+  {
+    size_t n = 0;
+    for(uint32_t k = 0; shards_ && k <= shard_mask; k++){
+      shard& s = shards_[k];
+      const uint32_t head = s.head;
+      if(head - s.tail > mask + 1){
+        lost_ += head - s.tail - (mask + 1);
+        s.tail = head - (mask + 1);
+      }
+      for(; s.tail != head; ++s.tail){
+        const trace_record& r = s.records[s.tail & mask];
+        const uint32_t sequence = r.sequence;
+        const int32_t diff = static_cast<int32_t>(sequence - (s.tail + 1));
+        if(!sequence || diff < 0)
+          break;
+        if(diff > 0){
+          // overwritten by the next lap
+          ++lost_;
+          continue;
+        }
+        trace_record copy;
+        copy.event = r.event;
+        copy.timestamp = r.timestamp;
+        copy.info = r.info;
+        copy.thread = r.thread;
+        for(uint32_t i = 0; i < trace_record::max_args; i++)
+          copy.args[i] = r.args[i];
+        intrinsic::_ReadBarrier();
+        if(r.sequence != sequence){
+          ++lost_;
+          continue;
+        }
+        copy.sequence = sequence;
+        visit(static_cast<const trace_record&>(copy));
+        ++n;
+      }
+    }
+    return n;
+  }
+
+  /**
+   *	@brief Drains the records formatted to the text lines
+   *
+   *  The \p formats maps the event id to its format string as <tt>const char* formats(uint32_t event)</tt>,
+   *  the \p sink receives every null terminated line as <tt>sink(const char* line, size_t length)</tt>.
+   **/
+  template<class Formats, class Sink>
+  size_t drain_text(Formats formats, Sink sink)
+  {
+    calibrate();
+    fmt::memory_buffer buf;
+    const __::trace_text_visitor<basic_trace_ring, Formats, Sink> visitor = { *this, formats, sink, buf };
+    return drain(visitor);
+  }
+
+  /** Formats the record as <tt>[seconds.microseconds] thread: message</tt> */
+  void format(fmt::basic_buffer<char>& out, const trace_record& r, const char* format) const
+  {
+    const uint64_t us = nanoseconds(r.timestamp) / 1000;
+    const fmt::basic_format_arg<char> prefix[] = { us / 1000000, us % 1000000, r.thread };
+    fmt::vformat_to(out, "[{}.{:06}] {:>5}: ", prefix, _countof(prefix));
+    fmt::basic_format_arg<char> args[trace_record::max_args];
+    const uint32_t argc = r.argc() < trace_record::max_args ? r.argc() : trace_record::max_args;
+    for(uint32_t i = 0; i < argc; i++)
+      args[i] = __::trace_format_arg(r, i);
+    fmt::vformat_to(out, format ? format : "event {}", args, argc);
+  }
+
+  /** Number of the records overwritten before they were drained */
+  uint64_t lost() const { return lost_; }
+
+  /** Records per shard */
+  uint32_t capacity() const { return mask + 1; }
+
+  uint32_t shards() const { return shard_mask + 1; }
+
+  /** Clock ticks per second */
+  double frequency() const
+  {
+    if(!frequency_)
+      calibrate();
+    return frequency_;
+  }
+
+  /** Measures the clock frequency by the interrupt time elapsed since the ring was created, it is more precise later */
+  void calibrate() const
+  {
+    if(Clock::frequency()){
+      frequency_ = static_cast<double>(Clock::frequency());
+      return;
+    }
+    const uint64_t ticks = Clock::now() - start_ticks;
+    const uint64_t time = trace_interrupt_clock::now() - start_time;
+    if(time)
+      frequency_ = static_cast<double>(ticks) * trace_interrupt_clock::frequency() / static_cast<double>(time);
+  }
+
+  /** Sets the known clock frequency */
+  void calibrate(uint64_t frequency)
+  {
+    frequency_ = static_cast<double>(frequency);
+  }
+
+  /** Nanoseconds elapsed since the ring was created till the \p timestamp */
+  uint64_t nanoseconds(uint64_t timestamp) const
+  {
+    const double f = frequency();
+    return f > 0 && timestamp > start_ticks ? static_cast<uint64_t>(static_cast<double>(timestamp - start_ticks) * 1e9 / f) : 0;
+  }
+
+private:
+  void write_packed(uint32_t event, const __::trace_arg* args, uint32_t argc)
+  {
+    if(!shards_)
+      return;
+    const uintptr_t thread = current_thread();
+    shard& s = shards_[(thread >> 2) & shard_mask];
+    const uint32_t index = atomic::exchange_add(s.head, 1);
+    trace_record& r = s.records[index & mask];
+    r.sequence = 0;
+    intrinsic::_WriteBarrier();
+    r.timestamp = Clock::now();
+    r.event = event;
+    r.thread = static_cast<uint32_t>(thread);
+    uint32_t info = argc;
+    for(uint32_t i = 0; i < argc; i++){
+      r.args[i] = args[i].value;
+      info |= args[i].type << (3 + i * 3);
+    }
+    r.info = info;
+    r.sequence = index + 1;   // a volatile store has release semantics
+  }
+
+  static uintptr_t current_thread()
+  {
+  #ifndef NTL_SUBSYSTEM_KM
+    return reinterpret_cast<uintptr_t>(teb::instance().ClientId.UniqueThread);
+  #else
+    return reinterpret_cast<uintptr_t>(km::PsGetCurrentThreadId());
+  #endif
+  }
+
+  static uint32_t processors()
+  {
+  #ifndef NTL_SUBSYSTEM_KM
+    const system_information<system_basic_information> info;
+    return info ? static_cast<uint32_t>(info->NumberOfProcessors) : 1;
+  #else
+    return static_cast<uint32_t>(km::KeNumberProcessors);
+  #endif
+  }
+
+  static uint32_t round_up(uint32_t n)
+  {
+    uint32_t r = 1;
+    while(r < n)
+      r <<= 1;
+    return r;
+  }
+
+  /** The writers' head is alone in its cache line */
+  struct shard
+  {
+    volatile uint32_t head;
+    uint32_t tail;
+    trace_record* records;
+    char pad_[64 - sizeof(uint32_t) * 2 - sizeof(trace_record*)];
+  };
+
+  void* raw;
+  shard* shards_;
+  const uint32_t mask, shard_mask;
+  uint64_t lost_;
+  mutable double frequency_;
+  const uint64_t start_ticks, start_time;
+};
+
+typedef basic_trace_ring<> trace_ring;
+
+/**@} debug */
+
+} // nt
+} // ntl
+
+#endif // NTL__NT_TRACE
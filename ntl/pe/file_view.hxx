@@ -0,0 +1,925 @@
+/**\file*********************************************************************
+*                                                                     \brief
+*  Bounds-checked Portable Executable parser over raw (file) views
+*
+****************************************************************************
+*/
+#ifndef NTL__PE_FILE_VIEW
+#define NTL__PE_FILE_VIEW
+#pragma once
+
+#include "image.hxx"
+#include "../stlx/iterator.hxx"
+
+namespace ntl {
+  namespace pe {
+
+#pragma warning(push)
+#pragma warning(disable:4820) // 'X' bytes padding added after data member
+#pragma warning(disable:4365) // signed/unsigned mismatch
+
+    /**\addtogroup  pe_images_support *** Portable Executable images support
+    *@{*/
+
+    /**
+     *	@brief Read-only PE parser for untrusted data
+     *
+     *  Unlike \c image, which expects a loaded module and adds RVAs to its own address,
+     *  file_view works over an arbitrary memory range (a mapped file, an \c nt::section view
+     *  or a plain buffer) without copying it. RVAs are translated through the section table
+     *  when the data has on-disk layout, and every structure is validated against the view size
+     *  before it is returned, so truncated or malformed files yield null pointers and empty
+     *  sequences instead of access violations.
+     *
+     *  All directories are walked lazily by forward iterators: nothing is allocated and
+     *  nothing is touched until the iterator is dereferenced.
+     **/
+    class file_view
+    {
+      ///////////////////////////////////////////////////////////////////////////
+    public:
+
+      /** How the sections are laid out in the view */
+      enum layout_type {
+        /** raw file: sections at PointerToRawData */
+        file_layout,
+        /** loaded (or mapped as SEC_IMAGE): sections at VirtualAddress */
+        image_layout
+      };
+
+      typedef image::dos_header             dos_header;
+      typedef image::nt_headers             nt_headers;
+      typedef image::file_header            file_header;
+      typedef image::data_directory         data_directory;
+      typedef image::section_header         section_header;
+      typedef image::import_descriptor      import_descriptor;
+      typedef image::export_directory       export_directory;
+      typedef image::base_relocation        base_relocation;
+      typedef image::resource_directory     resource_directory;
+      typedef image::resource_directory_entry resource_directory_entry;
+      typedef image::resource_data_entry    resource_data_entry;
+      typedef image::resource_dir_string    resource_dir_string;
+      typedef image::tls_directory32        tls_directory32;
+      typedef image::tls_directory64        tls_directory64;
+
+      /** Half-open sequence of lazily evaluated entries */
+      template<class Iterator>
+      struct sequence
+      {
+        typedef Iterator iterator;
+        typedef Iterator const_iterator;
+
+        sequence(Iterator first, Iterator last)
+          :first(first), last(last)
+        {}
+
+        iterator begin() const { return first; }
+        iterator end()   const { return last; }
+        bool empty()     const { return first == last; }
+      private:
+        Iterator first, last;
+      };
+
+      ///\name  Construction
+
+      file_view(const void * data, size_t size, layout_type layout = file_layout) __ntl_nothrow
+        :base_(static_cast<const uint8_t*>(data)), size_(data ? size : 0), layout_(layout),
+        nth_(), sections_(), nsections_(), dirs_(), ndirs_()
+      {
+        parse_headers();
+      }
+
+      /** The view contains well-formed DOS, NT and section headers */
+      bool is_valid() const { return nth_ != 0; }
+
+      __explicit_operator_bool() const { return __explicit_bool(is_valid()); }
+
+      layout_type layout() const { return layout_; }
+
+      const uint8_t * data() const { return base_; }
+
+      size_t size() const { return size_; }
+
+      bool is_pe64() const
+      {
+        return nth_ && nth_->OptionalHeader64.Magic == image::optional_header64::signature;
+      }
+
+      uint64_t image_base() const
+      {
+        if ( !nth_ ) return 0;
+        return is_pe64() ? nth_->OptionalHeader64.ImageBase : nth_->OptionalHeader32.ImageBase;
+      }
+
+      uint32_t size_of_image() const
+      {
+        // SizeOfImage has the same offset in both optional headers
+        return nth_ ? nth_->OptionalHeader32.SizeOfImage : 0;
+      }
+
+      uint32_t size_of_headers() const
+      {
+        return nth_ ? nth_->OptionalHeader32.SizeOfHeaders : 0;
+      }
+
+      ///\name  Headers
+
+      const dos_header * get_dos_header() const
+      {
+        return nth_ ? reinterpret_cast<const dos_header*>(base_) : 0;
+      }
+
+      const nt_headers * get_nt_headers() const { return nth_; }
+
+      size_t number_of_sections() const { return nsections_; }
+
+      const section_header * get_section_header(size_t n = 0) const
+      {
+        return n < nsections_ ? &sections_[n] : 0;
+      }
+
+      const section_header * get_section_header(const char name[]) const
+      {
+        for ( size_t n = 0; n < nsections_; ++n )
+          if ( !std::strncmp(name, sections_[n].Name, section_header::sizeof_short_name) )
+            return &sections_[n];
+        return 0;
+      }
+
+      /** Returns the section which contains the given RVA */
+      const section_header * section_from_rva(uint32_t rva) const
+      {
+        for ( size_t n = 0; n < nsections_; ++n )
+        {
+          const section_header & sh = sections_[n];
+          const uint32_t vsize = sh.VirtualSize ? sh.VirtualSize : sh.SizeOfRawData;
+          if ( rva >= sh.VirtualAddress && rva - sh.VirtualAddress < vsize )
+            return &sh;
+        }
+        return 0;
+      }
+
+      /** Returns the directory entry if it is present and lies entirely within the view */
+      const data_directory * get_data_directory(data_directory::entry entry) const
+      {
+        if ( static_cast<uint32_t>(entry) >= ndirs_ ) return 0;
+        const data_directory * const dd = &dirs_[entry];
+        if ( !dd->VirtualAddress || !dd->Size ) return 0;
+        // the security directory holds a file offset, not an RVA
+        if ( entry == data_directory::security_table )
+          return in_bounds(dd->VirtualAddress, dd->Size) ? dd : 0;
+        size_t offset;
+        return translate(dd->VirtualAddress, dd->Size, offset) ? dd : 0;
+      }
+
+      ///\name  Address translation
+
+      /**
+       *	@brief Converts an RVA to the offset in the view
+       *  @return \c false if [rva, rva+length) is not backed by the view data
+       **/
+      bool rva_to_offset(uint32_t rva, size_t & offset, size_t length = 1) const
+      {
+        return nth_ && translate(rva, length, offset);
+      }
+
+      /** Returns a pointer to \c count objects of type T at RVA or null if they are out of bounds */
+      template<typename T>
+      const T * at_rva(uint32_t rva, size_t count = 1) const
+      {
+        size_t offset;
+        if ( !nth_ || count > size_ / sizeof(T) || !translate(rva, sizeof(T) * count, offset) )
+          return 0;
+        return reinterpret_cast<const T*>(base_ + offset);
+      }
+
+      /** Returns a pointer to the \c index element of the table of T at RVA or null if it is out of bounds */
+      template<typename T>
+      const T * table_at(uint32_t rva, uint32_t index) const
+      {
+        // the element RVA is computed in 64 bits, the one beyond 4 GB is not wrapped around to the headers
+        const uint64_t element = rva + static_cast<uint64_t>(index) * sizeof(T);
+        return element <= 0xFFFFFFFFu ? at_rva<T>(static_cast<uint32_t>(element)) : 0;
+      }
+
+      /** Returns a pointer to \c count objects of type T at the view offset or null if they are out of bounds */
+      template<typename T>
+      const T * at_offset(size_t offset, size_t count = 1) const
+      {
+        return count <= size_ / sizeof(T) && in_bounds(offset, sizeof(T) * count)
+          ? reinterpret_cast<const T*>(base_ + offset) : 0;
+      }
+
+      /** Returns the zero-terminated string at RVA or null if it is not terminated inside its section */
+      const char * string_at(uint32_t rva, size_t max_length = 4096) const
+      {
+        size_t offset;
+        if ( !nth_ || !translate(rva, 1, offset) ) return 0;
+        const size_t avail = contiguous_size(rva, offset);
+        const char * const s = reinterpret_cast<const char*>(base_ + offset);
+        const size_t n = avail < max_length ? avail : max_length;
+        for ( size_t i = 0; i < n; ++i )
+          if ( !s[i] ) return s;
+        return 0;
+      }
+
+      ///\name  Imports
+
+      /** One imported function */
+      struct import_entry
+      {
+        /** Import lookup table entry as it is stored in the file */
+        uint64_t    thunk;
+        /** RVA of the IAT slot */
+        uint32_t    iat_rva;
+        uint16_t    ordinal;
+        uint16_t    hint;
+        /** Function name or null for imports by ordinal and malformed entries */
+        const char* name;
+
+        bool by_ordinal() const { return name == 0 && ordinal != 0; }
+      };
+
+      class import_iterator
+        : public std::iterator<std::forward_iterator_tag, const import_descriptor>
+      {
+      public:
+        import_iterator()
+          :view(), rva()
+        {}
+
+        reference operator* () const { return *p; }
+        pointer   operator->() const { return p; }
+
+        import_iterator & operator++()
+        {
+          rva += sizeof(import_descriptor);
+          fetch();
+          return *this;
+        }
+
+        import_iterator operator++(int)
+        {
+          import_iterator tmp(*this);
+          ++*this;
+          return tmp;
+        }
+
+        /** Name of the imported module */
+        const char * name() const { return view->string_at(p->Name); }
+
+        friend bool operator==(const import_iterator & x, const import_iterator & y)
+        {
+          return x.view == y.view && x.rva == y.rva;
+        }
+
+        friend bool operator!=(const import_iterator & x, const import_iterator & y)
+        {
+          return !(x == y);
+        }
+
+      private:
+        const file_view * view;
+        uint32_t          rva;
+        pointer           p;
+
+        import_iterator(const file_view * view, uint32_t rva)
+          :view(view), rva(rva)
+        {
+          fetch();
+        }
+
+        void fetch()
+        {
+          p = view->at_rva<import_descriptor>(rva);
+          // the null descriptor (or the end of data) terminates the table
+          if ( !p || (!p->OriginalFirstThunk && !p->FirstThunk) )
+            view = 0, rva = 0;
+        }
+
+        friend class file_view;
+      };
+
+      class import_thunk_iterator
+        : public std::iterator<std::forward_iterator_tag, const import_entry>
+      {
+      public:
+        import_thunk_iterator()
+          :view(), rva(), iat()
+        {}
+
+        reference operator* () const { return entry; }
+        pointer   operator->() const { return &entry; }
+
+        import_thunk_iterator & operator++()
+        {
+          const uint32_t width = view->is_pe64() ? sizeof(uint64_t) : sizeof(uint32_t);
+          rva += width, iat += width;
+          fetch();
+          return *this;
+        }
+
+        import_thunk_iterator operator++(int)
+        {
+          import_thunk_iterator tmp(*this);
+          ++*this;
+          return tmp;
+        }
+
+        friend bool operator==(const import_thunk_iterator & x, const import_thunk_iterator & y)
+        {
+          return x.view == y.view && x.rva == y.rva;
+        }
+
+        friend bool operator!=(const import_thunk_iterator & x, const import_thunk_iterator & y)
+        {
+          return !(x == y);
+        }
+
+      private:
+        const file_view * view;
+        uint32_t          rva, iat;
+        import_entry      entry;
+
+        import_thunk_iterator(const file_view * view, uint32_t rva, uint32_t iat)
+          :view(view), rva(rva), iat(iat)
+        {
+          fetch();
+        }
+
+        void fetch()
+        {
+          uint64_t thunk = 0;
+          bool by_ordinal = false;
+          if ( view->is_pe64() ) {
+            if ( const uint64_t * t = view->at_rva<uint64_t>(rva) )
+              thunk = *t, by_ordinal = (thunk >> 63) != 0;
+          } else {
+            if ( const uint32_t * t = view->at_rva<uint32_t>(rva) )
+              thunk = *t, by_ordinal = (thunk >> 31) != 0;
+          }
+          if ( !thunk ) {
+            view = 0, rva = iat = 0;
+            return;
+          }
+          entry.thunk = thunk;
+          entry.iat_rva = iat;
+          entry.hint = entry.ordinal = 0;
+          entry.name = 0;
+          if ( by_ordinal ) {
+            entry.ordinal = static_cast<uint16_t>(thunk);
+          } else {
+            const uint32_t hint_name = static_cast<uint32_t>(thunk) & 0x7FFFFFFF;
+            if ( const uint16_t * hint = view->at_rva<uint16_t>(hint_name) ) {
+              entry.hint = *hint;
+              entry.name = view->string_at(hint_name + sizeof(uint16_t));
+            }
+          }
+        }
+
+        friend class file_view;
+      };
+
+      sequence<import_iterator> imports() const
+      {
+        const data_directory * const dd = get_data_directory(data_directory::import_table);
+        return sequence<import_iterator>(dd ? import_iterator(this, dd->VirtualAddress) : import_iterator(),
+                                         import_iterator());
+      }
+
+      /** Functions imported through the given descriptor */
+      sequence<import_thunk_iterator> import_thunks(const import_descriptor & desc) const
+      {
+        // unbound images produced by some linkers have no lookup table; IAT holds the same data then
+        const uint32_t lookup = desc.OriginalFirstThunk ? desc.OriginalFirstThunk : desc.FirstThunk;
+        return sequence<import_thunk_iterator>(import_thunk_iterator(this, lookup, desc.FirstThunk),
+                                               import_thunk_iterator());
+      }
+
+      ///\name  Exports
+
+      /** One exported function */
+      struct export_entry
+      {
+        /** Biased ordinal (i.e. index + export_directory::Base) */
+        uint32_t    ordinal;
+        uint32_t    rva;
+        /** Name from the name pointer table or null when iterated by address table */
+        const char* name;
+        /** Forwarder string ("dll.function") or null */
+        const char* forwarder;
+      };
+
+      const export_directory * get_export_directory() const
+      {
+        const data_directory * const dd = get_data_directory(data_directory::export_table);
+        return dd && dd->Size >= sizeof(export_directory) ? at_rva<export_directory>(dd->VirtualAddress) : 0;
+      }
+
+      /**
+       *	@brief Forward iterator over the export tables
+       *
+       *  In the address mode it walks the export address table by ordinal, skipping empty slots;
+       *  in the name mode it walks the name pointer table in its (sorted) order.
+       **/
+      class export_iterator
+        : public std::iterator<std::forward_iterator_tag, const export_entry>
+      {
+      public:
+        export_iterator()
+          :view(), dir(), index(), by_name()
+        {}
+
+        reference operator* () const { return entry; }
+        pointer   operator->() const { return &entry; }
+
+        export_iterator & operator++()
+        {
+          ++index;
+          fetch();
+          return *this;
+        }
+
+        export_iterator operator++(int)
+        {
+          export_iterator tmp(*this);
+          ++*this;
+          return tmp;
+        }
+
+        friend bool operator==(const export_iterator & x, const export_iterator & y)
+        {
+          return x.view == y.view && x.index == y.index;
+        }
+
+        friend bool operator!=(const export_iterator & x, const export_iterator & y)
+        {
+          return !(x == y);
+        }
+
+      private:
+        const file_view *         view;
+        const export_directory *  dir;
+        uint32_t                  index;
+        bool                      by_name;
+        export_entry              entry;
+
+        export_iterator(const file_view * view, const export_directory * dir, bool by_name)
+          :view(view), dir(dir), index(), by_name(by_name)
+        {
+          fetch();
+        }
+
+        void fetch()
+        {
+          for ( ; ; ++index )
+          {
+            if ( index >= (by_name ? dir->NumberOfNames : dir->NumberOfFunctions) )
+              break;
+            uint32_t ordinal = index;
+            entry.name = 0;
+            if ( by_name ) {
+              const uint32_t * const name = view->table_at<uint32_t>(dir->AddressOfNames, index);
+              const uint16_t * const ord  = view->table_at<uint16_t>(dir->AddressOfNameOrdinals, index);
+              if ( !name || !ord ) break;
+              entry.name = view->string_at(*name);
+              ordinal = *ord;
+            }
+            const uint32_t * const func = ordinal < dir->NumberOfFunctions
+              ? view->table_at<uint32_t>(dir->AddressOfFunctions, ordinal) : 0;
+            if ( !func ) {
+              if ( by_name ) continue; // broken name entry
+              break;
+            }
+            if ( !*func && !by_name ) continue; // gap in the ordinal space
+            entry.ordinal = dir->Base + ordinal;
+            entry.rva = *func;
+            entry.forwarder = 0;
+            const data_directory * const dd = view->get_data_directory(data_directory::export_table);
+            if ( entry.rva >= dd->VirtualAddress && entry.rva - dd->VirtualAddress < dd->Size )
+              entry.forwarder = view->string_at(entry.rva);
+            return;
+          }
+          view = 0, dir = 0, index = 0;
+        }
+
+        friend class file_view;
+      };
+
+      /** Exports in ordinal order, without names */
+      sequence<export_iterator> exports() const
+      {
+        const export_directory * const dir = get_export_directory();
+        return sequence<export_iterator>(dir ? export_iterator(this, dir, false) : export_iterator(), export_iterator());
+      }
+
+      /** Named exports in the order of the name pointer table */
+      sequence<export_iterator> named_exports() const
+      {
+        const export_directory * const dir = get_export_directory();
+        return sequence<export_iterator>(dir ? export_iterator(this, dir, true) : export_iterator(), export_iterator());
+      }
+
+      ///\name  Relocations
+
+      /** Validated base relocation block */
+      struct relocation_block
+      {
+        /** RVA of the page the block applies to */
+        uint32_t  page_rva;
+        /** Number of entries (including padding \c absolute ones) */
+        uint32_t  count;
+        const base_relocation::entry_t * entries;
+
+        const base_relocation::entry_t * begin() const { return entries; }
+        const base_relocation::entry_t * end()   const { return entries + count; }
+      };
+
+      class relocation_iterator
+        : public std::iterator<std::forward_iterator_tag, const relocation_block>
+      {
+      public:
+        relocation_iterator()
+          :view(), rva(), last()
+        {}
+
+        reference operator* () const { return block; }
+        pointer   operator->() const { return &block; }
+
+        relocation_iterator & operator++()
+        {
+          rva += static_cast<uint32_t>(sizeof(uint32_t) * 2 + block.count * sizeof(base_relocation::entry_t));
+          fetch();
+          return *this;
+        }
+
+        relocation_iterator operator++(int)
+        {
+          relocation_iterator tmp(*this);
+          ++*this;
+          return tmp;
+        }
+
+        friend bool operator==(const relocation_iterator & x, const relocation_iterator & y)
+        {
+          return x.view == y.view && x.rva == y.rva;
+        }
+
+        friend bool operator!=(const relocation_iterator & x, const relocation_iterator & y)
+        {
+          return !(x == y);
+        }
+
+      private:
+        const file_view * view;
+        uint32_t          rva, last;
+        relocation_block  block;
+
+        relocation_iterator(const file_view * view, uint32_t rva, uint32_t size)
+          :view(view), rva(rva), last(rva + size)
+        {
+          fetch();
+        }
+
+        void fetch()
+        {
+          static const uint32_t header_size = sizeof(uint32_t) * 2;
+          const uint32_t * const hdr = rva < last && last - rva >= header_size ? view->at_rva<uint32_t>(rva, 2) : 0;
+          // SizeOfBlock must cover the header, be entry-aligned and fit into the directory
+          if ( !hdr || hdr[1] <= header_size || hdr[1] % sizeof(base_relocation::entry_t) || hdr[1] > last - rva ) {
+            view = 0, rva = last = 0;
+            return;
+          }
+          block.page_rva = hdr[0];
+          block.count = (hdr[1] - header_size) / sizeof(base_relocation::entry_t);
+          block.entries = view->at_rva<base_relocation::entry_t>(rva + header_size, block.count);
+          if ( !block.entries )
+            view = 0, rva = last = 0;
+        }
+
+        friend class file_view;
+      };
+
+      sequence<relocation_iterator> relocations() const
+      {
+        const data_directory * const dd = get_data_directory(data_directory::basereloc_table);
+        return sequence<relocation_iterator>(dd ? relocation_iterator(this, dd->VirtualAddress, dd->Size) : relocation_iterator(),
+                                             relocation_iterator());
+      }
+
+      ///\name  Resources
+
+      class resource_iterator
+        : public std::iterator<std::forward_iterator_tag, const resource_directory_entry>
+      {
+      public:
+        resource_iterator()
+          :view(), p(), left()
+        {}
+
+        reference operator* () const { return *p; }
+        pointer   operator->() const { return p; }
+
+        resource_iterator & operator++()
+        {
+          if ( --left ) ++p;
+          else view = 0, p = 0;
+          return *this;
+        }
+
+        resource_iterator operator++(int)
+        {
+          resource_iterator tmp(*this);
+          ++*this;
+          return tmp;
+        }
+
+        bool is_directory() const { return p->DataIsDirectory != 0; }
+        bool is_named() const { return p->Name.IsString != 0; }
+
+        friend bool operator==(const resource_iterator & x, const resource_iterator & y)
+        {
+          return x.p == y.p;
+        }
+
+        friend bool operator!=(const resource_iterator & x, const resource_iterator & y)
+        {
+          return !(x == y);
+        }
+
+      private:
+        const file_view *   view;
+        pointer             p;
+        size_t              left;
+
+        resource_iterator(const file_view * view, pointer p, size_t n)
+          :view(n ? view : 0), p(n ? p : 0), left(n)
+        {}
+
+        friend class file_view;
+      };
+
+      /** Root of the resource tree */
+      const resource_directory * get_resource_directory() const
+      {
+        return resource_at<resource_directory>(0);
+      }
+
+      /** Entries of the resource directory (named entries go first) */
+      sequence<resource_iterator> resources(const resource_directory * dir) const
+      {
+        if ( !dir ) return sequence<resource_iterator>(resource_iterator(), resource_iterator());
+        const size_t n = size_t(dir->NumberOfNamedEntries) + dir->NumberOfIdEntries;
+        const resource_directory_entry * const first = n
+          ? resource_at<resource_directory_entry>(resource_offset(dir) + sizeof(resource_directory), n) : 0;
+        return sequence<resource_iterator>(resource_iterator(this, first, first ? n : 0), resource_iterator());
+      }
+
+      sequence<resource_iterator> resources() const
+      {
+        return resources(get_resource_directory());
+      }
+
+      /** Subdirectory referred by the entry or null if it is a leaf */
+      const resource_directory * resource_subdirectory(const resource_directory_entry & e) const
+      {
+        return e.DataIsDirectory ? resource_at<resource_directory>(e.OffsetToDirectory) : 0;
+      }
+
+      /** Data entry referred by the leaf entry */
+      const resource_data_entry * resource_data(const resource_directory_entry & e) const
+      {
+        return e.DataIsDirectory ? 0 : resource_at<resource_data_entry>(e.OffsetToDirectory);
+      }
+
+      /** Resource data bytes (OffsetToData is an RVA) */
+      const uint8_t * resource_bytes(const resource_data_entry & d) const
+      {
+        return d.Size ? at_rva<uint8_t>(d.OffsetToData, d.Size) : 0;
+      }
+
+      /** Name of the named entry */
+      const resource_dir_string * resource_name(const resource_directory_entry & e) const
+      {
+        if ( !e.Name.IsString ) return 0;
+        const resource_dir_string * const s = resource_at<resource_dir_string>(e.Name.Offset);
+        return s && resource_at<uint16_t>(e.Name.Offset + sizeof(uint16_t), s->Length) ? s : 0;
+      }
+
+      ///\name  TLS
+
+      class tls_callback_iterator
+        : public std::iterator<std::forward_iterator_tag, const uint32_t>
+      {
+      public:
+        tls_callback_iterator()
+          :view(), rva(), callback()
+        {}
+
+        /** RVA of the callback */
+        reference operator* () const { return callback; }
+
+        tls_callback_iterator & operator++()
+        {
+          rva += view->is_pe64() ? sizeof(uint64_t) : sizeof(uint32_t);
+          fetch();
+          return *this;
+        }
+
+        tls_callback_iterator operator++(int)
+        {
+          tls_callback_iterator tmp(*this);
+          ++*this;
+          return tmp;
+        }
+
+        friend bool operator==(const tls_callback_iterator & x, const tls_callback_iterator & y)
+        {
+          return x.view == y.view && x.rva == y.rva;
+        }
+
+        friend bool operator!=(const tls_callback_iterator & x, const tls_callback_iterator & y)
+        {
+          return !(x == y);
+        }
+
+      private:
+        const file_view * view;
+        uint32_t          rva;
+        uint32_t          callback;
+
+        tls_callback_iterator(const file_view * view, uint32_t rva)
+          :view(view), rva(rva)
+        {
+          fetch();
+        }
+
+        void fetch()
+        {
+          uint64_t va = 0;
+          if ( view->is_pe64() ) {
+            if ( const uint64_t * p = view->at_rva<uint64_t>(rva) ) va = *p;
+          } else {
+            if ( const uint32_t * p = view->at_rva<uint32_t>(rva) ) va = *p;
+          }
+          const uint64_t base = view->image_base();
+          if ( !va || va < base || va - base >= view->size_of_image() ) {
+            view = 0, rva = callback = 0;
+            return;
+          }
+          callback = static_cast<uint32_t>(va - base);
+        }
+
+        friend class file_view;
+      };
+
+      const tls_directory32 * get_tls_directory32() const
+      {
+        const data_directory * const dd = is_pe64() ? 0 : get_data_directory(data_directory::tls_table);
+        return dd ? at_rva<tls_directory32>(dd->VirtualAddress) : 0;
+      }
+
+      const tls_directory64 * get_tls_directory64() const
+      {
+        const data_directory * const dd = is_pe64() ? get_data_directory(data_directory::tls_table) : 0;
+        return dd ? at_rva<tls_directory64>(dd->VirtualAddress) : 0;
+      }
+
+      /** RVAs of the TLS callbacks */
+      sequence<tls_callback_iterator> tls_callbacks() const
+      {
+        uint64_t va = 0;
+        if ( const tls_directory64 * t64 = get_tls_directory64() )
+          va = t64->AddressOfCallBacks;
+        else if ( const tls_directory32 * t32 = get_tls_directory32() )
+          va = t32->AddressOfCallBacks;
+        const uint64_t base = image_base();
+        if ( !va || va < base || va - base >= size_of_image() )
+          return sequence<tls_callback_iterator>(tls_callback_iterator(), tls_callback_iterator());
+        return sequence<tls_callback_iterator>(tls_callback_iterator(this, static_cast<uint32_t>(va - base)),
+                                               tls_callback_iterator());
+      }
+
+      ///}
+
+      ///////////////////////////////////////////////////////////////////////////
+    private:
+
+      const uint8_t *           base_;
+      size_t                    size_;
+      layout_type               layout_;
+      const nt_headers *        nth_;
+      const section_header *    sections_;
+      size_t                    nsections_;
+      const data_directory *    dirs_;
+      uint32_t                  ndirs_;
+
+      bool in_bounds(size_t offset, size_t length) const
+      {
+        return offset <= size_ && length <= size_ - offset;
+      }
+
+      void parse_headers()
+      {
+        if ( !in_bounds(0, sizeof(dos_header)) ) return;
+        const dos_header * const dh = reinterpret_cast<const dos_header*>(base_);
+        if ( !dh->is_valid() || dh->e_lfanew < static_cast<long>(sizeof(dos_header)) ) return;
+
+        const size_t nt_offset = static_cast<size_t>(dh->e_lfanew);
+        static const size_t fixed_headers = sizeof(uint32_t) + sizeof(file_header);
+        if ( !in_bounds(nt_offset, fixed_headers + sizeof(uint16_t)) ) return;
+        const nt_headers * const nth = reinterpret_cast<const nt_headers*>(base_ + nt_offset);
+        if ( !nth->is_valid() ) return;
+
+        const size_t opt_size = nth->FileHeader.SizeOfOptionalHeader;
+        if ( !in_bounds(nt_offset + fixed_headers, opt_size) ) return;
+
+        const uint16_t magic = nth->OptionalHeader32.Magic;
+        const size_t dirs_offset = magic == image::optional_header64::signature
+          ? offsetof(image::optional_header64, DataDirectory)
+          : offsetof(image::optional_header32, DataDirectory);
+        if ( magic != image::optional_header32::signature && magic != image::optional_header64::signature ) return;
+        if ( opt_size < dirs_offset ) return;
+
+        const uint32_t declared = magic == image::optional_header64::signature
+          ? nth->OptionalHeader64.NumberOfRvaAndSizes : nth->OptionalHeader32.NumberOfRvaAndSizes;
+        const uint32_t fit = static_cast<uint32_t>((opt_size - dirs_offset) / sizeof(data_directory));
+        uint32_t ndirs = declared < fit ? declared : fit;
+        if ( ndirs > data_directory::number_of_directory_entries )
+          ndirs = data_directory::number_of_directory_entries;
+
+        const size_t sections_offset = nt_offset + fixed_headers + opt_size;
+        const size_t nsections = nth->FileHeader.NumberOfSections;
+        if ( !in_bounds(sections_offset, nsections * sizeof(section_header)) ) return;
+
+        nth_ = nth;
+        dirs_ = reinterpret_cast<const data_directory*>(base_ + nt_offset + fixed_headers + dirs_offset);
+        ndirs_ = ndirs;
+        sections_ = reinterpret_cast<const section_header*>(base_ + sections_offset);
+        nsections_ = nsections;
+      }
+
+      /** Raw data of the section starts at the file-aligned offset, as the loader rounds it down */
+      static uint32_t raw_offset(const section_header & sh)
+      {
+        return sh.PointerToRawData & ~0x1FFu;
+      }
+
+      bool translate(uint32_t rva, size_t length, size_t & offset) const
+      {
+        if ( layout_ == image_layout ) {
+          offset = rva;
+          return in_bounds(offset, length);
+        }
+        if ( rva < size_of_headers() || !nsections_ ) {
+          offset = rva;
+          return in_bounds(offset, length);
+        }
+        const section_header * const sh = section_from_rva(rva);
+        if ( !sh ) return false;
+        const uint32_t delta = rva - sh->VirtualAddress;
+        // the tail of the section beyond SizeOfRawData is zero-filled by the loader and has no file data
+        if ( delta >= sh->SizeOfRawData || length > sh->SizeOfRawData - delta ) return false;
+        offset = size_t(raw_offset(*sh)) + delta;
+        return in_bounds(offset, length);
+      }
+
+      /** Number of bytes which are readable from the RVA before the backing data ends */
+      size_t contiguous_size(uint32_t rva, size_t offset) const
+      {
+        size_t avail = size_ - offset;
+        if ( layout_ == file_layout && rva >= size_of_headers() ) {
+          if ( const section_header * const sh = section_from_rva(rva) ) {
+            const size_t in_section = sh->SizeOfRawData - (rva - sh->VirtualAddress);
+            if ( in_section < avail ) avail = in_section;
+          }
+        }
+        return avail;
+      }
+
+      size_t resource_offset(const void * p) const
+      {
+        const data_directory * const dd = get_data_directory(data_directory::resource_table);
+        const uint8_t * const root = dd ? at_rva<uint8_t>(dd->VirtualAddress, dd->Size) : 0;
+        return root ? static_cast<const uint8_t*>(p) - root : 0;
+      }
+
+      /** Resource tree offsets are relative to the directory start and must stay inside it */
+      template<typename T>
+      const T * resource_at(size_t offset, size_t count = 1) const
+      {
+        const data_directory * const dd = get_data_directory(data_directory::resource_table);
+        if ( !dd || offset > dd->Size || count > (dd->Size - offset) / sizeof(T) ) return 0;
+        return at_rva<T>(static_cast<uint32_t>(dd->VirtualAddress + offset), count);
+      }
+
+    };// class file_view
+
+    /**@} pe_images_support */
+
+#pragma warning(pop)
+
+  }//namespace pe
+}//namespace ntl
+
+#endif//#ifndef NTL__PE_FILE_VIEW
@@ -449,25 +449,66 @@ namespace ntl {
         return va<const nt_headers*>(static_cast<uintptr_t>(get_dos_header()->e_lfanew));
       }
 
+      /**
+       *	@brief Adds \p size bytes to the 16-bit one's complement sum \p sum
+       *
+       *  The data is summed as 32-bit words into 64-bit accumulators and the carries are folded
+       *  once per chunk, which gives the same result as adding 16-bit words with the end-around
+       *  carry (2^16 == 1 modulo 0xFFFF), but consumes eight bytes per addition.
+       *  When the data is summed by parts, every part except the last must have an even size.
+       *  An odd trailing byte is added as a zero-extended word, as CheckSumMappedFile does.
+       **/
+      static uint32_t checksum_partial(const void * data, size_t size, uint32_t sum = 0)
+      {
+        const uint8_t * p = static_cast<const uint8_t*>(data);
+        uint64_t acc = sum;
+        static const size_t step = sizeof(uint64_t) * 2;
+        while ( size >= step )
+        {
+          // an accumulator grows by less than 2^33 per step, fold them before they could overflow
+          size_t n = size / step;
+          if ( n > (size_t(1) << 30) ) n = size_t(1) << 30;
+          size -= n * step;
+          uint64_t a = 0, b = 0;
+          for ( ; n; --n, p += step )
+          {
+            const uint64_t w0 = *reinterpret_cast<const uint64_t*>(p);
+            const uint64_t w1 = *reinterpret_cast<const uint64_t*>(p + sizeof(uint64_t));
+            a += (w0 & 0xFFFFFFFF) + (w0 >> 32);
+            b += (w1 & 0xFFFFFFFF) + (w1 >> 32);
+          }
+          acc = fold_sum(acc) + fold_sum(a) + fold_sum(b);
+        }
+        for ( ; size >= sizeof(uint16_t); size -= sizeof(uint16_t), p += sizeof(uint16_t) )
+          acc += *reinterpret_cast<const uint16_t*>(p);
+        if ( size )
+          acc += *p;
+        return static_cast<uint32_t>(fold_sum(acc));
+      }
+
+      /**
+       *	@brief Computes the checksum of the PE file as CheckSumMappedFile does
+       *  @param[in] file the raw file contents
+       *  @param[in] size the file size
+       *  @return the value for the OptionalHeader.CheckSum field; the stored CheckSum
+       *          is excluded from the sum, so the result may be compared with it directly.
+       **/
+      static uint32_t checksum(const void * file, size_t size)
+      {
+        uint32_t sum = checksum_partial(file, size);
+        if ( const uint32_t * const stored = checksum_field(file, size) )
+          sum = checksum_subtract(sum, *stored);
+        return static_cast<uint32_t>(size) + sum;
+      }
+
       uint32_t checksum() const
       {
         const dos_header * const dh = get_dos_header();
         if ( !dh->is_valid() ) return 0;
         const nt_headers * const nth = get_nt_headers();
-        uint32_t sum32 = 0;
-        for ( const uint16_t * p = va<uint16_t*>(0);
-          p < va<uint16_t*>(nth->OptionalHeader32.SizeOfImage); // < care about odd SizeOfImage
-          ++p )
-        {
-          sum32 += *p;
-          sum32 = (sum32 >> 16) + static_cast<uint16_t>(sum32);
-        }
-        uint16_t sum = static_cast<uint16_t>((sum32 >> 16) + sum32);
-        sum = sum - ( sum < static_cast<uint16_t>(nth->OptionalHeader32.CheckSum) );
-        sum = sum - static_cast<uint16_t>(nth->OptionalHeader32.CheckSum);
-        sum = sum - ( sum < static_cast<uint16_t>(nth->OptionalHeader32.CheckSum >> 16) );
-        sum = sum - static_cast<uint16_t>(nth->OptionalHeader32.CheckSum >> 16);
-        return nth->OptionalHeader32.SizeOfImage + sum;
+        // SizeOfImage and CheckSum have the same offsets in both optional headers
+        const uint32_t size = nth->OptionalHeader32.SizeOfImage;
+        return size + checksum_subtract(checksum_partial(this, size), nth->OptionalHeader32.CheckSum);
       }
 
       uint32_t checksum(bool update)
@@ -1070,33 +1111,97 @@ next_entry:;
 
       bool relocate()
       {
-        return relocate(uintptr_t(this) //-V104
-                            - get_nt_headers()->optional_header32()->ImageBase);
+        const nt_headers * const nth = get_nt_headers();
+        const uintptr_t image_base = nth->optional_header64()
+          ? static_cast<uintptr_t>(nth->optional_header64()->ImageBase)
+          : nth->optional_header32()->ImageBase;
+        return relocate(uintptr_t(this) - image_base); //-V104
       }
 
       bool relocate(ptrdiff_t delta)
+      {
+        return relocate(delta, 0, 1);
+      }
+
+      /**
+       *	@brief Applies every \p parts-th relocation block starting from the \p part one
+       *
+       *  Each block fixes up its own page, so the disjoint parts 0..parts-1 of the same image
+       *  may be relocated concurrently, one part per thread.
+       *  @return \c false if the image has no relocations or contains unsupported (skipped) fixups
+       **/
+      bool relocate(ptrdiff_t delta, size_t part, size_t parts)
       {
         const data_directory * const reloc_dir =
           get_data_directory(data_directory::basereloc_table);
-        if ( ! reloc_dir || ! reloc_dir->VirtualAddress ) return false;
+        if ( ! reloc_dir || ! reloc_dir->VirtualAddress || ! parts ) return false;
         const base_relocation * fixups = va<base_relocation*>(reloc_dir->VirtualAddress); //-V106
         const uintptr_t end = va(reloc_dir->VirtualAddress + reloc_dir->Size); //-V106
-        while ( reinterpret_cast<uintptr_t>(fixups) < end )
+        bool ok = true;
+        for ( size_t n = 0; reinterpret_cast<uintptr_t>(fixups) < end && fixups->SizeOfBlock; ++n )
+        {
+          const base_relocation::entry_t * const last = reinterpret_cast<const base_relocation::entry_t*>(
+            reinterpret_cast<uintptr_t>(fixups) + fixups->SizeOfBlock); //-V104
+          if ( n % parts == part )
+            ok &= relocate_block(va(fixups->VirtualAddress), &fixups->entry[0], last, delta); //-V106
+          fixups = reinterpret_cast<const base_relocation*>(last);
+        }
+        return ok;
+      }
+
+      /**
+       *	@brief Applies the fixups [entry, last) to the page at \p page
+       *
+       *  A block is usually a long run of \c highlow or \c dir64 entries padded by an \c absolute one,
+       *  so each run is handled by its own tight loop instead of dispatching on every entry.
+       **/
+      static bool relocate_block(uintptr_t page, const base_relocation::entry_t * entry,
+                                 const base_relocation::entry_t * const last, ptrdiff_t delta)
+      {
+        while ( entry < last )
         {
-          const uintptr_t addr = va(fixups->VirtualAddress); //-V106
-          const uintptr_t end = fixups->SizeOfBlock //-V104
-            + reinterpret_cast<uintptr_t>(fixups);
-          const base_relocation::entry_t * entry = &fixups->entry[0];
-          for ( ; reinterpret_cast<uintptr_t>(entry) < end; ++entry )
-            switch ( entry->Type )
+          switch ( entry->Type )
           {
-            case base_relocation::type32::highlow:
-              *reinterpret_cast<uint32_t*>(addr + entry->Offset) += static_cast<uint32_t>(delta);
-              break;
-            default:
-              break;
+          case base_relocation::absolute:
+            do ++entry; while ( entry < last && entry->Type == base_relocation::absolute );
+            break;
+          case base_relocation::highlow:
+            do {
+              *reinterpret_cast<uint32_t*>(page + entry->Offset) += static_cast<uint32_t>(delta);
+              ++entry;
+            } while ( entry < last && entry->Type == base_relocation::highlow );
+            break;
+          case base_relocation::dir64:
+            do {
+              *reinterpret_cast<uint64_t*>(page + entry->Offset) += static_cast<uint64_t>(static_cast<int64_t>(delta));
+              ++entry;
+            } while ( entry < last && entry->Type == base_relocation::dir64 );
+            break;
+          case base_relocation::high:
+            *reinterpret_cast<uint16_t*>(page + entry->Offset) += static_cast<uint16_t>(static_cast<uintptr_t>(delta) >> 16);
+            ++entry;
+            break;
+          case base_relocation::low:
+            *reinterpret_cast<uint16_t*>(page + entry->Offset) += static_cast<uint16_t>(delta);
+            ++entry;
+            break;
+          case base_relocation::highadj:
+            {
+              // the next slot is the parameter: the low half of the target, not an entry
+              if ( entry + 1 >= last )
+                return false;
+              uint16_t * const target = reinterpret_cast<uint16_t*>(page + entry->Offset);
+              const int16_t low = *reinterpret_cast<const int16_t*>(entry + 1);
+              const uint32_t value = (static_cast<uint32_t>(*target) << 16) + static_cast<int32_t>(low)
+                                     + static_cast<uint32_t>(delta) + 0x8000;
+              *target = static_cast<uint16_t>(value >> 16);
+              entry += 2;
+            }
+            break;
+          default:
+            // the size of an unknown entry is unknown as well, the rest of the block can not be decoded
+            return false;
           }
-          fixups = reinterpret_cast<const base_relocation*>(entry);
         }
         return true;
       }
@@ -1286,6 +1391,38 @@ next_entry:;
       ///////////////////////////////////////////////////////////////////////////
     private:
 
+      static uint64_t fold_sum(uint64_t sum)
+      {
+        while ( sum >> 16 )
+          sum = (sum & 0xFFFF) + (sum >> 16);
+        return sum;
+      }
+
+      /** one's complement subtraction of both halves of the stored checksum */
+      static uint32_t checksum_subtract(uint32_t sum32, uint32_t stored)
+      {
+        uint16_t sum = static_cast<uint16_t>(sum32);
+        sum = sum - ( sum < static_cast<uint16_t>(stored) );
+        sum = sum - static_cast<uint16_t>(stored);
+        sum = sum - ( sum < static_cast<uint16_t>(stored >> 16) );
+        sum = sum - static_cast<uint16_t>(stored >> 16);
+        return sum;
+      }
+
+      static const uint32_t * checksum_field(const void * file, size_t size)
+      {
+        if ( size < sizeof(dos_header) ) return 0;
+        const dos_header * const dh = static_cast<const dos_header*>(file);
+        if ( !dh->is_valid() || dh->e_lfanew < 0 ) return 0;
+        const uint8_t * const nt = static_cast<const uint8_t*>(file) + dh->e_lfanew;
+        const size_t offset = static_cast<size_t>(dh->e_lfanew)
+          + sizeof(uint32_t) + sizeof(file_header) + offsetof(optional_header32, CheckSum);
+        if ( offset >= size || size - offset < sizeof(uint32_t)
+          || !reinterpret_cast<const nt_headers*>(nt)->is_valid() )
+          return 0;
+        return reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(file) + offset);
+      }
+
     };// class image
 
     extern "C" image  __ImageBase;
@@ -11,6 +11,7 @@
 #include "cstddef.hxx"
 #include "stdexcept.hxx"
 #include "stdstring.hxx"
+#include "ext/bitops.hxx"
 #ifndef NTL__STLX_IOSFWD
 #include "iosfwd.hxx"    // for ios
 #endif
@@ -136,22 +137,19 @@ namespace std {
     /// @name bitset operations [20.5.2]
     bitset<N>& operator&=(const bitset<N>& rhs)
     {
-      for(unsigned i = 0; i < elements_count_; ++i)
-        storage_[i] &= ~rhs.storage_[i];
+      ext::bitops::assign_and(storage_, rhs.storage_, elements_count_);
       return *this;
     }
 
     bitset<N>& operator|=(const bitset<N>& rhs)
     {
-      for(unsigned i = 0; i < elements_count_; ++i)
-        storage_[i] |= rhs.storage_[i];
+      ext::bitops::assign_or(storage_, rhs.storage_, elements_count_);
       return *this;
     }
 
     bitset<N>& operator^=(const bitset<N>& rhs)
     {
-      for(unsigned i = 0; i < elements_count_; ++i)
-        storage_[i] ^= rhs.storage_[i];
+      ext::bitops::assign_xor(storage_, rhs.storage_, elements_count_);
       return *this;
     }
 
@@ -159,24 +157,7 @@ namespace std {
     {
       if(pos >= N)
         return reset();
-      else if(pos == 0)
-        return *this; // nothing to do
-      else if(pos >= element_size_){
-        large_shift_left(pos);
-        return *this;
-      }
-
-      storage_type preval = 0, curval = 0;
-      for(unsigned i = 0; i < elements_count_; ++i){
-        // save shifted bits
-        curval = storage_[i] >> (element_size_ - pos);
-        // shift
-        storage_[i] <<= pos;
-        // restore previous bits
-        storage_[i] |= preval;
-        preval = curval;
-      }
-
+      ext::bitops::shift_left(storage_, elements_count_, pos);
       // cut garbage bits
       storage_[elements_count_-1] &= digits_mod_;
       return *this;
@@ -184,32 +165,16 @@ namespace std {
 
     bitset<N>& operator>>=(size_t pos)
     {
-      if(pos > N)
+      if(pos >= N)
         return reset();
-      else if(pos == 0)
-        return *this; // nothing to do
-      else if(pos >= element_size_){
-        large_shift_right(pos);
-        return *this;
-      }
-
-      storage_type xval = 0, yval = 0;
-      for(int i = elements_count_-1; i >= 0; --i){
-        // save shifted bits
-        yval = storage_[i] & ((native_one_ << pos) - 1);
-        // shift
-        storage_[i] >>= pos;
-        // restore previous bits
-        storage_[i] |= xval << (element_size_ - pos);
-        xval = yval;
-      }
+      ext::bitops::shift_right(storage_, elements_count_, pos);
       return *this;
     }
 
     bitset<N>& set()
     {
-      for(unsigned i = 0; i < elements_count_; ++i)
-        storage_[i] = set_bits_;
+      ext::bitops::fill(storage_, elements_count_, set_bits_);
+      storage_[elements_count_-1] &= digits_mod_;
       return *this;
     }
 
@@ -218,16 +183,15 @@ namespace std {
       check_bounds(pos);
       storage_type xval = storage_[pos / element_size_];
       const size_t mod = pos & element_mod_;
-      xval &= ~(1 << mod);
-      xval |= (val << mod);
+      xval &= ~(static_cast<storage_type>(native_one_) << mod);
+      xval |= (static_cast<storage_type>(val) << mod);
       storage_[pos / element_size_] = xval;
       return *this;
     }
 
     bitset<N>& reset()
     {
-      for(unsigned i = 0; i < elements_count_; ++i)
-        storage_[i] = 0;
+      ext::bitops::fill(storage_, elements_count_, 0);
       return *this;
     }
 
@@ -236,7 +200,7 @@ namespace std {
       check_bounds(pos);
       storage_type val = storage_[pos / element_size_];
       const size_t mod = pos & element_mod_;
-      val &= ~(1 << mod);
+      val &= ~(static_cast<storage_type>(native_one_) << mod);
       storage_[pos / element_size_] = val;
       return *this;
     }
@@ -248,8 +212,8 @@ namespace std {
 
     bitset<N>& flip() __ntl_nothrow
     {
-      for(unsigned i = 0; i < elements_count_; ++i)
-        storage_[i] = ~storage_[i];
+      ext::bitops::flip(storage_, elements_count_);
+      storage_[elements_count_-1] &= digits_mod_;
       return *this;
     }
 
@@ -303,14 +267,7 @@ namespace std {
 
     size_t count() const
     {
-      static const char table[] = "\0\1\1\2\1\2\2\3\1\2\2\3\2\3\3\4";
-      unsigned count_ = 0;
-      for(storage_type j = storage_[elements_count_-1] & digits_mod_; j; j >>= 4)
-        count_ += table[j & 0xF];
-      for(ssize_t i = elements_count_-2; i >= 0; --i)
-        for(storage_type j = storage_[i]; j; j >>= 4)
-          count_ += table[j & 0xF];
-      return count_;
+      return ext::bitops::count(storage_, elements_count_);
     }
 
     constexpr size_t size() const { return N; }
@@ -329,18 +286,29 @@ namespace std {
     {
       check_bounds(pos);
       const storage_type val = storage_[pos / element_size_];
-      return (val & static_cast<storage_type>(1 << (pos & element_mod_)) ) != 0;
+      return (val & (static_cast<storage_type>(native_one_) << (pos & element_mod_)) ) != 0;
     }
 
     bool none() const { return !any(); }
     bool all()  const { return count() == size(); }
     bool any()  const
     {
-      for(uint32_t i = 0; i < elements_count_; i++)
-        if(storage_[i])
-          return true;
-      return false;
+      return ext::bitops::any(storage_, elements_count_);
+    }
+
+    ///\name Set bits iteration (extension)
+    /** Position of the first set bit or size() if there is none */
+    size_t _Find_first() const
+    {
+      return min(ext::bitops::find_next(storage_, elements_count_, 0), N);
+    }
+
+    /** Position of the first set bit after \p prev or size() if there is none */
+    size_t _Find_next(size_t prev) const
+    {
+      return prev + 1 >= N ? N : min(ext::bitops::find_next(storage_, elements_count_, prev + 1), N);
     }
+    ///\}
 
     bitset<N> operator<<(size_t pos) const
     {
@@ -391,56 +359,8 @@ namespace std {
       return str;
     }
 
-    void large_shift_left(size_t pos)
-    {
-      const size_t shift = pos % element_size_;
-      const unsigned lookup = static_cast<unsigned>(pos / element_size_);
-      if(shift == 0){
-        // shift by words, fastest pass
-        for(unsigned i = elements_count_-1; i >= lookup; --i)
-          storage_[i] = storage_[i-lookup];
-        for(int i = lookup-1; i >= 0; --i)
-          storage_[i] = 0;
-      }else{
-        // shift by bits
-        for(unsigned i = elements_count_-1; i > lookup; --i){
-          storage_[i]  = storage_[i-lookup] << shift;
-          storage_[i] |= storage_[i-lookup-1] >> (element_size_-shift);
-        }
-        storage_[lookup] = storage_[0] << shift;
-        // clear remaining bits
-        for(int i = lookup-1; i >= 0; --i)
-          storage_[i] = 0;
-      }
-      // cut garbage bits
-      storage_[elements_count_-1] &= digits_mod_;
-    }
-
-    void large_shift_right(size_t pos)
-    {
-      const size_t shift = pos % element_size_;
-      const unsigned lookup = static_cast<unsigned>(pos / element_size_);
-      if(shift == 0){
-        // shift by words, fastest pass
-        for(unsigned i = 0; i < elements_count_-lookup; ++i)
-          storage_[i] = storage_[i+lookup];
-        for(unsigned i = elements_count_-lookup; i < elements_count_; ++i)
-          storage_[i] = 0;
-      }else{
-        // shift by bits
-        for(unsigned i = 0; i < elements_count_-lookup-1; ++i){
-          storage_[i]  = storage_[i+lookup] >> shift;
-          storage_[i] |= storage_[i+lookup+1] << (element_size_-shift);
-        }
-        storage_[elements_count_-lookup-1] = storage_[elements_count_-1] >> shift;
-        // clear remaining bits
-        for(unsigned i = elements_count_-lookup; i < elements_count_; ++i)
-          storage_[i] = 0;
-      }
-    }
-
   private:
-    typedef uintptr_t storage_type; // native platform type
+    typedef ext::bitops::word_type storage_type; // native platform type
 
     enum { digits = N };
     enum { element_size_ = sizeof(storage_type) * 8 }; // bits count
@@ -464,8 +384,11 @@ namespace std {
     {
       static const uint64_t make_tidy()
       {
+        // the value fits entirely if the bitset is not shorter
+        if(size >= 64)
+          return ~uint64_t(0);
         uint64_t value = 1;
-        value <<= size;
+        value <<= size % 64;
         return --value;
       }
     };
@@ -478,19 +401,19 @@ namespace std {
   template <size_t N>
   bitset<N> operator&(const bitset<N>& lhs, const bitset<N>& rhs)
   {
-    return lhs &= rhs;
+    return bitset<N>(lhs) &= rhs;
   }
 
   template <size_t N>
   bitset<N> operator|(const bitset<N>& lhs, const bitset<N>& rhs)
   {
-    return lhs |= rhs;
+    return bitset<N>(lhs) |= rhs;
   }
 
   template <size_t N>
   bitset<N> operator^(const bitset<N>& lhs, const bitset<N>& rhs)
   {
-    return lhs ^= rhs;
+    return bitset<N>(lhs) ^= rhs;
   }
 
   template <class charT, class traits, size_t N>
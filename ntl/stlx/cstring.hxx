@@ -216,14 +216,22 @@ strncmp(const char * s1, const char * s2, size_t n)
 size_t NTL_CRTCALL strxfrm(char * __restrict s1, const char * __restrict s2, size_t n);
 
 ///\name Search functions
-__forceinline
+inline
 const void * NTL_CRTCALL memchr(const void * const mem, const int c, size_t n)
 {
   assert(mem || n == 0);
   const unsigned char * p = reinterpret_cast<const unsigned char*>(mem);
-  while ( n-- )
-    if ( static_cast<unsigned char>(c) != *p ) ++p;
-    else return p;
+  const unsigned char ch = static_cast<unsigned char>(c);
+  for ( ; n && (reinterpret_cast<size_t>(p) & (sizeof(size_t) - 1)); --n, ++p )
+    if ( ch == *p ) return p;
+  // skip the words which have no such byte: (x - 0x01..) & ~x & 0x80.. is nonzero if x has a zero byte
+  const size_t ones = ~size_t(0) / 0xFF, pattern = ones * ch;
+  for ( ; n >= sizeof(size_t); n -= sizeof(size_t), p += sizeof(size_t) ) {
+    const size_t x = *reinterpret_cast<const size_t*>(p) ^ pattern;
+    if ( (x - ones) & ~x & (ones << 7) ) break;
+  }
+  for ( ; n; --n, ++p )
+    if ( ch == *p ) return p;
   return 0;
 }
 
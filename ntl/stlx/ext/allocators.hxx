@@ -0,0 +1,624 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Arena, pool and caching allocators for the standard containers
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_ALLOCATORS
+#define NTL__EXT_ALLOCATORS
+#pragma once
+
+#include "../memory.hxx"      // for allocator
+
+namespace std
+{
+  namespace ext
+  {
+    /**\addtogroup  lib_memory
+     *@{*/
+
+    namespace __
+    {
+      /** Alignment of the blocks returned by operator new (MEMORY_ALLOCATION_ALIGNMENT) */
+      static const size_t allocation_alignment = sizeof(void*) * 2;
+
+      inline size_t align_up(size_t n, size_t align)
+      {
+        return (n + align - 1) & ~(align - 1);
+      }
+
+      template<class T>
+      inline size_t bytes_for(size_t n)
+      {
+        if(n > size_t(-1) / sizeof(T))
+          __ntl_throw(bad_alloc());
+        return n * sizeof(T);
+      }
+    }
+
+    /**
+     *	@brief Monotonic memory arena
+     *
+     *  Hands out memory by bumping a pointer inside the current chunk and takes new chunks from
+     *  \c operator new (each twice as large as the previous one) when it runs out of space.
+     *  Individual deallocations are ignored except for the most recent block; all memory
+     *  is returned at once by release() or by the destructor, which makes it suitable
+     *  for the per-request scratch containers which are thrown away as a whole.
+     *
+     *  The arena may start from a caller-provided buffer (e.g. on the stack), which is reused
+     *  after every release() and never freed by the arena.
+     *
+     *  @note The arena is not synchronized.
+     **/
+    class monotonic_arena
+    {
+    public:
+      static const size_t default_chunk_size = 4096 - __::allocation_alignment * 2;
+      static const size_t max_chunk_size = 1024 * 1024;
+
+      explicit monotonic_arena(size_t chunk_size = default_chunk_size)
+        :chunks(), cur(), end(), buffer(), buffer_size(), initial_chunk(chunk_size), next_chunk(chunk_size), used()
+      {}
+
+      monotonic_arena(void* buffer, size_t size, size_t chunk_size = default_chunk_size)
+        :chunks(), cur(static_cast<char*>(buffer)), end(static_cast<char*>(buffer) + size),
+        buffer(buffer), buffer_size(size), initial_chunk(chunk_size), next_chunk(chunk_size), used()
+      {}
+
+      ~monotonic_arena()
+      {
+        release();
+      }
+
+      /** Allocates \p size bytes aligned to \p align (must be a power of two) */
+      __noalias
+      void* allocate(size_t size, size_t align = __::allocation_alignment) __ntl_throws(bad_alloc)
+      {
+        char* p = reinterpret_cast<char*>(__::align_up(reinterpret_cast<uintptr_t>(cur), align));
+        if(p > end || size > size_t(end - p)){
+          grow(size + align);
+          p = reinterpret_cast<char*>(__::align_up(reinterpret_cast<uintptr_t>(cur), align));
+        }
+        cur = p + size;
+        used += size;
+        return p;
+      }
+
+      /** Reclaims the block only if it was the last one allocated */
+      void deallocate(void* p, size_t size) __ntl_nothrow
+      {
+        if(static_cast<char*>(p) + size == cur)
+          cur = static_cast<char*>(p);
+        used -= size;
+      }
+
+      /** Frees all chunks at once; the memory allocated from the arena becomes invalid */
+      void release() __ntl_nothrow
+      {
+        while(chunks){
+          chunk* const prev = chunks->prev;
+          ::operator delete(chunks);
+          chunks = prev;
+        }
+        cur = static_cast<char*>(buffer);
+        end = cur + buffer_size;
+        next_chunk = initial_chunk;
+        used = 0;
+      }
+
+      /** Bytes handed out and not yet deallocated */
+      size_t allocated() const { return used; }
+
+      friend bool operator==(const monotonic_arena& x, const monotonic_arena& y) { return &x == &y; }
+      friend bool operator!=(const monotonic_arena& x, const monotonic_arena& y) { return &x != &y; }
+
+    private:
+      struct chunk
+      {
+        chunk* prev;
+        size_t size;
+      };
+
+      void grow(size_t request)
+      {
+        size_t size = next_chunk;
+        if(size < request)
+          size = request;
+        const size_t header = __::align_up(sizeof(chunk), __::allocation_alignment);
+        if(size > size_t(-1) - header)
+          __ntl_throw(bad_alloc());
+        chunk* const c = static_cast<chunk*>(::operator new(header + size));
+        c->prev = chunks;
+        c->size = size;
+        chunks = c;
+        cur = reinterpret_cast<char*>(c) + header;
+        end = cur + size;
+        if(next_chunk < max_chunk_size)
+          next_chunk *= 2;
+      }
+
+      monotonic_arena(const monotonic_arena&) __deleted;
+      monotonic_arena& operator=(const monotonic_arena&) __deleted;
+
+      chunk*  chunks;
+      char*   cur, *end;
+      void*   buffer;
+      size_t  buffer_size, initial_chunk, next_chunk, used;
+    };
+
+
+    /**
+     *	@brief Pool of fixed-size blocks for the node-based containers
+     *
+     *  Requests up to max_block_size bytes are rounded up to the allocation granularity and served
+     *  from per-size free lists, which are refilled by carving the blocks from large chunks.
+     *  Since a container rebinds its allocator to the node type, each container ends up using
+     *  one or two size classes and gets O(1) allocation and deallocation without touching the heap.
+     *  Bigger requests (e.g. bucket arrays) go to \c operator new and are tracked as well, so
+     *  release() frees everything the pool ever handed out.
+     *
+     *  @note The pool is not synchronized.
+     **/
+    class node_pool
+    {
+    public:
+      static const size_t granularity = __::allocation_alignment;
+      static const size_t max_block_size = 256;
+      static const size_t default_chunk_size = 16 * 1024 - granularity * 2;
+
+      /** The \p chunk_size less than max_block_size (0, say) is taken as max_block_size, a chunk holds any block */
+      explicit node_pool(size_t chunk_size = default_chunk_size)
+        :chunks(), large(), cur(), end(), chunk_size(chunk_size < max_block_size ? max_block_size : chunk_size)
+      {
+        for(size_t i = 0; i < classes; ++i)
+          free_lists[i] = 0;
+      }
+
+      ~node_pool()
+      {
+        release();
+      }
+
+      __noalias
+      void* allocate(size_t size) __ntl_throws(bad_alloc)
+      {
+        if(size > max_block_size)
+          return allocate_large(size);
+        const size_t index = size_class(size);
+        if(free_block* const p = free_lists[index]){
+          free_lists[index] = p->next;
+          return p;
+        }
+        const size_t block = (index + 1) * granularity;
+        if(size_t(end - cur) < block)
+          grow();
+        void* const p = cur;
+        cur += block;
+        return p;
+      }
+
+      void deallocate(void* p, size_t size) __ntl_nothrow
+      {
+        if(!p)
+          return;
+        if(size > max_block_size)
+          return deallocate_large(p);
+        const size_t index = size_class(size);
+        free_block* const b = static_cast<free_block*>(p);
+        b->next = free_lists[index];
+        free_lists[index] = b;
+      }
+
+      /** Frees all memory at once; the memory allocated from the pool becomes invalid */
+      void release() __ntl_nothrow
+      {
+        while(chunks){
+          chunk* const prev = chunks->prev;
+          ::operator delete(chunks);
+          chunks = prev;
+        }
+        while(large){
+          chunk* const next = large->prev;
+          ::operator delete(large);
+          large = next;
+        }
+        for(size_t i = 0; i < classes; ++i)
+          free_lists[i] = 0;
+        cur = end = 0;
+      }
+
+      friend bool operator==(const node_pool& x, const node_pool& y) { return &x == &y; }
+      friend bool operator!=(const node_pool& x, const node_pool& y) { return &x != &y; }
+
+    private:
+      static const size_t classes = max_block_size / granularity;
+
+      struct free_block
+      {
+        free_block* next;
+      };
+      static_assert(granularity >= sizeof(free_block) && max_block_size % granularity == 0, "a block must hold the free list link");
+
+      // chunk header; large blocks are kept in a doubly-linked list to be unlinked on deallocation
+      struct chunk
+      {
+        chunk* prev;
+        chunk* next;
+      };
+
+      static size_t header_size() { return __::align_up(sizeof(chunk), granularity); }
+
+      static size_t size_class(size_t size)
+      {
+        return size ? (size - 1) / granularity : 0;
+      }
+
+      void grow()
+      {
+        if(chunk_size > size_t(-1) - header_size())
+          __ntl_throw(bad_alloc());
+        chunk* const c = static_cast<chunk*>(::operator new(header_size() + chunk_size));
+        c->prev = chunks;
+        c->next = 0;
+        chunks = c;
+        cur = reinterpret_cast<char*>(c) + header_size();
+        end = cur + chunk_size;
+      }
+
+      void* allocate_large(size_t size)
+      {
+        if(size > size_t(-1) - header_size())
+          __ntl_throw(bad_alloc());
+        chunk* const c = static_cast<chunk*>(::operator new(header_size() + size));
+        // `large` is linked through `prev` towards older blocks and through `next` back to the head
+        c->prev = large;
+        c->next = 0;
+        if(large)
+          large->next = c;
+        large = c;
+        return reinterpret_cast<char*>(c) + header_size();
+      }
+
+      void deallocate_large(void* p)
+      {
+        chunk* const c = reinterpret_cast<chunk*>(static_cast<char*>(p) - header_size());
+        if(c->prev)
+          c->prev->next = c->next;
+        if(c->next)
+          c->next->prev = c->prev;
+        else
+          large = c->prev;
+        ::operator delete(c);
+      }
+
+      node_pool(const node_pool&) __deleted;
+      node_pool& operator=(const node_pool&) __deleted;
+
+      free_block* free_lists[classes];
+      chunk*      chunks, *large;
+      char*       cur, *end;
+      size_t      chunk_size;
+    };
+
+
+    /**
+     *	@brief Cache of recently freed blocks owned by a single thread
+     *
+     *  Keeps up to \c max_cached freed blocks of every size class and reuses them for the next
+     *  allocations of that class, so short-lived containers do not reach the (serialized) process heap.
+     *  Every block is allocated individually from \c operator new with its size rounded to the class,
+     *  therefore a block may be freed through any cache, or through \c operator delete after trim().
+     *
+     *  @note A cache must only be used by one thread at a time.
+     **/
+    class thread_cache
+    {
+    public:
+      static const size_t granularity = __::allocation_alignment;
+      static const size_t max_block_size = 256;
+      static const size_t max_cached = 64;
+
+      thread_cache()
+      {
+        for(size_t i = 0; i < classes; ++i)
+          free_lists[i] = 0, counts[i] = 0;
+      }
+
+      ~thread_cache()
+      {
+        trim();
+      }
+
+#ifdef NTL_CXX_THREADL
+      /** The cache of the calling thread */
+      static thread_cache& current()
+      {
+        static thread_local thread_cache cache;
+        return cache;
+      }
+#endif
+
+      __noalias
+      void* allocate(size_t size) __ntl_throws(bad_alloc)
+      {
+        if(size > max_block_size)
+          return ::operator new(size);
+        const size_t index = size_class(size);
+        if(free_block* const p = free_lists[index]){
+          free_lists[index] = p->next;
+          --counts[index];
+          return p;
+        }
+        return ::operator new((index + 1) * granularity);
+      }
+
+      void deallocate(void* p, size_t size) __ntl_nothrow
+      {
+        if(!p)
+          return;
+        const size_t index = size_class(size);
+        if(size > max_block_size || counts[index] == max_cached)
+          return ::operator delete(p);
+        free_block* const b = static_cast<free_block*>(p);
+        b->next = free_lists[index];
+        free_lists[index] = b;
+        ++counts[index];
+      }
+
+      /** Returns all cached blocks to the heap */
+      void trim() __ntl_nothrow
+      {
+        for(size_t i = 0; i < classes; ++i){
+          while(free_block* const p = free_lists[i]){
+            free_lists[i] = p->next;
+            ::operator delete(p);
+          }
+          counts[i] = 0;
+        }
+      }
+
+    private:
+      static const size_t classes = max_block_size / granularity;
+
+      struct free_block
+      {
+        free_block* next;
+      };
+      static_assert(granularity >= sizeof(free_block) && max_block_size % granularity == 0, "a block must hold the free list link");
+
+      static size_t size_class(size_t size)
+      {
+        return size ? (size - 1) / granularity : 0;
+      }
+
+      thread_cache(const thread_cache&) __deleted;
+      thread_cache& operator=(const thread_cache&) __deleted;
+
+      free_block* free_lists[classes];
+      size_t      counts[classes];
+    };
+
+
+    namespace __
+    {
+      /**
+       *	Common part of the allocators bound to a memory resource:
+       *  everything but allocate/deallocate comes from std::allocator.
+       **/
+      template<class T, class Resource, template<class> class Derived>
+      class resource_allocator:
+        public allocator<T>
+      {
+      public:
+        typedef typename allocator<T>::size_type size_type;
+        typedef typename allocator<T>::pointer   pointer;
+        typedef Resource                         resource_type;
+
+        explicit resource_allocator(Resource& r) __ntl_nothrow
+          :r(&r)
+        {}
+
+        /** The resource the memory comes from */
+        Resource* resource() const { return r; }
+
+        template<class U>
+        friend bool operator==(const Derived<T>& x, const Derived<U>& y) __ntl_nothrow
+        {
+          return *x.resource() == *y.resource();
+        }
+
+        template<class U>
+        friend bool operator!=(const Derived<T>& x, const Derived<U>& y) __ntl_nothrow
+        {
+          return !(x == y);
+        }
+
+      protected:
+        Resource* r;
+      };
+    }
+
+    /**
+     *	@brief Allocator which takes memory from the monotonic_arena
+     *  @note Deallocation is a no-op; the memory is returned by monotonic_arena::release().
+     **/
+    template<class T>
+    class arena_allocator:
+      public __::resource_allocator<T, monotonic_arena, arena_allocator>
+    {
+      typedef __::resource_allocator<T, monotonic_arena, arena_allocator> base;
+    public:
+      typedef typename base::size_type  size_type;
+      typedef typename base::pointer    pointer;
+      template<class U> struct rebind { typedef arena_allocator<U> other; };
+
+      explicit arena_allocator(monotonic_arena& arena) __ntl_nothrow
+        :base(arena)
+      {}
+
+      template<class U>
+      arena_allocator(const arena_allocator<U>& x) __ntl_nothrow
+        :base(*x.resource())
+      {}
+
+      __noalias
+      pointer allocate(size_type n, allocator<void>::const_pointer = 0) __ntl_throws(bad_alloc)
+      {
+        return static_cast<pointer>(this->r->allocate(__::bytes_for<T>(n), alignof(T) > sizeof(void*) ? alignof(T) : sizeof(void*)));
+      }
+
+      void deallocate(pointer p, size_type n) __ntl_nothrow
+      {
+        this->r->deallocate(p, n * sizeof(T));
+      }
+    };
+
+    /**
+     *	@brief Allocator which takes memory from the node_pool
+     *  @details Intended for \c list, \c map, \c set and the unordered containers.
+     **/
+    template<class T>
+    class pool_allocator:
+      public __::resource_allocator<T, node_pool, pool_allocator>
+    {
+      typedef __::resource_allocator<T, node_pool, pool_allocator> base;
+    public:
+      typedef typename base::size_type  size_type;
+      typedef typename base::pointer    pointer;
+      template<class U> struct rebind { typedef pool_allocator<U> other; };
+
+      explicit pool_allocator(node_pool& pool) __ntl_nothrow
+        :base(pool)
+      {}
+
+      template<class U>
+      pool_allocator(const pool_allocator<U>& x) __ntl_nothrow
+        :base(*x.resource())
+      {}
+
+      __noalias
+      pointer allocate(size_type n, allocator<void>::const_pointer = 0) __ntl_throws(bad_alloc)
+      {
+        return static_cast<pointer>(this->r->allocate(__::bytes_for<T>(n)));
+      }
+
+      void deallocate(pointer p, size_type n) __ntl_nothrow
+      {
+        this->r->deallocate(p, n * sizeof(T));
+      }
+    };
+
+    /**
+     *	@brief Allocator which reuses the blocks cached by a thread_cache
+     *  @details Without an explicit cache it binds to thread_cache::current() (where \c thread_local is supported).
+     **/
+    template<class T>
+    class cached_allocator:
+      public __::resource_allocator<T, thread_cache, cached_allocator>
+    {
+      typedef __::resource_allocator<T, thread_cache, cached_allocator> base;
+    public:
+      typedef typename base::size_type  size_type;
+      typedef typename base::pointer    pointer;
+      template<class U> struct rebind { typedef cached_allocator<U> other; };
+
+#ifdef NTL_CXX_THREADL
+      cached_allocator() __ntl_nothrow
+        :base(thread_cache::current())
+      {}
+#endif
+
+      explicit cached_allocator(thread_cache& cache) __ntl_nothrow
+        :base(cache)
+      {}
+
+      template<class U>
+      cached_allocator(const cached_allocator<U>& x) __ntl_nothrow
+        :base(*x.resource())
+      {}
+
+      __noalias
+      pointer allocate(size_type n, allocator<void>::const_pointer = 0) __ntl_throws(bad_alloc)
+      {
+        return static_cast<pointer>(this->r->allocate(__::bytes_for<T>(n)));
+      }
+
+      void deallocate(pointer p, size_type n) __ntl_nothrow
+      {
+        this->r->deallocate(p, n * sizeof(T));
+      }
+    };
+
+    /**
+     *	@brief Allocator which routes the single-object allocations to a lookaside list
+     *
+     *  The \c Lookaside is either km::npaged_lookaside_list or its user-mode counterpart nt::lookaside_list
+     *  (usually created with the cell size of the container node, i.e. \c sizeof(Container::node_type) or larger).
+     *  Allocations of one object which fit into the cell are served by the list, everything else (e.g. the
+     *  bucket arrays of the unordered containers) comes directly from the backing pool of the list.
+     *  The list statistics show how effective the caching is.
+     **/
+    template<class T, class Lookaside>
+    class lookaside_allocator:
+      public allocator<T>
+    {
+    public:
+      typedef typename allocator<T>::size_type  size_type;
+      typedef typename allocator<T>::pointer    pointer;
+      typedef Lookaside                         lookaside_type;
+      template<class U> struct rebind { typedef lookaside_allocator<U, Lookaside> other; };
+
+      explicit lookaside_allocator(Lookaside& list) __ntl_nothrow
+        :list(&list)
+      {}
+
+      template<class U>
+      lookaside_allocator(const lookaside_allocator<U, Lookaside>& x) __ntl_nothrow
+        :list(x.lookaside())
+      {}
+
+      __noalias
+      pointer allocate(size_type n, allocator<void>::const_pointer = 0) __ntl_throws(bad_alloc)
+      {
+        void* p = fits(n) ? list->allocate() : list->allocate_block(__::bytes_for<T>(n));
+        if(!p)
+          __ntl_throw(bad_alloc());
+        return static_cast<pointer>(p);
+      }
+
+      void deallocate(pointer p, size_type n) __ntl_nothrow
+      {
+        if(fits(n))
+          list->free(p);
+        else
+          list->free_block(p);
+      }
+
+      Lookaside* lookaside() const { return list; }
+
+      template<class U>
+      friend bool operator==(const lookaside_allocator& x, const lookaside_allocator<U, Lookaside>& y) __ntl_nothrow
+      {
+        return x.lookaside() == y.lookaside();
+      }
+
+      template<class U>
+      friend bool operator!=(const lookaside_allocator& x, const lookaside_allocator<U, Lookaside>& y) __ntl_nothrow
+      {
+        return !(x == y);
+      }
+
+    private:
+      bool fits(size_type n) const
+      {
+        return n == 1 && sizeof(T) <= list->cell_size();
+      }
+
+      Lookaside* list;
+    };
+
+    /**@} lib_memory */
+  } // ext
+} // std
+
+#endif // NTL__EXT_ALLOCATORS
@@ -0,0 +1,251 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Bit operations over the arrays of words
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_BITOPS
+#define NTL__EXT_BITOPS
+#pragma once
+
+#include "../cstdint.hxx"
+
+#if defined(_MSC_VER) && (defined(__AVX__) || defined(__POPCNT__))
+// the processors with AVX have the popcnt instruction, the older ones may lack it
+# define NTL__EXT_BITOPS_POPCNT
+#endif
+
+#ifdef _MSC_VER
+namespace ntl {
+  namespace intrinsic {
+    extern "C" unsigned char __cdecl _BitScanForward(unsigned long* index, unsigned long mask);
+    #pragma intrinsic(_BitScanForward)
+  #ifdef _M_X64
+    extern "C" unsigned char __cdecl _BitScanForward64(unsigned long* index, unsigned long long mask);
+    #pragma intrinsic(_BitScanForward64)
+  #endif
+  #ifdef NTL__EXT_BITOPS_POPCNT
+    extern "C" unsigned int __cdecl __popcnt(unsigned int value);
+    #pragma intrinsic(__popcnt)
+    #ifdef _M_X64
+    extern "C" unsigned long long __cdecl __popcnt64(unsigned long long value);
+    #pragma intrinsic(__popcnt64)
+    #endif
+  #endif
+  }
+}
+#endif
+
+namespace std
+{
+  namespace ext
+  {
+    /**
+     *	@brief Kernels of the bitset classes
+     *
+     *  The bits are kept in the array of the machine words, the bit \c i is the bit <tt>i % word_bits</tt>
+     *  of the word <tt>i / word_bits</tt>. The kernels do not know the size in bits, so the callers
+     *  keep the unused bits of the last word zero.
+     **/
+    namespace bitops
+    {
+      typedef uintptr_t word_type;
+      static const size_t word_bits = sizeof(word_type) * 8;
+
+      namespace __
+      {
+        inline unsigned popcount32(uint32_t x)
+        {
+        #ifdef NTL__EXT_BITOPS_POPCNT
+          return ntl::intrinsic::__popcnt(x);
+        #elif defined(__GNUC__) || defined(__clang__)
+          return static_cast<unsigned>(__builtin_popcount(x));
+        #else
+          x -= (x >> 1) & 0x55555555;
+          x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+          x = (x + (x >> 4)) & 0x0F0F0F0F;
+          return (x * 0x01010101) >> 24;
+        #endif
+        }
+
+        inline unsigned popcount64(uint64_t x)
+        {
+        #if defined(NTL__EXT_BITOPS_POPCNT) && defined(_M_X64)
+          return static_cast<unsigned>(ntl::intrinsic::__popcnt64(x));
+        #elif defined(__GNUC__) || defined(__clang__)
+          return static_cast<unsigned>(__builtin_popcountll(x));
+        #elif defined(_M_X64)
+          x -= (x >> 1) & 0x5555555555555555ull;
+          x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+          x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+          return static_cast<unsigned>((x * 0x0101010101010101ull) >> 56);
+        #else
+          return popcount32(static_cast<uint32_t>(x)) + popcount32(static_cast<uint32_t>(x >> 32));
+        #endif
+        }
+
+        inline unsigned countr_zero32(uint32_t x)
+        {
+        #ifdef _MSC_VER
+          unsigned long index;
+          ntl::intrinsic::_BitScanForward(&index, x);
+          return index;
+        #elif defined(__GNUC__) || defined(__clang__)
+          return static_cast<unsigned>(__builtin_ctz(x));
+        #else
+          unsigned n = 0;
+          for(; !(x & 1); x >>= 1)
+            ++n;
+          return n;
+        #endif
+        }
+
+        inline unsigned countr_zero64(uint64_t x)
+        {
+        #if defined(_MSC_VER) && defined(_M_X64)
+          unsigned long index;
+          ntl::intrinsic::_BitScanForward64(&index, x);
+          return index;
+        #elif defined(__GNUC__) || defined(__clang__)
+          return static_cast<unsigned>(__builtin_ctzll(x));
+        #else
+          const uint32_t low = static_cast<uint32_t>(x);
+          return low ? countr_zero32(low) : 32 + countr_zero32(static_cast<uint32_t>(x >> 32));
+        #endif
+        }
+      } // __
+
+      /** Number of the set bits of \p x */
+      template<typename T>
+      inline unsigned popcount(T x)
+      {
+        return sizeof(T) > sizeof(uint32_t) ? __::popcount64(x) : __::popcount32(static_cast<uint32_t>(x));
+      }
+
+      /** Index of the lowest set bit of the nonzero \p x */
+      template<typename T>
+      inline unsigned countr_zero(T x)
+      {
+        return sizeof(T) > sizeof(uint32_t) ? __::countr_zero64(x) : __::countr_zero32(static_cast<uint32_t>(x));
+      }
+
+      /** Number of the words holding \p bits */
+      inline size_t words(size_t bits)
+      {
+        return bits / word_bits + (bits % word_bits ? 1 : 0);
+      }
+
+      /** Mask of the used bits of the last word of the \p bits long set */
+      inline word_type tail_mask(size_t bits)
+      {
+        return bits % word_bits ? (word_type(1) << (bits % word_bits)) - 1 : ~word_type(0);
+      }
+
+      inline size_t count(const word_type* w, size_t n)
+      {
+        size_t c = 0;
+        for(size_t i = 0; i != n; ++i)
+          c += popcount(w[i]);
+        return c;
+      }
+
+      inline bool any(const word_type* w, size_t n)
+      {
+        for(size_t i = 0; i != n; ++i)
+          if(w[i])
+            return true;
+        return false;
+      }
+
+      /** Index of the first set bit at or after \p pos, <tt>n * word_bits</tt> if there is none */
+      inline size_t find_next(const word_type* w, size_t n, size_t pos)
+      {
+        size_t i = pos / word_bits;
+        if(i >= n)
+          return n * word_bits;
+        word_type x = w[i] & (~word_type(0) << (pos % word_bits));
+        for(;;){
+          if(x)
+            return i * word_bits + countr_zero(x);
+          if(++i == n)
+            return n * word_bits;
+          x = w[i];
+        }
+      }
+
+      ///\name The word-parallel operations, the plain loops are vectorized by the compiler
+      inline void fill(word_type* w, size_t n, word_type value)
+      {
+        for(size_t i = 0; i != n; ++i)
+          w[i] = value;
+      }
+
+      inline void assign_and(word_type* w, const word_type* x, size_t n)
+      {
+        for(size_t i = 0; i != n; ++i)
+          w[i] &= x[i];
+      }
+
+      inline void assign_or(word_type* w, const word_type* x, size_t n)
+      {
+        for(size_t i = 0; i != n; ++i)
+          w[i] |= x[i];
+      }
+
+      inline void assign_xor(word_type* w, const word_type* x, size_t n)
+      {
+        for(size_t i = 0; i != n; ++i)
+          w[i] ^= x[i];
+      }
+
+      inline void flip(word_type* w, size_t n)
+      {
+        for(size_t i = 0; i != n; ++i)
+          w[i] = ~w[i];
+      }
+
+      /** Shifts the bits to the higher positions, the bits shifted out of the last word are lost */
+      inline void shift_left(word_type* w, size_t n, size_t pos)
+      {
+        const size_t skip = pos / word_bits, shift = pos % word_bits;
+        if(skip >= n){
+          fill(w, n, 0);
+          return;
+        }
+        if(shift == 0){
+          for(size_t i = n - 1; i != skip - 1; --i)
+            w[i] = w[i - skip];
+        }else{
+          for(size_t i = n - 1; i != skip; --i)
+            w[i] = (w[i - skip] << shift) | (w[i - skip - 1] >> (word_bits - shift));
+          w[skip] = w[0] << shift;
+        }
+        fill(w, skip, 0);
+      }
+
+      /** Shifts the bits to the lower positions */
+      inline void shift_right(word_type* w, size_t n, size_t pos)
+      {
+        const size_t skip = pos / word_bits, shift = pos % word_bits;
+        if(skip >= n){
+          fill(w, n, 0);
+          return;
+        }
+        const size_t last = n - skip - 1;
+        if(shift == 0){
+          for(size_t i = 0; i <= last; ++i)
+            w[i] = w[i + skip];
+        }else{
+          for(size_t i = 0; i != last; ++i)
+            w[i] = (w[i + skip] >> shift) | (w[i + skip + 1] << (word_bits - shift));
+          w[last] = w[n - 1] >> shift;
+        }
+        fill(w + last + 1, skip, 0);
+      }
+      ///\}
+
+    } // bitops
+  } // ext
+} // std
+
+#endif // NTL__EXT_BITOPS
@@ -0,0 +1,386 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Sources of the nondeterministic random numbers
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_ENTROPY
+#define NTL__EXT_ENTROPY
+#pragma once
+
+#include "../cstdint.hxx"
+#include "../cstring.hxx"
+#include "../stdexcept.hxx"
+#include "../../cpu.hxx"
+
+#ifndef NTL_SUBSYSTEM_KM
+# include "../../nt/file.hxx"
+# include "../../nt/ioctl.hxx"
+#endif
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+# define NTL__EXT_ENTROPY_X86
+#endif
+
+#if defined(NTL_CXX_THREADL) && !defined(NTL_SUBSYSTEM_KM)
+// the drivers have no thread local storage
+# define NTL__EXT_ENTROPY_TLS
+#endif
+
+#if defined(_MSC_VER) && defined(NTL__EXT_ENTROPY_X86)
+namespace ntl {
+  namespace intrinsic {
+    extern "C" void __cdecl __cpuidex(int info[4], int function, int subfunction);
+    #pragma intrinsic(__cpuidex)
+    // the random instructions are always the intrinsics
+    extern "C" int __cdecl _rdrand32_step(unsigned int* value);
+    extern "C" int __cdecl _rdseed32_step(unsigned int* value);
+  }
+}
+#endif
+
+namespace std
+{
+  namespace ext
+  {
+    /**
+     *	@brief Nondeterministic random numbers of std::random_device
+     *
+     *  There are two kinds of the sources: the processor instructions RDRAND and RDSEED (where cpuid reports them)
+     *  and the system one, which is the KsecDD device in the user mode (the provider of the RtlGenRandom) and
+     *  may be replaced by set_os_source(). Both need some hundred cycles or a system call per value, so the most
+     *  of the values are taken from the ChaCha20 generator of the calling thread which is seeded and reseeded by them.
+     **/
+    namespace entropy
+    {
+      namespace __
+      {
+      #ifdef NTL__EXT_ENTROPY_X86
+        inline void cpuid(uint32_t function, uint32_t subfunction, uint32_t (&r)[4])
+        {
+        #ifdef _MSC_VER
+          ntl::intrinsic::__cpuidex(reinterpret_cast<int*>(r), function, subfunction);
+        #else
+          __asm__ __volatile__("cpuid" : "=a"(r[0]), "=b"(r[1]), "=c"(r[2]), "=d"(r[3]) : "a"(function), "c"(subfunction));
+        #endif
+        }
+
+        inline bool rdrand_step(uint32_t& value)
+        {
+        #ifdef _MSC_VER
+          return ntl::intrinsic::_rdrand32_step(&value) != 0;
+        #else
+          unsigned char ok;
+          __asm__ __volatile__("rdrand %0; setc %1" : "=r"(value), "=qm"(ok) : : "cc");
+          return ok != 0;
+        #endif
+        }
+
+        inline bool rdseed_step(uint32_t& value)
+        {
+        #ifdef _MSC_VER
+          return ntl::intrinsic::_rdseed32_step(&value) != 0;
+        #else
+          unsigned char ok;
+          __asm__ __volatile__("rdseed %0; setc %1" : "=r"(value), "=qm"(ok) : : "cc");
+          return ok != 0;
+        #endif
+        }
+      #endif
+
+        inline uint32_t rotl32(uint32_t x, unsigned k)
+        {
+          return (x << k) | (x >> (32 - k));
+        }
+
+        template<size_t Lanes>
+        inline void quarter_round(uint32_t (&x)[16][Lanes], size_t a, size_t b, size_t c, size_t d)
+        {
+          for(size_t l = 0; l != Lanes; ++l){
+            x[a][l] += x[b][l]; x[d][l] = rotl32(x[d][l] ^ x[a][l], 16);
+            x[c][l] += x[d][l]; x[b][l] = rotl32(x[b][l] ^ x[c][l], 12);
+            x[a][l] += x[b][l]; x[d][l] = rotl32(x[d][l] ^ x[a][l], 8);
+            x[c][l] += x[d][l]; x[b][l] = rotl32(x[b][l] ^ x[c][l], 7);
+          }
+        }
+
+        /**
+         *	@brief The ChaCha20 blocks \p counter ... \p counter + \p Lanes - 1 [Bernstein]
+         *
+         *  The words 12, 13 of the input are the 64-bit block counter and the words 14, 15 are the \p nonce.
+         *  The blocks are computed side by side (a lane per block), so the compiler is able to vectorize the rounds.
+         **/
+        template<size_t Lanes>
+        inline void chacha20_blocks(const uint32_t (&key)[8], uint64_t counter, uint64_t nonce, uint32_t* out)
+        {
+          uint32_t in[16][Lanes], x[16][Lanes];
+          for(size_t l = 0; l != Lanes; ++l){
+            in[0][l] = 0x61707865; in[1][l] = 0x3320646E; in[2][l] = 0x79622D32; in[3][l] = 0x6B206574;
+            for(size_t i = 0; i != 8; ++i)
+              in[4 + i][l] = key[i];
+            const uint64_t block = counter + l;
+            in[12][l] = static_cast<uint32_t>(block);
+            in[13][l] = static_cast<uint32_t>(block >> 32);
+            in[14][l] = static_cast<uint32_t>(nonce);
+            in[15][l] = static_cast<uint32_t>(nonce >> 32);
+          }
+          std::memcpy(x, in, sizeof(x));
+          for(int round = 0; round != 10; ++round){
+            quarter_round(x, 0, 4,  8, 12);
+            quarter_round(x, 1, 5,  9, 13);
+            quarter_round(x, 2, 6, 10, 14);
+            quarter_round(x, 3, 7, 11, 15);
+            quarter_round(x, 0, 5, 10, 15);
+            quarter_round(x, 1, 6, 11, 12);
+            quarter_round(x, 2, 7,  8, 13);
+            quarter_round(x, 3, 4,  9, 14);
+          }
+          for(size_t l = 0; l != Lanes; ++l)
+            for(size_t i = 0; i != 16; ++i)
+              out[l * 16 + i] = x[i][l] + in[i][l];
+        }
+
+        /** Clears the secrets so that the compiler does not drop the stores */
+        inline void wipe(void* p, size_t size)
+        {
+          volatile uint8_t* v = static_cast<volatile uint8_t*>(p);
+          while(size--)
+            *v++ = 0;
+        }
+
+        inline bool system_random(void* buf, size_t size)
+        {
+        #ifndef NTL_SUBSYSTEM_KM
+          using namespace ntl::nt;
+          typedef ntl::nt::ioctl::ioctl<file_device::ksec, 2, ntl::nt::ioctl::method::buffered, ntl::nt::ioctl::file_any_access> ksec_random_fill;
+          const const_unicode_string name(L"\\Device\\KsecDD");
+          file_handler ksec;
+          if(!success(ksec.open(object_attributes(name), file_handler::access_mask_default, file_handler::share_valid_flags)))
+            return false;
+          io_status_block iosb;
+          const ntstatus st = NtDeviceIoControlFile(ksec.get(), legacy_handle(), nullptr, nullptr, &iosb,
+            ksec_random_fill::code, nullptr, 0, buf, static_cast<uint32_t>(size));
+          return success(st) && iosb.Information == size;
+        #else
+          // no documented source, the driver installs its own one
+          (void)buf, (void)size;
+          return false;
+        #endif
+        }
+      } // __
+
+      /** The random instructions of the processor */
+      struct processor
+      {
+        bool rdrand, rdseed;
+
+        /** The features of this processor, the concurrent first calls detect them twice and harmlessly */
+        static const processor& features()
+        {
+          static const processor p;
+          return p;
+        }
+
+      private:
+        processor()
+          :rdrand(false), rdseed(false)
+        {
+        #ifdef NTL__EXT_ENTROPY_X86
+          uint32_t r[4];
+          __::cpuid(0, 0, r);
+          const uint32_t max_function = r[0];
+          if(max_function >= 1){
+            __::cpuid(1, 0, r);
+            rdrand = (r[2] >> 30) & 1;
+          }
+          if(max_function >= 7){
+            __::cpuid(7, 0, r);
+            rdseed = (r[1] >> 18) & 1;
+          }
+          // some processors return the same value (all ones) and report the success after the resume
+          uint32_t a = 0, b = 0;
+          if(rdrand && (!__::rdrand_step(a) || !__::rdrand_step(b) || a == b))
+            rdrand = false;
+          if(rdseed && (!__::rdseed_step(a) || !__::rdseed_step(b) || a == b))
+            rdseed = false;
+        #endif
+        }
+      };
+
+      /** Fills \p n words by RDRAND, false if the processor has no RDRAND or it fails repeatedly */
+      inline bool rdrand(uint32_t* p, size_t n)
+      {
+      #ifdef NTL__EXT_ENTROPY_X86
+        if(!processor::features().rdrand)
+          return false;
+        for(; n; --n, ++p){
+          // the failure is the exhausted generator, it is refilled in a moment
+          int retries = 10;
+          while(!__::rdrand_step(*p))
+            if(!--retries)
+              return false;
+        }
+        return true;
+      #else
+        (void)p, (void)n;
+        return false;
+      #endif
+      }
+
+      /** Fills \p n words by RDSEED, false if the processor has no RDSEED or it fails repeatedly */
+      inline bool rdseed(uint32_t* p, size_t n)
+      {
+      #ifdef NTL__EXT_ENTROPY_X86
+        if(!processor::features().rdseed)
+          return false;
+        for(; n; --n, ++p){
+          // the seed generator is much slower than RDRAND and fails often under the load
+          int retries = 100;
+          while(!__::rdseed_step(*p)){
+            if(!--retries)
+              return false;
+            ntl::cpu::pause();
+          }
+        }
+        return true;
+      #else
+        (void)p, (void)n;
+        return false;
+      #endif
+      }
+
+      /** Fills \p n words by the processor: RDSEED if it is there, RDRAND otherwise */
+      inline bool hardware_random(uint32_t* p, size_t n)
+      {
+        return rdseed(p, n) || rdrand(p, n);
+      }
+
+      /** The system source of the random bytes, returns false if it has failed */
+      typedef bool os_source_t(void* buf, size_t size);
+
+      namespace __
+      {
+        inline os_source_t*& os_source()
+        {
+          static os_source_t* source = system_random;
+          return source;
+        }
+      }
+
+      /** Replaces the system source (by the \c /dev/urandom reader, say), returns the previous one */
+      inline os_source_t* set_os_source(os_source_t* source)
+      {
+        os_source_t* const prev = __::os_source();
+        __::os_source() = source ? source : __::system_random;
+        return prev;
+      }
+
+      /** Fills \p size bytes by the system source */
+      inline bool os_random(void* buf, size_t size)
+      {
+        return __::os_source()(buf, size);
+      }
+
+      /**
+       *	@brief ChaCha20 generator with the fast key erasure
+       *
+       *  Every refill ciphers the buffer of blocks by the current key and takes the first 32 bytes of the output
+       *  as the next key, the returned values are erased from the buffer. So the state reveals neither the past
+       *  nor the values given before the refill. The key is seeded at the first refill and mixed with the fresh
+       *  entropy every \c reseed_interval bytes; both the system and the processor sources are used, a failure
+       *  of one of them is tolerated.
+       *
+       *  @note The generator is not synchronized, it is intended to be thread local.
+       **/
+      class chacha20_random
+      {
+        static const size_t lanes = 4, block_words = 16, key_words = 8;
+        static const size_t buffer_words = lanes * block_words * 4;
+      public:
+        typedef uint32_t result_type;
+        static const size_t reseed_interval = 1024 * 1024;
+
+        chacha20_random()
+          :pos(buffer_words), refills(0), seeded(false)
+        {
+          std::memset(key, 0, sizeof(key));
+        }
+
+        ~chacha20_random()
+        {
+          __::wipe(key, sizeof(key));
+          __::wipe(buf, sizeof(buf));
+        }
+
+        result_type operator()() __ntl_throws(runtime_error)
+        {
+          if(pos == buffer_words)
+            refill();
+          const result_type r = buf[pos];
+          buf[pos++] = 0;
+          return r;
+        }
+
+        template<class OutputIterator>
+        void generate(OutputIterator first, OutputIterator last) __ntl_throws(runtime_error)
+        {
+          for(; first != last; ++first){
+            if(pos == buffer_words)
+              refill();
+            *first = buf[pos];
+            buf[pos++] = 0;
+          }
+        }
+
+        /** Mixes the fresh entropy to the key, returns false if no source has given it */
+        bool reseed()
+        {
+          uint32_t fresh[key_words], hw[key_words];
+          bool got = os_random(fresh, sizeof(fresh));
+          if(!got)
+            std::memset(fresh, 0, sizeof(fresh));
+          if(hardware_random(hw, key_words)){
+            for(size_t i = 0; i != key_words; ++i)
+              fresh[i] ^= hw[i];
+            got = true;
+          }
+          if(got){
+            for(size_t i = 0; i != key_words; ++i)
+              key[i] ^= fresh[i];
+            seeded = true;
+            pos = buffer_words;
+          }
+          __::wipe(fresh, sizeof(fresh));
+          __::wipe(hw, sizeof(hw));
+          return got;
+        }
+
+      private:
+        void refill() __ntl_throws(runtime_error)
+        {
+          if(refills % (reseed_interval / sizeof(buf)) == 0 && !reseed() && !seeded)
+            __ntl_throw(runtime_error("no source of entropy"));
+          ++refills;
+          for(size_t i = 0; i != buffer_words; i += lanes * block_words)
+            __::chacha20_blocks<lanes>(key, i / block_words, 0, buf + i);
+          std::memcpy(key, buf, sizeof(key));
+          std::memset(buf, 0, sizeof(key));
+          pos = key_words;
+        }
+
+      private:
+        uint32_t key[key_words];
+        uint32_t buf[buffer_words];
+        size_t pos;
+        size_t refills;
+        bool seeded;
+
+        chacha20_random(const chacha20_random&) __deleted;
+        void operator=(const chacha20_random&) __deleted;
+      };
+
+    } // entropy
+  } // ext
+} // std
+
+#endif // NTL__EXT_ENTROPY
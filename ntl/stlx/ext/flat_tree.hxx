@@ -0,0 +1,142 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Sorted sequence helpers for the flat_map and flat_set
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_FLAT_TREE
+#define NTL__EXT_FLAT_TREE
+#pragma once
+
+#include "../iterator.hxx"
+#include "../vector.hxx"
+#include "../functional.hxx"
+
+namespace std
+{
+  /**\addtogroup  lib_containers
+   *@{*/
+
+  /// The range is sorted by the key and has no equivalent keys
+  struct sorted_unique_t {/**/};
+  /// The range is sorted by the key
+  struct sorted_equivalent_t {/**/};
+#ifdef NTL_CXX_CONSTEXPR
+  constexpr sorted_unique_t sorted_unique = sorted_unique_t();
+  constexpr sorted_equivalent_t sorted_equivalent = sorted_equivalent_t();
+#else
+  extern __declspec(selectany) const sorted_unique_t sorted_unique = {};
+  extern __declspec(selectany) const sorted_equivalent_t sorted_equivalent = {};
+#endif
+
+  /**@} lib_containers */
+
+  namespace ext
+  {
+    namespace flat
+    {
+      /**
+       *	@brief Index of the first of the \p n sorted keys which is not less than \p k
+       *
+       *  The branchless binary search: every step halves the range by the conditional move,
+       *  so the lookup costs log2(n) compares without the mispredicted branches.
+       **/
+      template<class RandomAccessIterator, class K, class Compare>
+      inline size_t lower_bound(RandomAccessIterator keys, size_t n, const K& k, const Compare& comp)
+      {
+        if(!n)
+          return 0;
+        size_t base = 0;
+        while(n > 1){
+          const size_t half = n / 2;
+          base = comp(keys[base + half - 1], k) ? base + half : base;
+          n -= half;
+        }
+        return base + (comp(keys[base], k) ? 1 : 0);
+      }
+
+      /** Index of the first of the \p n sorted keys which is greater than \p k */
+      template<class RandomAccessIterator, class K, class Compare>
+      inline size_t upper_bound(RandomAccessIterator keys, size_t n, const K& k, const Compare& comp)
+      {
+        if(!n)
+          return 0;
+        size_t base = 0;
+        while(n > 1){
+          const size_t half = n / 2;
+          base = comp(k, keys[base + half - 1]) ? base : base + half;
+          n -= half;
+        }
+        return base + (comp(k, keys[base]) ? 0 : 1);
+      }
+
+      namespace __
+      {
+        template<class T, class Compare>
+        struct indirect_compare
+        {
+          const Compare& comp;
+          explicit indirect_compare(const Compare& comp) : comp(comp) {}
+          bool operator()(const T* x, const T* y) const { return comp(*x, *y); }
+        private:
+          indirect_compare& operator=(const indirect_compare&) __deleted;
+        };
+
+        /** Stable merge sort of the pointers, \p buf holds the half of the range */
+        template<class T, class Compare>
+        void merge_sort(T** first, T** last, T** buf, const Compare& comp)
+        {
+          const ptrdiff_t n = last - first;
+          if(n <= 16){
+            for(T** i = first + 1; i < last; ++i){
+              T* const x = *i;
+              T** j = i;
+              for(; j != first && comp(x, *(j - 1)); --j)
+                *j = *(j - 1);
+              *j = x;
+            }
+            return;
+          }
+          T** const mid = first + n / 2;
+          merge_sort(first, mid, buf, comp);
+          merge_sort(mid, last, buf, comp);
+          if(!comp(*mid, *(mid - 1)))
+            return;
+
+          // the left half goes to the buffer, the equal elements are taken from it first
+          T** const buf_end = std::copy(first, mid, buf);
+          T** l = buf, **r = mid, **out = first;
+          while(l != buf_end && r != last)
+            *out++ = comp(*r, *l) ? *r++ : *l++;
+          std::copy(l, buf_end, out);
+        }
+      }
+
+      /**
+       *	@brief Sorts the elements stably
+       *
+       *  The pointers are sorted instead of the elements, so the element is moved once whatever its size is.
+       **/
+      template<class T, class Allocator, class Compare>
+      void stable_sort(std::vector<T, Allocator>& v, const Compare& comp)
+      {
+        const size_t n = v.size();
+        if(n < 2)
+          return;
+        std::vector<T*> order(n), buf(n / 2 + 1);
+        for(size_t i = 0; i < n; i++)
+          order[i] = &v[i];
+        __::merge_sort(&order[0], &order[0] + n, &buf[0], __::indirect_compare<T, Compare>(comp));
+
+        std::vector<T, Allocator> sorted(v.get_allocator());
+        sorted.reserve(n);
+        for(size_t i = 0; i < n; i++)
+          sorted.push_back(std::move(*order[i]));
+        v.swap(sorted);
+      }
+
+    } // flat
+  } // ext
+} // std
+
+#endif // NTL__EXT_FLAT_TREE
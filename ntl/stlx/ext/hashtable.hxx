@@ -6,6 +6,7 @@
 #include "../functional.hxx"  // for hash & predicates
 #include "../utility.hxx"     // for pair
 #include "../algorithm.hxx"   // for swap<>
+#include "node_handle.hxx"
 
 namespace std
 {
@@ -121,6 +122,7 @@ namespace std
           void link(double_linked* next)
           {
             next->next = this->next; next->prev = this;
+            if(this->next) this->next->prev = next;
             this->next = next;
           }
 
@@ -523,52 +525,131 @@ namespace std
           assert(buckets_.first && n < static_cast<size_type>(buckets_.second-buckets_.first));
           bucket_type& b = buckets_.first[n];
 
-          if(is_unique::value && b.elems){
+          if(is_unique::value){
             // allow only unique keys
-            if(b.hash == hkey || b.dirty){
-              for(const node_type* p = b.elems; p; p = p->next)
-                if(p->hkey == hkey && equal_(value2key(p->elem, is_map()), value2key(v, is_map())))
-                  return std::make_pair(iterator(const_cast<node_type*>(p), &b, buckets_.second), false);
-            }
+            if(node_type* p = find_equal(b, hkey, value2key(v, is_map())))
+              return std::make_pair(iterator(p, &b, buckets_.second), false);
           }
           // construct node(value, hash)
           node* p = nalloc.allocate(1);
           nalloc.construct(p, v, hkey);
+          (void)hint;
+          return std::make_pair(link_node(p), true);
+        }
+
+        /** Looks for the key in the bucket, the dirty bucket keeps the nodes of the different hashes */
+        node_type* find_equal(const bucket_type& b, hash_t hkey, const key_type& k) const
+        {
+          if(b.elems && (b.hash == hkey || b.dirty)){
+            for(node_type* p = b.elems; p; p = p->next)
+              if(p->hkey == hkey && equal_(value2key(p->elem, is_map()), k))
+                return p;
+          }
+          return nullptr;
+        }
+
+        /** Links the detached node to the bucket of its hash */
+        iterator link_node(node_type* p)
+        {
+          const hash_t hkey = p->hkey;
+          bucket_type& b = buckets_.first[mapkey(hkey)];
 
           //       ,    ,   ?  ?.
           //     
 
-          if(hint.p && hint.p->hkey == hkey){
-            // link with the hint
-            //const_cast<node_type*>(hint.p)->link(p);
-            hint = hint;
-          }
-          //}else{
-          {
-            if(b.elems){
-              const bool to_end = b.hash != hkey; //     
-              if(!to_end)
-                b.elems->link_prev(p);            //     
-              else{
-                node_type* n = b.elems; 
-                while(n->next && n->hkey == hkey)
-                  n = n->next;
-                n->link(p);
-                b.dirty = true;
-              }
-            }else{
-              // construct bucket
+          if(b.elems){
+            const bool to_end = b.hash != hkey; //     
+            if(!to_end){
+              b.elems->link_prev(p);            //     
               b.elems = p;
-              b.hash = hkey;
-              if(count_ == 0 || head_ > &b)
-                head_ = &b;
+            }else{
+              node_type* n = b.elems; 
+              while(n->next && n->hkey == hkey)
+                n = n->next;
+              n->link(p);
+              b.dirty = true;
             }
-            b.size++;
+          }else{
+            // construct bucket
+            b.elems = p;
+            b.hash = hkey;
+            if(count_ == 0 || head_ > &b)
+              head_ = &b;
           }
+          b.size++;
           count_++;
-          return std::make_pair(iterator(p, &b, buckets_.second), true);
+          return iterator(p, &b, buckets_.second);
         }
 
+        /** Detaches the node from its bucket and moves the \p position to the following element */
+        node_type* unlink(const_iterator& position)
+        {
+          node_type* const p = position.p;
+          node_type* const next = p->next;
+          bucket_type* const b = position.b;
+          if(b->elems == p){
+            b->elems = next;
+            if(next)
+              b->hash = next->hkey; // keeps dirty: the rest of bucket may have other hashes
+          }
+          if(!--b->size)
+            b->dirty = false;
+          p->unlink();
+          p->prev = p->next = nullptr;
+          --count_;
+
+          position.p = next;
+          if(!next){
+            // find next nonempty bucket
+            bucket_type* nb = b;
+            while(++nb != buckets_.second && !nb->elems);
+            position.b = nb;
+            position.p = nb != buckets_.second ? nb->elems : nullptr;
+          }
+          if(head_ == b && !b->elems)
+            head_ = position.p ? position.b : nullptr;
+          return p;
+        }
+
+#ifdef NTL_CXX_RV
+        template<class Handle>
+        Handle extract_node(const_iterator position)
+        {
+          return node_handle_access::make<Handle>(unlink(position), nalloc);
+        }
+
+        template<class Handle>
+        std::pair<iterator, bool> insert_node(Handle& h)
+        {
+          node_type* const p = node_handle_access::get(h);
+          // the key could be changed while the node was extracted
+          p->hkey = hash_(value2key(p->elem, is_map()));
+          if(is_unique::value){
+            bucket_type& b = buckets_.first[mapkey(p->hkey)];
+            if(node_type* dup = find_equal(b, p->hkey, value2key(p->elem, is_map())))
+              return std::make_pair(iterator(dup, &b, buckets_.second), false);
+          }
+          node_handle_access::release(h);
+          return std::make_pair(link_node(p), true);
+        }
+
+        /** Relinks the nodes of the \p source which keys are absent here */
+        void merge_unique(hashtable& source)
+        {
+          for(const_iterator i = source.cbegin(); i != source.cend(); ){
+            const key_type& k = value2key(i.p->elem, is_map());
+            const hash_t hkey = hash_(k);
+            if(find_equal(buckets_.first[mapkey(hkey)], hkey, k)){
+              ++i;
+              continue;
+            }
+            node_type* const p = source.unlink(i);
+            p->hkey = hkey;
+            link_node(p);
+          }
+        }
+#endif
+
     public:
         template <class InputIterator>
         void insert(InputIterator first, InputIterator last)
@@ -581,36 +662,10 @@ namespace std
         {
           if(!position.p)
             return end();
-          node_type* next = position.p->next;
-          if(position.b->elems == position.p){
-            bucket_type* b = position.b;
-            const bool head = head_ == b;
-            b->elems = next;
-            if(!--b->size || (b->dirty && b->hash != next->hkey)){
-              b->dirty = false;
-              if(next)
-                b->hash = next->hkey;
-            }
-            if(!next || head){
-              // find next nonempty bucket for head
-              b = buckets_.first;
-              while(b != buckets_.second && !b->elems) ++b;
-              if(b != buckets_.second){
-                if(head)
-                  head_ = b;
-                position.b = b;
-                next = b->elems;
-              }else if(head)
-                head_ = nullptr;
-            }
-          }else{
-            --position.b->size;
-          }
-          --count_;
-          position.p->unlink();
-          nalloc.destroy(position.p);
-          nalloc.deallocate(position.p,1);
-          return iterator(next, position.b, position.be);
+          node_type* const p = unlink(position);
+          nalloc.destroy(p);
+          nalloc.deallocate(p,1);
+          return iterator(position.p, position.b, buckets_.second);
         }
 
         size_type erase(const key_type& k)
@@ -796,24 +851,16 @@ namespace std
           // swap it with old
           std::swap(buckets, buckets_);
           head_ = nullptr;
-          count_ = 0; // increased by following inserts
-          copy_from(buckets);
-
-          // destroy old buckets
-          b = buckets.first;
-          while(b != buckets.second){
-            if(!b->elems || b->size == 0){
-              b++;
-              continue;
-            }
-            node* p = b->elems;
-            while(b->size--){
-              node* d = p;
-              p = p->next;
-              nalloc.deallocate(d, 1);
+          count_ = 0; // increased by following links
+
+          // relink the nodes to the new buckets, the elements stay in place
+          for(b = buckets.first; b != buckets.second; ++b){
+            for(node_type* p = b->elems; p; ){
+              node_type* const next = p->next;
+              p->prev = p->next = nullptr;
+              link_node(p);
+              p = next;
             }
-            b->elems = nullptr;
-            b++;
           }
           balloc.deallocate(buckets.first, buckets.second-buckets.first);
         }
@@ -913,4 +960,4 @@ namespace std
   }
 }
 
-#endif // NTL__EXT_HASHTABLE
\ No newline at end of file
+#endif // NTL__EXT_HASHTABLE
\ No newline at end of file
@@ -51,29 +51,35 @@ namespace std
     }
   };
 
-  /** Stream-based formatter for iterators */
-  template <class InputIterator>
-  inline std::string join(InputIterator first, InputIterator last, const std::string_ref& sep)
+  namespace __
   {
-    std::ostringstream o;
+    /** The strings are joined without the stream if the values are the strings */
+    template <class InputIterator>
+    struct join_strings:
+      integral_constant<bool, is_convertible<typename iterator_traits<InputIterator>::value_type, string_ref>::value>
+    {};
 
-    if(first != last) {
-      o << *first;
-      ++first;
-    }
-    while(first != last) {
-      o << sep;
-      o << *first;
-      ++first;
+    /** The exact length of the result is known if the strings can be walked twice */
+    template <class InputIterator>
+    struct join_sized:
+      integral_constant<bool, join_strings<InputIterator>::value &&
+        is_base_of<forward_iterator_tag, typename iterator_traits<InputIterator>::iterator_category>::value>
+    {};
+
+    template <class InputIterator>
+    inline size_t join_length(InputIterator, InputIterator, size_t, false_type)
+    {
+      return 128;
     }
-    return o.str();
-  }
 
-  /** Stream-based formatter for container */
-  template <class Range>
-  inline std::string join(const Range& range, const std::string_ref& sep)
-  {
-    return join(std::begin(range), std::end(range), sep);
+    template <class ForwardIterator>
+    inline size_t join_length(ForwardIterator first, ForwardIterator last, size_t sep, true_type)
+    {
+      size_t n = 0, count = 0;
+      for(; first != last; ++first, ++count)
+        n += string_ref(*first).length();
+      return count ? n + sep * (count - 1) : 0;
+    }
   }
 
   // Range and Formatter
@@ -81,7 +87,7 @@ namespace std
   inline std::string sjoin(InputIterator first, InputIterator last, const std::string_ref& sep, Formatter format)
   {
     std::string o;
-    o.reserve(128);
+    o.reserve(__::join_length(first, last, sep.size(), __::join_sized<InputIterator>()));
 
     if(first != last) {
       format(o, *first);
@@ -95,12 +101,51 @@ namespace std
     return std::move(o);
   }
 
+  namespace __
+  {
+    template <class InputIterator>
+    inline std::string join(InputIterator first, InputIterator last, const std::string_ref& sep, true_type)
+    {
+      return sjoin(first, last, sep, join_formatter());
+    }
+
+    template <class InputIterator>
+    inline std::string join(InputIterator first, InputIterator last, const std::string_ref& sep, false_type)
+    {
+      std::ostringstream o;
+
+      if(first != last) {
+        o << *first;
+        ++first;
+      }
+      while(first != last) {
+        o << sep;
+        o << *first;
+        ++first;
+      }
+      return o.str();
+    }
+  }
+
+  /** Stream-based formatter for iterators, the strings are joined to the single allocation instead */
+  template <class InputIterator>
+  inline std::string join(InputIterator first, InputIterator last, const std::string_ref& sep)
+  {
+    return __::join(first, last, sep, __::join_strings<InputIterator>());
+  }
+
+  /** Stream-based formatter for container */
+  template <class Range>
+  inline std::string join(const Range& range, const std::string_ref& sep)
+  {
+    return join(std::begin(range), std::end(range), sep);
+  }
 
   // Range (a default formatter is used)
   template <class InputIterator>
   inline std::string sjoin(InputIterator first, InputIterator last, const std::string_ref& sep)
   {
-    return join(first, last, sep, join_formatter());
+    return sjoin(first, last, sep, join_formatter());
   }
 
   template <class Range, typename Formatter>
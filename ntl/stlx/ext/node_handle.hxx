@@ -0,0 +1,203 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Node handles of the associative containers [container.node]
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_NODE_HANDLE
+#define NTL__EXT_NODE_HANDLE
+#pragma once
+
+#include "../utility.hxx"
+
+namespace std
+{
+  namespace ext
+  {
+#ifdef NTL_CXX_RV
+    /** Gives the containers access to the node owned by the handle */
+    struct node_handle_access
+    {
+      template<class Handle, class Node, class NodeAllocator>
+      static Handle make(Node* p, const NodeAllocator& a) { return Handle(p, a); }
+
+      template<class Handle>
+      static typename Handle::node_pointer get(const Handle& h) { return h.node_; }
+
+      template<class Handle>
+      static typename Handle::node_pointer release(Handle& h) { return h.release(); }
+    };
+
+    /**
+     *	@brief The owner of the node extracted from the container
+     *
+     *  The node keeps the element and the allocator which it was allocated with, so it can be inserted
+     *  to the compatible container without the copying or the allocation. The empty handle owns nothing.
+     **/
+    template<class Node, class NodeAllocator, class Allocator>
+    class node_handle_base
+    {
+      friend struct node_handle_access;
+    public:
+      typedef Allocator allocator_type;
+      typedef Node*     node_pointer;
+
+      bool empty() const __ntl_nothrow { return node_ == nullptr; }
+
+      __explicit_operator_bool() const __ntl_nothrow { return __explicit_bool(node_); }
+
+      allocator_type get_allocator() const { return allocator_type(alloc_); }
+
+    protected:
+      node_handle_base()
+        :node_(), alloc_()
+      {}
+
+      node_handle_base(Node* p, const NodeAllocator& a)
+        :node_(p), alloc_(a)
+      {}
+
+      node_handle_base(node_handle_base&& x)
+        :node_(x.node_), alloc_(x.alloc_)
+      {
+        x.node_ = nullptr;
+      }
+
+      ~node_handle_base()
+      {
+        reset();
+      }
+
+      void assign(node_handle_base&& x)
+      {
+        if(this != &x){
+          reset();
+          node_ = x.node_;
+          alloc_ = x.alloc_;
+          x.node_ = nullptr;
+        }
+      }
+
+      void swap(node_handle_base& x)
+      {
+        using std::swap;
+        swap(node_, x.node_);
+        swap(alloc_, x.alloc_);
+      }
+
+      Node* release()
+      {
+        Node* const p = node_;
+        node_ = nullptr;
+        return p;
+      }
+
+      void reset()
+      {
+        if(node_){
+          alloc_.destroy(node_);
+          alloc_.deallocate(node_, 1);
+          node_ = nullptr;
+        }
+      }
+
+      Node* node_;
+      NodeAllocator alloc_;
+
+    private:
+      node_handle_base(const node_handle_base&) __deleted;
+      node_handle_base& operator=(const node_handle_base&) __deleted;
+    };
+
+    /** Node handle of the map: gives the key and the mapped value */
+    template<class Node, class NodeAllocator, class Allocator, class Key, class T>
+    class map_node_handle:
+      public node_handle_base<Node, NodeAllocator, Allocator>
+    {
+      typedef node_handle_base<Node, NodeAllocator, Allocator> base;
+      friend struct node_handle_access;
+    public:
+      typedef Key key_type;
+      typedef T   mapped_type;
+
+      map_node_handle()
+      {}
+
+      map_node_handle(map_node_handle&& x)
+        :base(std::move(x))
+      {}
+
+      map_node_handle& operator=(map_node_handle&& x)
+      {
+        base::assign(std::move(x));
+        return *this;
+      }
+
+      /** The key may be changed before the node is inserted back */
+      key_type& key() const { return const_cast<key_type&>(this->node_->elem.first); }
+      mapped_type& mapped() const { return this->node_->elem.second; }
+
+      void swap(map_node_handle& x) { base::swap(x); }
+      friend void swap(map_node_handle& x, map_node_handle& y) { x.swap(y); }
+
+    private:
+      map_node_handle(Node* p, const NodeAllocator& a)
+        :base(p, a)
+      {}
+    };
+
+    /** Node handle of the set: gives the value */
+    template<class Node, class NodeAllocator, class Allocator, class Value>
+    class set_node_handle:
+      public node_handle_base<Node, NodeAllocator, Allocator>
+    {
+      typedef node_handle_base<Node, NodeAllocator, Allocator> base;
+      friend struct node_handle_access;
+    public:
+      typedef Value value_type;
+
+      set_node_handle()
+      {}
+
+      set_node_handle(set_node_handle&& x)
+        :base(std::move(x))
+      {}
+
+      set_node_handle& operator=(set_node_handle&& x)
+      {
+        base::assign(std::move(x));
+        return *this;
+      }
+
+      value_type& value() const { return this->node_->elem; }
+
+      void swap(set_node_handle& x) { base::swap(x); }
+      friend void swap(set_node_handle& x, set_node_handle& y) { x.swap(y); }
+
+    private:
+      set_node_handle(Node* p, const NodeAllocator& a)
+        :base(p, a)
+      {}
+    };
+
+    /** Result of the insertion of the node handle to the container of the unique keys */
+    template<class Iterator, class NodeType>
+    struct node_insert_return
+    {
+      Iterator  position;
+      bool      inserted;
+      NodeType  node;
+
+      node_insert_return(Iterator position, bool inserted, NodeType&& node)
+        :position(position), inserted(inserted), node(std::move(node))
+      {}
+
+      node_insert_return(node_insert_return&& x)
+        :position(x.position), inserted(x.inserted), node(std::move(x.node))
+      {}
+    };
+#endif // NTL_CXX_RV
+  } // ext
+} // std
+
+#endif // NTL__EXT_NODE_HANDLE
@@ -0,0 +1,570 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Fast random number engines: xoshiro256**, PCG64 and Philox4x32
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_RANDOM_ENGINES
+#define NTL__EXT_RANDOM_ENGINES
+#pragma once
+
+#include "../random.hxx"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+namespace ntl {
+  namespace intrinsic {
+    extern "C" unsigned long long __cdecl _umul128(unsigned long long a, unsigned long long b, unsigned long long* high);
+    #pragma intrinsic(_umul128)
+  }
+}
+#endif
+
+namespace std
+{
+ /**\addtogroup  lib_numeric ************ 26 Numerics library [numerics]
+  *@{
+  **/
+ /**\addtogroup  lib_numeric_rand ******* 26.5 Random number generation [rand]
+  *@{
+  **/
+  namespace ext
+  {
+    namespace __
+    {
+      inline uint64_t rotl64(uint64_t x, unsigned k)
+      {
+        return (x << k) | (x >> (64 - k));
+      }
+
+      inline uint64_t rotr64(uint64_t x, unsigned k)
+      {
+        return (x >> k) | (x << ((64 - k) & 63));
+      }
+
+      /** The state expander of the single value seeds [Steele, Lea, Flood] */
+      inline uint64_t splitmix64(uint64_t& x)
+      {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+      }
+
+      /** The full product of \p a and \p b: returns the low half, \p hi receives the high one */
+      inline uint64_t mul128(uint64_t a, uint64_t b, uint64_t& hi)
+      {
+      #if defined(_MSC_VER) && defined(_M_X64)
+        return ntl::intrinsic::_umul128(a, b, &hi);
+      #else
+        const uint64_t a0 = static_cast<uint32_t>(a), a1 = a >> 32, b0 = static_cast<uint32_t>(b), b1 = b >> 32;
+        const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+        const uint64_t mid = (p00 >> 32) + static_cast<uint32_t>(p01) + static_cast<uint32_t>(p10);
+        hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+        return (mid << 32) | static_cast<uint32_t>(p00);
+      #endif
+      }
+
+      /** Unsigned 128-bit arithmetic of the PCG64 state */
+      struct uint128
+      {
+        uint64_t lo, hi;
+
+        uint128()
+          :lo(), hi()
+        {}
+        uint128(uint64_t hi, uint64_t lo)
+          :lo(lo), hi(hi)
+        {}
+
+        friend uint128 operator+(const uint128& a, const uint128& b)
+        {
+          const uint64_t lo = a.lo + b.lo;
+          return uint128(a.hi + b.hi + (lo < a.lo), lo);
+        }
+
+        friend uint128 operator*(const uint128& a, const uint128& b)
+        {
+          uint64_t hi;
+          const uint64_t lo = mul128(a.lo, b.lo, hi);
+          return uint128(hi + a.lo * b.hi + a.hi * b.lo, lo);
+        }
+
+        friend bool operator==(const uint128& a, const uint128& b) { return a.lo == b.lo && a.hi == b.hi; }
+        friend bool operator!=(const uint128& a, const uint128& b) { return !(a == b); }
+      };
+
+      /** Fills the words of \p w 64 bits by the 32-bit values of the seed sequence */
+      template<class Sseq, size_t N>
+      inline void generate_words(Sseq& q, uint64_t (&w)[N])
+      {
+        uint32_t arr[N * 2];
+        q.generate(arr, arr + N * 2);
+        for(size_t i = 0; i < N; i++)
+          w[i] = arr[i * 2] | static_cast<uint64_t>(arr[i * 2 + 1]) << 32;
+      }
+    } // __
+
+
+    /**
+     *	@brief The xoshiro256** engine [Blackman, Vigna]
+     *
+     *  The small and fast all-purpose generator of the 64-bit values with the 256-bit state and 2<sup>256</sup>-1 period.
+     *  The independent streams are made by jump() which equals to 2<sup>128</sup> calls, so the thread \e i gets
+     *  the copy of the seeded engine jumped \e i times. The discard() is linear.
+     **/
+    class xoshiro256starstar
+    {
+    public:
+      ///\name types
+      typedef uint64_t result_type;
+
+      ///\name engine characteristics
+      static constexpr const result_type default_seed = 5489u;
+      static constexpr result_type min() { return 0; }
+      static constexpr result_type max() { return ~result_type(0); }
+
+      ///\name constructors and seeding functions
+      explicit xoshiro256starstar(result_type value = default_seed)
+      {
+        seed(value);
+      }
+
+      template<class Sseq>
+      explicit xoshiro256starstar(Sseq& q, typename enable_if<!is_same<Sseq, xoshiro256starstar>::value>::type* =0)
+      {
+        seed(q);
+      }
+
+      /** The state is expanded from \p value by splitmix64 */
+      void seed(result_type value = default_seed)
+      {
+        for(size_t i = 0; i < 4; i++)
+          s[i] = __::splitmix64(value);
+      }
+
+      template<class Sseq>
+      typename enable_if<is_class<Sseq>::value>::type seed(Sseq& q)
+      {
+        __::generate_words(q, s);
+        if(!(s[0] | s[1] | s[2] | s[3]))
+          s[0] = 1;
+      }
+
+      ///\name generating functions
+      result_type operator()()
+      {
+        return next(s[0], s[1], s[2], s[3]);
+      }
+
+      /** Fills [first, last) by the values of the consecutive calls */
+      template<class ForwardIterator>
+      void generate(ForwardIterator first, ForwardIterator last)
+      {
+        // the state is kept in the registers
+        uint64_t s0 = s[0], s1 = s[1], s2 = s[2], s3 = s[3];
+        for(; first != last; ++first)
+          *first = next(s0, s1, s2, s3);
+        s[0] = s0, s[1] = s1, s[2] = s2, s[3] = s3;
+      }
+
+      void discard(unsigned long long z)
+      {
+        while(z--)
+          operator()();
+      }
+
+      /** Advances the engine by 2<sup>128</sup> calls */
+      void jump()
+      {
+        static const uint64_t poly[4] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+        jump(poly);
+      }
+
+      /** Advances the engine by 2<sup>192</sup> calls */
+      void long_jump()
+      {
+        static const uint64_t poly[4] = { 0x76E15D3EFEFDCBBFull, 0xC5004E441C522FB3ull, 0x77710069854EE241ull, 0x39109BB02ACBE635ull };
+        jump(poly);
+      }
+
+      ///\name comparsion
+      friend bool operator==(const xoshiro256starstar& x, const xoshiro256starstar& y) { return std::equal(x.s, x.s + 4, y.s); }
+      friend bool operator!=(const xoshiro256starstar& x, const xoshiro256starstar& y) { return !(x == y); }
+
+      ///\name I/O support
+      template<typename charT, typename traits>
+      friend basic_ostream<charT, traits>& operator<<(basic_ostream<charT, traits>& os, const xoshiro256starstar& x)
+      {
+        saveiostate st(os); os.flags(ios_base::dec|ios_base::left); //-V808
+        const charT w = os.widen(' ');
+        return os << setfill(' ') << x.s[0] << w << x.s[1] << w << x.s[2] << w << x.s[3];
+      }
+      template<typename charT, typename traits>
+      friend basic_istream<charT, traits>& operator>>(basic_istream<charT, traits>& is, xoshiro256starstar& x)
+      {
+        saveiostate st(is); is.flags(ios_base::dec|ios_base::skipws); //-V808
+        return is >> x.s[0] >> x.s[1] >> x.s[2] >> x.s[3];
+      }
+      ///\}
+    private:
+      static result_type next(uint64_t& s0, uint64_t& s1, uint64_t& s2, uint64_t& s3)
+      {
+        const uint64_t re = __::rotl64(s1 * 5, 7) * 9;
+        const uint64_t t = s1 << 17;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = __::rotl64(s3, 45);
+        return re;
+      }
+
+      void jump(const uint64_t (&poly)[4])
+      {
+        uint64_t j[4] = {};
+        for(size_t i = 0; i < 4; i++){
+          for(unsigned b = 0; b < 64; b++){
+            if(poly[i] & (uint64_t(1) << b)){
+              j[0] ^= s[0];
+              j[1] ^= s[1];
+              j[2] ^= s[2];
+              j[3] ^= s[3];
+            }
+            operator()();
+          }
+        }
+        std::copy(j, j + 4, s);
+      }
+
+    private:
+      uint64_t s[4];
+    };
+
+
+    /**
+     *	@brief The PCG64 engine (XSL RR 128/64) [O'Neill]
+     *
+     *  The 128-bit linear congruential generator with the permuted output. Every odd increment gives the distinct
+     *  stream, so the engines seeded by the same value and the different \e stream numbers are independent.
+     *  The discard() takes the logarithmic time.
+     **/
+    class pcg64
+    {
+    public:
+      ///\name types
+      typedef uint64_t result_type;
+
+      ///\name engine characteristics
+      static constexpr const result_type default_seed   = 0xCAFEF00DD15EA5E5ull;
+      static constexpr const result_type default_stream = 0xDA3E39CB94B95BDBull;
+      static constexpr result_type min() { return 0; }
+      static constexpr result_type max() { return ~result_type(0); }
+
+      ///\name constructors and seeding functions
+      explicit pcg64(result_type value = default_seed, result_type stream = default_stream)
+      {
+        seed(value, stream);
+      }
+
+      template<class Sseq>
+      explicit pcg64(Sseq& q, typename enable_if<!is_same<Sseq, pcg64>::value>::type* =0)
+      {
+        seed(q);
+      }
+
+      void seed(result_type value = default_seed, result_type stream = default_stream)
+      {
+        seed(__::uint128(0, value), __::uint128(0, stream));
+      }
+
+      template<class Sseq>
+      typename enable_if<is_class<Sseq>::value>::type seed(Sseq& q)
+      {
+        uint64_t w[4];
+        __::generate_words(q, w);
+        seed(__::uint128(w[1], w[0]), __::uint128(w[3], w[2]));
+      }
+
+      ///\name generating functions
+      result_type operator()()
+      {
+        step();
+        return output(state);
+      }
+
+      /** Fills [first, last) by the values of the consecutive calls */
+      template<class ForwardIterator>
+      void generate(ForwardIterator first, ForwardIterator last)
+      {
+        for(; first != last; ++first){
+          step();
+          *first = output(state);
+        }
+      }
+
+      void discard(unsigned long long z)
+      {
+        // x(n) = A*x + C where A = a^n and C = c*(a^(n-1) + ... + 1), by squaring
+        __::uint128 acc_mult(0, 1), acc_plus, cur_mult = multiplier(), cur_plus = inc;
+        for(; z; z >>= 1){
+          if(z & 1){
+            acc_mult = acc_mult * cur_mult;
+            acc_plus = acc_plus * cur_mult + cur_plus;
+          }
+          cur_plus = (cur_mult + __::uint128(0, 1)) * cur_plus;
+          cur_mult = cur_mult * cur_mult;
+        }
+        state = acc_mult * state + acc_plus;
+      }
+
+      ///\name comparsion
+      friend bool operator==(const pcg64& x, const pcg64& y) { return x.state == y.state && x.inc == y.inc; }
+      friend bool operator!=(const pcg64& x, const pcg64& y) { return !(x == y); }
+
+      ///\name I/O support
+      template<typename charT, typename traits>
+      friend basic_ostream<charT, traits>& operator<<(basic_ostream<charT, traits>& os, const pcg64& x)
+      {
+        saveiostate st(os); os.flags(ios_base::dec|ios_base::left); //-V808
+        const charT w = os.widen(' ');
+        return os << setfill(' ') << x.state.hi << w << x.state.lo << w << x.inc.hi << w << x.inc.lo;
+      }
+      template<typename charT, typename traits>
+      friend basic_istream<charT, traits>& operator>>(basic_istream<charT, traits>& is, pcg64& x)
+      {
+        saveiostate st(is); is.flags(ios_base::dec|ios_base::skipws); //-V808
+        return is >> x.state.hi >> x.state.lo >> x.inc.hi >> x.inc.lo;
+      }
+      ///\}
+    private:
+      static __::uint128 multiplier()
+      {
+        return __::uint128(0x2360ED051FC65DA4ull, 0x4385DF649FCCF645ull);
+      }
+
+      void seed(const __::uint128& value, const __::uint128& stream)
+      {
+        inc = __::uint128((stream.hi << 1) | (stream.lo >> 63), (stream.lo << 1) | 1);
+        state = __::uint128();
+        step();
+        state = state + value;
+        step();
+      }
+
+      void step()
+      {
+        state = state * multiplier() + inc;
+      }
+
+      static result_type output(const __::uint128& x)
+      {
+        return __::rotr64(x.hi ^ x.lo, static_cast<unsigned>(x.hi >> 58));
+      }
+
+    private:
+      __::uint128 state, inc;
+    };
+
+
+    /**
+     *	@brief The Philox4x32-10 counter-based engine [Salmon, Moraes, Dror, Shaw]
+     *
+     *  The value is the function of the key (the seed) and the 128-bit counter, which is ciphered by ten rounds
+     *  in the blocks of four 32-bit values. The upper half of the counter is the \e stream number, so every thread
+     *  gets the reproducible stream of its own; the discard() takes the constant time.
+     *  The bulk generate() ciphers several blocks side by side, the rounds over the blocks are vectorized by the compiler.
+     **/
+    class philox4x32
+    {
+    public:
+      ///\name types
+      typedef uint32_t result_type;
+
+      ///\name engine characteristics
+      static constexpr const uint64_t default_seed = 20111115u;
+      static constexpr result_type min() { return 0; }
+      static constexpr result_type max() { return ~result_type(0); }
+
+      ///\name constructors and seeding functions
+      explicit philox4x32(uint64_t value = default_seed, uint64_t stream = 0)
+      {
+        seed(value, stream);
+      }
+
+      template<class Sseq>
+      explicit philox4x32(Sseq& q, typename enable_if<!is_same<Sseq, philox4x32>::value>::type* =0)
+      {
+        seed(q);
+      }
+
+      void seed(uint64_t value = default_seed, uint64_t stream = 0)
+      {
+        key[0] = static_cast<uint32_t>(value);
+        key[1] = static_cast<uint32_t>(value >> 32);
+        ctr[0] = ctr[1] = 0;
+        ctr[2] = static_cast<uint32_t>(stream);
+        ctr[3] = static_cast<uint32_t>(stream >> 32);
+        idx = 4;
+      }
+
+      template<class Sseq>
+      typename enable_if<is_class<Sseq>::value>::type seed(Sseq& q)
+      {
+        uint32_t arr[4];
+        q.generate(arr, arr + 4);
+        key[0] = arr[0], key[1] = arr[1];
+        ctr[0] = ctr[1] = 0;
+        ctr[2] = arr[2], ctr[3] = arr[3];
+        idx = 4;
+      }
+
+      ///\name generating functions
+      result_type operator()()
+      {
+        if(idx == 4){
+          cipher(ctr, key, out);
+          advance(1);
+          idx = 0;
+        }
+        return out[idx++];
+      }
+
+      /** Fills [first, last) by the values of the consecutive calls */
+      template<class ForwardIterator>
+      void generate(ForwardIterator first, ForwardIterator last)
+      {
+        for(; idx != 4 && first != last; ++first)
+          *first = out[idx++];
+        result_type buf[lanes * 4];
+        while(first != last){
+          cipher_lanes(buf);
+          size_t i = 0;
+          for(; i != lanes * 4 && first != last; ++i, ++first)
+            *first = buf[i];
+          const size_t used = (i + 3) / 4;
+          advance(used);
+          if(i % 4){
+            // the rest of the last block is kept for the next calls
+            std::copy(buf + (used - 1) * 4, buf + used * 4, out);
+            idx = static_cast<unsigned>(i % 4);
+          }
+        }
+      }
+
+      void discard(unsigned long long z)
+      {
+        if(z <= 4u - idx){
+          idx += static_cast<unsigned>(z);
+          return;
+        }
+        z -= 4 - idx;
+        advance(z / 4);
+        idx = 4;
+        if(z % 4){
+          operator()();
+          idx = static_cast<unsigned>(z % 4);
+        }
+      }
+
+      ///\name comparsion
+      friend bool operator==(const philox4x32& x, const philox4x32& y)
+      {
+        return std::equal(x.key, x.key + 2, y.key) && std::equal(x.ctr, x.ctr + 4, y.ctr) && x.idx == y.idx;
+      }
+      friend bool operator!=(const philox4x32& x, const philox4x32& y) { return !(x == y); }
+
+      ///\name I/O support
+      template<typename charT, typename traits>
+      friend basic_ostream<charT, traits>& operator<<(basic_ostream<charT, traits>& os, const philox4x32& x)
+      {
+        saveiostate st(os); os.flags(ios_base::dec|ios_base::left); //-V808
+        const charT w = os.widen(' ');
+        os << setfill(' ') << x.key[0] << w << x.key[1];
+        for(size_t i = 0; i < 4; i++)
+          os << w << x.ctr[i];
+        return os << w << x.idx;
+      }
+      template<typename charT, typename traits>
+      friend basic_istream<charT, traits>& operator>>(basic_istream<charT, traits>& is, philox4x32& x)
+      {
+        saveiostate st(is); is.flags(ios_base::dec|ios_base::skipws); //-V808
+        is >> x.key[0] >> x.key[1] >> x.ctr[0] >> x.ctr[1] >> x.ctr[2] >> x.ctr[3] >> x.idx;
+        if(is && x.idx < 4){
+          // the current block is the previous counter
+          uint32_t c[4] = { x.ctr[0] - 1, x.ctr[1] - (x.ctr[0] == 0), x.ctr[2], x.ctr[3] };
+          cipher(c, x.key, x.out);
+        }
+        return is;
+      }
+      ///\}
+    private:
+      static const size_t lanes = 8;
+
+      static void round(uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3, uint32_t k0, uint32_t k1)
+      {
+        const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0, p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+        const uint32_t hi0 = static_cast<uint32_t>(p0 >> 32), hi1 = static_cast<uint32_t>(p1 >> 32);
+        c0 = hi1 ^ c1 ^ k0;
+        c2 = hi0 ^ c3 ^ k1;
+        c1 = static_cast<uint32_t>(p1);
+        c3 = static_cast<uint32_t>(p0);
+      }
+
+      static void cipher(const uint32_t (&c)[4], const uint32_t (&k)[2], uint32_t (&o)[4])
+      {
+        uint32_t c0 = c[0], c1 = c[1], c2 = c[2], c3 = c[3], k0 = k[0], k1 = k[1];
+        for(unsigned r = 0; r != 10; ++r, k0 += 0x9E3779B9u, k1 += 0xBB67AE85u)
+          round(c0, c1, c2, c3, k0, k1);
+        o[0] = c0, o[1] = c1, o[2] = c2, o[3] = c3;
+      }
+
+      /** Ciphers the \c lanes blocks starting by the current counter, the counter is not advanced */
+      void cipher_lanes(result_type (&buf)[lanes * 4]) const
+      {
+        // the counter words of every block are kept in the separate arrays
+        uint32_t c0[lanes], c1[lanes], c2[lanes], c3[lanes];
+        for(size_t l = 0; l != lanes; ++l){
+          const uint64_t low = (ctr[0] | static_cast<uint64_t>(ctr[1]) << 32) + l;
+          const uint32_t carry = low < l;
+          c0[l] = static_cast<uint32_t>(low);
+          c1[l] = static_cast<uint32_t>(low >> 32);
+          c2[l] = ctr[2] + carry;
+          c3[l] = ctr[3] + (carry && c2[l] == 0);
+        }
+        uint32_t k0 = key[0], k1 = key[1];
+        for(unsigned r = 0; r != 10; ++r, k0 += 0x9E3779B9u, k1 += 0xBB67AE85u)
+          for(size_t l = 0; l != lanes; ++l)
+            round(c0[l], c1[l], c2[l], c3[l], k0, k1);
+        for(size_t l = 0; l != lanes; ++l){
+          buf[l * 4 + 0] = c0[l];
+          buf[l * 4 + 1] = c1[l];
+          buf[l * 4 + 2] = c2[l];
+          buf[l * 4 + 3] = c3[l];
+        }
+      }
+
+      /** Adds \p n blocks to the counter */
+      void advance(unsigned long long n)
+      {
+        const uint64_t low = (ctr[0] | static_cast<uint64_t>(ctr[1]) << 32) + n;
+        const bool carry = low < n;
+        ctr[0] = static_cast<uint32_t>(low);
+        ctr[1] = static_cast<uint32_t>(low >> 32);
+        if(carry && ++ctr[2] == 0)
+          ++ctr[3];
+      }
+
+    private:
+      uint32_t key[2];
+      uint32_t ctr[4];
+      uint32_t out[4];
+      unsigned idx;
+    };
+
+  } // ext
+  /**@} lib_numeric_rand */
+  /**@} lib_numeric */
+} // std
+
+#endif // NTL__EXT_RANDOM_ENGINES
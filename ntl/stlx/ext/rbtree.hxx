@@ -5,6 +5,7 @@
 #include "../iterator.hxx"
 #include "../memory.hxx"
 #include "../functional.hxx"
+#include "node_handle.hxx"
 
 namespace std 
 {
@@ -107,6 +108,7 @@ namespace std
         };
 
         typedef typename rb_tree<T, Compare, Allocator>::node node_type;
+        typedef typename allocator_type::template rebind<node_type>::other node_allocator_type;
 
         struct iterator_impl:
           std::iterator<std::bidirectional_iterator_tag, value_type, difference_type, pointer, reference>
@@ -209,7 +211,7 @@ namespace std
           :root_(), first_(), last_(), count_(), 
           comparator_(x.comparator_), node_allocator(x.node_allocator)
         {
-          insert_range(x.cbegin(), x.cend());
+          copy_tree(x);
         }
 
 #ifdef NTL_CXX_RV
@@ -227,7 +229,7 @@ namespace std
           comparator_(x.comparator_),node_allocator(a)
           
         {
-          insert(x.begin(), x.end());
+          copy_tree(x);
         }
 
         rb_tree& operator=(const rb_tree& x)
@@ -324,7 +326,7 @@ namespace std
         {
           if(this != &x){
             clear();
-            insert_range(x.cbegin(), x.cend());
+            copy_tree(x);
           }
         }
 
@@ -342,7 +344,13 @@ namespace std
         node_type* construct_node(const value_type& x)
         {
           node_type* const np = node_allocator.allocate(1);
-          node_allocator.construct(np, x);
+          __ntl_try {
+            node_allocator.construct(np, x);
+          }
+          __ntl_catch(...) {
+            node_allocator.deallocate(np, 1);
+            __ntl_rethrow;
+          }
           return np;
         }
 
@@ -350,7 +358,13 @@ namespace std
         node_type* construct_node(value_type&& x)
         {
           node_type* const np = node_allocator.allocate(1);
-          node_allocator.construct(np, std::forward<value_type>(x));
+          __ntl_try {
+            node_allocator.construct(np, std::forward<value_type>(x));
+          }
+          __ntl_catch(...) {
+            node_allocator.deallocate(np, 1);
+            __ntl_rethrow;
+          }
           return np;
         }
 
@@ -362,17 +376,26 @@ namespace std
             return std::make_pair(make_iterator(place.first), false);
           return std::make_pair(insert_impl(place.second, construct_node(std::forward<value_type>(x)), greater), true);
         }
+
+        iterator insert_reference(const_iterator position, value_type&& x)
+        {
+          bool greater;
+          std::pair<node*, node*> place = find_node(position, x, greater);
+          if(place.first)
+            return make_iterator(place.first);
+          return insert_impl(place.second, construct_node(std::forward<value_type>(x)), greater);
+        }
     #endif
 
     #ifdef NTL_CXX_VT
         template <class... Args>
-        std::pair<iterator, bool> emplace_hint(const_iterator /*position*/, Args&&... args)
+        std::pair<iterator, bool> emplace_hint(const_iterator position, Args&&... args)
         {
           node_type* const np = node_allocator.allocate(1);
           node_allocator.construct(np, std::forward<Args>(args)...);
 
           bool greater;
-          std::pair<node*, node*> place = find_node(np->elem, greater);
+          std::pair<node*, node*> place = find_node(position, np->elem, greater);
           if(!place.first) {
             // not exists, place node at tree
             return std::make_pair(insert_impl(place.second, np, greater), true);
@@ -390,6 +413,7 @@ namespace std
         std::pair<node*, node*> find_node(const value_type& elem, bool& greater)
         {
           node *q = nullptr;
+          greater = false;
           for ( node* p = root_; p; p = p->child[greater] )
           {
             greater = elem_greater(elem, p->elem);
@@ -400,6 +424,51 @@ namespace std
           return std::make_pair(nullptr, q);
         }
 
+        /**
+         *	@brief The same as find_node() but checks first whether the \p elem belongs next to the \p hint
+         *
+         *  If the \p elem goes right before or right after the hint, the place is found in amortized O(1),
+         *  otherwise it falls back to the search from the root.
+         **/
+        std::pair<node*, node*> find_node(const_iterator hint, const value_type& elem, bool& greater)
+        {
+          node* const p = const_cast<node*>(hint.p);
+          greater = false;
+          if ( empty() )
+            return std::pair<node*, node*>(nullptr, nullptr);
+          if ( !p || elem_less(elem, p->elem) )
+          {
+            // prev(hint) < elem < hint: either prev has no right child or hint has no left one
+            node* const prev = !p ? last_ : p == first_ ? nullptr : next(p, left);
+            if ( !prev || elem_greater(elem, prev->elem) )
+            {
+              if ( prev && !prev->child[right] )
+              {
+                greater = true;
+                return std::pair<node*, node*>(nullptr, prev);
+              }
+              return std::pair<node*, node*>(nullptr, p);
+            }
+          }
+          else if ( elem_greater(elem, p->elem) )
+          {
+            // hint < elem < next(hint)
+            node* const succ = next(p, right);
+            if ( !succ || elem_less(elem, succ->elem) )
+            {
+              if ( !p->child[right] )
+              {
+                greater = true;
+                return std::pair<node*, node*>(nullptr, p);
+              }
+              return std::pair<node*, node*>(nullptr, succ);
+            }
+          }
+          else
+            return std::pair<node*, node*>(p, nullptr);
+          return find_node(elem, greater);
+        }
+
         iterator insert_impl(node* const place, node* const np, bool greater)
         {
           // insert this as the root node if the tree is empty
@@ -436,10 +505,14 @@ namespace std
           return std::make_pair(insert_impl(place.second, construct_node(x), greater), true);
         }
 
-        iterator insert(const_iterator /*position*/, const value_type& x)
+        /** inserts \p x in amortized O(1) if it belongs right before or after the \p position */
+        iterator insert(const_iterator position, const value_type& x)
         {
-          // TODO: implement fast insert function based on position
-          return insert(x).first;
+          bool greater;
+          std::pair<node*, node*> place = find_node(position, x, greater);
+          if(place.first)
+            return make_iterator(place.first);
+          return insert_impl(place.second, construct_node(x), greater);
         }
 
         template <class InputIterator>
@@ -451,10 +524,24 @@ namespace std
 
         iterator erase(const_iterator position)
         {
-          node* const erasable = const_cast<node*>(position.p);
-          if ( !erasable )
+          if ( !position.p )
             return make_iterator(nullptr);
+          node* const np = unlink(position);
+          node_allocator.destroy(np);
+          node_allocator.deallocate(np, 1);
+          return make_iterator(const_cast<node*>(position.p));
+        }
 
+      protected:
+        /**
+         *	@brief Removes the element at the \p position from the tree without destroying it
+         *
+         *  The \p position is advanced to the next element. The returned node is the one the \p position
+         *  pointed to: the node with two children is replaced by its successor's node, the elements never move.
+         **/
+        node* unlink(const_iterator& position)
+        {
+          node* const erasable = const_cast<node*>(position.p);
           ++position;
           // check limits
           if ( erasable == first_ )
@@ -474,37 +561,88 @@ namespace std
           }
           // remove successor from the parent chain
           node* const x = succ->child[right_direction(!succ->child[left])];
-          node* prev_root = nullptr;
+          // x may be null, so its parent is kept apart for the fixup
+          node* x_parent = succ->parent();
           if ( x )
-            x->parent(succ->parent());
-          if ( succ->parent() )
-            succ->parent()->child[ succ != succ->parent()->child[left] ] = x;
+            x->parent(x_parent);
+          if ( x_parent )
+            x_parent->child[ succ != x_parent->child[left] ] = x;
           else
-          {
-            prev_root = root_;
             root_ = x;
-            //root_->color(node::black);
-          }
 
+          // the color of the node which left its place decides the fixup
+          const typename node::color_type removed = succ->color();
           if ( succ != erasable )
           {
-            using std::swap;
-            swap(succ->elem, erasable->elem);
-          }
-          if ( succ->color() == node::black && x )
-          {
-            if ( !prev_root )
-              fixup_delete(x);
+            // the successor's node takes the place and the color of the erasable one
+            node* const parent = erasable->parent();
+            succ->parent_and_color = erasable->parent_and_color;
+            link(succ, erasable->child[left], left);
+            link(succ, erasable->child[right], right);
+            if ( parent )
+              parent->child[ erasable != parent->child[left] ] = succ;
             else
-              x->color(node::black);
+              root_ = succ;
+            if ( x_parent == erasable )
+              x_parent = succ;
           }
-          node_allocator.destroy(succ);
-          node_allocator.deallocate(succ, 1);
+          if ( removed == node::black )
+            fixup_delete(x, x_parent);
           if ( count_ )
             --count_;
-          return make_iterator(const_cast<node*>(position.p));
+          return erasable;
+        }
+
+    #ifdef NTL_CXX_RV
+        /** Removes the node from the tree and passes it to the handle */
+        template<class Handle>
+        Handle extract_node(const_iterator position)
+        {
+          return node_handle_access::make<Handle>(unlink(position), node_allocator);
         }
 
+        /** Links the node of the handle unless the equal element exists, then the handle keeps the node */
+        template<class Handle>
+        std::pair<iterator, bool> insert_node(const_iterator hint, Handle& h)
+        {
+          node* const np = node_handle_access::get(h);
+          bool greater;
+          std::pair<node*, node*> place = find_node(hint, np->elem, greater);
+          if(place.first)
+            return std::make_pair(make_iterator(place.first), false);
+          node_handle_access::release(h);
+          reset_node(np);
+          return std::make_pair(insert_impl(place.second, np, greater), true);
+        }
+
+        /** Moves the nodes which elements are absent here from the \p source without the allocation */
+        void merge_unique(rb_tree& source)
+        {
+          if(&source == this)
+            return;
+          for(const_iterator i = source.cbegin(); i != source.cend(); ){
+            bool greater;
+            const std::pair<node*, node*> place = find_node(*i, greater);
+            if(place.first){
+              ++i;
+              continue;
+            }
+            // the place stays valid: only the source changes
+            node* const np = source.unlink(i);
+            reset_node(np);
+            insert_impl(place.second, np, greater);
+          }
+        }
+    #endif
+
+        static void reset_node(node* np)
+        {
+          np->child[left] = np->child[right] = nullptr;
+          np->parent_and_color = node::red;
+        }
+
+      public:
+
         iterator erase(const_iterator first, const_iterator last)
         {
           if(first == cbegin() && last == cend()){
@@ -653,44 +791,41 @@ namespace std
           return x;
         }
 
-        node* fixup_delete(node* x, direction_type direction) __ntl_nothrow
+        static bool is_black(const node* x) __ntl_nothrow
         {
-          direction_type const reverse = reverse_direction(direction);;
-          node* w = x->parent()->child[direction];
-          if ( !w )
-            return x->parent();
+          return !x || x->color() == node::black;
+        }
+
+        /** the subtree of \p parent on the side of \p x lacks a black node, the sibling is in the \p direction */
+        node* fixup_delete(node* parent, direction_type direction) __ntl_nothrow
+        {
+          direction_type const reverse = reverse_direction(direction);
+          // the sibling exists: its subtree has the black height of at least one
+          node* w = parent->child[direction];
           if ( w->color() == node::red )
           {
             w->color(node::black);
-            x->parent()->color(node::red);
-            rotate(x->parent(), reverse);
-            w = x->parent()->child[direction];
-          }
-          if ( !w )
-            return x->parent();
-          if(
-            (!w->child[reverse] || w->child[reverse]->color() == node::black) &&
-            (!w->child[direction]|| w->child[direction]->color() == node::black))
+            parent->color(node::red);
+            rotate(parent, reverse);
+            w = parent->child[direction];
+          }
+          if ( is_black(w->child[reverse]) && is_black(w->child[direction]) )
           {
             w->color(node::red);
-            x = x->parent();
+            return parent;
           }
-          else
+          if ( is_black(w->child[direction]) )
           {
-            if(!w->child[direction] || w->child[direction]->color() == node::black)
-            {
-              w->child[reverse]->color(node::black);
-              w->color(node::red);
-              rotate(w, direction);
-              w = x->parent()->child[direction];
-            }
-            w->color(x->parent()->color());
-            x->parent()->color(node::black);
-            w->child[direction]->color(node::black);
-            rotate(x->parent(), reverse);
-            x = root_;
+            w->child[reverse]->color(node::black);
+            w->color(node::red);
+            rotate(w, direction);
+            w = parent->child[direction];
           }
-          return x;
+          w->color(parent->color());
+          parent->color(node::black);
+          w->child[direction]->color(node::black);
+          rotate(parent, reverse);
+          return root_;
         }
 
         void fixup_insert(node* x) __ntl_nothrow
@@ -703,14 +838,16 @@ namespace std
           root_->color(node::black);
         }
 
-        void fixup_delete(node* x) __ntl_nothrow
+        /** restores the black height after the black node above \p x was removed, \p x may be null */
+        void fixup_delete(node* x, node* parent) __ntl_nothrow
         {
-          if ( !x ) return;
-          while ( x != root_ && x->color() == node::black )
+          while ( x != root_ && is_black(x) )
           {
-            x = fixup_delete(x, right_direction(x == x->parent()->child[left]));
+            x = fixup_delete(parent, right_direction(x == parent->child[left]));
+            parent = x->parent();
           }
-          x->color(node::black);
+          if ( x )
+            x->color(node::black);
         }
 
         bool elem_less(const T& x, const T& y) const
@@ -739,10 +876,128 @@ namespace std
         template<class InputIterator>
         void insert_range(InputIterator first, InputIterator last)
         {
-          while(first != last){
-            insert(*first);
-            ++first;
+          insert_range(first, last, typename iterator_traits<InputIterator>::iterator_category());
+        }
+
+        template<class InputIterator>
+        void insert_range(InputIterator first, InputIterator last, input_iterator_tag)
+        {
+          // the sorted elements are appended at the end in amortized O(1) each
+          for(; first != last; ++first)
+            insert(cend(), *first);
+        }
+
+        template<class ForwardIterator>
+        void insert_range(ForwardIterator first, ForwardIterator last, forward_iterator_tag)
+        {
+          if(empty() && first != last){
+            // the strictly increasing range makes the balanced tree as is
+            size_type n = 1;
+            ForwardIterator prev = first, i = first;
+            for(++i; i != last && elem_less(*prev, *i); prev = i, ++i)
+              ++n;
+            if(i == last){
+              build_tree(first, n);
+              return;
+            }
           }
+          insert_range(first, last, input_iterator_tag());
+        }
+
+        /** makes the tree of the \p n sorted unique elements in O(n), the tree must be empty */
+        template<class ForwardIterator>
+        void build_tree(ForwardIterator first, size_type n)
+        {
+          // the levels above the last one are full and black, the nodes of the incomplete last level are red
+          size_type full_levels = 0;
+          for(size_type m = n + 1; m > 1; m >>= 1)
+            ++full_levels;
+          root_ = build_subtree(first, n, 0, full_levels);
+          count_ = n;
+          update_limits();
+        }
+
+        template<class ForwardIterator>
+        node* build_subtree(ForwardIterator& first, size_type n, size_type depth, size_type red_depth)
+        {
+          if(!n)
+            return nullptr;
+          node* const l = build_subtree(first, n / 2, depth + 1, red_depth);
+          node* np;
+          __ntl_try {
+            np = construct_node(*first);
+          }
+          __ntl_catch(...) {
+            destroy_subtree(l);
+            __ntl_rethrow;
+          }
+          ++first;
+          np->color(depth == red_depth ? node::red : node::black);
+          link(np, l, left);
+          __ntl_try {
+            link(np, build_subtree(first, n - n / 2 - 1, depth + 1, red_depth), right);
+          }
+          __ntl_catch(...) {
+            destroy_subtree(np);
+            __ntl_rethrow;
+          }
+          return np;
+        }
+
+        /** clones the structure of \p x, the tree must be empty */
+        void copy_tree(const rb_tree& x)
+        {
+          if(x.empty())
+            return;
+          root_ = clone(x.root_);
+          count_ = x.count_;
+          update_limits();
+        }
+
+        node* clone(const node* x)
+        {
+          node* const np = construct_node(x->elem);
+          np->color(x->color());
+          __ntl_try {
+            if(x->child[left])
+              link(np, clone(x->child[left]), left);
+            if(x->child[right])
+              link(np, clone(x->child[right]), right);
+          }
+          __ntl_catch(...) {
+            // a failed clone() has freed its own part, the complete ones are linked to np
+            destroy_subtree(np);
+            __ntl_rethrow;
+          }
+          return np;
+        }
+
+        /** frees the detached subtree \p np */
+        void destroy_subtree(node* np)
+        {
+          while(np){
+            destroy_subtree(np->child[right]);
+            node* const l = np->child[left];
+            node_allocator.destroy(np);
+            node_allocator.deallocate(np, 1);
+            np = l;
+          }
+        }
+
+        static void link(node* parent, node* child, direction_type d)
+        {
+          parent->child[d] = child;
+          if(child)
+            child->parent(parent);
+        }
+
+        void update_limits()
+        {
+          first_ = last_ = root_;
+          while(first_ && first_->child[left])
+            first_ = first_->child[left];
+          while(last_ && last_->child[right])
+            last_ = last_->child[right];
         }
 
       protected:
@@ -752,7 +1007,7 @@ namespace std
         size_type count_;
 
         value_compare comparator_;
-        typename allocator_type::template rebind<node_type>::other node_allocator;
+        node_allocator_type node_allocator;
       };
 
       template<class T, class Compare, class Allocator>
@@ -10,9 +10,19 @@
 
 #include "../string_ref.hxx"
 #include "../vector.hxx"
+#include "string_search.hxx"
 
 namespace std
 {
+  namespace __
+  {
+    /** The deduced \c String&& is the temporary string, the pieces of which would outlive it */
+    template<class String>
+    struct is_string_rvalue:
+      is_same<typename remove_cv<String>::type, string>
+    {};
+  }
+
   ///\name Standard split predicates
 
   /** Skips empty substrings in the std::split() output collection. */
@@ -29,6 +39,7 @@ namespace std
    *	
    *	This is the default delimiter used if a string is given as the delimiter argument to \c std::split().
    *	Alternatively, this delimiter could be named differently, such as \c std::literal_delimiter.
+   *  @note The delimiter refers to the string, it is not copied.
    **/
   class literal
   {
@@ -42,9 +53,19 @@ namespace std
     {
       if(text.empty())
         return string_ref();
+      if(sref.empty())
+        // the empty delimiter splits the text to the characters: the empty match is after the first one
+        return text.length() > 1 ? string_ref(text.data() + 1, 0) : string_ref();
       const string_ref::size_type pos = text.find(sref);
       return pos == text.npos ? string_ref() : string_ref(text, pos, sref.length());
     }
+
+  private:
+    // do not bind to temporary objects
+#if defined(NTL_CXX_RV)
+    template<class String>
+    explicit literal(String&&, typename enable_if<__::is_string_rvalue<String>::value>::type* =0) __deleted;
+#endif
   };
 
 
@@ -53,6 +74,7 @@ namespace std
    *	
    *	This is different from the \c std::any_of algorithm [alg.any_of], but overload resolution should disambiguate this delimiter. 
    *	Alternatively, this delimiter could be named differently, such as \c std::any_of_delimiter.
+   *  @note The delimiter refers to the string, it is not copied.
    **/
   class split_any
   {
@@ -66,56 +88,139 @@ namespace std
     {
       if(text.empty())
         return string_ref();
-      //else if(sref.empty())
-      //  return string_ref(text, 0, 1);
-      size_t pos = text.npos;
-      for(string_ref::const_iterator t = text.begin(), te = text.end(), se = sref.end(); t != te; ++t){
-        for(string_ref::const_iterator s = sref.begin(); s != se; ++s){
-          if(*t == *s)
-            return string_ref(t, 1);
-        }
-      }
-      return string_ref();
+      const char* t = ext::strsearch::find_first_of<char_traits<char>, true>(text.data(), text.length(), sref.data(), sref.length());
+      return t ? string_ref(t, 1) : string_ref();
     }
+
+  private:
+    // do not bind to temporary objects
+#if defined(NTL_CXX_RV)
+    template<class String>
+    explicit split_any(String&&, typename enable_if<__::is_string_rvalue<String>::value>::type* =0) __deleted;
+#endif
   };
   ///\}
 
 
+  namespace __
+  {
+    struct split_default_predicate
+    {
+      bool operator()(const string_ref& /*sref*/) const { return true; }
+    };
+  }
+
   /**
-   *	@brief Holds split results
+   *	@brief The lazy range of the split results
+   *
+   *  The substrings are found one by one while the range is iterated and refer to the text, nothing is allocated.
+   *  The iterators refer to the splitter, so it must outlive them, and the text (as well as the string of
+   *  the literal or split_any delimiter) must outlive both. The temporary strings are rejected at compile time,
+   *  keep the string in a variable or convert the range to the container, which copies the pieces.
    **/
-  template <typename Delimiter>
+  template <typename Delimiter, typename Predicate = __::split_default_predicate>
   class splitter
   {
-    typedef std::vector<string_ref>            refs_type;
-  public:
-    typedef typename refs_type::const_iterator const_iterator;
-    typedef typename refs_type::iterator       iterator;
-    typedef typename refs_type::value_type     value_type;
-    
   public:
-    splitter(refs_type& inrefs)
+    typedef string_ref value_type;
+
+    class const_iterator:
+      public std::iterator<forward_iterator_tag, string_ref, ptrdiff_t, const string_ref*, const string_ref&>
     {
-      refs.swap(inrefs);
-    }
+      friend class splitter;
+    public:
+      const_iterator()
+        :owner(), next(), last(true), done(true)
+      {}
+
+      const string_ref& operator*() const { return piece; }
+      const string_ref* operator->() const { return &piece; }
+
+      const_iterator& operator++()
+      {
+        advance();
+        return *this;
+      }
 
-#ifdef NTL_CXX_RV
-    splitter(splitter&& r)
-      :refs(std::move(r.refs))
+      const_iterator operator++(int)
+      {
+        const_iterator tmp(*this);
+        advance();
+        return tmp;
+      }
+
+      friend bool operator==(const const_iterator& x, const const_iterator& y)
+      {
+        return x.done == y.done && x.piece.data() == y.piece.data() && x.piece.length() == y.piece.length();
+      }
+
+      friend bool operator!=(const const_iterator& x, const const_iterator& y)
+      {
+        return !(x == y);
+      }
+
+    private:
+      explicit const_iterator(const splitter* owner)
+        :owner(owner), next(owner->text.data()), last(owner->text.empty()), done(owner->text.empty())
+      {
+        if(!done)
+          advance();
+      }
+
+      void advance()
+      {
+        do{
+          if(last){
+            piece = string_ref();
+            done = true;
+            return;
+          }
+          const char* const end = owner->text.end();
+          const string_ref rest(next, end - next);
+          const string_ref pos = owner->d.find(rest);
+          // the empty match at the edges is not a match, otherwise the next piece would be the same
+          const bool found = !pos.empty() || (pos.data() && pos.data() > rest.data() && pos.data() < end);
+          if(!found){
+            // the last piece, it is empty if the text is ended by the delimiter
+            piece = rest;
+            last = true;
+          }else{
+            piece = string_ref(next, pos.data() - next);
+            next = pos.end();
+          }
+        }while(!owner->filter(piece));
+      }
+
+      const splitter* owner;
+      string_ref piece;
+      const char* next;
+      bool last, done;
+    };
+    typedef const_iterator iterator;
+
+  public:
+    splitter(const string_ref& text, const Delimiter& d, const Predicate& filter = Predicate())
+      :text(text), d(d), filter(filter)
     {}
+    // do not bind to temporary objects
+#if defined(NTL_CXX_RV)
+    template<class String>
+    splitter(String&& text, const Delimiter& d, const Predicate& filter = Predicate(), typename enable_if<__::is_string_rvalue<String>::value>::type* =0) __deleted;
 #endif
 
-    const_iterator begin() const { return refs.begin(); }
-    const_iterator end()   const { return refs.end();   }
+    const_iterator begin() const { return const_iterator(this); }
+    const_iterator end()   const { return const_iterator(); }
 
     template <typename Container>
-    operator Container()
+    operator Container() const
     {
       return Container(begin(), end());
     }
 
   private:
-    refs_type refs;
+    string_ref text;
+    Delimiter d;
+    Predicate filter;
   };
 
   namespace __
@@ -132,43 +237,21 @@ namespace std
       static const bool value = sizeof(check<T>(0)) == sizeof(sfinae_passed_tag);
     };
 
-    struct split_default_predicate
-    {
-      bool operator()(const string_ref& /*sref*/) const { return true; }
-    };
-
     template <typename Delimiter, typename Predicate>
-    inline typename enable_if<__::split_is_delimiter<Delimiter>::value,splitter<Delimiter> >::type split(const std::string_ref& text, Delimiter d, Predicate filter)
+    inline typename enable_if<__::split_is_delimiter<Delimiter>::value,splitter<Delimiter, Predicate> >::type split(const std::string_ref& text, Delimiter d, Predicate filter)
     {
-      std::vector<string_ref> seq;
-      for(string_ref cur = text, pos = d.find(cur); !cur.empty(); pos = d.find(cur)){
-        const bool notfound = pos.empty();
-        // range [current] delim
-        const string_ref::size_type len = notfound ? cur.length() : (pos.data()-cur.data());
-        const string_ref sub(cur.data(), len);
-        if(filter(sub))
-          seq.push_back(sub);
-        if(notfound)
-          break;
-        // current = delim [rest]
-        cur = string_ref(pos.end(), text.length() - (pos.end()-text.begin()));
-        if(cur.empty() && pos.end() == text.end()){
-          // if delimiter at end of string, treat end as additional empty result
-          const string_ref sub(pos.end());
-          if(filter(sub))
-            seq.push_back(sub);
-        }
-      }
-      splitter<Delimiter> result(seq);
-      return std::move(result);
+      return splitter<Delimiter, Predicate>(text, d, filter);
     }
 
   }
 
 
-  /** The function called to split an input string into a collection of substrings. */
+  /**
+   *	The function called to split an input string into a collection of substrings.
+   *  @note The result refers to the \p text, see splitter.
+   **/
   template <typename Delimiter, typename Predicate>
-  inline splitter<Delimiter> split(const std::string_ref& text, Delimiter d, Predicate filter)
+  inline splitter<Delimiter, Predicate> split(const std::string_ref& text, Delimiter d, Predicate filter)
   {
     static_assert(__::split_is_delimiter<Delimiter>::value, "string_ref Delimiter::find(string_ref) is not found in <Delimiter>");
     return __::split(text, d, filter);
@@ -181,23 +264,13 @@ namespace std
   }
 
   template <typename Predicate>
-  inline splitter<literal> split(const std::string_ref& text, const string_ref& delim, Predicate filter)
+  inline splitter<literal, Predicate> split(const std::string_ref& text, const string_ref& delim, Predicate filter)
   {
-    if(delim.empty()){
-      std::vector<string_ref> seq;
-      for(string_ref::const_iterator p = text.begin(), end = text.end(); p != end; ++p){
-        string_ref sub(p, 1);
-        if(filter(sub))
-          seq.push_back(sub);
-      }
-      splitter<literal> result(seq);
-      return std::move(result);
-    }
     return __::split(text, literal(delim), filter);
   }
 
   template <typename Predicate>
-  inline splitter<literal> split(const std::string_ref& text, const char* delim, Predicate filter)
+  inline splitter<literal, Predicate> split(const std::string_ref& text, const char* delim, Predicate filter)
   {
     return std::split(text, string_ref(delim), filter);
   }
@@ -206,5 +279,14 @@ namespace std
   {
     return std::split(text, delim, __::split_default_predicate());
   }
+
+#if defined(NTL_CXX_RV)
+  // the pieces would refer to the destroyed string
+  template <typename String, typename Delimiter, typename Predicate>
+  typename enable_if<__::is_string_rvalue<String>::value>::type split(String&& text, Delimiter d, Predicate filter) __deleted;
+
+  template <typename String, typename Delimiter>
+  typename enable_if<__::is_string_rvalue<String>::value>::type split(String&& text, Delimiter d) __deleted;
+#endif
 }
 #endif // NTL__EXT_SPLIT
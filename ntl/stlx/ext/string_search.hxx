@@ -0,0 +1,386 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Character and substring search of the string classes
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__EXT_STRING_SEARCH
+#define NTL__EXT_STRING_SEARCH
+#pragma once
+
+#include "../cstdint.hxx"
+#include "../cstring.hxx"
+
+namespace std
+{
+  template<class charT> struct char_traits;
+
+  namespace ext
+  {
+    /**
+     *	@brief Search algorithms used by basic_string and basic_string_ref
+     *
+     *  The characters are compared by the word: the machine word holds several characters (lanes),
+     *  and the lane equal to the sought character is detected by the well-known "has zero byte" trick,
+     *  so the vector registers are not touched and the code is usable in the kernel mode as well.
+     *  The word tricks are applied only if the traits are std::char_traits, the other traits
+     *  are served by their own \c eq(), \c lt() and \c find().
+     **/
+    namespace strsearch
+    {
+      namespace __
+      {
+        template<class traits>
+        struct is_std_traits { static const bool value = false; };
+        template<class charT>
+        struct is_std_traits<char_traits<charT> > { static const bool value = true; };
+
+        /** Word of the characters of the given size */
+        template<size_t CharSize> struct lanes;
+        template<> struct lanes<1>
+        {
+          static const size_t ones = ~size_t(0) / 0xFF;
+          typedef uint8_t lane_type;
+        };
+        template<> struct lanes<2>
+        {
+          static const size_t ones = ~size_t(0) / 0xFFFF;
+          typedef uint16_t lane_type;
+        };
+        template<> struct lanes<4>
+        {
+          static const size_t ones = ~size_t(0) / 0xFFFFFFFF;
+          typedef uint32_t lane_type;
+        };
+
+        template<class charT>
+        struct word
+        {
+          typedef lanes<sizeof(charT)> lane_traits;
+          static const size_t per_word = sizeof(size_t) / sizeof(charT);
+          static const size_t ones = lane_traits::ones;
+          static const size_t highs = ones << (sizeof(charT) * 8 - 1);
+
+          /** The word with every lane set to \p c */
+          static size_t broadcast(charT c)
+          {
+            return ones * static_cast<typename lane_traits::lane_type>(c);
+          }
+
+          /** Nonzero if some lane of \p x is zero */
+          static size_t has_zero(size_t x)
+          {
+            return (x - ones) & ~x & highs;
+          }
+
+          /** Index of the lowest lane flagged by has_zero(), it is exact unlike the higher ones (little-endian) */
+          static size_t first_lane(size_t mask)
+          {
+            const size_t below = ((mask & (0 - mask)) - 1) & highs;
+            // sum the flags of the lanes below by the multiplication
+            return ((below >> (sizeof(charT) * 8 - 1)) * ones) >> (sizeof(size_t) - sizeof(charT)) * 8;
+          }
+
+          static size_t load(const charT* p)
+          {
+            size_t x;
+            std::memcpy(&x, p, sizeof(x));
+            return x;
+          }
+        };
+
+        template<class traits, class charT>
+        inline bool equal(const charT* a, const charT* b, size_t n)
+        {
+          if(is_std_traits<traits>::value)
+            return std::memcmp(a, b, n * sizeof(charT)) == 0;
+          for(; n; --n, ++a, ++b)
+            if(!traits::eq(*a, *b))
+              return false;
+          return true;
+        }
+
+        /**
+         *	@brief Critical factorization of the needle [Crochemore-Perrin]
+         *
+         *  The maximal suffix is computed for both the ordering and the reversed one, the longer is taken.
+         *	@return position of the right half, \p period receives the period of it
+         **/
+        template<class traits, class charT>
+        size_t critical_factorization(const charT* x, size_t m, size_t& period)
+        {
+          size_t ms = size_t(-1), j = 0, k = 1, p = 1;
+          while(j + k < m){
+            const charT a = x[j + k], b = x[ms + k];
+            if(traits::lt(a, b)){
+              j += k; k = 1; p = j - ms;
+            }else if(traits::eq(a, b)){
+              if(k != p) ++k; else { j += p; k = 1; }
+            }else{
+              ms = j++; k = p = 1;
+            }
+          }
+          period = p;
+
+          size_t rms = size_t(-1), rp = 1;
+          j = 0, k = 1;
+          while(j + k < m){
+            const charT a = x[j + k], b = x[rms + k];
+            if(traits::lt(b, a)){
+              j += k; k = 1; rp = j - rms;
+            }else if(traits::eq(a, b)){
+              if(k != rp) ++k; else { j += rp; k = 1; }
+            }else{
+              rms = j++; k = rp = 1;
+            }
+          }
+          if(rms + 1 < ms + 1)
+            return ms + 1;
+          period = rp;
+          return rms + 1;
+        }
+      } // __
+
+      /**
+       *	@brief Two-way string matching
+       *
+       *  Finds the \p needle in the \p hay in the linear time and the constant space whatever the input is.
+       **/
+      template<class traits, class charT>
+      const charT* two_way(const charT* hay, size_t n, const charT* needle, size_t m)
+      {
+        if(m > n)
+          return nullptr;
+        size_t period;
+        const size_t suffix = __::critical_factorization<traits>(needle, m, period);
+        if(__::equal<traits>(needle, needle + period, suffix)){
+          // the needle is periodic, the matched prefix is remembered
+          size_t memory = 0;
+          for(size_t j = 0; j <= n - m; ){
+            size_t i = suffix > memory ? suffix : memory;
+            while(i < m && traits::eq(needle[i], hay[i + j]))
+              ++i;
+            if(i >= m){
+              i = suffix - 1;
+              while(memory < i + 1 && traits::eq(needle[i], hay[i + j]))
+                --i;
+              if(i + 1 < memory + 1)
+                return hay + j;
+              j += period;
+              memory = m - period;
+            }else{
+              j += i - suffix + 1;
+              memory = 0;
+            }
+          }
+        }else{
+          period = (suffix > m - suffix ? suffix : m - suffix) + 1;
+          for(size_t j = 0; j <= n - m; ){
+            size_t i = suffix;
+            while(i < m && traits::eq(needle[i], hay[i + j]))
+              ++i;
+            if(i >= m){
+              i = suffix - 1;
+              while(i != size_t(-1) && traits::eq(needle[i], hay[i + j]))
+                --i;
+              if(i == size_t(-1))
+                return hay + j;
+              j += period;
+            }else{
+              j += i - suffix + 1;
+            }
+          }
+        }
+        return nullptr;
+      }
+
+      /** Finds the character \p c in the first \p n characters of \p s by the word */
+      template<class charT>
+      inline const charT* find_char(const charT* s, size_t n, charT c)
+      {
+        typedef __::word<charT> word;
+        while(n && (reinterpret_cast<uintptr_t>(s) & (sizeof(size_t) - 1))){
+          if(*s == c)
+            return s;
+          ++s, --n;
+        }
+        const size_t pattern = word::broadcast(c);
+        for(; n >= word::per_word; s += word::per_word, n -= word::per_word){
+          if(word::has_zero(*reinterpret_cast<const size_t*>(s) ^ pattern))
+            break;
+        }
+        for(; n; ++s, --n)
+          if(*s == c)
+            return s;
+        return nullptr;
+      }
+
+      inline const char* find_char(const char* s, size_t n, char c)
+      {
+        return static_cast<const char*>(std::memchr(s, static_cast<unsigned char>(c), n));
+      }
+
+      /**
+       *	@brief Finds the first occurence of the \p needle in the \p hay
+       *
+       *  The candidates are filtered by the first and the last character of the needle, a word of candidates
+       *  at time; the survivors are compared in full. When the filter lets too much through (the periodic
+       *  inputs), the rest is searched by the two_way() which keeps the time linear.
+       **/
+      template<class traits, class charT>
+      const charT* search(const charT* hay, size_t n, const charT* needle, size_t m)
+      {
+        if(m == 0)
+          return hay;
+        if(m > n)
+          return nullptr;
+        if(!__::is_std_traits<traits>::value){
+          // the only character search is known for the other traits
+          for(size_t j = 0; j <= n - m; ){
+            const charT* p = traits::find(hay + j, n - m - j + 1, needle[0]);
+            if(!p)
+              return nullptr;
+            if(__::equal<traits>(p + 1, needle + 1, m - 1))
+              return p;
+            j = (p - hay) + 1;
+          }
+          return nullptr;
+        }
+        if(m == 1)
+          return find_char(hay, n, needle[0]);
+
+        typedef __::word<charT> word;
+        const charT first = needle[0], last = needle[m - 1];
+        const size_t fp = word::broadcast(first), lp = word::broadcast(last);
+        const size_t end = n - m + 1; // the candidate positions
+        size_t work = 0;              // characters compared by the verification
+        size_t j = 0;
+        for(; j + word::per_word <= end; j += word::per_word){
+          const size_t hits = word::has_zero(word::load(hay + j) ^ fp) & word::has_zero(word::load(hay + j + m - 1) ^ lp);
+          if(!hits)
+            continue;
+          for(size_t k = j; k != j + word::per_word; k++){
+            if(hay[k] == first && hay[k + m - 1] == last){
+              if(__::equal<traits>(hay + k + 1, needle + 1, m - 2))
+                return hay + k;
+              work += m;
+            }
+          }
+          if(work > 64 + 4 * j && m > 2 * word::per_word){
+            // the needle is too repetitive for the filter
+            return two_way<traits>(hay + j, n - j, needle, m);
+          }
+        }
+        for(; j != end; j++)
+          if(hay[j] == first && hay[j + m - 1] == last && __::equal<traits>(hay + j + 1, needle + 1, m - 2))
+            return hay + j;
+        return nullptr;
+      }
+
+      /**
+       *	@brief Set of characters looked up by the bitmap
+       *
+       *  Only the sets of the characters below 256 are put to the bitmap, is_small() tells that.
+       **/
+      template<class charT>
+      class charset
+      {
+        uint32_t bits[8];
+        bool small;
+
+        static uint32_t code(charT c)
+        {
+          return sizeof(charT) == 1 ? static_cast<uint8_t>(c) : static_cast<uint32_t>(c);
+        }
+      public:
+        charset(const charT* s, size_t n)
+          :small(true)
+        {
+          std::memset(bits, 0, sizeof(bits));
+          for(; n; ++s, --n){
+            const uint32_t u = code(*s);
+            if(u > 0xFF)
+              small = false;
+            else
+              bits[u >> 5] |= 1u << (u & 31);
+          }
+        }
+
+        bool is_small() const { return small; }
+
+        bool test(charT c) const
+        {
+          const uint32_t u = code(c);
+          return u <= 0xFF && (bits[u >> 5] >> (u & 31)) & 1;
+        }
+      };
+
+      /**
+       *	@brief Finds the first character of \p s which is (\p Of is \c true) or is not a member of the \p set
+       **/
+      template<class traits, bool Of, class charT>
+      const charT* find_first_of(const charT* s, size_t n, const charT* set, size_t sn)
+      {
+        if(Of && sn == 1 && __::is_std_traits<traits>::value)
+          return find_char(s, n, set[0]);
+        if(Of && sn <= 4 && __::is_std_traits<traits>::value){
+          // the few characters (the field and line delimiters) are tested against the whole word
+          typedef __::word<charT> word;
+          size_t patterns[4];
+          for(size_t i = 0; i != sn; i++)
+            patterns[i] = word::broadcast(set[i]);
+          for(; n >= word::per_word; s += word::per_word, n -= word::per_word){
+            const size_t x = word::load(s);
+            size_t hits = 0;
+            for(size_t i = 0; i != sn; i++)
+              hits |= word::has_zero(x ^ patterns[i]);
+            if(hits)
+              return s + word::first_lane(hits);
+          }
+          for(; n; ++s, --n)
+            for(size_t i = 0; i != sn; i++)
+              if(*s == set[i])
+                return s;
+          return nullptr;
+        }
+        if(__::is_std_traits<traits>::value && sn > 1){
+          const charset<charT> cs(set, sn);
+          if(cs.is_small()){
+            for(; n; ++s, --n)
+              if(cs.test(*s) == Of)
+                return s;
+            return nullptr;
+          }
+        }
+        for(; n; ++s, --n)
+          if((traits::find(set, sn, *s) != nullptr) == Of)
+            return s;
+        return nullptr;
+      }
+
+      /**
+       *	@brief Finds the last character of \p s which is (\p Of is \c true) or is not a member of the \p set
+       **/
+      template<class traits, bool Of, class charT>
+      const charT* find_last_of(const charT* s, size_t n, const charT* set, size_t sn)
+      {
+        if(__::is_std_traits<traits>::value && sn > 1){
+          const charset<charT> cs(set, sn);
+          if(cs.is_small()){
+            while(n--)
+              if(cs.test(s[n]) == Of)
+                return s + n;
+            return nullptr;
+          }
+        }
+        while(n--)
+          if((traits::find(set, sn, s[n]) != nullptr) == Of)
+            return s + n;
+        return nullptr;
+      }
+
+    } // strsearch
+  } // ext
+} // std
+
+#endif // NTL__EXT_STRING_SEARCH
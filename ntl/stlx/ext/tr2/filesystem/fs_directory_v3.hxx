@@ -34,24 +34,29 @@ namespace std
        *  @note Because status() on a pathname may be a very expensive operation, some operating systems provide status information 
        *  as a byproduct of directory iteration. 
        *  Caching such status information can result is significant time savings. Cached and non-cached results may differ in the presence of race conditions.
+       *
+       *  The entries obtained from the directory_iterator also cache the file size, times and attributes
+       *  returned by the directory query, so file_size(), last_write_time() and info() do not touch the file system.
        **/
       
       class directory_entry
       {
+        friend class directory_iterator;
       public:
         typedef files::path path_type;
         typedef path_type::string_type string_type;
 
         ///\name constructors
         directory_entry()
+          :info_known()
         {}
 
         explicit directory_entry(const path_type& p, file_status st = file_status(), file_status symlink_st = file_status())
-          :p(p),st(st), lst(symlink_st)
+          :p(p),st(st), lst(symlink_st), info_known()
         {}
 
         directory_entry(const directory_entry& r)
-          :p(r.p), st(r.st), lst(r.lst)
+          :p(r.p), st(r.st), lst(r.lst), fi(r.fi), info_known(r.info_known)
         {}
 
         directory_entry& operator=(const directory_entry& r)
@@ -62,9 +67,10 @@ namespace std
 
       #ifdef NTL_CXX_RV
         explicit directory_entry(path_type&& p, file_status st = file_status(), file_status symlink_st = file_status())
-          :p(forward<path_type>(p)),st(st), lst(symlink_st)
+          :p(forward<path_type>(p)),st(st), lst(symlink_st), info_known()
         {}
         directory_entry(directory_entry&& r)
+          :info_known()
         {
           swap(r);
         }
@@ -75,7 +81,7 @@ namespace std
 
         void assign(path_type&& p, file_status st = file_status(), file_status symlink_st = file_status())
         {
-          this->p = move(p), this->st = st, lst = symlink_st;
+          this->p = move(p), this->st = st, lst = symlink_st, info_known = false;
         }
 
       #endif
@@ -84,6 +90,8 @@ namespace std
           p.swap(r.p);
           std::swap(st,r.st);
           std::swap(lst,r.lst);
+          std::swap(fi,r.fi);
+          std::swap(info_known,r.info_known);
         }
 
         friend void swap(directory_entry& x, directory_entry& y) { x.swap(y); }
@@ -92,14 +100,14 @@ namespace std
         /** Assigns the stored path and statuses with the new values */
         void assign(const path_type& p, file_status st = file_status(), file_status symlink_st = file_status())
         {
-          this->p = p, this->st = st, lst = symlink_st;
+          this->p = p, this->st = st, lst = symlink_st, info_known = false;
         }
 
         /** Replaces the base filename and statuses of the stored path with the new values */
         void replace_filename(const string_type& s, file_status st = file_status(), file_status symlink_st = file_status())
         {
           p = p.parent_path() / s;
-          this->st = st, lst = symlink_st;
+          this->st = st, lst = symlink_st, info_known = false;
         }
 
         ///\name observers
@@ -131,6 +139,32 @@ namespace std
           return lst;
         }
 
+        /** Returns the file size cached by the directory iteration or determines it by files::file_size(), which reports the directory as an error */
+        uintmax_t file_size(error_code& ec = throws()) const
+        {
+          if(!info_known || (fi.FileAttributes & ntl::nt::file_attribute::directory))
+            return files::file_size(p, ec);
+          if(&ec != &throws())
+            ec.clear();
+          return static_cast<uintmax_t>(fi.EndOfFile);
+        }
+
+        /** Returns the last write time cached by the directory iteration or determines it by files::last_write_time() */
+        std::time_t last_write_time(error_code& ec = throws()) const
+        {
+          if(!info_known)
+            return files::last_write_time(p, ec);
+          if(&ec != &throws())
+            ec.clear();
+          return ntime2ctime(fi.LastWriteTime);
+        }
+
+        /** Checks if the native file information is cached */
+        bool has_info() const { return info_known; }
+
+        /** Returns the cached native file information (sizes, times and attributes), requires has_info() */
+        const ntl::nt::file_network_open_information& info() const { assert(info_known); return fi; }
+
         ///\name comparisons
         bool operator<(const directory_entry& rhs);
         bool operator==(const directory_entry& rhs) { return st == rhs.st && lst == rhs.lst && p == rhs.p; }
@@ -140,10 +174,25 @@ namespace std
         bool operator>=(const directory_entry& rhs);
         ///\}
 
+      private:
+        void assign_info(const ntl::nt::file_directory_information& di)
+        {
+          fi.CreationTime = di.CreationTime;
+          fi.LastAccessTime = di.LastAccessTime;
+          fi.LastWriteTime = di.LastWriteTime;
+          fi.ChangeTime = di.ChangeTime;
+          fi.AllocationSize = di.AllocationSize;
+          fi.EndOfFile = di.EndOfFile;
+          fi.FileAttributes = di.FileAttributes;
+          info_known = true;
+        }
+
       private:
         path_type            p;
         mutable file_status  st;
         mutable file_status  lst;
+        ntl::nt::file_network_open_information fi;
+        bool                 info_known;
       };
 
 
@@ -168,26 +217,28 @@ namespace std
        *
        *  The result of calling the path() member of the directory_entry object obtained by dereferencing a directory_iterator is a reference 
        *  to a basic_path object composed of the directory argument from which the iterator was constructed with filename of the directory entry appended as if by <tt>operator/=</tt>.
+       *
+       *  The directory is read by the chunks of the fixed size (ntl::nt::directory_reader) as the iterator advances,
+       *  the copies of the iterator share the reader and its position.
        **/
       class directory_iterator:
         public iterator<input_iterator_tag, directory_entry>
       {
-        typedef const ntl::nt::file_directory_information  fdi_t;
+        typedef ntl::nt::directory_reader reader_t;
       public:
         typedef files::path path_type;
 
         ///\name Constructors
         directory_iterator() __ntl_nothrow
-          :di(), base(), memsize()
         {}
         explicit directory_iterator(const files::path& dp) __ntl_nothrow
-          :dp(dp), di(), base(), memsize()
+          :dp(dp)
         {
           error_code ec;
           ReadDirectory(dp, ec);
         }
         directory_iterator(const files::path& dp, error_code& ec) __ntl_nothrow
-          :dp(dp), di(), base(), memsize()
+          :dp(dp)
         {
           error_code e;
           ReadDirectory(dp, e);
@@ -195,71 +246,78 @@ namespace std
             ec = e;
         }
         directory_iterator(const directory_iterator& r) __ntl_nothrow
-          :dp(r.dp), di(r.di), base(r.base), bdi(r.bdi), memsize(r.memsize)
+          :dp(r.dp), reader(r.reader), bdi(r.bdi)
         {
         }
         directory_iterator& operator=(const directory_iterator& r) __ntl_nothrow
         {
           dp = r.dp,
-          base = r.base,
-          di = r.di,
-          bdi = r.bdi,
-          memsize = r.memsize;
+          reader = r.reader,
+          bdi = r.bdi;
           return *this;
         }
         ~directory_iterator() __ntl_nothrow
         {}
 #ifdef NTL_CXX_RV
         explicit directory_iterator(files::path&& dp) __ntl_nothrow
-          :dp(forward<files::path>(dp)), di(), base(), memsize()
+          :dp(forward<files::path>(dp))
         {
           error_code ec;
-          ReadDirectory(dp, ec);
+          ReadDirectory(this->dp, ec);
         }
         directory_iterator(files::path&& dp, error_code& ec) __ntl_nothrow
-          :dp(forward<files::path>(dp)), di(), base(), memsize()
+          :dp(forward<files::path>(dp))
         {
           error_code e;
-          ReadDirectory(dp, e);
+          ReadDirectory(this->dp, e);
           if(&ec != &throws())
             ec = e;
         }
         directory_iterator(directory_iterator&& r) __ntl_nothrow
-          :di()
         {
           swap(r);
         }
         directory_iterator& operator=(directory_iterator&& r) __ntl_nothrow
         {
           dp = move(r.dp),
-            base = move(r.base),
-            di = r.di,
-            bdi = r.bdi,
-            memsize = r.memsize;
-          r.di = nullptr;
+            reader = move(r.reader),
+            bdi = r.bdi;
           return *this;
         }
 #endif
         void swap(directory_iterator& r)
         {
           dp.swap(r.dp);
-          base.swap(r.base);
-          std::swap(di,r.di);
+          reader.swap(r.reader);
           bdi.swap(r.bdi);
-          std::swap(memsize,r.memsize);
         }
 
 
 
         ///\name Input iterator operations
-        const directory_entry& operator*()  const { assert(di != nullptr); return bdi;  }
-        const directory_entry* operator->() const { assert(di != nullptr); return &bdi; }
+        const directory_entry& operator*()  const { assert(reader); return bdi;  }
+        const directory_entry* operator->() const { assert(reader); return &bdi; }
 
         directory_iterator& operator++()
         {
-          assert(di != nullptr);
-          di = step(di);
-          sync();
+          return increment(throws());
+        }
+
+        /** Advances to the next entry, the failed directory query is reported by \p ec (or thrown) and ends the iteration */
+        directory_iterator& increment(error_code& ec)
+        {
+          assert(reader);
+          reader->next();
+          const ntl::nt::ntstatus st = sync();
+          if(!ntl::nt::status::is_error(st)){
+            if(&ec != &throws())
+              ec.clear();
+          }else{
+            const error_code e = make_error_code(st);
+            if(&ec == &throws())
+              __ntl_throw(filesystem_error("Can't read directory", dp, e));
+            ec = e;
+          }
           return *this;
         }
         directory_iterator operator++(int)
@@ -270,12 +328,14 @@ namespace std
         }
 
         ///\name Comparsions
-        friend inline bool operator== (const directory_iterator& x, const directory_iterator& y) { return x.di == y.di; }
+        /** The copies of an iterator share the directory position, so the iterators are equal if they read the same directory */
+        friend inline bool operator== (const directory_iterator& x, const directory_iterator& y) { return x.reader == y.reader; }
         friend inline bool operator!= (const directory_iterator& x, const directory_iterator& y) { return !(x == y); }
         ///\}
 
 
       protected:
+        /** Opens the directory, its entries are read by the fixed-size chunks as the iterator advances */
         bool ReadDirectory(const files::path& dp, error_code& ec) __ntl_nothrow
         {
           ec.clear();
@@ -283,83 +343,24 @@ namespace std
             return false;
 
           using namespace ntl::nt;
-          file_handler f;
-          ntstatus st = f.open(const_unicode_string(native(dp)), file::generic_read, file::share_valid_flags, 
-            file::directory_file|file::open_for_backup_intent|file::synchronous_io_nonalert);
-          if(success(st)){
-            io_status_block iosb;
-            char* buf = nullptr;
-          #ifdef NTL_SUBSYSTEM_KM
-            static const uint32_t multiplier = 2;
-            memsize = (sizeof(file_directory_information)+32)*16; // ~32 files by default (~3KB), multiplies by 2
-          #else
-            static const uint32_t multiplier = 4;
-            memsize = (sizeof(file_directory_information)+32)*64; // 256 files by default (26KB), multiplies by 4
-          #endif
-            do{
-              delete[] buf;
-              buf = new (nothrow) char[ memsize *= multiplier ];
-              if(!buf){
-                ec = make_error_code(status::insufficient_resources);
-                return false;
-              }
-              st = ZwQueryDirectoryFile(f.get(), nullptr, nullptr, nullptr, &iosb, buf, memsize, FileDirectoryInformation, false, nullptr, true);
-              if(success(st)){
-                file_directory_information tmp;
-                io_status_block iosb;
-                st = ZwQueryDirectoryFile(f.get(), nullptr, nullptr, nullptr, &iosb, &tmp, sizeof(tmp), FileDirectoryInformation, false, nullptr, false);
-                if(st != status::no_more_files)
-                  st = status::buffer_overflow;
-              }
-            } while(st == status::buffer_overflow);
-
-            memsize = static_cast<uint32_t>(iosb.Information);
-            base.reset(di = reinterpret_cast<fdi_t*>(buf));
-          }
-          if(status::is_error(st))
+          reader.reset(new (nothrow) reader_t());
+          ntstatus st = reader ? reader->open(const_unicode_string(native(dp))) : status::insufficient_resources;
+          if(st == status::no_more_files)
+            st = status::success;
+          if(!status::is_error(st))
+            st = sync();
+          if(status::is_error(st)){
+            reader.reset();
             ec = make_error_code(st);
-          else
-            sync();
-          return !ec;
-        }
-        #if 0
-        void copy(const directory_iterator& bdi)
-        {
-          if(!bdi.base)
-            return;
-
-          memsize = bdi.memsize;
-          di = bdi.di;
-          
-          //difference_type idx = 0;
-          //for(fdi_t p = bdi.base.get(); p != bdi.di; p = step(p), idx++);
-
-          //base = reinterpret_cast<fdi_t>( new (nothrow) char[memsize = bdi.memsize] );
-          //if(!base)
-          //  return;
-
-          //memcpy((void*)base, bdi.base, memsize);
-
-          //for(difference_type n = 0; n < idx; n++)
-          //  di = step(di);
-        }
-        void free() __ntl_nothrow
-        {
-          if(base){
-            delete[] reinterpret_cast<const char*>(base);
-            base = di = nullptr;
-            memsize = 0;
           }
-        }
-        #endif
-        static fdi_t* step(fdi_t* p) __ntl_nothrow
-        {
-          return p->NextEntryOffset ? reinterpret_cast<fdi_t*>( uintptr_t(p) + p->NextEntryOffset ) : nullptr;
+          return !ec;
         }
 
-        void sync()
+        /** Loads the current entry, at the end of directory resets the reader and returns the status of the last query */
+        ntl::nt::ntstatus sync()
         {
           // skip the '.' and '..'
+          const ntl::nt::file_directory_information* di = reader->get();
           while(di && 
                 (
                   (di->FileNameLength == 2 && di->FileName[0] == '.') || 
@@ -367,12 +368,13 @@ namespace std
                 )
                )
           {
-            di = step(di);
+            di = reader->next();
           }
           if(!di){
-            base.reset();
+            const ntl::nt::ntstatus st = reader->last_status();
+            reader.reset();
             bdi.assign(files::path());
-            return;
+            return st == ntl::nt::status::no_more_files ? ntl::nt::status::success : st;
           }
           using ntl::nt::file_attribute;
           file_type ft = regular_file;
@@ -384,13 +386,12 @@ namespace std
             ft = device_file;
           const path_type p( ntl::nt::const_unicode_string(di->FileName, di->FileNameLength/sizeof(wchar_t)) );
           bdi.assign(dp / p, file_status(ft));
-          //bdi.assign(files::path::traits_type::to_internal(dp, files::path::external_string_type(di->FileName, di->FileNameLength/sizeof(wchar_t))), file_status(ft));
+          bdi.assign_info(*di);
+          return ntl::nt::status::success;
         }
 
       private:
-        shared_ptr<fdi_t> base;
-        fdi_t* di;
-        uint32_t memsize;
+        shared_ptr<reader_t> reader;
         value_type bdi;
         files::path dp;
       };
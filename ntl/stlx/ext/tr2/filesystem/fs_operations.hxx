@@ -10,6 +10,9 @@
 
 #include "../../../nt/file.hxx"
 #include "../../../nt/system_error.hxx"
+#ifndef NTL_SUBSYSTEM_KM
+# include "../../../nt/file_copy.hxx"
+#endif
 
 namespace std 
 {
@@ -309,6 +312,8 @@ namespace std
           using namespace NTL_SUBSYSTEM_NS;
           file_network_open_information fbi;
           ntstatus st = ZwQueryFullAttributesFile(const_unicode_string(p.external_file_string()), fbi);
+          if(success(st) && (fbi.FileAttributes & file_attribute::directory))
+            st = status::file_is_a_directory;
           if(success(st)){
             size = static_cast<uintmax_t>(fbi.EndOfFile);
           }else{
@@ -529,6 +534,10 @@ namespace std
             return;
 
           using namespace NTL_SUBSYSTEM_NS;
+#ifndef NTL_SUBSYSTEM_KM
+          // pipelined copy with the default buffers
+          ntstatus st = ntl::nt::copy_file(const_unicode_string(from_fp.external_file_string()), const_unicode_string(to_fp.external_file_string()));
+#else
           file_handler from, to;
           ntstatus st = from.open(const_unicode_string(from_fp.external_file_string()), file::generic_read, file::share_valid_flags, file::creation_options_default);
           if(success(st)){
@@ -539,6 +548,8 @@ namespace std
               int64_t size = from.size();
               while(size){
                 st = from.read(buf.begin(), buf_size);
+                if(!success(st))
+                  break;
                 size_t readed = from.get_io_status_block().Information;
                 st = to.write(buf.begin(), static_cast<uint32_t>(readed));
                 size -= readed;
@@ -547,6 +558,7 @@ namespace std
                 st = status::success;
             }
           }
+#endif
           if(!success(st)){
             error_code e = make_error_code(st);
             if(&ec == &throws())
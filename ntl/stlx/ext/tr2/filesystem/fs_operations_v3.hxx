@@ -11,6 +11,9 @@
 
 #include "../../../nt/file.hxx"
 #include "../../../nt/system_error.hxx"
+#ifndef NTL_SUBSYSTEM_KM
+# include "../../../nt/file_copy.hxx"
+#endif
 
 namespace std 
 {
@@ -140,6 +140,10 @@ namespace std
           return;
 
         using namespace NTL_SUBSYSTEM_NS;
+#ifndef NTL_SUBSYSTEM_KM
+        // pipelined copy with the default buffers
+        ntstatus st = ntl::nt::copy_file(const_unicode_string(native(from_fp)), const_unicode_string(native(to_fp)));
+#else
         file_handler from, to;
         ntstatus st = from.open(const_unicode_string(native(from_fp)), file::generic_read, file::share_valid_flags, file::creation_options_default);
         if(success(st)){
@@ -149,7 +153,9 @@ namespace std
             ntl::raw_data buf(buf_size); // 64k
             int64_t size = from.size();
             while(size){
-              from.read(buf.begin(), buf_size);
+              st = from.read(buf.begin(), buf_size);
+              if(!success(st))
+                break;
               size_t readed = from.get_io_status_block().Information;
               st = to.write(buf.begin(), static_cast<uint32_t>(readed));
               size -= readed;
@@ -158,6 +164,7 @@ namespace std
               st = status::success;
           }
         }
+#endif
         if(!success(st)){
           error_code e = make_error_code(st);
           if(&ec == &throws())
@@ -181,6 +188,8 @@ namespace std
         using namespace NTL_SUBSYSTEM_NS;
         file_network_open_information fbi;
         ntstatus st = ZwQueryFullAttributesFile(const_unicode_string(native(p)), fbi);
+        if(success(st) && (fbi.FileAttributes & file_attribute::directory))
+          st = status::file_is_a_directory;
         return !__::throw_files_error(ec, st, "Can't get file size", p) ? 0 : static_cast<uintmax_t>(fbi.EndOfFile);
       }
 
@@ -292,6 +292,400 @@ namespace std { namespace tr2 { namespace sys {
   /** Typedef for the typical usage of basic_fifobuf. */
   typedef basic_fifobuf<> fifobuf, streambuf;
 
+  /**
+   *  @brief Pool of the fixed-size blocks of the basic_segmented_fifobuf
+   *
+   *  Keeps up to \c max_cached released blocks for the reuse, so the streaming buffer doesn't allocate in the steady state.
+   *  The pool can be shared by several buffers used by the same thread, it is not thread-safe.
+   **/
+  template<class Allocator = std::allocator<char> >
+  class basic_block_pool
+    : ntl::noncopyable
+  {
+  public:
+    typedef Allocator allocator_type;
+
+    /** Block header, followed by the block data */
+    struct block
+    {
+      block* next;
+
+      char* data() { return reinterpret_cast<char*>(this + 1); }
+      const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+    };
+
+    static const size_t default_block_size = 16*1024;
+
+    explicit basic_block_pool(size_t block_size = default_block_size, size_t max_cached = 64, const Allocator& alloc = Allocator())
+      : alloc_(alloc)
+      , free_()
+      , cached_()
+      , block_size_(block_size ? block_size : 1)
+      , max_cached_(max_cached)
+    {}
+
+    ~basic_block_pool()
+    {
+      while(free_) {
+        block* b = free_;
+        free_ = b->next;
+        deallocate(b);
+      }
+    }
+
+    allocator_type get_allocator() const { return alloc_; }
+
+    size_t block_size() const { return block_size_; }
+
+    /** Takes the cached block or allocates the new one */
+    block* get() __ntl_throws(bad_alloc)
+    {
+      block* b = free_;
+      if(b) {
+        free_ = b->next;
+        cached_--;
+      } else {
+        b = reinterpret_cast<block*>(alloc_.allocate(sizeof(block) + block_size_));
+      }
+      b->next = nullptr;
+      return b;
+    }
+
+    /** Returns the block to the cache or frees it if the cache is full */
+    void put(block* b)
+    {
+      if(cached_ < max_cached_) {
+        b->next = free_;
+        free_ = b;
+        cached_++;
+      } else {
+        deallocate(b);
+      }
+    }
+
+  private:
+    void deallocate(block* b)
+    {
+      alloc_.deallocate(reinterpret_cast<char*>(b), sizeof(block) + block_size_);
+    }
+
+  private:
+    Allocator alloc_;
+    block* free_;
+    size_t cached_;
+    const size_t block_size_, max_cached_;
+  };
+
+  typedef basic_block_pool<> block_pool;
+
+
+  /**
+   *  @brief Buffer sequence over the chain of the fixed-size blocks
+   *
+   *  Yields one buffer per block, so the data spread over several blocks is passed to the vectored I/O
+   *  (such as \c WSASend) as is. The sequence refers to the blocks and is invalidated with them.
+   **/
+  template<class Buffer, class Block>
+  class segmented_buffers
+  {
+  public:
+    // types:
+    typedef Buffer value_type;
+
+    class const_iterator:
+      public std::iterator<forward_iterator_tag, Buffer, ptrdiff_t, const Buffer*, Buffer>
+    {
+    public:
+      const_iterator()
+        : b(), off(), rest(), bs()
+      {}
+
+      const_iterator(Block* b, size_t off, size_t rest, size_t bs)
+        : b(b), off(off), rest(rest), bs(bs)
+      {}
+
+      value_type operator*() const { return value_type(b->data() + off, length()); }
+
+      const_iterator& operator++()
+      {
+        rest -= length();
+        b = b->next;
+        off = 0;
+        return *this;
+      }
+
+      const_iterator operator++(int)
+      {
+        const_iterator tmp(*this);
+        ++*this;
+        return tmp;
+      }
+
+      // every step consumes at least one byte, so the rest identifies the position
+      friend bool operator==(const const_iterator& x, const const_iterator& y) { return x.rest == y.rest; }
+      friend bool operator!=(const const_iterator& x, const const_iterator& y) { return x.rest != y.rest; }
+
+    private:
+      size_t length() const { return std::min(bs - off, rest); }
+
+      Block* b;
+      size_t off, rest, bs;
+    };
+
+    // constructors:
+    segmented_buffers()
+      : first(), off(), size_(), bs()
+    {}
+
+    /** The sequence of \p size bytes starting at the offset \p off of the block \p first */
+    segmented_buffers(Block* first, size_t off, size_t size, size_t block_size)
+      : first(first), off(off), size_(size), bs(block_size)
+    {
+      if(size_ && off == bs) {
+        this->first = first->next;
+        this->off = 0;
+      }
+    }
+
+    // members:
+    const_iterator begin() const { return const_iterator(first, off, size_, bs); }
+    const_iterator end()   const { return const_iterator(nullptr, 0, 0, bs); }
+
+    /** Total size of the buffers */
+    size_t size() const { return size_; }
+
+    friend size_t buffer_size(const segmented_buffers& b) __ntl_nothrow { return b.size_; }
+
+  private:
+    Block* first;
+    size_t off, size_, bs;
+  };
+
+
+  /**
+   *  @brief Class template basic_segmented_fifobuf
+   *
+   *  The basic_fifobuf which stores the character sequence in the chain of the fixed-size blocks taken from the block pool.
+   *  The written data is never moved: the output sequence grows by the appending of the blocks and the consumed blocks are
+   *  returned to the pool. The data() and prepare() return the multi-element buffer sequences, one buffer per block,
+   *  which are passed to the vectored socket and file I/O without the coalescing copies.
+   **/
+  template<class Allocator = std::allocator<char> >
+  class basic_segmented_fifobuf
+    : public std::streambuf
+    , ntl::noncopyable
+  {
+  public:
+    // types:
+    typedef Allocator                             allocator_type;
+    typedef basic_block_pool<Allocator>           pool_type;
+    typedef typename pool_type::block             block;
+    typedef segmented_buffers<const_buffer, block>    const_buffers_type;
+    typedef segmented_buffers<mutable_buffer, block>  mutable_buffers_type;
+
+  public:
+    // constructors:
+    explicit basic_segmented_fifobuf(size_t max_sz = numeric_limits<size_t>::max(), const Allocator& alloc = Allocator())
+      : pool(*new (&own_pool) pool_type(pool_type::default_block_size, 4, alloc))
+      , head(), pblock(), tail(), middle(), prepared(), max_size_(max_sz)
+    {}
+
+    /** Takes the blocks from the shared \p pool, the own one is not constructed */
+    explicit basic_segmented_fifobuf(pool_type& pool, size_t max_sz = numeric_limits<size_t>::max())
+      : pool(pool)
+      , head(), pblock(), tail(), middle(), prepared(), max_size_(max_sz)
+    {}
+
+    ~basic_segmented_fifobuf()
+    {
+      while(head) {
+        block* b = head;
+        head = b->next;
+        pool.put(b);
+      }
+      if(&pool == reinterpret_cast<pool_type*>(&own_pool))
+        pool.~pool_type();
+    }
+
+    // members:
+    allocator_type get_allocator() const { return pool.get_allocator(); }
+
+    size_t size() const
+    {
+      if(!head)
+        return 0;
+      if(head == pblock)
+        return pptr() - gptr();
+      return (head->data() + block_size() - gptr()) + middle * block_size() + (pptr() - pblock->data());
+    }
+
+    size_t max_size() const { return max_size_; }
+
+    size_t block_size() const { return pool.block_size(); }
+
+    const_buffers_type data() const
+    {
+      return head ? const_buffers_type(head, gptr() - head->data(), size(), block_size()) : const_buffers_type();
+    }
+
+    /** Ensures that the output sequence can accommodate n characters, appending the blocks as necessary. */
+    mutable_buffers_type prepare(size_t n) __ntl_throws(length_error)
+    {
+      if(n > max_size_ - size())
+        __throw_length_error(__func__": `n` too large");
+      if(!head)
+        init();
+      reset_if_empty();
+
+      size_t capacity = epptr() - pptr();
+      for(const block* b = pblock->next; b; b = b->next)
+        capacity += block_size();
+      for(; capacity < n; capacity += block_size()) {
+        tail->next = pool.get();
+        tail = tail->next;
+      }
+      prepared = n;
+      return mutable_buffers_type(pblock, pptr() - pblock->data(), n, block_size());
+    }
+
+    /** Appends \p n characters from the start of the output sequence to the input sequence. The beginning of the output sequence is advanced by \p n characters. */
+    void commit(size_t n)
+    {
+      if(!head)
+        return;
+      if(n > prepared)
+        n = prepared;
+      prepared = 0;
+      while(n) {
+        const size_t avail = epptr() - pptr();
+        if(n <= avail) {
+          pbump(static_cast<int>(n));
+          break;
+        }
+        n -= avail;
+        next_put_block();
+      }
+      sync_get();
+    }
+
+    /** Removes \p n characters from the beginning of the input sequence. The consumed blocks are returned to the pool. */
+    void consume(size_t n)
+    {
+      if(!head)
+        return;
+      prepared = 0;
+      for(;;) {
+        sync_get();
+        const size_t avail = egptr() - gptr();
+        if(n < avail || head == pblock) {
+          gbump(static_cast<int>(std::min(n, avail)));
+          break;
+        }
+        n -= avail;
+        release_head();
+      }
+      reset_if_empty();
+    }
+
+  protected:
+    // overridden virtual functions:
+    virtual int_type underflow() override
+    {
+      if(!head)
+        return traits_type::eof();
+      for(;;) {
+        sync_get();
+        if(gptr() < egptr())
+          return traits_type::to_int_type(*gptr());
+        if(head == pblock)
+          return traits_type::eof();
+        release_head();
+      }
+    }
+
+    virtual int_type overflow(int_type c = traits_type::eof()) override
+    {
+      if(traits_type::eq_int_type(c, traits_type::eof()))
+        return traits_type::not_eof(c);
+      if(size() >= max_size_)
+        return traits_type::eof();
+
+      prepared = 0;
+      if(!head)
+        init();
+      if(pptr() == epptr()) {
+        reset_if_empty();
+        if(pptr() == epptr())
+          next_put_block();
+      }
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+      sync_get();
+      return c;
+    }
+
+  private:
+    void init()
+    {
+      head = pblock = tail = pool.get();
+      middle = 0;
+      char* const p = head->data();
+      setg(p, p, p);
+      setp(p, p + block_size());
+    }
+
+    /** The get area ends at the end of the first block or at the put position if it is in the same block */
+    void sync_get()
+    {
+      setg(head->data(), gptr(), head == pblock ? pptr() : head->data() + block_size());
+    }
+
+    /** Moves the put area to the next block, appending it if needed */
+    void next_put_block()
+    {
+      if(pblock == tail) {
+        tail->next = pool.get();
+        tail = tail->next;
+      }
+      if(pblock != head)
+        middle++;
+      pblock = pblock->next;
+      setp(pblock->data(), pblock->data() + block_size());
+    }
+
+    void release_head()
+    {
+      block* const b = head;
+      head = b->next;
+      if(head != pblock)
+        middle--;
+      pool.put(b);
+      setg(head->data(), head->data(), head->data());
+    }
+
+    /** Rewinds the empty buffer to the start of its block */
+    void reset_if_empty()
+    {
+      if(head == pblock && gptr() == pptr()) {
+        char* const p = head->data();
+        setg(p, p, p);
+        setp(p, p + block_size());
+      }
+    }
+
+  private:
+    typename aligned_storage<sizeof(pool_type), alignof(pool_type)>::type own_pool; // constructed by the default constructor only
+    pool_type& pool;
+    block *head, *pblock, *tail;  // the first block, the block of the put position and the last prepared one
+    size_t middle;                // number of the blocks between the head and the pblock
+    size_t prepared;
+    size_t max_size_;
+  };
+
+  /** Typedef for the typical usage of basic_segmented_fifobuf. */
+  typedef basic_segmented_fifobuf<> segmented_fifobuf;
+
+
 
   /**
    *	@brief 5.5.9. Class transfer_all
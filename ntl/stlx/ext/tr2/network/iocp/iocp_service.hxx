@@ -2,6 +2,7 @@
 
 #include <nt/iocp.hxx>
 #include <nt/event.hxx>
+#include <nt/timer.hxx>
 #include <nt/thread.hxx>
 #include <nt/srwlock.hxx>
 #include <nt/system_error.hxx>
@@ -23,22 +24,11 @@ namespace std { namespace tr2 { namespace sys {
     typedef __::async_operation async_operation;
     typedef __::timer_scheduler::timer_data timer_data;
     typedef ntl::nt::overlapped overlapped;
-    
-    // sort by time, unique by handle
-    typedef std::vector<timer_data> timer_queue; // can't use std::priority_queue because of erase(timer)
+    typedef __::timer_wheel::tick_type tick_type;
+
+    // timer wheel resolution
+    typedef std::chrono::milliseconds timer_tick;
 
-    struct find_timer
-    {
-      ntl::nt::legacy_handle h;
-      bool operator()(const timer_queue::value_type& t) const
-      {
-        return h == t.h;
-      }
-      explicit find_timer(ntl::nt::legacy_handle h)
-        : h(h)
-      {}
-    };
-    
     // system codes
     static const ntl::nt::ntstatus
       stop_service_code   = ntl::nt::status::system_shutdown,
@@ -51,7 +41,10 @@ namespace std { namespace tr2 { namespace sys {
     explicit iocp_service(io_service& ios)
       : service(ios)
       , timer_event(ntl::nt::SynchronizationEvent)
+      , wheel_timer(ntl::nt::timer::SynchronizationTimer)
       , timer_thread(&iocp_service::timer_proc, this, true) // create_suspended
+      , timers(to_ticks(system_now()))
+      , armed_tick(~tick_type(0))
       , scheduler(use_service<__::timer_scheduler>(ios))
       , self_id()
     {
@@ -172,51 +165,56 @@ namespace std { namespace tr2 { namespace sys {
         : std::make_error_code(st);
     }
 
-    size_t add_timer(const void* timer, const timer_data* data)
+    size_t add_timer(timer_data* timer)
     {
-      if(!data)
-        return remove_timer(timer);
-
       if(shutdown.test()) {
-        post_immediate_completion(data->op);
+        post_immediate_completion(timer->op);
         return false;
       }
 
       work_started();
 
-      wlock lock(timer_lock);
-      const ntl::nt::legacy_handle t = reinterpret_cast<ntl::nt::legacy_handle>(timer);
-      timer_queue::iterator tm = std::find_if(timers.begin(), timers.end(), find_timer(t));
-      if(tm != timers.end()) {
-        timers.erase(tm);
+      // round up: the timer must not fire before its time
+      const tick_type due = to_ticks(timer->fire + timer_tick(1) - ntl::nt::system_duration(1));
+      bool wake;
+      {
+        wlock lock(timer_lock);
+        timers.schedule(*timer, due);
+        // wake up the thread only if the new timer is earlier than the armed one;
+        // the armed tick is left to the thread which sets the kernel timer to it
+        wake = due < armed_tick;
       }
-      timers.push_back(*data);
-      timer_event.set();
+      if(wake)
+        timer_event.set();
       timer_thread.resume();
       return true;
     }
 
-    size_t remove_timer(const void* timer)
+    size_t remove_timer(timer_data* timer)
     {
       if(shutdown.test())
         return 0;
 
-      wlock lock(timer_lock);
-      const ntl::nt::legacy_handle t = reinterpret_cast<ntl::nt::legacy_handle>(timer);
-      timer_queue::iterator tm = std::find_if(timers.begin(), timers.end(), find_timer(t));
-      if(tm != timers.end()) {
-        async_operation* op = tm->op;
-        timers.erase(tm);
+      {
+        wlock lock(timer_lock);
+        if(!timers.cancel(*timer))
+          return 0;
+      }
+      // the armed wakeup becomes spurious, the thread just recalculates it
 
-        // wake up thread to recalculate timers
-        timer_event.set();
+      // complete handler with aborted code
+      on_completion(timer->op, std::make_error_code(std::tr2::network::error::operation_aborted));
+      return 1;
+    }
 
-        // complete handler with aborted code
-        on_completion(op, std::make_error_code(std::tr2::network::error::operation_aborted));
+    static ntl::nt::system_duration system_now()
+    {
+      return std::chrono::duration_cast<ntl::nt::system_duration>(std::chrono::system_clock::now().time_since_epoch());
+    }
 
-        return 1;
-      }
-      return 0;
+    static tick_type to_ticks(const ntl::nt::system_duration& d)
+    {
+      return static_cast<tick_type>(std::chrono::duration_cast<timer_tick>(d).count());
     }
 
   public:
@@ -355,52 +353,54 @@ namespace std { namespace tr2 { namespace sys {
 
     static uint32_t __stdcall timer_proc(void* Parameter)
     { return static_cast<iocp_service*>(Parameter)->timer_worker(); }
-    static size_t add_timer_(void* ctx, const void* timer, const timer_data* data)
-    { return static_cast<iocp_service*>(ctx)->add_timer(timer, data); }
+    static size_t add_timer_(void* ctx, timer_data* timer, bool schedule)
+    {
+      iocp_service* self = static_cast<iocp_service*>(ctx);
+      return schedule ? self->add_timer(timer) : self->remove_timer(timer);
+    }
+
+    struct fire_timer
+    {
+      iocp_service* self;
+      void operator()(__::timer_wheel::node& n) const
+      {
+        self->post_deferred_completion(static_cast<timer_data&>(n).op);
+      }
+    };
 
     uint32_t __stdcall timer_worker()
     {
       using namespace ntl::nt;
       ntl::nt::this_thread::setname("iocp::timer_proc");
 
-      uint32_t count;
-      legacy_handle handles[2] = { timer_event.get() };
+      const legacy_handle handles[2] = { timer_event.get(), wheel_timer.get() };
+      ntstatus woken = status::wait_0;
 
       do {
-
-        timer_data first;
         {
-          count = 1;
+          // fire the expired timers and arm the kernel timer for the next wheel event
           wlock lock(timer_lock);
-          if(!timers.empty()) {
-            // remove the last timer now to eliminate a possible concurrent change when fired
-            if(timers.size() > 1)
-              std::sort(timers.begin(), timers.end(), std::greater<timer_queue::value_type>());
-            first = timers.back();
-            //timers.pop_back();
-            handles[count++] = first.h;
-          }
-        }
-
-        ntstatus st = NtWaitForMultipleObjects(count, handles, wait_type::WaitAny, false, infinite_timeout());
-        if(st == ntl::nt::status::wait_0) {
-          // queue was changed
-          continue;
-        }
-        else if(st == status::wait_1) {
-          // timer fired
-          wlock lock(timer_lock);
-          timer_queue::iterator tm = std::find_if(timers.begin(), timers.end(), find_timer(first.h));
-          if(tm != timers.end()) {
-            // fired and not erased yet
-            timers.erase(tm);
-            post_deferred_completion(first.op);
+          if(woken != status::wait_0)
+            // the kernel timer is spent, even if the clock has not reached its tick yet
+            armed_tick = ~tick_type(0);
+          const fire_timer fire = { this };
+          timers.advance(to_ticks(system_now()), fire);
+
+          tick_type next;
+          if(timers.next_expiry(next)) {
+            if(next != armed_tick) {
+              const std::chrono::system_clock::time_point due(std::chrono::duration_cast<std::chrono::system_clock::duration>(timer_tick(next)));
+              wheel_timer.set(due, nullptr, nullptr);
+              armed_tick = next;
+            }
           } else {
-            // if erased, operation_aborted will be sent 
-            first.h = 0;
+            armed_tick = ~tick_type(0);
           }
         }
 
+        // wait_0: the wheel was changed, wait_1: the next wheel event is due
+        woken = NtWaitForMultipleObjects(_countof(handles), handles, wait_type::WaitAny, false, infinite_timeout());
+
       } while(shutdown.test(false));
 
       ntl::nt::this_thread::exit(status::success);
@@ -413,10 +413,12 @@ namespace std { namespace tr2 { namespace sys {
     ntl::nt::legacy_handle volatile self_id;
     
     // timers
+    ntl::nt::user_event timer_event;
+    ntl::nt::timer wheel_timer;     // the single kernel timer of the service
     ntl::nt::user_thread timer_thread;
     ntl::nt::srwlock timer_lock;
-    ntl::nt::user_event timer_event;
-    timer_queue timers;
+    __::timer_wheel timers;
+    tick_type armed_tick;           // the wheel tick the wheel_timer is set to
     typedef ntl::nt::srwlock::guard<false> rlock;
     typedef ntl::nt::srwlock::guard<true>  wlock;
   };
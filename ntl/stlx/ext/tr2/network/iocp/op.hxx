@@ -1,5 +1,7 @@
 #pragma once
 
+#include "timer_wheel.hxx"
+
 namespace std { namespace tr2 { namespace sys {
 
   namespace iocp
@@ -20,26 +22,33 @@ namespace std { namespace tr2 { namespace sys {
         , ctx()
       {}
 
-      struct timer_data 
+      /** Timer state, embedded into the timer implementation and linked into the service timer wheel */
+      struct timer_data:
+        timer_wheel::node
       {
-        ntl::nt::legacy_handle h;
         async_operation* op;
         ntl::nt::system_duration fire;
+
+        timer_data()
+          : op()
+        {}
       };
 
-      typedef size_t add_timer_t(void* ctx, const void* timer, const timer_data* data);
+      typedef size_t add_timer_t(void* ctx, timer_data* timer, bool schedule);
 
-      void add_timer(const void* timer, const timer_data* data)
+      /** Arms the \p timer to complete its operation at the \c fire time */
+      void add_timer(timer_data* timer)
       {
         assert(handler);
         if(handler)
-          handler(ctx, timer, data);
+          handler(ctx, timer, true);
       }
 
-      size_t remove_timer(const void* timer)
+      /** Disarms the \p timer and completes its operation with the \c operation_aborted error */
+      size_t remove_timer(timer_data* timer)
       {
         assert(handler);
-        return handler ? handler(ctx, timer, nullptr) : 0;
+        return handler ? handler(ctx, timer, false) : 0;
       }
 
 
@@ -188,25 +197,3 @@ namespace std { namespace tr2 { namespace sys {
   } // __ ns
 
 }}}
-
-namespace std
-{
-  template<>
-  struct less<std::tr2::sys::__::timer_scheduler::timer_data>
-  {
-    typedef std::tr2::sys::__::timer_scheduler::timer_data T;
-    bool operator()(const T& x, const T& y) const
-    {
-      return x.fire < y.fire;
-    }
-  };
-  template<>
-  struct greater<std::tr2::sys::__::timer_scheduler::timer_data>
-  {
-    typedef std::tr2::sys::__::timer_scheduler::timer_data T;
-    bool operator()(const T& x, const T& y) const
-    {
-      return x.fire > y.fire;
-    }
-  };
-}
@@ -0,0 +1,233 @@
+#pragma once
+
+namespace std { namespace tr2 { namespace sys {
+
+  namespace __
+  {
+    /**
+     *	@brief Hierarchical timer wheel
+     *
+     *  Timers are intrusive nodes kept in the slots of \c levels wheels of 64 slots each: the level \e L slot
+     *  holds the timers which expire in the 64<sup>L</sup> tick long block with that index, so arming and
+     *  cancelling a timer is O(1). When the time reaches the block of a higher level slot, its timers are moved
+     *  ("cascaded") to the lower levels, and the level 0 slots are fired tick by tick.
+     *  Each level keeps a bitmap of non-empty slots, so advance() and next_expiry() skip the empty slots
+     *  instead of walking every tick.
+     *
+     *  Timers beyond the wheel range (64<sup>levels</sup> ticks) are parked in the top level and re-examined
+     *  on every its turn. The wheel is not synchronized.
+     **/
+    class timer_wheel
+    {
+      timer_wheel(const timer_wheel&) __deleted;
+      timer_wheel& operator=(const timer_wheel&) __deleted;
+
+      static const unsigned slot_bits = 6;
+      static const unsigned slots = 1 << slot_bits;
+      static const unsigned slot_mask = slots - 1;
+
+    public:
+      static const unsigned levels = 5;
+
+      typedef uint64_t tick_type;
+
+      /** Timer node, embedded into the timer object */
+      struct node
+      {
+        node* prev;
+        node* next;
+        tick_type expires;
+
+        node()
+          :prev(), next(), expires()
+        {}
+
+        bool linked() const { return next != nullptr; }
+
+      private:
+        friend class timer_wheel;
+        uint8_t level, slot;
+      };
+
+      explicit timer_wheel(tick_type now = 0)
+        :now(now), count(0)
+      {
+        for(unsigned l = 0; l < levels; ++l){
+          occupied[l] = 0;
+          for(unsigned s = 0; s < slots; ++s)
+            wheel[l][s].prev = wheel[l][s].next = &wheel[l][s];
+        }
+      }
+
+      /** The last processed tick */
+      tick_type current() const { return now; }
+
+      size_t size() const { return count; }
+      bool empty() const { return count == 0; }
+
+      /** Arms (or re-arms) the timer \p n to fire at the \p expires tick, the overdue timers fire on the next tick */
+      void schedule(node& n, tick_type expires)
+      {
+        if(n.linked())
+          unlink(n);
+        else
+          ++count;
+        n.expires = expires;
+        insert(n, expires > now ? expires : now + 1);
+      }
+
+      /** Disarms the timer \p n, returns false if it was not armed */
+      bool cancel(node& n)
+      {
+        if(!n.linked())
+          return false;
+        unlink(n);
+        --count;
+        return true;
+      }
+
+      /**
+       *  Returns the next tick at which advance() has something to do: the expiration of the earliest level 0 timer
+       *  or the cascade of a higher level slot (which is not later than the expiration of any timer in it).
+       *  @return false if the wheel is empty
+       **/
+      bool next_expiry(tick_type& t) const
+      {
+        if(!count)
+          return false;
+        t = next_event();
+        return true;
+      }
+
+      /**
+       *  Advances the wheel to the tick \p to, calling \p expired for every timer which expires no later than \p to.
+       *  The timer is unlinked before the call, so the callback may re-arm it or manipulate other timers.
+       *  @return the number of timers fired
+       **/
+      template<class Callback>
+      size_t advance(tick_type to, Callback expired)
+      {
+        size_t fired = 0;
+        while(now < to){
+          if(!count){
+            now = to;
+            break;
+          }
+          const tick_type next = next_event();
+          if(next > to){
+            now = to;
+            break;
+          }
+          now = next;
+
+          // move the timers of the started blocks down, level by level
+          for(unsigned l = 1; l < levels && (now & ((tick_type(1) << (l*slot_bits)) - 1)) == 0; ++l)
+            cascade(l, static_cast<unsigned>(now >> (l*slot_bits)) & slot_mask);
+
+          node& head = wheel[0][now & slot_mask];
+          while(head.next != &head){
+            node& n = *head.next;
+            unlink(n);
+            --count;
+            ++fired;
+            expired(n);
+          }
+        }
+        return fired;
+      }
+
+    private:
+      /** Links the timer into the slot of the \p at tick, which is not earlier than \c now */
+      void insert(node& n, tick_type at)
+      {
+        unsigned level = 0;
+        const tick_type delta = at - now;
+        while(level < levels - 1 && delta >= (tick_type(1) << ((level+1)*slot_bits)))
+          ++level;
+        // park the far timers at the top level, they will be re-inserted on its turn
+        if(level == levels - 1 && (delta >> (levels*slot_bits)) != 0)
+          at = now + (tick_type(1) << (levels*slot_bits)) - 1;
+        const unsigned slot = static_cast<unsigned>(at >> (level*slot_bits)) & slot_mask;
+        node& head = wheel[level][slot];
+        n.level = static_cast<uint8_t>(level);
+        n.slot = static_cast<uint8_t>(slot);
+        n.prev = head.prev;
+        n.next = &head;
+        head.prev->next = &n;
+        head.prev = &n;
+        occupied[level] |= uint64_t(1) << slot;
+      }
+
+      void unlink(node& n)
+      {
+        n.prev->next = n.next;
+        n.next->prev = n.prev;
+        n.prev = n.next = nullptr;
+        const node& head = wheel[n.level][n.slot];
+        if(head.next == &head)
+          occupied[n.level] &= ~(uint64_t(1) << n.slot);
+      }
+
+      void cascade(unsigned level, unsigned slot)
+      {
+        node& head = wheel[level][slot];
+        if(head.next == &head)
+          return;
+        // detach the whole list first: the timers may be re-inserted into the same slot
+        node* first = head.next;
+        head.prev->next = nullptr;
+        head.prev = head.next = &head;
+        occupied[level] &= ~(uint64_t(1) << slot);
+        while(first){
+          node& n = *first;
+          first = n.next;
+          insert(n, n.expires);
+        }
+      }
+
+      /** The earliest tick after \c now at which one of the occupied slots is due */
+      tick_type next_event() const
+      {
+        tick_type best = ~tick_type(0);
+        for(unsigned l = 0; l < levels; ++l){
+          if(!occupied[l])
+            continue;
+          // the first occupied slot after the current block of this level
+          const unsigned shift = l*slot_bits;
+          const tick_type block = (now >> shift) + 1;
+          const unsigned distance = first_set(rotate(occupied[l], static_cast<unsigned>(block) & slot_mask));
+          const tick_type t = (block + distance) << shift;
+          if(t < best)
+            best = t;
+        }
+        return best;
+      }
+
+      /** Rotates the bitmap right so the bit \p n becomes the bit 0 */
+      static uint64_t rotate(uint64_t bits, unsigned n)
+      {
+        return n ? (bits >> n) | (bits << (slots - n)) : bits;
+      }
+
+      static unsigned first_set(uint64_t bits)
+      {
+        unsigned n = 0;
+        if(!(bits & 0xFFFFFFFF)) bits >>= 32, n += 32;
+        if(!(bits & 0xFFFF)) bits >>= 16, n += 16;
+        if(!(bits & 0xFF)) bits >>= 8, n += 8;
+        if(!(bits & 0xF)) bits >>= 4, n += 4;
+        if(!(bits & 0x3)) bits >>= 2, n += 2;
+        if(!(bits & 0x1)) n += 1;
+        return n;
+      }
+
+    private:
+      tick_type now;
+      size_t    count;
+      uint64_t  occupied[levels];
+      node      wheel[levels][slots];
+    };
+
+  } // __ ns
+
+}}}
@@ -57,25 +57,9 @@ namespace std { namespace tr2 { namespace sys {
     struct implementation_type:
       private ntl::noncopyable
     {
-      ntl::nt::timer  tm;
+      // no kernel object per timer: the io_service arms its timer wheel on async_wait
+      __::timer_scheduler::timer_data data;
       Time            tp;
-
-      implementation_type()
-        :tm(tm.manual_reset)
-      {}
-
-      bool reset(const Time& t)
-      {
-        tp = t;
-        return tm.set(t, nullptr, this);
-      }
-    private:
-      static void __stdcall routine(void* ctx, uint32_t, int32_t)
-      {
-        implementation_type* self = reinterpret_cast<implementation_type*>(ctx);
-        if(self->handler)
-          self->handler(error_code()); // error_code = success
-      }
     };
 
 
@@ -102,7 +86,6 @@ namespace std { namespace tr2 { namespace sys {
     {
       error_code ec;
       cancel(impl, ec);
-      impl.tm.reset();
     }
 
     /**  Causes any outstanding asynchronous wait operations to complete as soon as possible. Handlers for 
@@ -110,10 +93,7 @@ namespace std { namespace tr2 { namespace sys {
     size_t cancel(implementation_type& impl, error_code& ec) __ntl_nothrow
     {
       ec.clear();
-      size_t c = scheduler.remove_timer(impl.tm.get());
-      if(!impl.tm.cancel())
-        ec = std::make_error_code(impl.tm.last_status());
-      return c;
+      return scheduler.remove_timer(&impl.data);
     }
 
     /** Returns the expiry time associated with the timer implementation impl */
@@ -124,8 +104,7 @@ namespace std { namespace tr2 { namespace sys {
     size_t expires_at(implementation_type& impl, const time_type& t, error_code& ec) __ntl_nothrow
     {
       const size_t c = cancel(impl, ec);
-      if(!impl.reset(t))
-        ec = std::make_error_code(impl.tm.last_status());
+      impl.tp = t;
       return c;
     }
 
@@ -140,8 +119,7 @@ namespace std { namespace tr2 { namespace sys {
     size_t expires_from_now(implementation_type& impl, const duration_type& d, error_code& ec) __ntl_nothrow
     {
       const size_t c = cancel(impl, ec);
-      if(!impl.reset(traits_type::add(traits_type::now(), d)))
-        ec = std::make_error_code(impl.tm.last_status());
+      impl.tp = traits_type::add(traits_type::now(), d);
       return c;
     }
 
@@ -149,7 +127,7 @@ namespace std { namespace tr2 { namespace sys {
     error_code wait(implementation_type& impl, error_code& ec) __ntl_nothrow
     {
       using namespace ntl::nt;
-      ntstatus st = NtWaitForSingleObject(impl.tm.get(), true, infinite_timeout());
+      ntstatus st = NtDelayExecution(true, std::chrono::duration_cast<system_duration>(impl.tp.time_since_epoch()).count());
       if(success(st))
         ec.clear();
       else
@@ -158,15 +136,19 @@ namespace std { namespace tr2 { namespace sys {
     }
 
     /**  Initiates an asynchronous wait operation that is performed via the io_service object returned by 
-      get_io_service() and behaves according to asynchronous operation requirements.  */
+      get_io_service() and behaves according to asynchronous operation requirements.
+      The outstanding wait of \p impl is completed with \c operation_aborted first.  */
     template<class WaitHandler>
     void async_wait(implementation_type& impl, WaitHandler handler)
     {
       typedef __::wait_operation<WaitHandler> op;
       typename op::ptr p (handler);
 
-      const __::timer_scheduler::timer_data data = { impl.tm.get(), p.op, std::chrono::duration_cast<ntl::nt::system_duration>(impl.tp.time_since_epoch()) };
-      scheduler.add_timer(data.h, &data);
+      // the pending wait is aborted under the timer lock: the timer thread reads op only while the timer is linked
+      scheduler.remove_timer(&impl.data);
+      impl.data.op = p.op;
+      impl.data.fire = std::chrono::duration_cast<ntl::nt::system_duration>(impl.tp.time_since_epoch());
+      scheduler.add_timer(&impl.data);
       p.release();
     }
 
@@ -0,0 +1,755 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Class templates flat_map and flat_multimap
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__STLX_FLAT_MAP
+#define NTL__STLX_FLAT_MAP
+#pragma once
+
+#include "stdexcept_fwd.hxx"
+#include "algorithm.hxx"
+#include "ext/flat_tree.hxx"
+
+namespace std {
+
+/**\addtogroup  lib_containers
+  *@{
+  **/
+
+/**\addtogroup  lib_associative
+  *@{
+  **/
+
+  namespace __
+  {
+    /**
+     *	@brief Common part of the flat_map and flat_multimap
+     *
+     *  The keys and the mapped values are kept in two sorted random access containers, the element \c i
+     *  is the pair of <tt>keys()[i]</tt> and <tt>values()[i]</tt>. The lookup searches the keys only, so it walks
+     *  the contiguous memory instead of the tree nodes. The insertion and the erasure move the tail of the
+     *  containers and invalidate the iterators; the range is inserted by the single merge pass.
+     **/
+    template<class Key, class T, class Compare, class KeyContainer, class MappedContainer, bool Multi>
+    class flat_map_base
+    {
+    public:
+      ///\name types
+      typedef Key                                   key_type;
+      typedef T                                     mapped_type;
+      typedef pair<Key, T>                          value_type;
+      typedef Compare                               key_compare;
+      typedef pair<const Key&, T&>                  reference;
+      typedef pair<const Key&, const T&>            const_reference;
+      typedef size_t                                size_type;
+      typedef ptrdiff_t                             difference_type;
+      typedef KeyContainer                          key_container_type;
+      typedef MappedContainer                       mapped_container_type;
+
+      /** The containers of the flat_map */
+      struct containers
+      {
+        key_container_type    keys;
+        mapped_container_type values;
+      };
+
+      class value_compare
+      {
+        friend class flat_map_base;
+      public:
+        bool operator()(const_reference x, const_reference y) const { return comp(x.first, y.first); }
+      protected:
+        explicit value_compare(const Compare& c) : comp(c) {}
+        Compare comp;
+      };
+
+    protected:
+      template<bool Const>
+      class iterator_impl:
+        public std::iterator<random_access_iterator_tag, value_type, difference_type,
+          void, typename conditional<Const, pair<const Key&, const T&>, pair<const Key&, T&> >::type>
+      {
+        typedef typename key_container_type::const_iterator key_iterator;
+        typedef typename conditional<Const, typename mapped_container_type::const_iterator,
+          typename mapped_container_type::iterator>::type value_iterator;
+      public:
+        typedef typename conditional<Const, pair<const Key&, const T&>, pair<const Key&, T&> >::type reference;
+
+        /** The element is the pair of references, so the arrow operator returns the proxy holding it */
+        struct pointer
+        {
+          reference ref;
+          const reference* operator->() const { return &ref; }
+        };
+
+        iterator_impl()
+          :k(), v()
+        {}
+
+        template<bool C>
+        iterator_impl(const iterator_impl<C>& i, typename enable_if<Const || !C>::type* = 0)
+          :k(i.k), v(i.v)
+        {}
+
+        reference operator*() const { return reference(*k, *v); }
+        pointer operator->() const { const pointer p = { **this }; return p; }
+        reference operator[](difference_type n) const { return reference(k[n], v[n]); }
+
+        iterator_impl& operator++()    { ++k; ++v; return *this; }
+        iterator_impl& operator--()    { --k; --v; return *this; }
+        iterator_impl  operator++(int) { iterator_impl tmp(*this); ++*this; return tmp; }
+        iterator_impl  operator--(int) { iterator_impl tmp(*this); --*this; return tmp; }
+
+        iterator_impl& operator+=(difference_type n) { k += n; v += n; return *this; }
+        iterator_impl& operator-=(difference_type n) { k -= n; v -= n; return *this; }
+        iterator_impl  operator+ (difference_type n) const { iterator_impl tmp(*this); return tmp += n; }
+        iterator_impl  operator- (difference_type n) const { iterator_impl tmp(*this); return tmp -= n; }
+
+        friend iterator_impl operator+(difference_type n, const iterator_impl& i) { return i + n; }
+        friend difference_type operator-(const iterator_impl& x, const iterator_impl& y) { return x.k - y.k; }
+
+        friend bool operator==(const iterator_impl& x, const iterator_impl& y) { return x.k == y.k; }
+        friend bool operator!=(const iterator_impl& x, const iterator_impl& y) { return x.k != y.k; }
+        friend bool operator< (const iterator_impl& x, const iterator_impl& y) { return x.k <  y.k; }
+        friend bool operator> (const iterator_impl& x, const iterator_impl& y) { return x.k >  y.k; }
+        friend bool operator<=(const iterator_impl& x, const iterator_impl& y) { return x.k <= y.k; }
+        friend bool operator>=(const iterator_impl& x, const iterator_impl& y) { return x.k >= y.k; }
+
+      private:
+        template<bool> friend class iterator_impl;
+        friend class flat_map_base;
+
+        iterator_impl(key_iterator k, value_iterator v)
+          :k(k), v(v)
+        {}
+
+        key_iterator k;
+        value_iterator v;
+      };
+
+    public:
+      typedef iterator_impl<false>                  iterator;
+      typedef iterator_impl<true>                   const_iterator;
+      typedef std::reverse_iterator<iterator>       reverse_iterator;
+      typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+      ///\name iterators
+      iterator        begin()        { return make_iterator(0); }
+      const_iterator  begin()  const { return make_iterator(0); }
+      iterator        end()          { return make_iterator(size()); }
+      const_iterator  end()    const { return make_iterator(size()); }
+      const_iterator  cbegin() const { return begin(); }
+      const_iterator  cend()   const { return end(); }
+
+      reverse_iterator        rbegin()        { return reverse_iterator(end()); }
+      const_reverse_iterator  rbegin()  const { return const_reverse_iterator(end()); }
+      reverse_iterator        rend()          { return reverse_iterator(begin()); }
+      const_reverse_iterator  rend()    const { return const_reverse_iterator(begin()); }
+      const_reverse_iterator  crbegin() const { return rbegin(); }
+      const_reverse_iterator  crend()   const { return rend(); }
+
+      ///\name capacity
+      bool      empty()    const { return c.keys.empty(); }
+      size_type size()     const { return c.keys.size(); }
+      size_type max_size() const { return c.keys.max_size(); }
+
+      ///\name modifiers
+
+      /** Inserts the range: the copy of it is sorted and merged with the elements in one pass */
+      template<class InputIterator>
+      void insert(InputIterator first, InputIterator last)
+      {
+        std::vector<value_type> tmp(first, last);
+        ext::flat::stable_sort(tmp, value_less(comp_));
+        merge(std::make_move_iterator(tmp.begin()), std::make_move_iterator(tmp.end()));
+      }
+
+      void insert(initializer_list<value_type> il)
+      {
+        insert(il.begin(), il.end());
+      }
+
+      /** Extracts the containers leaving the map empty */
+      containers extract()
+      {
+        containers tmp;
+        using std::swap;
+        swap(tmp.keys, c.keys);
+        swap(tmp.values, c.values);
+        return tmp;
+      }
+
+      /** Replaces the containers by the sorted ones of the same size */
+    #ifdef NTL_CXX_RV
+      void replace(key_container_type&& keys, mapped_container_type&& values)
+    #else
+      void replace(const key_container_type& keys, const mapped_container_type& values)
+    #endif
+      {
+        c.keys = std::move(keys);
+        c.values = std::move(values);
+      }
+
+      iterator erase(const_iterator position)
+      {
+        return erase(position, position + 1);
+      }
+
+      iterator erase(const_iterator first, const_iterator last)
+      {
+        const size_type i = first - cbegin(), n = last - first;
+        c.keys.erase(c.keys.begin() + i, c.keys.begin() + (i + n));
+        c.values.erase(c.values.begin() + i, c.values.begin() + (i + n));
+        return make_iterator(i);
+      }
+
+      size_type erase(const key_type& x)
+      {
+        const size_type i = lower_index(x), j = Multi ? upper_index(x) : (i < size() && !comp_(x, c.keys[i]) ? i + 1 : i);
+        if(i != j)
+          erase(make_iterator(i), make_iterator(j));
+        return j - i;
+      }
+
+      void swap(flat_map_base& x)
+      {
+        using std::swap;
+        swap(c.keys, x.c.keys);
+        swap(c.values, x.c.values);
+        swap(comp_, x.comp_);
+      }
+
+      void clear()
+      {
+        c.keys.clear();
+        c.values.clear();
+      }
+
+      ///\name observers
+      key_compare key_comp() const { return comp_; }
+      value_compare value_comp() const { return value_compare(comp_); }
+      const key_container_type& keys() const { return c.keys; }
+      const mapped_container_type& values() const { return c.values; }
+
+      ///\name map operations
+      iterator find(const key_type& x)
+      {
+        const size_type i = lower_index(x);
+        return i < size() && !comp_(x, c.keys[i]) ? make_iterator(i) : end();
+      }
+
+      const_iterator find(const key_type& x) const
+      {
+        return const_cast<flat_map_base*>(this)->find(x);
+      }
+
+      size_type count(const key_type& x) const
+      {
+        if(!Multi)
+          return find(x) != end() ? 1 : 0;
+        return upper_index(x) - lower_index(x);
+      }
+
+      bool contains(const key_type& x) const
+      {
+        return find(x) != end();
+      }
+
+      iterator        lower_bound(const key_type& x)        { return make_iterator(lower_index(x)); }
+      const_iterator  lower_bound(const key_type& x) const  { return make_iterator(lower_index(x)); }
+      iterator        upper_bound(const key_type& x)        { return make_iterator(upper_index(x)); }
+      const_iterator  upper_bound(const key_type& x) const  { return make_iterator(upper_index(x)); }
+
+      pair<iterator, iterator> equal_range(const key_type& x)
+      {
+        return make_pair(lower_bound(x), upper_bound(x));
+      }
+
+      pair<const_iterator, const_iterator> equal_range(const key_type& x) const
+      {
+        return make_pair(lower_bound(x), upper_bound(x));
+      }
+      ///\}
+
+      friend bool operator==(const flat_map_base& x, const flat_map_base& y)
+      {
+        return x.c.keys == y.c.keys && x.c.values == y.c.values;
+      }
+
+      friend bool operator< (const flat_map_base& x, const flat_map_base& y)
+      {
+        return lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+      }
+
+      friend bool operator!=(const flat_map_base& x, const flat_map_base& y) { return !(x == y); }
+      friend bool operator> (const flat_map_base& x, const flat_map_base& y) { return y < x; }
+      friend bool operator>=(const flat_map_base& x, const flat_map_base& y) { return !(x < y); }
+      friend bool operator<=(const flat_map_base& x, const flat_map_base& y) { return !(y < x); }
+
+    protected:
+      explicit flat_map_base(const Compare& comp)
+        :comp_(comp)
+      {}
+
+      flat_map_base(key_container_type& keys, mapped_container_type& values, const Compare& comp, bool sorted)
+        :comp_(comp)
+      {
+        if(sorted){
+          c.keys.swap(keys);
+          c.values.swap(values);
+          return;
+        }
+        std::vector<value_type> tmp;
+        tmp.reserve(keys.size());
+        for(size_type i = 0; i < keys.size(); i++)
+          tmp.push_back(value_type(std::move(keys[i]), std::move(values[i])));
+        ext::flat::stable_sort(tmp, value_less(comp_));
+        merge(std::make_move_iterator(tmp.begin()), std::make_move_iterator(tmp.end()));
+      }
+
+      /**
+       *	@brief Merges the sorted range in one pass
+       *
+       *  The range going after the last element is appended in place, otherwise the merged sequence is built
+       *  in the new containers. The equivalent elements keep their order, the existing ones go first;
+       *  the unique map drops the elements which keys are already there.
+       *
+       *  If an exception is thrown, the appended elements are removed; the merge moves the elements
+       *  out of the map, so it leaves the map empty (the basic guarantee).
+       **/
+      template<class InputIterator>
+      void merge(InputIterator first, InputIterator last)
+      {
+        if(first == last)
+          return;
+        const size_type size = this->size();
+        if(empty() || comp_(c.keys.back(), (*first).first)){
+          __ntl_try{
+            for(; first != last; ++first)
+              append(c, *first);
+          }
+          __ntl_catch(...){
+            c.keys.erase(c.keys.begin() + size, c.keys.end());
+            c.values.erase(c.values.begin() + size, c.values.end());
+            __ntl_rethrow;
+          }
+          return;
+        }
+
+        containers tmp;
+        __ntl_try{
+          const size_type n = size + static_cast<size_type>(distance_hint(first, last, typename iterator_traits<InputIterator>::iterator_category()));
+          tmp.keys.reserve(n);
+          tmp.values.reserve(n);
+          size_type i = 0;
+          while(i < size && first != last){
+            if(comp_((*first).first, c.keys[i])){
+              append(tmp, *first);
+              ++first;
+            }else{
+              tmp.keys.push_back(std::move(c.keys[i]));
+              tmp.values.push_back(std::move(c.values[i]));
+              ++i;
+            }
+          }
+          for(; i < size; i++){
+            tmp.keys.push_back(std::move(c.keys[i]));
+            tmp.values.push_back(std::move(c.values[i]));
+          }
+          for(; first != last; ++first)
+            append(tmp, *first);
+        }
+        __ntl_catch(...){
+          clear();
+          __ntl_rethrow;
+        }
+        c.keys.swap(tmp.keys);
+        c.values.swap(tmp.values);
+      }
+
+      /** Inserts the element before the position \p i */
+    #ifdef NTL_CXX_RV
+      template<class K, class V>
+      iterator emplace_at(size_type i, K&& k, V&& v)
+      {
+        c.keys.insert(c.keys.begin() + i, std::forward<K>(k));
+        c.values.insert(c.values.begin() + i, std::forward<V>(v));
+        return make_iterator(i);
+      }
+    #else
+      iterator emplace_at(size_type i, const key_type& k, const mapped_type& v)
+      {
+        c.keys.insert(c.keys.begin() + i, k);
+        c.values.insert(c.values.begin() + i, v);
+        return make_iterator(i);
+      }
+    #endif
+
+      /** Position to insert \p x: the \p hint if it is right, otherwise the lower or upper bound of the key */
+      size_type insert_index(const_iterator hint, const key_type& x) const
+      {
+        const size_type h = hint - cbegin();
+        if((h == 0 || comp_(c.keys[h - 1], x) || (Multi && !comp_(x, c.keys[h - 1])))
+          && (h == size() || comp_(x, c.keys[h])))
+          return h;
+        return Multi ? upper_index(x) : lower_index(x);
+      }
+
+      size_type lower_index(const key_type& x) const
+      {
+        return ext::flat::lower_bound(c.keys.begin(), size(), x, comp_);
+      }
+
+      size_type upper_index(const key_type& x) const
+      {
+        return ext::flat::upper_bound(c.keys.begin(), size(), x, comp_);
+      }
+
+      bool equivalent(size_type i, const key_type& x) const
+      {
+        return i < size() && !comp_(x, c.keys[i]);
+      }
+
+      iterator make_iterator(size_type i)
+      {
+        return iterator(c.keys.begin() + i, c.values.begin() + i);
+      }
+
+      const_iterator make_iterator(size_type i) const
+      {
+        return const_iterator(c.keys.begin() + i, c.values.begin() + i);
+      }
+
+    private:
+      struct value_less
+      {
+        const Compare& comp;
+        explicit value_less(const Compare& comp) : comp(comp) {}
+        bool operator()(const value_type& x, const value_type& y) const { return comp(x.first, y.first); }
+      private:
+        value_less& operator=(const value_less&) __deleted;
+      };
+
+    #ifdef NTL_CXX_RV
+      template<class P>
+      void append(containers& to, P&& x)
+      {
+        if(!Multi && !to.keys.empty() && !comp_(to.keys.back(), x.first))
+          return;
+        to.keys.push_back(std::forward<P>(x).first);
+        to.values.push_back(std::forward<P>(x).second);
+      }
+    #else
+      template<class P>
+      void append(containers& to, const P& x)
+      {
+        if(!Multi && !to.keys.empty() && !comp_(to.keys.back(), x.first))
+          return;
+        to.keys.push_back(x.first);
+        to.values.push_back(x.second);
+      }
+    #endif
+
+      template<class InputIterator>
+      static difference_type distance_hint(InputIterator, InputIterator, input_iterator_tag) { return 0; }
+      template<class ForwardIterator>
+      static difference_type distance_hint(ForwardIterator first, ForwardIterator last, forward_iterator_tag) { return std::distance(first, last); }
+
+    protected:
+      containers c;
+      Compare comp_;
+    };
+  } // __
+
+
+/**
+ *	@brief Associative container of the unique keys over the sorted sequences
+ *
+ *  Mirrors the std::map interface, the keys and the mapped values are stored in the separate containers
+ *  (std::vector by default) and the iterator's reference is the <tt>pair<const Key&, T&></tt>.
+ *  The insertion or the erasure invalidates the iterators.
+ **/
+template <class Key,
+          class T,
+          class Compare = less<Key>,
+          class KeyContainer = vector<Key>,
+          class MappedContainer = vector<T> >
+class flat_map:
+  public __::flat_map_base<Key, T, Compare, KeyContainer, MappedContainer, false>
+{
+  typedef __::flat_map_base<Key, T, Compare, KeyContainer, MappedContainer, false> base;
+public:
+  typedef typename base::value_type     value_type;
+  typedef typename base::key_type       key_type;
+  typedef typename base::mapped_type    mapped_type;
+  typedef typename base::iterator       iterator;
+  typedef typename base::const_iterator const_iterator;
+  typedef typename base::size_type      size_type;
+
+  ///\name construct/copy/destroy
+  explicit flat_map(const Compare& comp = Compare())
+    :base(comp)
+  {}
+
+  /** Takes the containers of the same size and sorts them */
+  flat_map(KeyContainer keys, MappedContainer values, const Compare& comp = Compare())
+    :base(keys, values, comp, false)
+  {}
+
+  /** Takes the containers already sorted by the key without duplicates */
+  flat_map(sorted_unique_t, KeyContainer keys, MappedContainer values, const Compare& comp = Compare())
+    :base(keys, values, comp, true)
+  {}
+
+  template <class InputIterator>
+  flat_map(InputIterator first, InputIterator last, const Compare& comp = Compare())
+    :base(comp)
+  {
+    base::insert(first, last);
+  }
+
+  template <class InputIterator>
+  flat_map(sorted_unique_t, InputIterator first, InputIterator last, const Compare& comp = Compare())
+    :base(comp)
+  {
+    this->merge(first, last);
+  }
+
+  flat_map(initializer_list<value_type> il, const Compare& comp = Compare())
+    :base(comp)
+  {
+    base::insert(il.begin(), il.end());
+  }
+
+  flat_map& operator=(initializer_list<value_type> il)
+  {
+    this->clear();
+    base::insert(il.begin(), il.end());
+    return *this;
+  }
+
+  ///\name element access
+  T& operator[](const key_type& x)
+  {
+    const size_type i = this->lower_index(x);
+    return (this->equivalent(i, x) ? this->make_iterator(i) : this->emplace_at(i, x, T()))->second;
+  }
+
+#ifdef NTL_CXX_RV
+  T& operator[](key_type&& x)
+  {
+    const size_type i = this->lower_index(x);
+    return (this->equivalent(i, x) ? this->make_iterator(i) : this->emplace_at(i, std::move(x), T()))->second;
+  }
+#endif
+
+  T& at(const key_type& x) __ntl_throws(out_of_range)
+  {
+    const iterator i = this->find(x);
+    if(i == this->end())
+      __throw_out_of_range("specified key isn't exists in the flat_map");
+    return i->second;
+  }
+
+  const T& at(const key_type& x) const __ntl_throws(out_of_range)
+  {
+    const const_iterator i = this->find(x);
+    if(i == this->end())
+      __throw_out_of_range("specified key isn't exists in the flat_map");
+    return i->second;
+  }
+
+  ///\name modifiers
+  using base::insert;
+
+  pair<iterator, bool> insert(const value_type& x)
+  {
+    const size_type i = this->lower_index(x.first);
+    if(this->equivalent(i, x.first))
+      return make_pair(this->make_iterator(i), false);
+    return make_pair(this->emplace_at(i, x.first, x.second), true);
+  }
+
+  iterator insert(const_iterator position, const value_type& x)
+  {
+    const size_type i = this->insert_index(position, x.first);
+    return this->equivalent(i, x.first) ? this->make_iterator(i) : this->emplace_at(i, x.first, x.second);
+  }
+
+#ifdef NTL_CXX_RV
+  pair<iterator, bool> insert(value_type&& x)
+  {
+    const size_type i = this->lower_index(x.first);
+    if(this->equivalent(i, x.first))
+      return make_pair(this->make_iterator(i), false);
+    return make_pair(this->emplace_at(i, std::move(x.first), std::move(x.second)), true);
+  }
+
+  iterator insert(const_iterator position, value_type&& x)
+  {
+    const size_type i = this->insert_index(position, x.first);
+    return this->equivalent(i, x.first) ? this->make_iterator(i) : this->emplace_at(i, std::move(x.first), std::move(x.second));
+  }
+#endif
+
+  /** Merges the range sorted by the key without duplicates in one pass */
+  template<class InputIterator>
+  void insert(sorted_unique_t, InputIterator first, InputIterator last)
+  {
+    this->merge(first, last);
+  }
+
+#ifdef NTL_CXX_VT
+  template <class... Args>
+  pair<iterator, bool> emplace(Args&&... args)
+  {
+    return insert(value_type(std::forward<Args>(args)...));
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator position, Args&&... args)
+  {
+    return insert(position, value_type(std::forward<Args>(args)...));
+  }
+#endif
+
+  void swap(flat_map& x)
+  {
+    base::swap(x);
+  }
+};
+
+/**
+ *	@brief Associative container of the equivalent keys over the sorted sequences
+ *
+ *  Mirrors the std::multimap interface, see flat_map.
+ **/
+template <class Key,
+          class T,
+          class Compare = less<Key>,
+          class KeyContainer = vector<Key>,
+          class MappedContainer = vector<T> >
+class flat_multimap:
+  public __::flat_map_base<Key, T, Compare, KeyContainer, MappedContainer, true>
+{
+  typedef __::flat_map_base<Key, T, Compare, KeyContainer, MappedContainer, true> base;
+public:
+  typedef typename base::value_type     value_type;
+  typedef typename base::iterator       iterator;
+  typedef typename base::const_iterator const_iterator;
+  typedef typename base::size_type      size_type;
+
+  ///\name construct/copy/destroy
+  explicit flat_multimap(const Compare& comp = Compare())
+    :base(comp)
+  {}
+
+  flat_multimap(KeyContainer keys, MappedContainer values, const Compare& comp = Compare())
+    :base(keys, values, comp, false)
+  {}
+
+  flat_multimap(sorted_equivalent_t, KeyContainer keys, MappedContainer values, const Compare& comp = Compare())
+    :base(keys, values, comp, true)
+  {}
+
+  template <class InputIterator>
+  flat_multimap(InputIterator first, InputIterator last, const Compare& comp = Compare())
+    :base(comp)
+  {
+    base::insert(first, last);
+  }
+
+  template <class InputIterator>
+  flat_multimap(sorted_equivalent_t, InputIterator first, InputIterator last, const Compare& comp = Compare())
+    :base(comp)
+  {
+    this->merge(first, last);
+  }
+
+  flat_multimap(initializer_list<value_type> il, const Compare& comp = Compare())
+    :base(comp)
+  {
+    base::insert(il.begin(), il.end());
+  }
+
+  flat_multimap& operator=(initializer_list<value_type> il)
+  {
+    this->clear();
+    base::insert(il.begin(), il.end());
+    return *this;
+  }
+
+  ///\name modifiers
+  using base::insert;
+
+  iterator insert(const value_type& x)
+  {
+    return this->emplace_at(this->upper_index(x.first), x.first, x.second);
+  }
+
+  iterator insert(const_iterator position, const value_type& x)
+  {
+    return this->emplace_at(this->insert_index(position, x.first), x.first, x.second);
+  }
+
+#ifdef NTL_CXX_RV
+  iterator insert(value_type&& x)
+  {
+    const size_type i = this->upper_index(x.first);
+    return this->emplace_at(i, std::move(x.first), std::move(x.second));
+  }
+
+  iterator insert(const_iterator position, value_type&& x)
+  {
+    const size_type i = this->insert_index(position, x.first);
+    return this->emplace_at(i, std::move(x.first), std::move(x.second));
+  }
+#endif
+
+  /** Merges the range sorted by the key in one pass */
+  template<class InputIterator>
+  void insert(sorted_equivalent_t, InputIterator first, InputIterator last)
+  {
+    this->merge(first, last);
+  }
+
+#ifdef NTL_CXX_VT
+  template <class... Args>
+  iterator emplace(Args&&... args)
+  {
+    return insert(value_type(std::forward<Args>(args)...));
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator position, Args&&... args)
+  {
+    return insert(position, value_type(std::forward<Args>(args)...));
+  }
+#endif
+
+  void swap(flat_multimap& x)
+  {
+    base::swap(x);
+  }
+};
+
+template <class Key, class T, class Compare, class KeyContainer, class MappedContainer>
+inline void swap(flat_map<Key, T, Compare, KeyContainer, MappedContainer>& x, flat_map<Key, T, Compare, KeyContainer, MappedContainer>& y)
+{
+  x.swap(y);
+}
+
+template <class Key, class T, class Compare, class KeyContainer, class MappedContainer>
+inline void swap(flat_multimap<Key, T, Compare, KeyContainer, MappedContainer>& x, flat_multimap<Key, T, Compare, KeyContainer, MappedContainer>& y)
+{
+  x.swap(y);
+}
+
+/**@} lib_associative */
+/**@} lib_containers */
+
+} // std
+
+#endif // NTL__STLX_FLAT_MAP
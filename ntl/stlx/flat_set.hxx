@@ -0,0 +1,564 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  Class templates flat_set and flat_multiset
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__STLX_FLAT_SET
+#define NTL__STLX_FLAT_SET
+#pragma once
+
+#include "algorithm.hxx"
+#include "ext/flat_tree.hxx"
+
+namespace std {
+
+/**\addtogroup  lib_containers
+  *@{
+  **/
+
+/**\addtogroup  lib_associative
+  *@{
+  **/
+
+  namespace __
+  {
+    /**
+     *	@brief Common part of the flat_set and flat_multiset
+     *
+     *  The keys are kept in the sorted random access container and searched by the branchless binary search.
+     *  The insertion and the erasure move the tail of the container and invalidate the iterators;
+     *  the range is inserted by the single merge pass.
+     **/
+    template<class Key, class Compare, class KeyContainer, bool Multi>
+    class flat_set_base
+    {
+    public:
+      ///\name types
+      typedef Key                                         key_type;
+      typedef Key                                         value_type;
+      typedef Compare                                     key_compare;
+      typedef Compare                                     value_compare;
+      typedef Key&                                        reference;
+      typedef const Key&                                  const_reference;
+      typedef size_t                                      size_type;
+      typedef ptrdiff_t                                   difference_type;
+      typedef KeyContainer                                container_type;
+      typedef typename container_type::const_iterator     iterator;
+      typedef typename container_type::const_iterator     const_iterator;
+      typedef std::reverse_iterator<iterator>             reverse_iterator;
+      typedef std::reverse_iterator<const_iterator>       const_reverse_iterator;
+
+      ///\name iterators
+      iterator        begin()   const { return c.begin(); }
+      iterator        end()     const { return c.end(); }
+      const_iterator  cbegin()  const { return c.begin(); }
+      const_iterator  cend()    const { return c.end(); }
+
+      reverse_iterator        rbegin()  const { return reverse_iterator(end()); }
+      reverse_iterator        rend()    const { return reverse_iterator(begin()); }
+      const_reverse_iterator  crbegin() const { return rbegin(); }
+      const_reverse_iterator  crend()   const { return rend(); }
+
+      ///\name capacity
+      bool      empty()    const { return c.empty(); }
+      size_type size()     const { return c.size(); }
+      size_type max_size() const { return c.max_size(); }
+
+      ///\name modifiers
+
+      /** Inserts the range: the copy of it is sorted and merged with the elements in one pass */
+      template<class InputIterator>
+      void insert(InputIterator first, InputIterator last)
+      {
+        std::vector<value_type> tmp(first, last);
+        ext::flat::stable_sort(tmp, comp_);
+        merge(std::make_move_iterator(tmp.begin()), std::make_move_iterator(tmp.end()));
+      }
+
+      void insert(initializer_list<value_type> il)
+      {
+        insert(il.begin(), il.end());
+      }
+
+      /** Extracts the container leaving the set empty */
+      container_type extract()
+      {
+        container_type tmp;
+        tmp.swap(c);
+        return tmp;
+      }
+
+      /** Replaces the container by the sorted one */
+    #ifdef NTL_CXX_RV
+      void replace(container_type&& keys)
+    #else
+      void replace(const container_type& keys)
+    #endif
+      {
+        c = std::move(keys);
+      }
+
+      iterator erase(const_iterator position)
+      {
+        return erase(position, position + 1);
+      }
+
+      iterator erase(const_iterator first, const_iterator last)
+      {
+        const size_type i = first - c.begin(), n = last - first;
+        c.erase(c.begin() + i, c.begin() + (i + n));
+        return begin() + i;
+      }
+
+      size_type erase(const key_type& x)
+      {
+        const size_type i = lower_index(x), j = Multi ? upper_index(x) : (equivalent(i, x) ? i + 1 : i);
+        if(i != j)
+          erase(begin() + i, begin() + j);
+        return j - i;
+      }
+
+      void swap(flat_set_base& x)
+      {
+        using std::swap;
+        swap(c, x.c);
+        swap(comp_, x.comp_);
+      }
+
+      void clear()
+      {
+        c.clear();
+      }
+
+      ///\name observers
+      key_compare key_comp() const { return comp_; }
+      value_compare value_comp() const { return comp_; }
+
+      ///\name set operations
+      iterator find(const key_type& x) const
+      {
+        const size_type i = lower_index(x);
+        return equivalent(i, x) ? begin() + i : end();
+      }
+
+      size_type count(const key_type& x) const
+      {
+        if(!Multi)
+          return equivalent(lower_index(x), x) ? 1 : 0;
+        return upper_index(x) - lower_index(x);
+      }
+
+      bool contains(const key_type& x) const
+      {
+        return equivalent(lower_index(x), x);
+      }
+
+      iterator lower_bound(const key_type& x) const { return begin() + lower_index(x); }
+      iterator upper_bound(const key_type& x) const { return begin() + upper_index(x); }
+
+      pair<iterator, iterator> equal_range(const key_type& x) const
+      {
+        return make_pair(lower_bound(x), upper_bound(x));
+      }
+      ///\}
+
+      friend bool operator==(const flat_set_base& x, const flat_set_base& y) { return x.c == y.c; }
+      friend bool operator< (const flat_set_base& x, const flat_set_base& y) { return x.c <  y.c; }
+      friend bool operator!=(const flat_set_base& x, const flat_set_base& y) { return !(x == y); }
+      friend bool operator> (const flat_set_base& x, const flat_set_base& y) { return y < x; }
+      friend bool operator>=(const flat_set_base& x, const flat_set_base& y) { return !(x < y); }
+      friend bool operator<=(const flat_set_base& x, const flat_set_base& y) { return !(y < x); }
+
+    protected:
+      explicit flat_set_base(const Compare& comp)
+        :comp_(comp)
+      {}
+
+      flat_set_base(container_type& keys, const Compare& comp, bool sorted)
+        :comp_(comp)
+      {
+        if(sorted){
+          c.swap(keys);
+          return;
+        }
+        std::vector<value_type> tmp;
+        tmp.reserve(keys.size());
+        for(size_type i = 0; i < keys.size(); i++)
+          tmp.push_back(std::move(keys[i]));
+        ext::flat::stable_sort(tmp, comp_);
+        merge(std::make_move_iterator(tmp.begin()), std::make_move_iterator(tmp.end()));
+      }
+
+      /**
+       *	@brief Merges the sorted range in one pass
+       *
+       *  The range going after the last element is appended in place, otherwise the merged sequence is built
+       *  in the new container. The equivalent elements keep their order, the existing ones go first;
+       *  the unique set drops the elements which are already there.
+       *
+       *  If an exception is thrown, the appended elements are removed; the merge moves the elements
+       *  out of the set, so it leaves the set empty (the basic guarantee).
+       **/
+      template<class InputIterator>
+      void merge(InputIterator first, InputIterator last)
+      {
+        if(first == last)
+          return;
+        const size_type size = this->size();
+        if(empty() || comp_(c.back(), *first)){
+          __ntl_try{
+            for(; first != last; ++first)
+              append(c, *first);
+          }
+          __ntl_catch(...){
+            c.erase(c.begin() + size, c.end());
+            __ntl_rethrow;
+          }
+          return;
+        }
+
+        container_type tmp;
+        __ntl_try{
+          tmp.reserve(size + static_cast<size_type>(distance_hint(first, last, typename iterator_traits<InputIterator>::iterator_category())));
+          size_type i = 0;
+          while(i < size && first != last){
+            if(comp_(*first, c[i])){
+              append(tmp, *first);
+              ++first;
+            }else{
+              tmp.push_back(std::move(c[i++]));
+            }
+          }
+          for(; i < size; i++)
+            tmp.push_back(std::move(c[i]));
+          for(; first != last; ++first)
+            append(tmp, *first);
+        }
+        __ntl_catch(...){
+          c.clear();
+          __ntl_rethrow;
+        }
+        c.swap(tmp);
+      }
+
+      /** Inserts the element before the position \p i */
+    #ifdef NTL_CXX_RV
+      template<class K>
+      iterator emplace_at(size_type i, K&& k)
+      {
+        c.insert(c.begin() + i, std::forward<K>(k));
+        return begin() + i;
+      }
+    #else
+      iterator emplace_at(size_type i, const key_type& k)
+      {
+        c.insert(c.begin() + i, k);
+        return begin() + i;
+      }
+    #endif
+
+      /** Position to insert \p x: the \p hint if it is right, otherwise the lower or upper bound of the key */
+      size_type insert_index(const_iterator hint, const key_type& x) const
+      {
+        const size_type h = hint - c.begin();
+        if((h == 0 || comp_(c[h - 1], x) || (Multi && !comp_(x, c[h - 1])))
+          && (h == size() || comp_(x, c[h])))
+          return h;
+        return Multi ? upper_index(x) : lower_index(x);
+      }
+
+      size_type lower_index(const key_type& x) const
+      {
+        return ext::flat::lower_bound(c.begin(), size(), x, comp_);
+      }
+
+      size_type upper_index(const key_type& x) const
+      {
+        return ext::flat::upper_bound(c.begin(), size(), x, comp_);
+      }
+
+      bool equivalent(size_type i, const key_type& x) const
+      {
+        return i < size() && !comp_(x, c[i]);
+      }
+
+    private:
+    #ifdef NTL_CXX_RV
+      template<class K>
+      void append(container_type& to, K&& x)
+      {
+        if(Multi || to.empty() || comp_(to.back(), x))
+          to.push_back(std::forward<K>(x));
+      }
+    #else
+      void append(container_type& to, const key_type& x)
+      {
+        if(Multi || to.empty() || comp_(to.back(), x))
+          to.push_back(x);
+      }
+    #endif
+
+      template<class InputIterator>
+      static difference_type distance_hint(InputIterator, InputIterator, input_iterator_tag) { return 0; }
+      template<class ForwardIterator>
+      static difference_type distance_hint(ForwardIterator first, ForwardIterator last, forward_iterator_tag) { return std::distance(first, last); }
+
+    protected:
+      container_type c;
+      Compare comp_;
+    };
+  } // __
+
+
+/**
+ *	@brief Associative container of the unique keys over the sorted sequence
+ *
+ *  Mirrors the std::set interface, the keys are stored in the container (std::vector by default).
+ *  The insertion or the erasure invalidates the iterators.
+ **/
+template <class Key,
+          class Compare = less<Key>,
+          class KeyContainer = vector<Key> >
+class flat_set:
+  public __::flat_set_base<Key, Compare, KeyContainer, false>
+{
+  typedef __::flat_set_base<Key, Compare, KeyContainer, false> base;
+public:
+  typedef typename base::value_type     value_type;
+  typedef typename base::iterator       iterator;
+  typedef typename base::const_iterator const_iterator;
+  typedef typename base::size_type      size_type;
+
+  ///\name construct/copy/destroy
+  explicit flat_set(const Compare& comp = Compare())
+    :base(comp)
+  {}
+
+  /** Takes the container and sorts it */
+  explicit flat_set(KeyContainer keys, const Compare& comp = Compare())
+    :base(keys, comp, false)
+  {}
+
+  /** Takes the container already sorted without duplicates */
+  flat_set(sorted_unique_t, KeyContainer keys, const Compare& comp = Compare())
+    :base(keys, comp, true)
+  {}
+
+  template <class InputIterator>
+  flat_set(InputIterator first, InputIterator last, const Compare& comp = Compare())
+    :base(comp)
+  {
+    base::insert(first, last);
+  }
+
+  template <class InputIterator>
+  flat_set(sorted_unique_t, InputIterator first, InputIterator last, const Compare& comp = Compare())
+    :base(comp)
+  {
+    this->merge(first, last);
+  }
+
+  flat_set(initializer_list<value_type> il, const Compare& comp = Compare())
+    :base(comp)
+  {
+    base::insert(il.begin(), il.end());
+  }
+
+  flat_set& operator=(initializer_list<value_type> il)
+  {
+    this->clear();
+    base::insert(il.begin(), il.end());
+    return *this;
+  }
+
+  ///\name modifiers
+  using base::insert;
+
+  pair<iterator, bool> insert(const value_type& x)
+  {
+    const size_type i = this->lower_index(x);
+    if(this->equivalent(i, x))
+      return make_pair(this->begin() + i, false);
+    return make_pair(this->emplace_at(i, x), true);
+  }
+
+  iterator insert(const_iterator position, const value_type& x)
+  {
+    const size_type i = this->insert_index(position, x);
+    return this->equivalent(i, x) ? this->begin() + i : this->emplace_at(i, x);
+  }
+
+#ifdef NTL_CXX_RV
+  pair<iterator, bool> insert(value_type&& x)
+  {
+    const size_type i = this->lower_index(x);
+    if(this->equivalent(i, x))
+      return make_pair(this->begin() + i, false);
+    return make_pair(this->emplace_at(i, std::move(x)), true);
+  }
+
+  iterator insert(const_iterator position, value_type&& x)
+  {
+    const size_type i = this->insert_index(position, x);
+    return this->equivalent(i, x) ? this->begin() + i : this->emplace_at(i, std::move(x));
+  }
+#endif
+
+  /** Merges the range sorted without duplicates in one pass */
+  template<class InputIterator>
+  void insert(sorted_unique_t, InputIterator first, InputIterator last)
+  {
+    this->merge(first, last);
+  }
+
+#ifdef NTL_CXX_VT
+  template <class... Args>
+  pair<iterator, bool> emplace(Args&&... args)
+  {
+    return insert(value_type(std::forward<Args>(args)...));
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator position, Args&&... args)
+  {
+    return insert(position, value_type(std::forward<Args>(args)...));
+  }
+#endif
+
+  void swap(flat_set& x)
+  {
+    base::swap(x);
+  }
+};
+
+/**
+ *	@brief Associative container of the equivalent keys over the sorted sequence
+ *
+ *  Mirrors the std::multiset interface, see flat_set.
+ **/
+template <class Key,
+          class Compare = less<Key>,
+          class KeyContainer = vector<Key> >
+class flat_multiset:
+  public __::flat_set_base<Key, Compare, KeyContainer, true>
+{
+  typedef __::flat_set_base<Key, Compare, KeyContainer, true> base;
+public:
+  typedef typename base::value_type     value_type;
+  typedef typename base::iterator       iterator;
+  typedef typename base::const_iterator const_iterator;
+  typedef typename base::size_type      size_type;
+
+  ///\name construct/copy/destroy
+  explicit flat_multiset(const Compare& comp = Compare())
+    :base(comp)
+  {}
+
+  explicit flat_multiset(KeyContainer keys, const Compare& comp = Compare())
+    :base(keys, comp, false)
+  {}
+
+  flat_multiset(sorted_equivalent_t, KeyContainer keys, const Compare& comp = Compare())
+    :base(keys, comp, true)
+  {}
+
+  template <class InputIterator>
+  flat_multiset(InputIterator first, InputIterator last, const Compare& comp = Compare())
+    :base(comp)
+  {
+    base::insert(first, last);
+  }
+
+  template <class InputIterator>
+  flat_multiset(sorted_equivalent_t, InputIterator first, InputIterator last, const Compare& comp = Compare())
+    :base(comp)
+  {
+    this->merge(first, last);
+  }
+
+  flat_multiset(initializer_list<value_type> il, const Compare& comp = Compare())
+    :base(comp)
+  {
+    base::insert(il.begin(), il.end());
+  }
+
+  flat_multiset& operator=(initializer_list<value_type> il)
+  {
+    this->clear();
+    base::insert(il.begin(), il.end());
+    return *this;
+  }
+
+  ///\name modifiers
+  using base::insert;
+
+  iterator insert(const value_type& x)
+  {
+    return this->emplace_at(this->upper_index(x), x);
+  }
+
+  iterator insert(const_iterator position, const value_type& x)
+  {
+    return this->emplace_at(this->insert_index(position, x), x);
+  }
+
+#ifdef NTL_CXX_RV
+  iterator insert(value_type&& x)
+  {
+    const size_type i = this->upper_index(x);
+    return this->emplace_at(i, std::move(x));
+  }
+
+  iterator insert(const_iterator position, value_type&& x)
+  {
+    const size_type i = this->insert_index(position, x);
+    return this->emplace_at(i, std::move(x));
+  }
+#endif
+
+  /** Merges the sorted range in one pass */
+  template<class InputIterator>
+  void insert(sorted_equivalent_t, InputIterator first, InputIterator last)
+  {
+    this->merge(first, last);
+  }
+
+#ifdef NTL_CXX_VT
+  template <class... Args>
+  iterator emplace(Args&&... args)
+  {
+    return insert(value_type(std::forward<Args>(args)...));
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator position, Args&&... args)
+  {
+    return insert(position, value_type(std::forward<Args>(args)...));
+  }
+#endif
+
+  void swap(flat_multiset& x)
+  {
+    base::swap(x);
+  }
+};
+
+template <class Key, class Compare, class KeyContainer>
+inline void swap(flat_set<Key, Compare, KeyContainer>& x, flat_set<Key, Compare, KeyContainer>& y)
+{
+  x.swap(y);
+}
+
+template <class Key, class Compare, class KeyContainer>
+inline void swap(flat_multiset<Key, Compare, KeyContainer>& x, flat_multiset<Key, Compare, KeyContainer>& y)
+{
+  x.swap(y);
+}
+
+/**@} lib_associative */
+/**@} lib_containers */
+
+} // std
+
+#endif // NTL__STLX_FLAT_SET
@@ -74,12 +74,12 @@ namespace std {
     ///\name 27.9.1.2 basic_filebuf constructors [filebuf.cons]
 
     basic_filebuf()
-      :mode(), our_buffer(true), encoding(Encoding::Default)
+      :mode(), our_buffer(true), encoding(Encoding::Default), buffer_size_(default_file_buffer_size)
     {}
 
 #ifdef NTL_CXX_RV
     basic_filebuf(basic_filebuf&& rhs)
-      :mode(), our_buffer(true), encoding(Encoding::Default)
+      :mode(), our_buffer(true), encoding(Encoding::Default), buffer_size_(default_file_buffer_size)
     {
       swap(rhs);
     }
@@ -114,6 +114,7 @@ namespace std {
       swap(encoding, rhs.encoding);
       swap(mode, rhs.mode);
       swap(our_buffer, rhs.our_buffer);
+      swap(buffer_size_, rhs.buffer_size_);
     }
 
     ///\name 27.9.1.4 Member functions [filebuf.members]
@@ -156,6 +157,36 @@ namespace std {
       return ok ? this : nullptr;
     }
 
+    /**
+     *	@brief Sets the size of the stream buffer in characters (NTL extension)
+     *
+     *  The size is used by the next open() or, if the file is open, the buffer is reallocated immediately
+     *  after the pending output is written. Fails if there is unread input in the buffer.
+     **/
+    bool buffer_size(streamsize n)
+    {
+      if(n <= 0 || gptr() < egptr())
+        return false;
+      if(pptr() > pbase() && sync() == -1)
+        return false;
+
+      if(our_buffer && buf.second)
+        reallocate_buffer(0);
+      buf.first = nullptr;
+      buf.second = 0;
+      our_buffer = true;
+      buffer_size_ = n;
+      const bool ok = !f || reallocate_buffer(n);
+      reset();
+      return ok;
+    }
+
+    /** Size of the stream buffer in characters (NTL extension) */
+    streamsize buffer_size() const
+    {
+      return buf.second ? buf.second : buffer_size_;
+    }
+
     ///////////////////////////////////////////////////////////////////////////
   protected:
 
@@ -197,14 +228,14 @@ namespace std {
       if(!writeable){
         // use all buffer
         if(egptr() == p){
-          // possible first call, read 128 characters
-          cb = 128;
+          // possible first call, read 128 characters or less if the buffer is smaller
+          cb = min(streamsize(128), buf.second);
         }else{
           avail = gptr()-eback();
           avail = avail > 32 ? 16 : (avail <= 1 ? 0 : 1); // leave 16 characters for backup seq if avail
           cb = buf.second - avail;
           if(avail){
-            traits_type::move(p, gptr()-1, avail);
+            traits_type::move(p, gptr()-avail, avail); // the last characters before the position
             p += avail;
             setg(buf.first, p, p); // temporary set read position to the end of backup
           }
@@ -243,6 +274,44 @@ namespace std {
 
     //virtual int_type uflow(); // default
 
+    virtual streamsize xsgetn(char_type* s, streamsize n)
+    {
+      // the large reads of the binary input go straight to the caller's memory
+      if(!f || (mode & (ios_base::binary|ios_base::out)) != ios_base::binary || n < buf.second / 2)
+        return basic_streambuf::xsgetn(s, n);
+
+      // the buffered characters first, they may satisfy the whole request
+      streamsize copied = egptr() - gptr();
+      if(copied >= n){
+        traits_type::copy(s, gptr(), static_cast<size_t>(n));
+        gbump(static_cast<int>(n));
+        return n;
+      }
+      if(copied > 0){
+        traits_type::copy(s, gptr(), static_cast<size_t>(copied));
+        s += copied;
+        n -= copied;
+      }else{
+        copied = 0;
+      }
+      // the buffer contents are stale after the direct read, so it doesn't keep the putback characters
+      setg(buf.first, buf.first, buf.first);
+
+      static const streamsize max_chunk = 0x40000000 / sizeof(char_type);
+      while(n > 0){
+        const streamsize chunk = min(n, max_chunk);
+        if(!NTL_SUBSYSTEM_NS::success(f.read(s, static_cast<uint32_t>(chunk*sizeof(char_type)))))
+          break;
+        const streamsize readed = static_cast<streamsize>(f.get_io_status_block().Information / sizeof(char_type));
+        s += readed;
+        n -= readed;
+        copied += readed;
+        if(readed < chunk)
+          break;
+      }
+      return copied;
+    }
+
     virtual int_type pbackfail(int_type c = traits::eof())
     {
       const int_type eof = traits_type::eof();
@@ -254,19 +323,20 @@ namespace std {
 
     virtual streamsize xsputn(const char_type* s, streamsize n)
     {
-      if(n <= default_file_buffer_size)
+      // the blocks of the half of the buffer and larger are written directly
+      if(n < buf.second / 2)
         return basic_streambuf::xsputn(s, n);
       else if(!f)
         return 0;
-      // directly put the large data
 
       // put the pending data
-      overflow();
-      // request file space & write data
-      f.size(f.tell() + n);
+      if(const streamsize pending = pptr()-pbase()){
+        if(!write(pbase(), pending))
+          return 0;
+        reset();
+      }
       streamsize written;
       write(s, n, &written);
-      f.flush();
       return written;
     }
 
@@ -285,11 +355,18 @@ namespace std {
       }
 
       if(ok && !eofc){
-        // write c
+        // put c into the emptied buffer or write it if the stream is unbuffered
         const char_type cc = traits_type::to_char_type(c);
-        ok = write(&cc, 1);
+        if(pptr() < epptr()){
+          *pptr() = cc;
+          pbump(1);
+        }else{
+          ok = write(&cc, 1);
+        }
       }
-      ok &= flush();
+      // the full buffer is just written, the explicit flush request goes to the disk
+      if(eofc)
+        ok &= flush();
       if(!ok)
         return eof;
       return eofc ? traits_type::not_eof(c) : c;
@@ -297,14 +374,18 @@ namespace std {
 
     virtual basic_streambuf<charT,traits>* setbuf(char_type* s, streamsize n)
     {
+      // the pending output goes to the file before the buffer is replaced
+      if(pptr() > pbase() && sync() == -1)
+        return nullptr;
+      if(buf.second) reallocate_buffer(0);
       if(!s && !n){
-        // unbuffered io
+        // unbuffered io, the buffer is never shrunk by reallocate_buffer() so it is freed first
+        buf.second = 0;
         our_buffer = true;
         reallocate_buffer(1);
         reset();
         return this;
       }
-      if(buf.second) reallocate_buffer(0);
       buf.first = s,
         buf.second = n;
       our_buffer = false;
@@ -610,11 +691,10 @@ namespace std {
         }
       }
 
-      // setup buffer
-      if(!buf.second){
-        reallocate_buffer(default_file_buffer_size);
-        reset();
-      }
+      // setup buffer, the one set by setbuf() before open() gets its positions too
+      if(!buf.second)
+        reallocate_buffer(buffer_size_);
+      reset();
 
       // detect encoding on nonempty file
       if(bom_size > 0){
@@ -695,7 +775,8 @@ namespace std {
       if(mode&ios_base::in)
         setg(buf.first, buf.first, buf.first); // empty input sequence
       if(mode&ios_base::out)
-        setp(buf.first, buf.first+buf.second);
+        // the one character buffer of the unbuffered stream is not used for output, overflow() writes through
+        setp(buf.first, buf.first + (buf.second > 1 ? buf.second : 0));
     }
 
     EncodingType parse_encoding(uint32_t bom, uint32_t& bom_size)
@@ -741,6 +822,7 @@ namespace std {
     EncodingType encoding;
     ios_base::openmode mode;
     bool our_buffer;
+    streamsize buffer_size_;
   };
 
 
@@ -218,15 +218,9 @@ class basic_istream : virtual public basic_ios<charT, traits>
       if (ok && sb)
       __ntl_try
       {
-        basic_streambuf<char_type, traits_type>* buf = rdbuf();
-        const int_type eof = traits_type::eof();
-        int_type c = buf->sgetc();
-        while(!traits_type::eq_int_type(c, eof)){
-          if(traits_type::eq_int_type(sb->sputc(traits_type::to_char_type(c)), eof))
-            break;
-          ++n;
-        }
-        if(traits_type::eq_int_type(c, eof))
+        bool at_eof;
+        n = __copy_streambuf(*rdbuf(), *sb, at_eof);
+        if(at_eof)
           state |= ios_base::eofbit;
       }
       __ntl_catch(...)
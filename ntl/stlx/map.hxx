@@ -132,6 +132,11 @@ class map:
     typedef typename tree_type::reverse_iterator       reverse_iterator;
     typedef typename tree_type::const_reverse_iterator const_reverse_iterator;
 
+#ifdef NTL_CXX_RV
+    typedef ext::map_node_handle<node, typename tree_type::node_allocator_type, Allocator, Key, T> node_type;
+    typedef ext::node_insert_return<iterator, node_type> insert_return_type;
+#endif
+
 public:
     ///\name 23.3.1.1 construct/copy/destroy:
     explicit map(const Compare& comp = Compare(), const Allocator& a = Allocator())
@@ -313,10 +318,9 @@ public:
       return tree_type::insert_reference(std::forward<P>(x));
     }
     template<class P>
-    iterator insert(const_iterator /*position*/, P&& x)
+    iterator insert(const_iterator position, P&& x)
     {
-      // TODO: implement fast insert function based on position
-      return tree_type::insert_reference(std::forward<P>(x)).first;
+      return tree_type::insert_reference(position, std::forward<P>(x));
     }
 #endif
 
@@ -334,6 +338,47 @@ public:
       return val == end() ? 0 : (erase(val), 1);
     }
 
+#ifdef NTL_CXX_RV
+    ///\name node handles
+    /** Unlinks the element and returns the node owning it, no other iterators are invalidated */
+    node_type extract(const_iterator position)
+    {
+      return tree_type::template extract_node<node_type>(position);
+    }
+
+    node_type extract(const key_type& x)
+    {
+      const iterator i = find(x);
+      return i == end() ? node_type() : extract(i);
+    }
+
+    /** Links the node unless the key exists, then the node is returned back */
+    insert_return_type insert(node_type&& nh)
+    {
+      if(nh.empty())
+        return insert_return_type(end(), false, node_type());
+      const pair<iterator, bool> r = tree_type::insert_node(cend(), nh);
+      return insert_return_type(r.first, r.second, r.second ? node_type() : std::move(nh));
+    }
+
+    iterator insert(const_iterator hint, node_type&& nh)
+    {
+      return nh.empty() ? end() : tree_type::insert_node(hint, nh).first;
+    }
+
+    /** Moves the elements which keys are absent here from the \p source, the nodes are relinked without the allocation */
+    void merge(map& source)
+    {
+      tree_type::merge_unique(source);
+    }
+
+    void merge(map&& source)
+    {
+      tree_type::merge_unique(source);
+    }
+    ///\}
+#endif
+
     void swap(map<Key,T,Compare,Allocator>& x)
     {
       if(this != &x){
@@ -696,10 +741,9 @@ public:
     return tree_type::insert_reference(std::forward<P>(x));
   }
   template<class P>
-  iterator insert(const_iterator /*position*/, P&& x)
+  iterator insert(const_iterator position, P&& x)
   {
-    // TODO: implement fast insert function based on position
-    return tree_type::insert_reference(std::forward<P>(x)).first;
+    return tree_type::insert_reference(position, std::forward<P>(x));
   }
 #endif
 
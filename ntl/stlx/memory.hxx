@@ -733,6 +733,40 @@ namespace __ {
       return re;
     }
   };
+
+  /**
+   *	@brief Detects the NTL allocator extension <tt>bool expand(pointer p, size_type n, size_type new_n)</tt>
+   *
+   *  The expand() grows the block of \c n elements at \c p to \c new_n elements without moving it,
+   *  returns false if it can't (the block is unchanged then).
+   **/
+  template<class Alloc>
+  struct has_allocator_expand
+  {
+    template<class A, bool (A::*)(typename A::pointer, typename A::size_type, typename A::size_type)> struct check;
+    template<class A> static char test(check<A, &A::expand>*);
+    template<class A> static int  test(...);
+    static const bool value = sizeof(test<Alloc>(0)) == sizeof(char);
+  };
+
+  template<class Alloc>
+  inline bool allocator_expand(Alloc& a, typename Alloc::pointer p, typename Alloc::size_type n, typename Alloc::size_type new_n, true_type)
+  {
+    return a.expand(p, n, new_n);
+  }
+
+  template<class Alloc>
+  inline bool allocator_expand(Alloc&, typename Alloc::pointer, typename Alloc::size_type, typename Alloc::size_type, false_type)
+  {
+    return false;
+  }
+
+  /** Grows the block in place if the allocator supports it */
+  template<class Alloc>
+  inline bool allocator_expand(Alloc& a, typename Alloc::pointer p, typename Alloc::size_type n, typename Alloc::size_type new_n)
+  {
+    return allocator_expand(a, p, n, new_n, bool_type<has_allocator_expand<Alloc>::value>());
+  }
 } // __
 
 /**@} lib_memory */
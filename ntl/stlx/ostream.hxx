@@ -257,15 +257,8 @@ class basic_ostream
       if (ok && sb)
       __ntl_try
       {
-        basic_streambuf<char_type, traits_type>* buf = rdbuf();
-        const int_type eof = traits_type::eof();
-        int_type c = sb->sgetc();
-        while(!traits_type::eq_int_type(c, eof)){
-          if(traits_type::eq_int_type(buf->sputc(traits_type::to_char_type(c)), eof))
-            break;
-          ++n;
-          c = sb->snextc();
-        }
+        bool at_eof;
+        n = __copy_streambuf(*sb, *rdbuf(), at_eof);
         //if(traits_type::eq_int_type(c, eof))
         //  state |= ios_base::eofbit;
       }
@@ -14,6 +14,7 @@
 #include "ratio.hxx"
 #include "cmath.hxx"
 #include "ext/numeric_conversions.hxx"
+#include "ext/bitops.hxx"
 
 #ifndef NTL_CXX_CONSTEXPR
 //#pragma push_macro("constexpr")
@@ -319,6 +320,18 @@ namespace std
     {
       return produce();
     }
+
+    /** Fills [first, last) by the values of the consecutive calls */
+    template<class ForwardIterator>
+    void generate(ForwardIterator first, ForwardIterator last)
+    {
+      // the state is kept in the register
+      result_type x = state_;
+      for(; first != last; ++first)
+        *first = x = zerom::eval(x);
+      state_ = x;
+    }
+
     void discard(unsigned long long z)
     {
       while(z--)
@@ -484,13 +497,22 @@ namespace std
     {
       if(n >= state_size)
         rotate();
+      return temper(state[n++]);
+    }
 
-      result_type z = state[n++];
-      z ^= (z >> tempering_u) & tempering_d;
-      z ^= (z << tempering_s) & tempering_b;
-      z ^= (z << tempering_t) & tempering_c;
-      z ^= (z >> tempering_l);
-      return z;
+    /** Fills [first, last) by the values of the consecutive calls */
+    template<class ForwardIterator>
+    void generate(ForwardIterator first, ForwardIterator last)
+    {
+      // the state is checked once per the rotated block
+      while(first != last){
+        if(n >= state_size)
+          rotate();
+        size_t i = n;
+        for(; i < state_size && first != last; ++first)
+          *first = temper(state[i++]);
+        n = i;
+      }
     }
 
     void discard(unsigned long long z)
@@ -544,6 +566,15 @@ namespace std
       n = 0;
     }
 
+    static result_type temper(result_type z)
+    {
+      z ^= (z >> tempering_u) & tempering_d;
+      z ^= (z << tempering_s) & tempering_b;
+      z ^= (z << tempering_t) & tempering_c;
+      z ^= (z >> tempering_l);
+      return z;
+    }
+
   private:
     UIntType state[state_size];
     size_t n;
@@ -622,6 +653,14 @@ namespace std
       return e();
     }
 
+    /** Fills [first, last) by the values of the consecutive calls */
+    template<class ForwardIterator>
+    void generate(ForwardIterator first, ForwardIterator last)
+    {
+      for(; first != last; ++first)
+        *first = this->operator ()();
+    }
+
     void discard(unsigned long long z)
     {
       while(z--)
@@ -731,6 +770,14 @@ namespace std
       return Y;
     }
 
+    /** Fills [first, last) by the values of the consecutive calls */
+    template<class ForwardIterator>
+    void generate(ForwardIterator first, ForwardIterator last)
+    {
+      for(; first != last; ++first)
+        *first = this->operator()();
+    }
+
     void discard(unsigned long long z)
     {
       while(z--)
@@ -892,47 +939,6 @@ namespace std
 
 
 
-  /**
-   *	@brief 26.5.6 Class random_device [rand.device]
-   *  @details A random_device uniform random number generator produces non-deterministic random numbers.
-   *  @note In NTL mt19937 selected as generator.
-   **/
-  class random_device
-  {
-  public:
-    ///\name types
-    typedef unsigned int result_type;
-
-    ///\name generator characteristics
-    static constexpr result_type min() { return numeric_limits<result_type>::min(); }
-    static constexpr result_type max() { return numeric_limits<result_type>::max(); }
-
-    ///\name constructors
-    random_device()
-    {}
-    /** Constructs generator with initial state determined by \p token (which must be a number). */
-    explicit random_device(const string& token)
-    {
-      result_type s = ntl::numeric::strtoul(token.c_str());
-      if(s)
-        gen.seed(s);
-    }
-
-    ///\name generating functions
-    result_type operator()() { return gen(); }
-
-    ///\name property functions
-    double entropy() const __ntl_nothrow { return 0.0; }
-    ///\}
-  private:
-    mt19937 gen;
-
-    random_device(const random_device& ) __deleted;
-    void operator=(const random_device& ) __deleted;
-  };
-
-
-
   /**\addtogroup  lib_numeric_rand_util ************ 26.5.7 Utilities [rand.util]
   *@{
   **/
@@ -1087,6 +1093,63 @@ namespace std
 
 
 
+  namespace __
+  {
+    /** The constants of generate_canonical() computed once for the series of values */
+    template<class RealType, size_t bits, class URNG>
+    class canonical
+    {
+    public:
+      explicit canonical(URNG& g)
+        :min(static_cast<double>(g.min())), R(1.0 + static_cast<double>(g.max()) - static_cast<double>(g.min())), shift(), direct(false)
+      {
+        static const size_t rd = numeric_limits<RealType>::digits,
+          b = rd < bits ? rd : bits;
+
+        // the generator of the w-bit values with w >= b gives the b bits at once
+        const uint64_t gmin = static_cast<uint64_t>(g.min()), gmax = static_cast<uint64_t>(g.max());
+        if(gmin == 0 && (gmax & (gmax + 1)) == 0 && b < 64){
+          const size_t w = ext::bitops::popcount(gmax);
+          if(w >= b){
+            shift = static_cast<unsigned>(w - b);
+            direct = true;
+            k = 1;
+            scale = 1.0 / static_cast<double>(uint64_t(1) << b);
+            return;
+          }
+        }
+
+        const size_t log2r = static_cast<size_t>(std::log(R) / std::log(2.0));
+        k = std::max<size_t>(1, (b + log2r - 1) / log2r);
+        double ri = 1;
+        for(size_t i = 0; i < k; i++)
+          ri *= R;
+        scale = 1 / ri;
+      }
+
+      RealType operator()(URNG& g) const
+      {
+        if(direct)
+          // exact and below 1: the signed conversion of the b bits is cheap
+          return static_cast<RealType>(static_cast<int64_t>(static_cast<uint64_t>(g()) >> shift) * scale);
+        double S = 0, ri = 1;
+        for(size_t i = 0; i < k; i++){
+          S += (g() - min) * ri;
+          ri *= R;
+        }
+        // the rounding may reach 1 which is out of range
+        const RealType re = static_cast<RealType>(S * scale);
+        return re < RealType(1) ? re : RealType(1) - numeric_limits<RealType>::epsilon() / 2;
+      }
+
+    private:
+      double min, R, scale;
+      size_t k;
+      unsigned shift;
+      bool direct;
+    };
+  }
+
   /**
    *	@brief 26.5.7.2 Function template generate_canonical [rand.util.canonical]
    *  @details Each function instantiated from the template described in this section 26.5.7.2 maps the result of one or
@@ -1097,18 +1160,7 @@ namespace std
   template<class RealType, size_t bits, class URNG>
   inline RealType generate_canonical(URNG& g)
   {
-    static const size_t rd = numeric_limits<RealType>::digits, 
-      b = rd < bits ? rd : bits;
-    const double R = 1.0 + g.max() - g.min();
-    const size_t log2r = static_cast<size_t>(std::log(R) / std::log(2.0));
-    const size_t k = std::max<size_t>(1, b / log2r);
-    const double min = g.min();
-    double S = 0, ri = 1;
-    for(size_t i = 0; i < k; i++){
-      S += (g() - min) * ri;
-      ri *= R;
-    }
-    return static_cast<RealType>(S / ri);
+    return __::canonical<RealType, bits, URNG>(g)(g);
   }
 
   /**@} lib_numeric_rand_util */
@@ -1119,6 +1171,8 @@ namespace std
   /**@} lib_numeric */
 }
 
+#include "ext/random_engines.hxx"
+#include "random_device.hxx"
 #include "random_dist.hxx"
 
 #ifndef NTL_CXX_CONSTEXPR
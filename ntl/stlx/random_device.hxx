@@ -0,0 +1,127 @@
+/**\file*********************************************************************
+ *                                                                     \brief
+ *  26.5.6 Class random_device [rand.device]
+ *
+ ****************************************************************************
+ */
+#ifndef NTL__STLX_RANDOM
+#error internal <random> file
+#endif
+#pragma once
+
+// the sources of random_device, the rest of <random> does not need them
+#include "ext/entropy.hxx"
+
+namespace std
+{
+ /**\addtogroup  lib_numeric ************ 26 Numerics library [numerics]
+  *@{
+  **/
+ /**\addtogroup  lib_numeric_rand ******* 26.5 Random number generation [rand]
+  *@{
+  **/
+
+  /**
+   *	@brief 26.5.6 Class random_device [rand.device]
+   *  @details A random_device uniform random number generator produces non-deterministic random numbers.
+   *  @note In NTL the values are taken from the ChaCha20 generator of the calling thread, which is seeded and reseeded
+   *  by the system source and the processor instructions RDSEED/RDRAND (see ext::entropy). So the most of the calls
+   *  neither enter the kernel nor wait for the processor. The other sources are selected by the token.
+   **/
+  class random_device
+  {
+  public:
+    ///\name types
+    typedef unsigned int result_type;
+
+    ///\name generator characteristics
+    static constexpr result_type min() { return numeric_limits<result_type>::min(); }
+    static constexpr result_type max() { return numeric_limits<result_type>::max(); }
+
+    ///\name constructors
+    random_device()
+      :source(buffered)
+    {}
+    /**
+     *	Constructs generator of the source named by the \p token:
+     *  - \c "default" (or empty) is the buffered generator;
+     *  - \c "rdseed" and \c "rdrand" are the processor instructions per value;
+     *  - \c "os" is the system source (ext::entropy::os_random()) per value;
+     *  - a number is the deterministic mt19937 seeded by it.
+     *  @throw runtime_error if the source is unknown or absent
+     **/
+    explicit random_device(const string& token) __ntl_throws(runtime_error)
+      :source(buffered)
+    {
+      if(token.empty() || token == "default")
+        return;
+      const ext::entropy::processor& cpu = ext::entropy::processor::features();
+      if(token == "rdseed" && cpu.rdseed)
+        source = rdseed;
+      else if(token == "rdrand" && cpu.rdrand)
+        source = rdrand;
+      else if(token == "os")
+        source = os;
+      else if(token.find_first_not_of("0123456789") == string::npos){
+        source = deterministic;
+        result_type s = ntl::numeric::strtoul(token.c_str());
+        if(s)
+          gen.seed(s);
+      }else
+        __ntl_throw(runtime_error("random_device: unsupported token"));
+    }
+
+    ///\name generating functions
+    result_type operator()() __ntl_throws(runtime_error)
+    {
+      if(source == buffered)
+        return pool()();
+      if(source == deterministic)
+        return gen();
+      uint32_t value;
+      const bool ok = source == rdseed ? ext::entropy::rdseed(&value, 1)
+        : source == rdrand ? ext::entropy::rdrand(&value, 1)
+        : ext::entropy::os_random(&value, sizeof(value));
+      if(!ok)
+        __ntl_throw(runtime_error("random_device: the source has failed"));
+      return value;
+    }
+
+    /** Fills [\p first, \p last) by the same values as the sequence of calls of operator() does */
+    template<class OutputIterator>
+    void generate(OutputIterator first, OutputIterator last) __ntl_throws(runtime_error)
+    {
+      if(source == buffered)
+        pool().generate(first, last);
+      else
+        for(; first != last; ++first)
+          *first = (*this)();
+    }
+
+    ///\name property functions
+    double entropy() const __ntl_nothrow { return source == deterministic ? 0.0 : numeric_limits<result_type>::digits; }
+    ///\}
+  private:
+    enum source_type { buffered, rdseed, rdrand, os, deterministic };
+
+  #ifdef NTL__EXT_ENTROPY_TLS
+    static ext::entropy::chacha20_random& pool()
+    {
+      static thread_local ext::entropy::chacha20_random generator;
+      return generator;
+    }
+  #else
+    ext::entropy::chacha20_random& pool() { return generator; }
+    ext::entropy::chacha20_random generator;
+  #endif
+
+    source_type source;
+    mt19937 gen;
+
+    random_device(const random_device& ) __deleted;
+    void operator=(const random_device& ) __deleted;
+  };
+
+  /**@} lib_numeric_rand */
+  /**@} lib_numeric */
+}
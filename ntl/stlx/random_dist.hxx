@@ -28,7 +28,7 @@ namespace std
     struct uniform2real
     {
       uniform2real(E& e)
-        :e(e)
+        :e(e), canon(e)
       {}
 
       static R min() { return R(0); }
@@ -36,10 +36,11 @@ namespace std
 
       R operator()()
       {
-        return std::generate_canonical<R, std::numeric_limits<R>::digits, E>(e);
+        return canon(e);
       }
     private:
       E& e;
+      const canonical<R, std::numeric_limits<R>::digits, E> canon;
       uniform2real& operator=(const uniform2real&) __deleted;
     };
   }
@@ -80,40 +81,21 @@ namespace std
     template<class URNG>
     result_type operator()(URNG& g, const param_type& p)
     {
-      typedef typename make_unsigned<result_type>::type R;
-      typedef typename make_unsigned<typename URNG::result_type>::type UR;
-      typedef typename conditional<( sizeof(R) > sizeof(UR) ), R, UR>::type T;
-
-      assert(p.first <= p.second);
-      const T umin = g.min(), umax = g.max(), uspace = umax-umin, pspace = p.second - p.first;
-      T re;
-      if(uspace > pspace) {
-        // zoom out
-        const T space = pspace+1,
-          scale = uspace / space,
-          up = scale * space;
+      return mapping<URNG>(g, p)(g);
+    }
 
-        do {
-          re = static_cast<T>(g()) - umin;
-        } while(re >= up);
-
-        re /= scale;
-
-      } else if(uspace < pspace) {
-        // zoom in
-        T x;
-        const T space = uspace+1;
-        const param_type smaller(0, space != 0 ? static_cast<IntType>(pspace / space) : IntType());
-        do {
-          x = space * this->operator()(g, smaller);
-          re = x + ( static_cast<T>(g()) - umin );
-        } while(re > pspace || re < x);
-
-      } else {
-        // equal space
-        re = static_cast<T>(g()) - umin;
-      }
-      return static_cast<IntType>(re + p.first);
+    /** Fills [first, last) by the values of the consecutive calls, the range is mapped once */
+    template<class ForwardIterator, class URNG>
+    void generate(ForwardIterator first, ForwardIterator last, URNG& g)
+    {
+      generate(first, last, g, p);
+    }
+    template<class ForwardIterator, class URNG>
+    void generate(ForwardIterator first, ForwardIterator last, URNG& g, const param_type& parm)
+    {
+      const mapping<URNG> map(g, parm);
+      for(; first != last; ++first)
+        *first = map(g);
     }
 
     ///\name property functions
@@ -144,6 +126,95 @@ namespace std
       return is >> x.p.first >> x.p.second;
     }
     ///\}
+  private:
+    /** Maps the values of the generator to the requested range */
+    template<class URNG>
+    class mapping
+    {
+      typedef typename make_unsigned<result_type>::type R;
+      typedef typename make_unsigned<typename URNG::result_type>::type UR;
+      typedef typename conditional<( sizeof(R) > sizeof(UR) ), R, UR>::type T;
+      enum method { equal_space, multiply32, multiply64, zoom_out, zoom_in };
+    public:
+      mapping(URNG& g, const param_type& p)
+        :p(p), umin(g.min()), uspace(static_cast<T>(g.max()) - umin), pspace(static_cast<T>(p.second) - static_cast<T>(p.first)),
+        space(), scale(), up(), threshold()
+      {
+        assert(p.first <= p.second);
+        if(uspace == pspace){
+          how = equal_space;
+        }else if(uspace > pspace){
+          space = pspace + 1;
+          if(uspace == 0xFFFFFFFF){
+            // the multiplication by the range instead of the division [Lemire]
+            how = multiply32;
+            threshold = static_cast<uint32_t>(0 - static_cast<uint32_t>(space)) % static_cast<uint32_t>(space);
+          }else if(sizeof(T) == sizeof(uint64_t) && uspace == static_cast<T>(~uint64_t(0))){
+            how = multiply64;
+            threshold = (0 - static_cast<uint64_t>(space)) % static_cast<uint64_t>(space);
+          }else{
+            how = zoom_out;
+            scale = uspace / space;
+            up = scale * space;
+          }
+        }else{
+          how = zoom_in;
+          space = uspace + 1;
+        }
+      }
+
+      result_type operator()(URNG& g) const
+      {
+        T re;
+        switch(how){
+        case equal_space:
+          re = static_cast<T>(g()) - umin;
+          break;
+        case multiply32:
+          {
+            uint64_t m;
+            do {
+              m = static_cast<uint64_t>(static_cast<uint32_t>(static_cast<T>(g()) - umin)) * static_cast<uint32_t>(space);
+            } while(static_cast<uint32_t>(m) < threshold);
+            re = static_cast<T>(m >> 32);
+          }
+          break;
+        case multiply64:
+          {
+            uint64_t hi;
+            while(ext::__::mul128(static_cast<uint64_t>(static_cast<T>(g()) - umin), static_cast<uint64_t>(space), hi) < threshold)
+              ;
+            re = static_cast<T>(hi);
+          }
+          break;
+        case zoom_out:
+          do {
+            re = static_cast<T>(g()) - umin;
+          } while(re >= up);
+          re /= scale;
+          break;
+        default:
+          {
+            // zoom in
+            T x;
+            const param_type smaller(0, space != 0 ? static_cast<IntType>(pspace / space) : IntType());
+            do {
+              x = space * static_cast<T>(mapping(g, smaller)(g));
+              re = x + ( static_cast<T>(g()) - umin );
+            } while(re > pspace || re < x);
+          }
+          break;
+        }
+        return static_cast<IntType>(re + p.first);
+      }
+
+    private:
+      param_type p;
+      T umin, uspace, pspace, space, scale, up;
+      uint64_t threshold;
+      method how;
+    };
+
   private:
     param_type p;
   };
@@ -178,10 +249,28 @@ namespace std
     template<class URNG>
     result_type operator()(URNG& g)
     {
-      this->operator()(g, param_type(0.0,1.0));
+      return this->operator()(g, p);
     }
     template<class URNG>
-    result_type operator()(URNG& g, const param_type& parm);
+    result_type operator()(URNG& g, const param_type& parm)
+    {
+      return std::generate_canonical<RealType, numeric_limits<RealType>::digits>(g) * (parm.second - parm.first) + parm.first;
+    }
+
+    /** Fills [first, last) by the values of the consecutive calls */
+    template<class ForwardIterator, class URNG>
+    void generate(ForwardIterator first, ForwardIterator last, URNG& g)
+    {
+      generate(first, last, g, p);
+    }
+    template<class ForwardIterator, class URNG>
+    void generate(ForwardIterator first, ForwardIterator last, URNG& g, const param_type& parm)
+    {
+      const __::canonical<RealType, numeric_limits<RealType>::digits, URNG> canon(g);
+      const RealType a = parm.first, width = parm.second - parm.first;
+      for(; first != last; ++first)
+        *first = canon(g) * width + a;
+    }
 
     ///\name property functions
     result_type a()     const { return p.first;  }
@@ -259,27 +348,22 @@ namespace std
     template<class URNG>
     result_type operator()(URNG& g, const param_type& parm)
     {
-      result_type re;
-      typedef result_type T;
-      if(res.second){
-        re = res.first;
-        res.second = false;
-      }else{
-        __::uniform2real<URNG, T> rg(g);
-        T x,y,r2;
-        do{
-          x = T(2) * rg() - 1;
-          y = T(2) * rg() - 1;
-          r2 = x*x + y*y;
-        }while(r2 > 1 || r2 == 0);
-        
-        const T m = std::sqrt(-2 * std::log(r2) / r2);
-        res.first = m * x,
-          res.second = true;
-        re = m * y;
-      }
-      re = re * parm.second + parm.first;
-      return re;
+      __::uniform2real<URNG, result_type> rg(g);
+      return next(rg, parm);
+    }
+
+    /** Fills [first, last) by the values of the consecutive calls */
+    template<class ForwardIterator, class URNG>
+    void generate(ForwardIterator first, ForwardIterator last, URNG& g)
+    {
+      generate(first, last, g, p);
+    }
+    template<class ForwardIterator, class URNG>
+    void generate(ForwardIterator first, ForwardIterator last, URNG& g, const param_type& parm)
+    {
+      __::uniform2real<URNG, result_type> rg(g);
+      for(; first != last; ++first)
+        *first = next(rg, parm);
     }
 
     ///\name property functions
@@ -325,6 +409,32 @@ namespace std
       return is;
     }
     ///\}
+  private:
+    template<class Uniform>
+    result_type next(Uniform& rg, const param_type& parm)
+    {
+      result_type re;
+      typedef result_type T;
+      if(res.second){
+        re = res.first;
+        res.second = false;
+      }else{
+        T x,y,r2;
+        do{
+          x = T(2) * rg() - 1;
+          y = T(2) * rg() - 1;
+          r2 = x*x + y*y;
+        }while(r2 > 1 || r2 == 0);
+
+        const T m = std::sqrt(-2 * std::log(r2) / r2);
+        res.first = m * x,
+          res.second = true;
+        re = m * y;
+      }
+      re = re * parm.second + parm.first;
+      return re;
+    }
+
   private:
     param_type p;
     pair<result_type, bool> res;
@@ -49,6 +49,11 @@ namespace std {
     typedef std::reverse_iterator<iterator>       reverse_iterator;
     typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
 
+#ifdef NTL_CXX_RV
+    typedef ext::set_node_handle<typename tree_type::node, typename tree_type::node_allocator_type, Allocator, Key> node_type;
+    typedef ext::node_insert_return<iterator, node_type> insert_return_type;
+#endif
+
   public:
     // 23.3.3.1 construct/copy/destroy:
     explicit set(const Compare& comp = Compare(),
@@ -151,10 +156,9 @@ namespace std {
       return std::make_pair(insert_impl(place.second, construct_node(x), greater), true);
     }
 
-    iterator insert(const_iterator /*position*/, const value_type& x)
+    iterator insert(const_iterator position, const value_type& x)
     {
-      // TODO: implement fast insert function based on position
-      return insert(x).first;
+      return tree_type::insert(position, x);
     }
 
 #ifdef NTL_CXX_RV
@@ -162,10 +166,46 @@ namespace std {
     {
       return tree_type::insert_reference(std::forward<value_type>(x));
     }
-    iterator insert(const_iterator /*position*/, value_type&& x)
+    iterator insert(const_iterator position, value_type&& x)
+    {
+      return tree_type::insert_reference(position, std::forward<value_type>(x));
+    }
+#endif
+
+#ifdef NTL_CXX_RV
+    // node handles:
+    node_type extract(const_iterator position)
+    {
+      return tree_type::template extract_node<node_type>(position);
+    }
+
+    node_type extract(const key_type& x)
+    {
+      const iterator i = find(x);
+      return i == end() ? node_type() : extract(i);
+    }
+
+    insert_return_type insert(node_type&& nh)
+    {
+      if(nh.empty())
+        return insert_return_type(end(), false, node_type());
+      const pair<iterator, bool> r = tree_type::insert_node(cend(), nh);
+      return insert_return_type(r.first, r.second, r.second ? node_type() : std::move(nh));
+    }
+
+    iterator insert(const_iterator hint, node_type&& nh)
+    {
+      return nh.empty() ? end() : tree_type::insert_node(hint, nh).first;
+    }
+
+    void merge(set& source)
+    {
+      tree_type::merge_unique(source);
+    }
+
+    void merge(set&& source)
     {
-      // TODO: implement fast insert function based on position
-      return tree_type::insert_reference(std::forward<value_type>(x)).first;
+      tree_type::merge_unique(source);
     }
 #endif
 
@@ -10,6 +10,7 @@
 
 #include "ios.hxx"
 #include "istream.hxx"
+#include "string_ref.hxx"
 
 namespace std {
 
@@ -70,18 +71,18 @@ namespace std {
 
     ///\name 27.7.1.1 Constructors:
     explicit basic_stringbuf(ios_base::openmode which = ios_base::in | ios_base::out)
-      :mode_(which)
+      :mode_(which), ext_()
     {}
 
     explicit basic_stringbuf(const basic_string<charT,traits,Allocator>& s, ios_base::openmode which = ios_base::in | ios_base::out)
-      :mode_(which)
+      :mode_(which), ext_()
     {
       str(s);
     }
 
   #ifdef NTL_CXX_RV
     basic_stringbuf(basic_stringbuf&& rhs)
-      :mode_()
+      :mode_(), ext_()
     {
       swap(rhs);
     }
@@ -102,11 +103,16 @@ namespace std {
         basic_streambuf::swap(rhs);
         swap(str_, rhs.str_);
         swap(mode_, rhs.mode_);
+        swap(ext_, rhs.ext_);
       }
     }
 
     ///\name 27.7.1.3 Get and set:
+  #ifdef NTL_CXX_RVTHIS
+    basic_string<charT,traits,Allocator> str() const &
+  #else
     basic_string<charT,traits,Allocator> str() const
+  #endif
     {
       // NOTE: update to the specification:
       /*
@@ -125,8 +131,46 @@ namespace std {
       return basic_string<charT,traits,Allocator>(beg, std::max(endp,endg));
     }
 
+  #ifdef NTL_CXX_RVTHIS
+    /** Moves the character sequence out without copying, the stringbuf becomes empty */
+    basic_string<charT,traits,Allocator> str() &&
+    {
+      if(ext_){
+        // the external buffer can't be given away
+        basic_string<charT,traits,Allocator> s(view().begin(), view().end());
+        reset();
+        return s;
+      }
+      const char_type* const high = high_mark();
+      str_.resize(high ? high - str_.begin() : 0);
+      basic_string<charT,traits,Allocator> s(std::move(str_));
+      str_.clear();
+      // the new storage is allocated by the next output
+      this->setg(nullptr, nullptr, nullptr);
+      this->setp(nullptr, nullptr);
+      return s;
+    }
+  #endif
+
+    /** The view of the character sequence in the stringbuf storage, valid until the next output (NTL extension) */
+    basic_string_ref<charT,traits> view() const
+    {
+      const char_type* const beg = begin_mark();
+      return basic_string_ref<charT,traits>(beg, high_mark() - beg);
+    }
+
+    /** Empties the character sequence keeping the storage for the following output (NTL extension) */
+    void reset()
+    {
+      char_type* const beg = begin_mark();
+      if(mode_ & ios_base::out)
+        this->setp(beg, epptr());
+      this->setg(beg, beg, beg);
+    }
+
     void str(const basic_string<charT,traits,Allocator>& s)
     {
+      ext_ = nullptr;
       //str_ = s;
       if(mode_ & ios_base::out){
         // reserve additional characters for output buffer
@@ -193,6 +237,10 @@ namespace std {
         *pptr() = cc;
         pbump(1);
       }else{
+        if(ext_)
+          // the external buffer is full
+          return eof;
+
         if(mode_ & ios_base::app)
           pbump(static_cast<int>(epptr()-pptr()));
 
@@ -212,6 +260,31 @@ namespace std {
       return c;
     }
 
+    /**
+     *	@brief Makes the stringbuf use the fixed buffer [s, s+n), which is never reallocated (NTL extension)
+     *
+     *  The output fails when the buffer is full. In the input only mode the buffer contents are the input sequence,
+     *  otherwise the sequence is empty. The setbuf(0, 0) and str(s) return to the own storage of the stringbuf.
+     **/
+    virtual basic_streambuf<charT,traits>* setbuf(char_type* s, streamsize n)
+    {
+      str_.clear();
+      if(!s || n <= 0){
+        ext_ = nullptr;
+        this->setg(nullptr, nullptr, nullptr);
+        this->setp(nullptr, nullptr);
+        return this;
+      }
+      ext_ = s;
+      if(mode_ & ios_base::out){
+        this->setp(s, s + n);
+        this->setg(s, s, s);
+      }else{
+        this->setg(s, s, s + n);
+      }
+      return this;
+    }
+
     virtual pos_type seekoff(off_type off, ios_base::seekdir way, ios_base::openmode which = ios_base::in | ios_base::out)
     {
       pos_type re = pos_type(off_type(-1));
@@ -273,6 +346,19 @@ namespace std {
     ///\}
 
   private:
+    /// start of the character sequence, see str()
+    char_type* begin_mark() const
+    {
+      return mode_ & ios_base::out ? this->pbase()
+        : mode_ & ios_base::in ? this->eback() : 0;
+    }
+
+    /// one past the highest initialized character
+    char_type* high_mark() const
+    {
+      return std::max(pptr(), egptr());
+    }
+
     /// set stream poiners according to mode. \see str.
     void set_ptrs()
     {
@@ -312,8 +398,9 @@ namespace std {
         str_.resize(str_.capacity());
     }
   private:
-    basic_string<charT, traits> str_;
+    basic_string<charT, traits, Allocator> str_;
     ios_base::openmode mode_;
+    char_type* ext_; // the external buffer, see setbuf
   };
 
 
@@ -377,9 +464,16 @@ namespace std {
       return const_cast<basic_stringbuf<charT,traits,Allocator>*>(&sb);
     }
 
+  #ifdef NTL_CXX_RVTHIS
+    basic_string<charT,traits,Allocator> str() const & { return sb.str(); }
+    basic_string<charT,traits,Allocator> str() && { return std::move(sb).str(); }
+  #else
     basic_string<charT,traits,Allocator> str() const { return sb.str(); }
+  #endif
     void str(const basic_string<charT,traits,Allocator>& s) { sb.str(s); }
-
+    basic_string_ref<charT,traits> view() const { return sb.view(); }
+    /** Empties the character sequence keeping the storage (NTL extension) */
+    void reset() { sb.reset(); }
     ///\}
   private:
     basic_stringbuf<charT,traits,Allocator> sb;
@@ -448,8 +542,16 @@ namespace std {
     {
       return const_cast<basic_stringbuf<charT,traits,Allocator>*>(&sb);
     }
+  #ifdef NTL_CXX_RVTHIS
+    basic_string<charT,traits,Allocator> str() const & { return sb.str(); }
+    basic_string<charT,traits,Allocator> str() && { return std::move(sb).str(); }
+  #else
     basic_string<charT,traits,Allocator> str() const { return sb.str(); }
+  #endif
     void str(const basic_string<charT,traits,Allocator>& s) { sb.str(s); }
+    basic_string_ref<charT,traits> view() const { return sb.view(); }
+    /** Empties the character sequence keeping the storage (NTL extension) */
+    void reset() { sb.reset(); }
     ///\}
   private:
     basic_stringbuf<charT,traits,Allocator> sb;
@@ -519,11 +621,19 @@ namespace std {
 
     ///\name Members:
     basic_stringbuf<charT,traits,Allocator>* rdbuf() const { return const_cast<basic_stringbuf<charT,traits,Allocator>*>(&sb); }
+  #ifdef NTL_CXX_RVTHIS
+    basic_string<charT,traits,Allocator> str() const & { return sb.str(); }
+    basic_string<charT,traits,Allocator> str() && { return std::move(sb).str(); }
+  #else
     basic_string<charT,traits,Allocator> str() const { return sb.str(); }
+  #endif
     void str(const basic_string<charT,traits,Allocator>& str) { sb.str(str); }
+    basic_string_ref<charT,traits> view() const { return sb.view(); }
+    /** Empties the character sequence keeping the storage (NTL extension) */
+    void reset() { sb.reset(); }
     ///\}
   private:
-     basic_stringbuf<charT, traits> sb;
+     basic_stringbuf<charT, traits, Allocator> sb;
 
      basic_stringstream(const basic_stringstream& rhs) __deleted;
      basic_stringstream& operator=(const basic_stringstream& rhs) __deleted;
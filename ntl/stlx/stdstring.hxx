@@ -35,6 +35,9 @@
 #ifndef NTL__STLX_RANGE
 #include "range.hxx"
 #endif
+#ifndef NTL__EXT_STRING_SEARCH
+# include "ext/string_search.hxx"
+#endif
 
 #ifndef EOF // should be moved to "stdio.hxx" ?
 # define EOF -1
@@ -78,7 +81,7 @@ struct char_traits<char>
     { return strncmp(s1, s2, n); }
   static size_t length(const char_type* s) { return strlen(s); }
   static const char_type* find(const char_type* s, size_t n, const char_type& a)
-    { while ( n-- ) if ( a != *s ) ++s; else return s; return 0; }
+    { return static_cast<const char_type*>(memchr(s, to_int_type(a), n)); }
   static char_type* move(char_type* dst, const char_type* src, size_t n)
     { return reinterpret_cast<char_type*>(memmove(dst, src, n)); }
   static char_type* copy(char_type* dst, const char_type* src, size_t n)
@@ -113,7 +116,7 @@ struct char_traits<char16_t>
   { return wcsncmp(reinterpret_cast<const wchar_t*>(s1), reinterpret_cast<const wchar_t*>(s2), n); }
   static size_t length(const char_type* s) { return wcslen(reinterpret_cast<const wchar_t*>(s)); }
   static const char_type* find(const char_type* s, size_t n, const char_type& a)
-  { while ( n-- ) if ( a != *s ) ++s; else return s; return 0; }
+  { return ext::strsearch::find_char(s, n, a); }
   static char_type* move(char_type* dst, const char_type* src, size_t n)
   { return reinterpret_cast<char_type*>(memmove(dst, src, n*sizeof(char_type))); }
   static char_type* copy(char_type* dst, const char_type* src, size_t n)
@@ -156,7 +159,7 @@ struct char_traits<char32_t>
     return n;
   }
   static const char_type* find(const char_type* s, size_t n, const char_type& a)
-  { while ( n-- ) if ( a != *s ) ++s; else return s; return 0; }
+  { return ext::strsearch::find_char(s, n, a); }
   static char_type* move(char_type* dst, const char_type* src, size_t n)
   { return reinterpret_cast<char_type*>(memmove(dst, src, n*sizeof(char_type))); }
   static char_type* copy(char_type* dst, const char_type* src, size_t n)
@@ -194,7 +197,7 @@ struct char_traits<wchar_t>
     { return wcsncmp(s1, s2, n); }
   static size_t length(const char_type* s) { return wcslen(s); }
   static const char_type* find(const char_type* s, size_t n, const char_type& a)
-    { while ( n-- ) if ( a != *s ) ++s; else return s; return 0; }
+    { return ext::strsearch::find_char(s, n, a); }
   static char_type* move(char_type* dst, const char_type* src, size_t n)
     { return reinterpret_cast<char_type*>(memmove(dst, src, n * sizeof(char_type))); }
   static char_type* copy(char_type* dst, const char_type* src, size_t n)
@@ -1255,16 +1258,8 @@ struct char_traits<wchar_t>
       const size_type cursize = size();
       if(pos > cursize || pos+n > cursize) return npos;
       const charT* const beg = begin();
-      for ( size_type xpos = pos; xpos + n <= cursize; ++xpos )
-      {
-        for(size_type i = 0; i != n; ++i){
-          if ( !traits_type::eq(*(beg + xpos  + i), *(s + i)) )
-            goto next_xpos;
-        }
-        return xpos;
-      next_xpos:;
-      }
-      return npos;
+      const charT* const xp = ext::strsearch::search<traits_type>(beg + pos, cursize - pos, s, n);
+      return xp ? xp - beg : npos;
     }
 
     /// 5 Returns: find(basic_string<charT,traits,Allocator>(s),pos).
@@ -1277,12 +1272,11 @@ struct char_traits<wchar_t>
     /// 7 Returns: find(basic_string<charT,traits,Allocator>(1,c),pos).
     size_type find(charT c, size_type pos = 0) const
     {
-      const charT* const beg = begin();
       const size_type cursize = size();
-      for ( size_type xpos = pos; xpos < cursize; ++xpos )
-        if ( traits_type::eq(*(beg + xpos), c) )
-          return xpos;
-      return npos;
+      if(pos >= cursize) return npos;
+      const charT* const beg = begin();
+      const charT* const xp = traits_type::find(beg + pos, cursize - pos, c);
+      return xp ? xp - beg : npos;
     }
 
     ///\name   basic_string::rfind [21.4.6.2 string::rfind]
@@ -1370,14 +1364,10 @@ next_xpos:
     /// 4 Returns: find_first_of(basic_string<charT,traits,Allocator>(s,n),pos).
     size_type find_first_of(const charT* s, size_type pos, size_type n) const
     {
+      if(pos >= length_) return npos;
       const charT* const beg = begin();
-      for ( size_type xpos = pos; xpos < length_; ++xpos ){
-        for ( size_type i = 0; i != n; ++i ) {
-          if ( traits_type::eq(*(beg + xpos), *(s + i)) )
-            return xpos;
-        }
-      }
-      return npos;
+      const charT* const xp = ext::strsearch::find_first_of<traits_type, true>(beg + pos, length_ - pos, s, n);
+      return xp ? xp - beg : npos;
     }
 
     /// 5 Returns: find_first_of(basic_string<charT,traits,Allocator>(s),pos).
@@ -1390,11 +1380,7 @@ next_xpos:
     /// 7 Returns: find_first_of(basic_string<charT,traits,Allocator>(1,c),pos).
     size_type find_first_of(charT c, size_type pos = 0) const
     {
-      const charT* const beg = begin();
-      for ( size_type xpos = pos; xpos < length_; ++xpos )
-        if ( traits_type::eq(*(beg + xpos), c) )
-          return xpos;
-      return npos;
+      return find(c, pos);
     }
 
     ///\name  21.4.7.5 basic_string::find_last_of [string::find.last.of]
@@ -1417,17 +1403,9 @@ next_xpos:
     {
       if(!n || !length_)
         return npos;
-
-      size_type xpos = min(pos, length_-1);
       const charT* const beg = begin();
-      do
-      {
-        for ( size_type i = 0; i != n; ++i ){
-          if ( traits_type::eq(*(beg + xpos), *(s + i)) )
-            return xpos;
-        }
-      }while(xpos--);
-      return npos;
+      const charT* const xp = ext::strsearch::find_last_of<traits_type, true>(beg, min(pos, length_-1) + 1, s, n);
+      return xp ? xp - beg : npos;
     }
 
     /// 5 Returns: find_last_of(basic_string<charT,traits,Allocator>(s),pos).
@@ -1461,17 +1439,11 @@ next_xpos:
     /// 4 Returns: find_first_not_of(basic_string<charT,traits,Allocator>(s,n),pos).
     size_type find_first_not_of(const charT* s, size_type pos, size_type n) const
     {
-      const charT* const beg = begin();
       const size_type cursize = size();
-      for ( size_type xpos = pos; xpos < cursize; ++xpos )
-      {
-        for ( size_type i = 0; i != n; ++i )
-          if ( traits_type::eq(*(beg + xpos), *(s + i)) )
-            goto next_xpos;
-        return xpos;
-next_xpos:;
-      }
-      return npos;
+      if(pos >= cursize) return npos;
+      const charT* const beg = begin();
+      const charT* const xp = ext::strsearch::find_first_of<traits_type, false>(beg + pos, cursize - pos, s, n);
+      return xp ? xp - beg : npos;
     }
 
     /// 5 Returns: find_first_not_of(basic_string<charT,traits,Allocator>(s),pos).
@@ -1510,18 +1482,11 @@ next_xpos:;
     /// 4 Returns: find_last_not_of(basic_string<charT,traits,Allocator>(s,n),pos).
     size_type find_last_not_of(const charT* s, size_type pos, size_type n) const
     {
-      const charT* const beg = begin();
       const size_type cursize = size();
-      for ( size_type xpos = pos < cursize ? pos + 1 : cursize; xpos; )
-      {
-        --xpos;
-        for ( size_type i = 0; i != n; ++i )
-          if ( traits_type::eq(*(beg + xpos), *(s + i)) )
-            goto next_xpos;
-        return xpos;
-next_xpos:;
-      }
-      return npos;
+      if(!cursize) return npos;
+      const charT* const beg = begin();
+      const charT* const xp = ext::strsearch::find_last_of<traits_type, false>(beg, min(pos, cursize-1) + 1, s, n);
+      return xp ? xp - beg : npos;
     }
 
     /// 5 Returns: find_last_not_of(basic_string<charT,traits,Allocator>(s),pos).
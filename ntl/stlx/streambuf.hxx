@@ -368,6 +368,45 @@ class basic_streambuf
 
     ///@}
 
+    /**
+     *	@brief Copies the input sequence of \p from to \p to (used by the stream buffer insertion and extraction)
+     *
+     *  Moves the whole get area of \p from at once with to.sputn(), so the buffered streams exchange
+     *  the blocks of their buffer size instead of the characters.
+     *  @param[out] at_eof set if the input sequence is over
+     *  @return number of the copied characters
+     **/
+    friend streamsize __copy_streambuf(basic_streambuf& from, basic_streambuf& to, bool& at_eof)
+    {
+      const int_type eof = traits_type::eof();
+      streamsize copied = 0;
+      at_eof = false;
+      for(;;){
+        const streamsize avail = from.gend - from.gnext;
+        if(0 < avail){
+          const streamsize written = to.sputn(from.gnext, avail);
+          from.gnext += written;
+          copied += written;
+          if(written < avail)
+            break;
+          continue;
+        }
+        const int_type c = from.underflow();
+        if(traits_type::eq_int_type(c, eof)){
+          at_eof = true;
+          break;
+        }
+        if(!(from.gnext < from.gend)){
+          // unbuffered input
+          if(traits_type::eq_int_type(to.sputc(traits_type::to_char_type(c)), eof))
+            break;
+          from.sbumpc();
+          copied++;
+        }
+      }
+      return copied;
+    }
+
   ///////////////////////////////////////////////////////////////////////////
   //private:
 
@@ -202,17 +202,10 @@ namespace std
     //////////////////////////////////////////////////////////////////////////
     size_type find(const basic_string_ref& s, size_type pos = 0) const
     {
-      const charT* const beg = begin(), *p = s.begin();
-      for(size_type xpos = pos, n = s.length(); xpos + n <= len; ++xpos)
-      {
-        for(size_type i = 0; i != n; ++i){
-          if ( !traits_type::eq(*(beg + xpos  + i), *(p + i)) )
-            goto next_xpos;
-        }
-        return xpos;
-      next_xpos:;
-      }
-      return npos;
+      if(pos > len || s.len > len - pos)
+        return npos;
+      const charT* e = ext::strsearch::search<traits_type>(p+pos, len-pos, s.p, s.len);
+      return e == nullptr ? npos : (e-p);
     }
 
     size_type find(charT c, size_type pos = 0) const
@@ -254,14 +247,50 @@ namespace std
       return npos;
     }
 
-    size_type find_first_of(const basic_string_ref& s) const;
-    size_type find_first_of(charT c) const;
-    size_type find_last_of(const basic_string_ref& s) const;
-    size_type find_last_of(charT c) const;
-    size_type find_first_not_of(const basic_string_ref& s) const;
-    size_type find_first_not_of(charT c) const;
-    size_type find_last_not_of(const basic_string_ref& s) const;
-    size_type find_last_not_of(charT c) const;
+    size_type find_first_of(const basic_string_ref& s, size_type pos = 0) const
+    {
+      if(pos >= len)
+        return npos;
+      const charT* e = ext::strsearch::find_first_of<traits_type, true>(p+pos, len-pos, s.p, s.len);
+      return e == nullptr ? npos : (e-p);
+    }
+    size_type find_first_of(charT c, size_type pos = 0) const
+    {
+      return find(c, pos);
+    }
+    size_type find_last_of(const basic_string_ref& s, size_type pos = npos) const
+    {
+      if(!len)
+        return npos;
+      const charT* e = ext::strsearch::find_last_of<traits_type, true>(p, min(pos, len-1)+1, s.p, s.len);
+      return e == nullptr ? npos : (e-p);
+    }
+    size_type find_last_of(charT c, size_type pos = npos) const
+    {
+      return find_last_of(basic_string_ref(&c, 1), pos);
+    }
+    size_type find_first_not_of(const basic_string_ref& s, size_type pos = 0) const
+    {
+      if(pos >= len)
+        return npos;
+      const charT* e = ext::strsearch::find_first_of<traits_type, false>(p+pos, len-pos, s.p, s.len);
+      return e == nullptr ? npos : (e-p);
+    }
+    size_type find_first_not_of(charT c, size_type pos = 0) const
+    {
+      return find_first_not_of(basic_string_ref(&c, 1), pos);
+    }
+    size_type find_last_not_of(const basic_string_ref& s, size_type pos = npos) const
+    {
+      if(!len)
+        return npos;
+      const charT* e = ext::strsearch::find_last_of<traits_type, false>(p, min(pos, len-1)+1, s.p, s.len);
+      return e == nullptr ? npos : (e-p);
+    }
+    size_type find_last_not_of(charT c, size_type pos = npos) const
+    {
+      return find_last_not_of(basic_string_ref(&c, 1), pos);
+    }
 
   private:
     pointer p;
@@ -126,6 +126,17 @@ namespace __ {
     public bool_type<is_pod<T>::value || has_trivial_destructor<T>::value>
   {};
 
+  /**
+   *	@brief Can the object of T be moved to the other address by memcpy(), leaving the source as the raw memory
+   *
+   *  True for the trivially copyable types. Specialize it for the types which don't point to themselves
+   *  and aren't known by their address elsewhere, like the containers holding their data by pointers.
+   **/
+  template<typename T>
+  struct is_trivially_relocatable:
+    public bool_type<is_pod<T>::value || (has_trivial_copy_constructor<T>::value && has_trivial_destructor<T>::value)>
+  {};
+
 
   ///\name 30.2.6 decay_copy [thread.decaycopy]
 #ifdef NTL_CXX_RV
@@ -68,6 +68,10 @@ namespace std {
     typedef typename allocator_type::reference        reference;
     typedef typename allocator_type::const_reference  const_reference;
 #endif
+#ifdef NTL_CXX_RV
+    typedef ext::map_node_handle<typename base::node, typename base::node_allocator, Allocator, Key, T> node_type;
+    typedef ext::node_insert_return<typename base::iterator, node_type> insert_return_type;
+#endif
 
   public:
     using base::insert;
@@ -199,6 +203,50 @@ namespace std {
     template <class... Args> iterator emplace_hint(const_iterator position, Args&&... args);
 #endif
 
+#ifdef NTL_CXX_RV
+    ///\name node handles
+    /** Unlinks the element in the specified position and returns the node owning it */
+    node_type extract(const_iterator position)
+    {
+      return base::template extract_node<node_type>(position);
+    }
+
+    /** Unlinks the element with the given key, if any */
+    node_type extract(const key_type& k)
+    {
+      const_iterator i = find(k);
+      return i == cend() ? node_type() : extract(i);
+    }
+
+    /** Links the node if container doesn't have element with its key, otherwise the node is returned back */
+    insert_return_type insert(node_type&& nh)
+    {
+      if(nh.empty())
+        return insert_return_type(end(), false, node_type());
+      const pair<iterator, bool> r = base::insert_node(nh);
+      return insert_return_type(r.first, r.second, r.second ? node_type() : std::move(nh));
+    }
+
+    /** Links the node if container doesn't have element with its key.
+        @return iterator, which points to the element with the key of node */
+    iterator insert(const_iterator /*hint*/, node_type&& nh)
+    {
+      return nh.empty() ? end() : base::insert_node(nh).first;
+    }
+
+    /** Moves the nodes of \c source which keys are absent in container, the elements are neither copied nor allocated */
+    void merge(unordered_map& source)
+    {
+      base::merge_unique(source);
+    }
+
+    void merge(unordered_map&& source)
+    {
+      base::merge_unique(source);
+    }
+    ///\}
+#endif
+
 #ifdef NTL_DOC
     /** Inserts value if container doesn't have element with the specified key.
         @return Pair of iterator, which points to the given element, and flag, which indicates whether the insertion takes place */
@@ -419,37 +419,20 @@ class vector
 
     iterator insert__blank_space(const_iterator position, const size_type n)
     {
-      const size_type old_capacity = capacity_;
-      iterator old_mem = 0;
-      iterator new_end = end_ + n;
-      // a hint to compiler - may be it'll eliminate  while ( tail_size-- ) ...
-      difference_type tail_size = end_ - position;
-      // realloc the first part if needed
+      const iterator pos = const_cast<iterator>(position);
+      // realloc if needed
       if ( capacity_ < end_- begin_ + n )
       {
-        old_mem = begin_;
-        capacity_ = n + capacity_factor();
-        const iterator new_mem = array_allocator.allocate(capacity_);
-        new_end = new_mem + difference_type(new_end - old_mem);
-        //new_end += difference_type(new_mem - old_mem);        // dangerous alignment
-        iterator dest = begin_ = new_mem;
-        // this is safe for begin_ == 0 && end_ == 0, but keep vector() intact
-        //#ifndef NTL_CXX_RV
-        for ( iterator src = old_mem; src != position; ++src, ++dest )
-          move(dest, src);
-        //#else
-        //for ( iterator src = old_mem; src != position; ++src, ++dest ){
-        //  *dest = std::move(*src);
-        //  array_allocator.destroy(src);
-        //}
-        //#endif
+        const size_type new_capacity = n + capacity_factor();
+        if ( begin_ && __::allocator_expand(array_allocator, begin_, capacity_, new_capacity) )
+          capacity_ = new_capacity;
+        else
+          return reallocate(new_capacity, pos, n) + n;
       }
-      // move the tail. iterators are reverse - may be no realloc
-      iterator r_src = end();
-      iterator r_dest = end_ = new_end;
-      while ( tail_size-- )
-        move(--r_dest, --r_src);
-      if ( old_mem ) array_allocator.deallocate(old_mem, old_capacity);
+      // move the tail. iterators are reverse - no realloc
+      const iterator r_dest = pos + n;
+      relocate_backward(r_dest, pos, end_, relocatable());
+      end_ += n;
       return r_dest;
     }
 
@@ -524,7 +507,8 @@ class vector
     {
       if ( size() == capacity() ) realloc(capacity_factor());
       //*end_++ = move(x);
-      array_allocator.construct(end_++, forward<value_type>(x));
+      array_allocator.construct(end_, forward<value_type>(x));
+      ++end_;
     }
     #endif
 
@@ -532,7 +516,8 @@ class vector
     void push_back(const T& x)
     {
       if ( size() == capacity() ) realloc(capacity_factor());
-      array_allocator.construct(end_++, (x));
+      array_allocator.construct(end_, (x));
+      ++end_;
     }
 
     void pop_back() __ntl_nothrow { array_allocator.destroy(--end_); }
@@ -695,18 +680,87 @@ class vector
       array_allocator.destroy(from);
     }
 
+    typedef __::bool_type<__::is_trivially_relocatable<T>::value> relocatable;
+
+    /// moves [begin_, position) to the raw memory at dest and [position, end_) to dest_tail, the source becomes the raw memory
+    void relocate(iterator dest, iterator position, iterator dest_tail, true_type) const
+    {
+      if ( position != begin_ ) memcpy(dest, begin_, (position - begin_) * sizeof(T));
+      if ( position != end_ ) memcpy(dest_tail, position, (end_ - position) * sizeof(T));
+    }
+
+    /// the elements are destroyed after all of them are constructed, so the vector keeps them if a constructor throws
+    void relocate(iterator dest, iterator position, iterator dest_tail, false_type) const
+    {
+      iterator src = begin_, to = dest;
+      __ntl_try
+      {
+        for ( ; src != end_; ++src, ++to )
+        {
+          if ( src == position ) to = dest_tail;
+          #ifndef NTL_CXX_RV
+          array_allocator.construct(to, *src);
+          #else
+          array_allocator.construct(to, forward<value_type>(*src));
+          #endif
+        }
+      }
+      __ntl_catch(...)
+      {
+        for ( iterator p = begin_; p != src; ++p, ++dest )
+        {
+          if ( p == position ) dest = dest_tail;
+          array_allocator.destroy(dest);
+        }
+        __ntl_rethrow;
+      }
+      for ( src = begin_; src != end_; ++src )
+        array_allocator.destroy(src);
+    }
+
+    /// the same as relocate() for the overlapping ranges with dest > first
+    void relocate_backward(iterator dest, iterator first, iterator last, true_type) const
+    {
+      if ( first != last ) memmove(dest, first, (last - first) * sizeof(T));
+    }
+
+    void relocate_backward(iterator dest, iterator first, iterator last, false_type) const
+    {
+      for ( iterator r_dest = dest + (last - first); last != first; )
+        move(--r_dest, --last);
+    }
+
     void realloc(size_type n) __ntl_throws(bad_alloc)
+    {
+      // the elements stay in place if the allocator can grow the block
+      if ( begin_ && __::allocator_expand(array_allocator, begin_, capacity_, n) ){
+        capacity_ = n;
+        return;
+      }
+      reallocate(n, end_, 0);
+    }
+
+    /// moves the elements to the new block of n elements leaving the gap of raw elements at position, returns the gap.
+    /// The vector is unchanged if the allocation or an element constructor throws
+    iterator reallocate(size_type n, iterator position, size_type gap) __ntl_throws(bad_alloc)
     {
       const iterator new_mem = array_allocator.allocate(n);
-      const size_type old_capacity = capacity_;
-      capacity_ = n;
-      iterator dest = new_mem;
-      // this is safe for begin_ == 0 && end_ == 0, but keep vector() coherent
-      for ( iterator src = begin_; src != end_; ++src, ++dest )
-        move(dest, src);
-      if ( begin_ ) array_allocator.deallocate(begin_, old_capacity);
+      const iterator new_position = new_mem + (position - begin_);
+      __ntl_try
+      {
+        // this is safe for begin_ == 0 && end_ == 0, but keep vector() coherent
+        relocate(new_mem, position, new_position + gap, relocatable());
+      }
+      __ntl_catch(...)
+      {
+        array_allocator.deallocate(new_mem, n);
+        __ntl_rethrow;
+      }
+      if ( begin_ ) array_allocator.deallocate(begin_, capacity_);
+      end_ = new_position + gap + (end_ - position);
       begin_ = new_mem;
-      end_ = dest;
+      capacity_ = n;
+      return new_position;
     }
 
     //  + 8/2 serves two purposes:
@@ -760,6 +814,12 @@ inline bool operator<=(const vector<T, Allocator>& x, const vector<T, Allocator>
 template <class T, class Allocator>
 inline void swap(vector<T, Allocator>& x, vector<T, Allocator>& y) __ntl_nothrow { x.swap(y); }
 
+namespace __ {
+  /// the vector holds its elements by pointers, so the vectors of vectors are reallocated by memcpy()
+  template <class T, class Allocator>
+  struct is_trivially_relocatable<vector<T, Allocator> >: true_type {};
+}
+
 ///@}
 /**@} lib_sequence */
 /**@} lib_containers */
@@ -0,0 +1,92 @@
+/**
+ *	@file btreebench.cpp
+ *	@brief B-tree map benchmark
+ *
+ *  Compares the ntl::btree_map with the std::map (the red-black tree) on the same random keys:
+ *  the insertion one by one, the lookup of every key, the ordered scan, the bulk load of the sorted keys
+ *  and the memory taken by the nodes.
+ *
+ *	@note Compilation command-line: cl /nologo /O2 /I../ntl /DWIN32 /D_UNICODE /DUNICODE /GS- btreebench.cpp ../ntl/rtl/crt.cpp /link /subsystem:console /libpath:your_lib_path_with_ntdll.lib
+ *	@note Usage: btreebench.exe [elements]
+ **/
+#include <consoleapp.hxx>
+
+#include <btree.hxx>
+
+#include <map>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+using namespace ntl;
+using namespace std;
+
+typedef chrono::high_resolution_clock clock_type;
+
+typedef std::map<uint32_t, uint32_t>       rb_map;
+typedef ntl::btree_map<uint32_t, uint32_t> bt_map;
+
+static uint64_t elapsed(clock_type::time_point start)
+{
+  return static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(clock_type::now() - start).count());
+}
+
+template<class Map>
+static void run(const char* name, const vector<uint32_t>& keys, const vector<pair<uint32_t, uint32_t> >& sorted)
+{
+  Map m;
+  clock_type::time_point start = clock_type::now();
+  for(size_t i = 0; i < keys.size(); i++)
+    m.insert(make_pair(keys[i], static_cast<uint32_t>(i)));
+  const uint64_t insert_ms = elapsed(start);
+
+  uint64_t sum = 0;
+  start = clock_type::now();
+  for(size_t i = 0; i < keys.size(); i++)
+    sum += (*m.find(keys[i])).second;
+  const uint64_t find_ms = elapsed(start);
+
+  start = clock_type::now();
+  for(typename Map::const_iterator i = m.begin(); i != m.end(); ++i)
+    sum += (*i).second;
+  const uint64_t scan_ms = elapsed(start);
+
+  start = clock_type::now();
+  Map bulk(sorted.begin(), sorted.end());
+  const uint64_t bulk_ms = elapsed(start);
+
+  cout << name << insert_ms << "\t " << find_ms << "\t " << scan_ms << "\t " << bulk_ms << "\t " << (sum & 1) + bulk.size() << endl;
+}
+
+int ntl::consoleapp::main()
+{
+  command_line cmdl;
+  uint32_t n = 1000000;
+  if(cmdl.size() > 1)
+    n = static_cast<uint32_t>(_wtoi(cmdl[1]));
+  if(!n){
+    cout << "usage: btreebench.exe [elements]" << endl;
+    return 2;
+  }
+
+  // the distinct keys in the random order: the multiplicative hash of the index
+  vector<uint32_t> keys(n);
+  for(uint32_t i = 0; i < n; i++)
+    keys[i] = i * 2654435761u;
+  vector<pair<uint32_t, uint32_t> > sorted(n);
+  for(uint32_t i = 0; i < n; i++)
+    sorted[i] = make_pair(keys[i], i);
+  sort(sorted.begin(), sorted.end());
+
+  cout << "           insert  find  scan  bulk (ms), elements" << endl;
+  run<rb_map>("std::map:  ", keys, sorted);
+  run<bt_map>("btree_map: ", keys, sorted);
+
+  // the node of the red-black tree holds three links and the color besides the value
+  bt_map m(sorted.begin(), sorted.end());
+  const uint64_t rb_bytes = uint64_t(n) * (sizeof(void*) * 4 + sizeof(rb_map::value_type));
+  cout << "memory: std::map ~" << rb_bytes / 1024 << " KB, btree_map " << m.memory_footprint() / 1024 << " KB, "
+    << bt_map::leaf_capacity << " elements per leaf, height " << m.height() << endl;
+  return 0;
+}
@@ -0,0 +1,74 @@
+/**
+ *	@file fmtbench.cpp
+ *	@brief Log line formatting benchmark
+ *
+ *  Formats the typical log line (integers, the status in hex, the elapsed time and the name) the given number of times
+ *  by fmt::format_to_n with the compile time checked format string, by fmt::format_to into the memory_buffer
+ *  and by ntdll's _snprintf, reporting the time per line of every method.
+ *
+ *	@note Compilation command-line: cl /nologo /O2 /I../ntl /DWIN32 /D_UNICODE /DUNICODE /GS- fmtbench.cpp ../ntl/rtl/crt.cpp /link /subsystem:console /libpath:your_lib_path_with_ntdll.lib
+ *	@note Usage: fmtbench.exe [lines]
+ **/
+#include <consoleapp.hxx>
+
+#include <format.hxx>
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+using namespace ntl;
+using namespace std;
+
+typedef chrono::high_resolution_clock clock_type;
+
+static void report(const char* name, clock_type::time_point start, uint32_t lines, size_t total)
+{
+  const uint64_t ns = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(clock_type::now() - start).count());
+  cout << name << ns / (lines ? lines : 1) << " ns/line, " << total << " chars" << endl;
+}
+
+int ntl::consoleapp::main()
+{
+  command_line cmdl;
+  uint32_t lines = 1000000;
+  if(cmdl.size() > 1)
+    lines = static_cast<uint32_t>(_wtoi(cmdl[1]));
+  if(!lines){
+    cout << "usage: fmtbench.exe [lines]" << endl;
+    return 2;
+  }
+
+  const char* const name = "\\Device\\HarddiskVolume1\\Windows\\System32\\ntdll.dll";
+  char buf[256];
+  size_t total = 0;
+
+  clock_type::time_point start = clock_type::now();
+  for(uint32_t i = 0; i < lines; i++){
+    const fmt::format_to_n_result<char*> r = fmt::format_to_n(buf, _countof(buf),
+      NTL_FMT("[{:>8}] pid {} status {:#010x} elapsed {:.3f} ms: {}"), i, 4242, 0xC0000034u, i * 0.001, name);
+    total += r.size;
+  }
+  report("fmt::format_to_n: ", start, lines, total);
+
+  total = 0;
+  start = clock_type::now();
+  {
+    fmt::memory_buffer mb;
+    for(uint32_t i = 0; i < lines; i++){
+      mb.clear();
+      fmt::format_to(mb, "[{:>8}] pid {} status {:#010x} elapsed {:.3f} ms: {}", i, 4242, 0xC0000034u, i * 0.001, name);
+      total += mb.size();
+    }
+  }
+  report("fmt::format_to:   ", start, lines, total);
+
+  total = 0;
+  start = clock_type::now();
+  for(uint32_t i = 0; i < lines; i++){
+    const int n = _snprintf(buf, _countof(buf), "[%8u] pid %d status %#010x elapsed %.3f ms: %s", i, 4242, 0xC0000034u, i * 0.001, name);
+    total += n > 0 ? static_cast<size_t>(n) : 0;
+  }
+  report("_snprintf:        ", start, lines, total);
+  return 0;
+}
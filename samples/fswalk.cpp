@@ -0,0 +1,86 @@
+/**
+ *	@file fswalk.cpp
+ *	@brief Directory tree walk benchmark
+ *
+ *  Walks the given directory tree with ntl::fs::parallel_walk, first by the single thread and then
+ *  by the given number of threads (unordered and ordered), reporting the number of entries,
+ *  their total size taken from the directory query buffers and the time of every walk.
+ *
+ *	@note Compilation command-line: cl /nologo /O2 /I../ntl /DWIN32 /D_UNICODE /DUNICODE /GS- fswalk.cpp ../ntl/rtl/crt.cpp /link /subsystem:console /libpath:your_lib_path_with_ntdll.lib
+ *	@note Usage: fswalk.exe [-t threads] <directory>
+ **/
+#include <consoleapp.hxx>
+
+#include <fs_walk.hxx>
+#include <atomic.hxx>
+
+#include <chrono>
+#include <iostream>
+
+using namespace ntl;
+using namespace std;
+
+typedef chrono::high_resolution_clock clock_type;
+
+class size_counter
+{
+public:
+  explicit size_counter(volatile int64_t& total)
+    :total(total)
+  {}
+
+  void operator()(const fs::walk_entry& e) const
+  {
+    if(!e.is_directory())
+      atomic::exchange_add(total, e.size);
+  }
+private:
+  size_counter& operator=(const size_counter&) __deleted;
+  volatile int64_t& total;
+};
+
+static void walk(const wstring& root, unsigned threads, bool ordered)
+{
+  fs::walk_options options;
+  options.threads = threads;
+  options.ordered = ordered;
+
+  volatile int64_t total = 0;
+  const clock_type::time_point start = clock_type::now();
+  const fs::walk_stats stats = fs::parallel_walk(root, size_counter(total), options);
+  const uint64_t ms = static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(clock_type::now() - start).count());
+
+  cout << threads << (ordered ? " ordered  " : " unordered") << "  files: " << stats.files << ", directories: " << stats.directories
+    << ", errors: " << stats.errors << ", bytes: " << total << ", " << ms << " ms" << endl;
+}
+
+int ntl::consoleapp::main()
+{
+  command_line cmdl;
+  unsigned threads = std::thread::hardware_concurrency();
+  const wchar_t* dir = nullptr;
+  for(command_line::const_iterator cmd = cmdl.cbegin()+1; cmd != cmdl.cend(); ++cmd){
+    if(!wcscmp(*cmd, L"-t") && cmd+1 != cmdl.cend())
+      threads = static_cast<unsigned>(_wtoi(*++cmd));
+    else
+      dir = *cmd;
+  }
+  if(!dir){
+    cout << "usage: fswalk.exe [-t threads] <directory>" << endl;
+    return 2;
+  }
+  if(!threads)
+    threads = 1;
+
+  const nt::rtl::relative_name name(dir);
+  if(!name){
+    cout << "invalid path" << endl;
+    return 2;
+  }
+  const wstring root(name.path.begin(), name.path.size());
+
+  walk(root, 1, false);
+  walk(root, threads, false);
+  walk(root, threads, true);
+  return 0;
+}
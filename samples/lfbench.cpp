@@ -0,0 +1,177 @@
+/**
+ *	@file lfbench.cpp
+ *	@brief Contention benchmark for the lock-free stack and queues
+ *
+ *  For every thread count from 1 to the given maximum measures the throughput of
+ *  the lockfree::stack used as a shared free list (pop and push back), of the lockfree::bounded_queue
+ *  with the half of threads producing and the other half consuming, and of the lockfree::mpsc_queue
+ *  with the single consumer (the main thread).
+ *
+ *	@note Compilation command-line: cl /nologo /O2 /I../ntl /DWIN32 /D_UNICODE /DUNICODE /GS- lfbench.cpp ../ntl/rtl/crt.cpp /link /subsystem:console /libpath:your_lib_path_with_ntdll.lib
+ *	@note Usage: lfbench.exe [max_threads] [operations_per_thread]
+ **/
+#include <consoleapp.hxx>
+
+#include <lockfree.hxx>
+
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <iostream>
+
+using namespace ntl;
+using namespace std;
+
+typedef chrono::high_resolution_clock clock_type;
+
+struct item: nt::slist_entry
+{
+  uint32_t value;
+};
+
+static uint64_t per_second(uint64_t ops, clock_type::duration d)
+{
+  const uint64_t us = static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(d).count());
+  return ops * 1000000 / (us ? us : 1);
+}
+
+class stack_worker
+{
+public:
+  stack_worker(lockfree::stack& s, uint32_t ops)
+    :s(s), ops(ops)
+  {}
+
+  void operator()()
+  {
+    for(uint32_t i = 0; i < ops; i++){
+      if(nt::slist_entry* e = s.pop()){
+        static_cast<item*>(e)->value++;
+        s.push(e);
+      }
+    }
+  }
+private:
+  stack_worker& operator=(const stack_worker&) __deleted;
+  lockfree::stack& s;
+  const uint32_t ops;
+};
+
+class queue_producer
+{
+public:
+  queue_producer(lockfree::bounded_queue<uint32_t>& q, uint32_t ops)
+    :q(q), ops(ops)
+  {}
+
+  void operator()()
+  {
+    for(uint32_t i = 0; i < ops; i++)
+      for(atomic::backoff b; !q.push(i); b.pause());
+  }
+private:
+  queue_producer& operator=(const queue_producer&) __deleted;
+  lockfree::bounded_queue<uint32_t>& q;
+  const uint32_t ops;
+};
+
+class queue_consumer
+{
+public:
+  queue_consumer(lockfree::bounded_queue<uint32_t>& q, uint32_t ops)
+    :q(q), ops(ops)
+  {}
+
+  void operator()()
+  {
+    uint32_t v;
+    for(uint32_t i = 0; i < ops; i++)
+      for(atomic::backoff b; !q.pop(v); b.pause());
+  }
+private:
+  queue_consumer& operator=(const queue_consumer&) __deleted;
+  lockfree::bounded_queue<uint32_t>& q;
+  const uint32_t ops;
+};
+
+class mpsc_producer
+{
+public:
+  mpsc_producer(lockfree::mpsc_queue& q, item* items, uint32_t ops)
+    :q(q), items(items), ops(ops)
+  {}
+
+  void operator()()
+  {
+    for(uint32_t i = 0; i < ops; i++)
+      q.push(&items[i]);
+  }
+private:
+  mpsc_producer& operator=(const mpsc_producer&) __deleted;
+  lockfree::mpsc_queue& q;
+  item* const items;
+  const uint32_t ops;
+};
+
+static void join(vector<std::thread>& workers)
+{
+  for(size_t i = 0; i < workers.size(); i++)
+    workers[i].join();
+  workers.clear();
+}
+
+int ntl::consoleapp::main()
+{
+  command_line cmdl;
+  unsigned max_threads = std::thread::hardware_concurrency();
+  uint32_t ops = 1000000;
+  if(cmdl.size() > 1)
+    max_threads = static_cast<unsigned>(_wtoi(cmdl[1]));
+  if(cmdl.size() > 2)
+    ops = static_cast<uint32_t>(_wtoi(cmdl[2]));
+  if(!max_threads)
+    max_threads = 1;
+
+  vector<item> items(ops * max_threads);
+  vector<std::thread> workers;
+  workers.reserve(max_threads);
+
+  cout << "threads    stack ops/s    mpmc ops/s    mpsc ops/s" << endl;
+  for(unsigned threads = 1; threads <= max_threads; threads++){
+    // free list: twice as many entries as threads, so the threads mostly collide on the head
+    lockfree::stack s;
+    for(unsigned i = 0; i < threads * 2; i++)
+      s.push(&items[i]);
+    clock_type::time_point start = clock_type::now();
+    for(unsigned i = 0; i < threads; i++)
+      workers.push_back(std::thread(stack_worker(s, ops)));
+    join(workers);
+    const uint64_t stack_rate = per_second(uint64_t(ops) * threads, clock_type::now() - start);
+    while(s.pop());
+
+    // bounded queue: producers and consumers in pairs
+    lockfree::bounded_queue<uint32_t> q(1024);
+    const unsigned pairs = threads > 1 ? threads / 2 : 1;
+    start = clock_type::now();
+    for(unsigned i = 0; i < pairs; i++){
+      workers.push_back(std::thread(queue_producer(q, ops)));
+      workers.push_back(std::thread(queue_consumer(q, ops)));
+    }
+    join(workers);
+    const uint64_t mpmc_rate = per_second(uint64_t(ops) * pairs, clock_type::now() - start);
+
+    // mpsc queue: all threads produce, the main thread consumes
+    lockfree::mpsc_queue mq;
+    start = clock_type::now();
+    for(unsigned i = 0; i < threads; i++)
+      workers.push_back(std::thread(mpsc_producer(mq, &items[i * ops], ops)));
+    for(uint64_t left = uint64_t(ops) * threads; left; )
+      if(mq.pop())
+        left--;
+    join(workers);
+    const uint64_t mpsc_rate = per_second(uint64_t(ops) * threads, clock_type::now() - start);
+
+    cout << threads << "\t   " << stack_rate << "\t  " << mpmc_rate << "\t" << mpsc_rate << endl;
+  }
+  return 0;
+}
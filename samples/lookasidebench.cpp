@@ -0,0 +1,121 @@
+/**
+ *	@file lookasidebench.cpp
+ *	@brief Lookaside allocator benchmark
+ *
+ *  Fills and drains std::list and std::map by the default allocator and by the std::ext::lookaside_allocator
+ *  over the user-mode nt::lookaside_list, reporting the time of every pass and the lookaside statistics:
+ *  the hit ratio is <tt>1 - AllocateMisses / TotalAllocates</tt>. The working set (\c count nodes) is churned
+ *  by the erase and insert of \c batch nodes per round; while the batch fits into the list depth, every node
+ *  after the initial fill is a hit.
+ *
+ *	@note Compilation command-line: cl /nologo /O2 /I../ntl /DWIN32 /D_UNICODE /DUNICODE /GS- lookasidebench.cpp ../ntl/rtl/crt.cpp /link /subsystem:console /libpath:your_lib_path_with_ntdll.lib
+ *	@note Usage: lookasidebench.exe [count [depth]]
+ **/
+#include <consoleapp.hxx>
+
+#include <nt/lookaside_list.hxx>
+#include <stlx/ext/allocators.hxx>
+
+#include <list>
+#include <map>
+#include <chrono>
+#include <iostream>
+
+using namespace ntl;
+using namespace std;
+
+typedef chrono::high_resolution_clock clock_type;
+typedef nt::lookaside_list<> lookaside;
+
+static const size_t rounds = 1000, batch = 1024;
+
+static void report(const char* name, clock_type::time_point start, const lookaside* cells = nullptr)
+{
+  cout << name << chrono::duration_cast<chrono::microseconds>(clock_type::now() - start).count() / 1000 << " ms";
+  if(cells)
+    cout << ", allocates " << cells->TotalAllocates << ", misses " << cells->AllocateMisses
+      << ", hits " << (cells->TotalAllocates ? 100 - uint64_t(cells->AllocateMisses) * 100 / cells->TotalAllocates : 0) << "%"
+      << ", free misses " << cells->FreeMisses;
+  cout << endl;
+}
+
+template<class List>
+static size_t churn_list(List& l, size_t count)
+{
+  for(size_t i = 0; i < count; i++)
+    l.push_back(static_cast<int>(i));
+  for(size_t r = 0; r < rounds; r++){
+    for(size_t i = 0; i < batch; i++)
+      l.pop_front();
+    for(size_t i = 0; i < batch; i++)
+      l.push_back(static_cast<int>(i));
+  }
+  return l.size();
+}
+
+template<class Map>
+static size_t churn_map(Map& m, size_t count)
+{
+  for(size_t i = 0; i < count; i++)
+    m[static_cast<int>(i * 7919 % count)] = static_cast<int>(i);
+  for(size_t r = 0; r < rounds; r++){
+    const int base = static_cast<int>(r * batch % (count - batch));
+    for(int i = 0; i < static_cast<int>(batch); i++)
+      m.erase(base + i);
+    for(int i = 0; i < static_cast<int>(batch); i++)
+      m[base + i] = i;
+  }
+  return m.size();
+}
+
+int ntl::consoleapp::main()
+{
+  command_line cmdl;
+  size_t count = 100000;
+  uint16_t depth = 4096;
+  if(cmdl.size() > 1)
+    count = static_cast<size_t>(_wtoi(cmdl[1]));
+  if(cmdl.size() > 2)
+    depth = static_cast<uint16_t>(_wtoi(cmdl[2]));
+  if(count <= batch){
+    cout << "usage: lookasidebench.exe [count [depth]]" << endl;
+    return 2;
+  }
+
+  clock_type::time_point start = clock_type::now();
+  {
+    list<int> l;
+    churn_list(l, count);
+  }
+  report("list, std::allocator:        ", start);
+
+  {
+    lookaside cells(64, nt::process_heap(), depth);
+    start = clock_type::now();
+    {
+      typedef ext::lookaside_allocator<int, lookaside> allocator;
+      list<int, allocator> l((allocator(cells)));
+      churn_list(l, count);
+    }
+    report("list, lookaside_allocator:   ", start, &cells);
+  }
+
+  start = clock_type::now();
+  {
+    map<int, int> m;
+    churn_map(m, count);
+  }
+  report("map, std::allocator:         ", start);
+
+  {
+    lookaside cells(64, nt::process_heap(), depth);
+    start = clock_type::now();
+    {
+      typedef ext::lookaside_allocator<pair<const int, int>, lookaside> allocator;
+      map<int, int, less<int>, allocator> m(less<int>(), (allocator(cells)));
+      churn_map(m, count);
+    }
+    report("map, lookaside_allocator:    ", start, &cells);
+  }
+  return 0;
+}
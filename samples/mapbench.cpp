@@ -0,0 +1,106 @@
+/**
+ *	@file mapbench.cpp
+ *	@brief Mapped file read benchmark
+ *
+ *  Checksums the file read by basic_file::get_data(), mapped as the single nt::mapped_view (with and without
+ *  the prefetch hint) and scanned through the nt::mapped_window of the given size, reporting the time of every pass.
+ *
+ *	@note Compilation command-line: cl /nologo /O2 /I../ntl /DWIN32 /D_UNICODE /DUNICODE /GS- mapbench.cpp ../ntl/rtl/crt.cpp /link /subsystem:console /libpath:your_lib_path_with_ntdll.lib
+ *	@note Usage: mapbench.exe [-w window_kib] <file>
+ **/
+#include <consoleapp.hxx>
+
+#include <nt/mapped_file.hxx>
+
+#include <chrono>
+#include <iostream>
+
+using namespace ntl;
+using namespace ntl::nt;
+using namespace std;
+
+typedef chrono::high_resolution_clock clock_type;
+
+static uint32_t checksum(const char* p, size_t size, uint32_t sum = 0)
+{
+  for(size_t i = 0; i < size; i++)
+    sum = sum * 31 + static_cast<unsigned char>(p[i]);
+  return sum;
+}
+
+static void report(const char* name, clock_type::time_point start, uint64_t size, uint32_t sum)
+{
+  const uint64_t us = static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(clock_type::now() - start).count());
+  cout << name << us / 1000 << " ms, " << size / (us ? us : 1) << " MB/s, checksum " << hex << sum << dec << endl;
+}
+
+int ntl::consoleapp::main()
+{
+  command_line cmdl;
+  size_t window = mapped_window::default_window_size;
+  const wchar_t* name = nullptr;
+  for(command_line::const_iterator cmd = cmdl.cbegin()+1; cmd != cmdl.cend(); ++cmd){
+    if(!wcscmp(*cmd, L"-w") && cmd+1 != cmdl.cend())
+      window = static_cast<size_t>(_wtoi(*++cmd)) * 1024;
+    else
+      name = *cmd;
+  }
+  if(!name || !window){
+    cout << "usage: mapbench.exe [-w window_kib] <file>" << endl;
+    return 2;
+  }
+
+  const rtl::relative_name path(name);
+  if(!path){
+    cout << "invalid path" << endl;
+    return 2;
+  }
+
+  const mapped_file mf(path.path);
+  if(!mf){
+    cout << "can't map the file, status " << hex << static_cast<uint32_t>(mf.last_status()) << endl;
+    return 1;
+  }
+  const uint64_t size = mf.size();
+
+  // the data is read as a whole only if it fits into 4 GiB
+  clock_type::time_point start = clock_type::now();
+  {
+    file f(path, file::open_existing, file::generic_read);
+    const raw_data data = f.get_data();
+    if(!data.empty())
+      report("get_data:          ", start, size, checksum(reinterpret_cast<const char*>(&data[0]), data.size()));
+  }
+
+  start = clock_type::now();
+  {
+    const mapped_view v(mf);
+    if(v)
+      report("view:              ", start, size, checksum(v.data(), v.size()));
+  }
+
+  start = clock_type::now();
+  {
+    const mapped_view v(mf);
+    if(v){
+      v.advise(mapped_view::will_need);
+      report("view, prefetched:  ", start, size, checksum(v.data(), v.size()));
+    }
+  }
+
+  start = clock_type::now();
+  {
+    mapped_window w(mf, window);
+    uint32_t sum = 0;
+    const size_t block = window < 64*1024 ? window : 64*1024;
+    for(uint64_t offset = 0; offset < size; offset += block){
+      const size_t length = size - offset < block ? static_cast<size_t>(size - offset) : block;
+      const char* p = w.map(offset, length);
+      if(!p)
+        break;
+      sum = checksum(p, length, sum);
+    }
+    report("window:            ", start, size, sum);
+  }
+  return 0;
+}
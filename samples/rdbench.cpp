@@ -0,0 +1,121 @@
+/**
+ *	@file rdbench.cpp
+ *	@brief random_device benchmark and sanity tests
+ *
+ *  Measures the throughput of the random_device sources: the buffered ChaCha20 generator (per call and by generate()),
+ *  RDRAND, RDSEED and the system source per value, the latter is what random_device cost before. Then checks
+ *  the output of every source by the simple statistics: the bit frequency (monobit), the chi-square of the bytes,
+ *  the runs of the equal bits and the serial correlation of the bytes. These catch a broken source (the stuck
+ *  RDRAND, the wrong buffer handling), not the subtle bias.
+ *
+ *	@note Compilation command-line: cl /nologo /O2 /I../ntl /DWIN32 /D_UNICODE /DUNICODE /GS- rdbench.cpp ../ntl/rtl/crt.cpp /link /subsystem:console /libpath:your_lib_path_with_ntdll.lib
+ *	@note Usage: rdbench.exe [megabytes]
+ **/
+#include <consoleapp.hxx>
+
+#include <random>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+using namespace ntl;
+using namespace std;
+
+typedef chrono::high_resolution_clock clock_type;
+
+static double seconds(clock_type::time_point start)
+{
+  return static_cast<double>(chrono::duration_cast<chrono::microseconds>(clock_type::now() - start).count()) / 1e6;
+}
+
+static void report(const char* name, size_t bytes, double sec)
+{
+  cout << name << static_cast<unsigned>(bytes / (sec > 0 ? sec : 1e-6) / 1e6) << " MB/s" << endl;
+}
+
+// all the statistics are about N(0,1) or chi-square(255) for the good source
+static bool sane(const char* name, const vector<uint32_t>& v)
+{
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(v.data());
+  const size_t n = v.size() * sizeof(uint32_t);
+  double ones = 0, counts[256] = {};
+  for(size_t i = 0; i < n; i++){
+    ones += ext::bitops::popcount(p[i]);
+    counts[p[i]]++;
+  }
+  const double bits = n * 8.0, monobit = (ones - bits / 2) / sqrt(bits / 4);
+
+  double chi2 = 0;
+  const double expected = n / 256.0;
+  for(size_t i = 0; i < 256; i++)
+    chi2 += (counts[i] - expected) * (counts[i] - expected) / expected;
+
+  double runs = 1;
+  unsigned prev = p[0] & 1;
+  for(size_t i = 0; i < n; i++)
+    for(unsigned b = 0; b < 8; b++){
+      const unsigned x = (p[i] >> b) & 1;
+      if(x != prev)
+        runs++, prev = x;
+    }
+  const double pi = ones / bits, runs_z = (runs - 2 * bits * pi * (1 - pi) - 1) / (2 * sqrt(2 * bits) * pi * (1 - pi));
+
+  double sxy = 0, sx = 0, sxx = 0;
+  for(size_t i = 0; i < n; i++){
+    const double x = p[i], y = p[(i + 1) % n];
+    sxy += x * y, sx += x, sxx += x * x;
+  }
+  const double serial = (n * sxy - sx * sx) / (n * sxx - sx * sx);
+
+  const bool ok = fabs(monobit) < 4.5 && chi2 > 160 && chi2 < 370 && fabs(runs_z) < 4.5 && fabs(serial) < 4.5 / sqrt(double(n));
+  cout << name << "monobit " << monobit << ", chi2 " << chi2 << ", runs " << runs_z << ", serial " << serial
+    << (ok ? "\t ok" : "\t FAILED") << endl;
+  return ok;
+}
+
+int ntl::consoleapp::main()
+{
+  command_line cmdl;
+  size_t mb = 16;
+  if(cmdl.size() > 1)
+    mb = static_cast<size_t>(_wtoi(cmdl[1]));
+  if(!mb){
+    cout << "usage: rdbench.exe [megabytes]" << endl;
+    return 2;
+  }
+  const ext::entropy::processor& cpu = ext::entropy::processor::features();
+  cout << "rdrand: " << cpu.rdrand << ", rdseed: " << cpu.rdseed << endl;
+
+  vector<uint32_t> v((mb << 20) / sizeof(uint32_t));
+  random_device rd;
+  clock_type::time_point start = clock_type::now();
+  for(size_t i = 0; i < v.size(); i++)
+    v[i] = rd();
+  report("default:          ", v.size() * 4, seconds(start));
+  bool ok = sane("default:          ", v);
+
+  start = clock_type::now();
+  rd.generate(v.begin(), v.end());
+  report("default generate: ", v.size() * 4, seconds(start));
+  ok &= sane("default generate: ", v);
+
+  // the slow sources make the sixteenth part
+  const char* const tokens[] = {"rdrand", "rdseed", "os"};
+  vector<uint32_t> part(v.size() / 16);
+  for(size_t t = 0; t < _countof(tokens); t++){
+    const string token = tokens[t];
+    if((token == "rdrand" && !cpu.rdrand) || (token == "rdseed" && !cpu.rdseed)){
+      cout << token << ":\t not supported" << endl;
+      continue;
+    }
+    random_device source(token);
+    const string name = token + ":" + string(18 - token.size() - 1, ' ');
+    start = clock_type::now();
+    for(size_t i = 0; i < part.size(); i++)
+      part[i] = source();
+    report(name.c_str(), part.size() * 4, seconds(start));
+    ok &= sane(name.c_str(), part);
+  }
+  return ok ? 0 : 1;
+}
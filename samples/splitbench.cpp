@@ -0,0 +1,134 @@
+/**
+ *	@file splitbench.cpp
+ *	@brief String split and join benchmark
+ *
+ *  Splits the CSV-like text block to the lines and the fields repeatedly (the total input is
+ *  the block size times the passes, gigabytes by default) by the lazy std::split() and by copying
+ *  the fields to the vector of strings as the eager split did; then joins the fields back by
+ *  std::sjoin() and by the stream.
+ *
+ *	@note Compilation command-line: cl /nologo /O2 /I../ntl /DWIN32 /D_UNICODE /DUNICODE /GS- splitbench.cpp ../ntl/rtl/crt.cpp /link /subsystem:console /libpath:your_lib_path_with_ntdll.lib
+ *	@note Usage: splitbench.exe [block megabytes] [passes]
+ **/
+#include <consoleapp.hxx>
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stlx/ext/split.hxx>
+#include <stlx/ext/join.hxx>
+
+using namespace ntl;
+using namespace std;
+
+typedef chrono::high_resolution_clock clock_type;
+typedef splitter<literal, skip_empty> lines_type;
+typedef splitter<literal> fields_type;
+typedef splitter<split_any> any_type;
+
+static uint64_t elapsed(clock_type::time_point start)
+{
+  return static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(clock_type::now() - start).count());
+}
+
+// megabytes per second
+static uint64_t throughput(uint64_t bytes, uint64_t ms)
+{
+  return ms ? (bytes >> 20) * 1000 / ms : 0;
+}
+
+static void report(const char* name, uint64_t bytes, uint64_t ms, size_t count)
+{
+  cout << name << ms << " ms\t " << throughput(bytes, ms) << " MB/s\t " << count << endl;
+}
+
+int ntl::consoleapp::main()
+{
+  command_line cmdl;
+  size_t mb = 64, passes = 32;
+  if(cmdl.size() > 1)
+    mb = static_cast<size_t>(_wtoi(cmdl[1]));
+  if(cmdl.size() > 2)
+    passes = static_cast<size_t>(_wtoi(cmdl[2]));
+  if(!mb || !passes){
+    cout << "usage: splitbench.exe [block megabytes] [passes]" << endl;
+    return 2;
+  }
+  const size_t n = mb << 20;
+
+  // the lines of the 8 comma separated fields of the random length
+  string text;
+  text.reserve(n + 64);
+  uint32_t seed = 1;
+  while(text.size() < n){
+    for(unsigned field = 0; field < 8; field++){
+      seed = seed * 1103515245 + 12345;
+      text.append((seed >> 16) % 16, static_cast<char>('a' + field));
+      text.push_back(field == 7 ? '\n' : ',');
+    }
+  }
+  const uint64_t total = static_cast<uint64_t>(text.size()) * passes;
+  cout << "input: " << (total >> 20) << " MB" << endl;
+
+  // the lines and then the fields of each one
+  clock_type::time_point start = clock_type::now();
+  size_t fields = 0;
+  for(size_t pass = 0; pass < passes; pass++){
+    const lines_type lines = split(text, "\n", skip_empty());
+    for(lines_type::const_iterator line = lines.begin(); line != lines.end(); ++line){
+      const fields_type row = split(*line, ",");
+      for(fields_type::const_iterator field = row.begin(); field != row.end(); ++field)
+        fields++;
+    }
+  }
+  report("lazy split:  ", total, elapsed(start), fields);
+
+  // the same by the any-of delimiter
+  start = clock_type::now();
+  fields = 0;
+  for(size_t pass = 0; pass < passes; pass++){
+    const any_type all = split(text, split_any(",\n"));
+    for(any_type::const_iterator field = all.begin(); field != all.end(); ++field)
+      fields++;
+  }
+  report("split_any:   ", total, elapsed(start), fields);
+
+  // the fields are copied as the eager split did
+  start = clock_type::now();
+  fields = 0;
+  for(size_t pass = 0; pass < passes; pass++){
+    vector<string> copies;
+    const lines_type lines = split(text, "\n", skip_empty());
+    for(lines_type::const_iterator line = lines.begin(); line != lines.end(); ++line){
+      const fields_type row = split(*line, ",");
+      for(fields_type::const_iterator field = row.begin(); field != row.end(); ++field)
+        copies.push_back(string(field->data(), field->size()));
+    }
+    fields += copies.size();
+  }
+  report("eager split: ", total, elapsed(start), fields);
+
+  // join the fields of the whole block back
+  const vector<string_ref> refs = split(text, split_any(",\n"));
+  start = clock_type::now();
+  size_t joined = 0;
+  for(size_t pass = 0; pass < passes; pass++)
+    joined += sjoin(refs.begin(), refs.end(), ",").size();
+  report("sjoin:       ", total, elapsed(start), joined);
+
+  start = clock_type::now();
+  joined = 0;
+  for(size_t pass = 0; pass < passes; pass++){
+    ostringstream o;
+    for(vector<string_ref>::const_iterator i = refs.begin(); i != refs.end(); ++i){
+      if(i != refs.begin())
+        o << ",";
+      o << *i;
+    }
+    joined += o.str().size();
+  }
+  report("stream join: ", total, elapsed(start), joined);
+  return 0;
+}
@@ -0,0 +1,133 @@
+/**
+ *	@file strsearch.cpp
+ *	@brief String search benchmark
+ *
+ *  Searches the large haystack by the basic_string::find family and by the plain character loops
+ *  which the string used before: the single character, the random needle, the periodic needle
+ *  in the periodic haystack (the worst case of the plain loop) and the character sets.
+ *
+ *	@note Compilation command-line: cl /nologo /O2 /I../ntl /DWIN32 /D_UNICODE /DUNICODE /GS- strsearch.cpp ../ntl/rtl/crt.cpp /link /subsystem:console /libpath:your_lib_path_with_ntdll.lib
+ *	@note Usage: strsearch.exe [haystack megabytes]
+ **/
+#include <consoleapp.hxx>
+
+#include <string>
+#include <chrono>
+#include <iostream>
+
+using namespace ntl;
+using namespace std;
+
+typedef chrono::high_resolution_clock clock_type;
+
+static uint64_t elapsed(clock_type::time_point start)
+{
+  return static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(clock_type::now() - start).count());
+}
+
+// the loops replaced by the ext::strsearch
+static size_t plain_find(const string& hay, const string& needle)
+{
+  const size_t n = hay.size(), m = needle.size();
+  for(size_t xpos = 0; xpos + m <= n; ++xpos){
+    size_t i = 0;
+    while(i != m && hay[xpos + i] == needle[i])
+      ++i;
+    if(i == m)
+      return xpos;
+  }
+  return string::npos;
+}
+
+static size_t plain_find(const string& hay, char c)
+{
+  for(size_t xpos = 0; xpos != hay.size(); ++xpos)
+    if(hay[xpos] == c)
+      return xpos;
+  return string::npos;
+}
+
+static size_t plain_find_first_of(const string& hay, const string& set, bool of)
+{
+  for(size_t xpos = 0; xpos != hay.size(); ++xpos){
+    bool found = false;
+    for(size_t i = 0; i != set.size() && !found; ++i)
+      found = hay[xpos] == set[i];
+    if(found == of)
+      return xpos;
+  }
+  return string::npos;
+}
+
+static void report(const char* name, uint64_t fast_us, uint64_t plain_us, size_t fast, size_t plain)
+{
+  cout << name << fast_us << "\t " << plain_us << (fast == plain ? "" : "\t MISMATCH") << endl;
+}
+
+int ntl::consoleapp::main()
+{
+  command_line cmdl;
+  size_t mb = 64;
+  if(cmdl.size() > 1)
+    mb = static_cast<size_t>(_wtoi(cmdl[1]));
+  if(!mb){
+    cout << "usage: strsearch.exe [haystack megabytes]" << endl;
+    return 2;
+  }
+  const size_t n = mb << 20;
+
+  // the random lowercase text, the sought things are at the very end
+  string hay(n, ' ');
+  uint32_t seed = 1;
+  for(size_t i = 0; i < n; i++){
+    seed = seed * 1103515245 + 12345;
+    hay[i] = static_cast<char>('a' + (seed >> 16) % 26);
+  }
+  const string needle = "needle in the haystack!";
+  hay.replace(n - needle.size(), needle.size(), needle);
+
+  cout << "                 find  plain (us)" << endl;
+
+  clock_type::time_point start = clock_type::now();
+  size_t fast = hay.find('!');
+  uint64_t fast_us = elapsed(start);
+  start = clock_type::now();
+  size_t plain = plain_find(hay, '!');
+  report("char:            ", fast_us, elapsed(start), fast, plain);
+
+  start = clock_type::now();
+  fast = hay.find(needle);
+  fast_us = elapsed(start);
+  start = clock_type::now();
+  plain = plain_find(hay, needle);
+  report("needle:          ", fast_us, elapsed(start), fast, plain);
+
+  const string digits = "0123456789 !";
+  start = clock_type::now();
+  fast = hay.find_first_of(digits);
+  fast_us = elapsed(start);
+  start = clock_type::now();
+  plain = plain_find_first_of(hay, digits, true);
+  report("find_first_of:   ", fast_us, elapsed(start), fast, plain);
+
+  const string letters = "abcdefghijklmnopqrstuvwxyz";
+  start = clock_type::now();
+  fast = hay.find_first_not_of(letters);
+  fast_us = elapsed(start);
+  start = clock_type::now();
+  plain = plain_find_first_of(hay, letters, false);
+  report("find_first_not_of:", fast_us, elapsed(start), fast, plain);
+
+  // "aaa...a" haystack and "a..aba..a" needle: the plain loop compares the half of needle at every position
+  // and the first and last characters filter lets every position through
+  const string periodic(n / 64, 'a');
+  string pneedle(257, 'a');
+  pneedle[128] = 'b';
+  start = clock_type::now();
+  fast = periodic.find(pneedle);
+  fast_us = elapsed(start);
+  start = clock_type::now();
+  plain = plain_find(periodic, pneedle);
+  report("periodic needle: ", fast_us, elapsed(start), fast, plain);
+  return 0;
+}
@@ -0,0 +1,73 @@
+/**
+ *	@file timerwheel.cpp
+ *	@brief Timer wheel benchmark
+ *
+ *  Arms a million timers with the connection-timeout-like spread of deadlines, cancels them,
+ *  arms them again and runs the wheel until all of them have fired, reporting the time of every phase.
+ *
+ *	@note Compilation command-line: cl /nologo /O2 /I../ntl /DWIN32 /D_UNICODE /DUNICODE /GS- timerwheel.cpp ../ntl/rtl/crt.cpp /link /subsystem:console /libpath:your_lib_path_with_ntdll.lib
+ *	@note Usage: timerwheel.exe [timers]
+ **/
+#include <consoleapp.hxx>
+
+#include <chrono>
+#include <vector>
+#include <iostream>
+
+#include <stlx/ext/tr2/network/iocp/timer_wheel.hxx>
+
+using namespace std;
+typedef std::tr2::sys::__::timer_wheel timer_wheel;
+typedef chrono::high_resolution_clock clock_type;
+
+struct connection_timeout: timer_wheel::node
+{
+  uint32_t fired;
+};
+
+struct on_timeout
+{
+  void operator()(timer_wheel::node& n) const
+  {
+    static_cast<connection_timeout&>(n).fired++;
+  }
+};
+
+static uint64_t elapsed_ms(clock_type::time_point start)
+{
+  return static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(clock_type::now() - start).count());
+}
+
+int ntl::consoleapp::main()
+{
+  command_line cmdl;
+  uint32_t count = 1000000;
+  if(cmdl.size() > 1)
+    count = static_cast<uint32_t>(_wtoi(cmdl[1]));
+
+  // 1 ms ticks, deadlines between 1 second and 10 minutes
+  const timer_wheel::tick_type start_tick = 1000000;
+  vector<connection_timeout> timers(count);
+  timer_wheel wheel(start_tick);
+
+  clock_type::time_point start = clock_type::now();
+  for(uint32_t i = 0; i < count; i++)
+    wheel.schedule(timers[i], start_tick + 1000 + (uint64_t(i) * 7919) % 600000);
+  cout << "arm:     " << elapsed_ms(start) << " ms" << endl;
+
+  start = clock_type::now();
+  for(uint32_t i = 0; i < count; i++)
+    wheel.cancel(timers[i]);
+  cout << "cancel:  " << elapsed_ms(start) << " ms" << endl;
+
+  for(uint32_t i = 0; i < count; i++)
+    wheel.schedule(timers[i], start_tick + 1000 + (uint64_t(i) * 7919) % 600000);
+
+  // advance in 10 ms steps as a timer thread would do
+  start = clock_type::now();
+  size_t fired = 0;
+  for(timer_wheel::tick_type now = start_tick; !wheel.empty(); now += 10)
+    fired += wheel.advance(now, on_timeout());
+  cout << "expire:  " << elapsed_ms(start) << " ms, " << fired << " timers fired" << endl;
+  return 0;
+}
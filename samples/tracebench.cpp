@@ -0,0 +1,126 @@
+/**
+ *	@file tracebench.cpp
+ *	@brief Binary trace ring benchmark
+ *
+ *  Measures the cost of the record written to the nt::trace_ring by one and by all threads,
+ *  compares it with the eager formatting of the same line by fmt::format_to_n,
+ *  then drains the ring and prints the last few records decoded to the text.
+ *
+ *	@note Compilation command-line: cl /nologo /O2 /I../ntl /DWIN32 /D_UNICODE /DUNICODE /GS- tracebench.cpp ../ntl/rtl/crt.cpp /link /subsystem:console /libpath:your_lib_path_with_ntdll.lib
+ *	@note Usage: tracebench.exe [records_per_thread]
+ **/
+#include <consoleapp.hxx>
+
+#include <nt/trace.hxx>
+
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <iostream>
+
+using namespace ntl;
+using namespace std;
+
+typedef chrono::high_resolution_clock clock_type;
+
+enum events { ev_request, ev_complete, ev_count };
+
+static const char* const formats[ev_count] =
+{
+  "request {} from {} status {:#010x}",
+  "complete {} in {:.3f} ms: {}"
+};
+
+struct event_format
+{
+  const char* operator()(uint32_t event) const { return event < ev_count ? formats[event] : nullptr; }
+};
+
+struct print_tail
+{
+  uint32_t* left;
+
+  void operator()(const char* line, size_t) const
+  {
+    if(*left){
+      --*left;
+      cout << line;
+    }
+  }
+};
+
+class writer
+{
+public:
+  writer(nt::trace_ring& ring, uint32_t records)
+    :ring(ring), records(records)
+  {}
+
+  void operator()()
+  {
+    for(uint32_t i = 0; i < records; i++){
+      ring.write(ev_request, i, 4242, 0xC0000034u);
+      ring.write(ev_complete, i, i * 0.001, "done");
+    }
+  }
+private:
+  writer& operator=(const writer&) __deleted;
+  nt::trace_ring& ring;
+  const uint32_t records;
+};
+
+static uint64_t per_record(clock_type::time_point start, uint64_t records)
+{
+  const uint64_t ns = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(clock_type::now() - start).count());
+  return ns / (records ? records : 1);
+}
+
+int ntl::consoleapp::main()
+{
+  command_line cmdl;
+  uint32_t records = 1000000;
+  if(cmdl.size() > 1)
+    records = static_cast<uint32_t>(_wtoi(cmdl[1]));
+  if(!records){
+    cout << "usage: tracebench.exe [records_per_thread]" << endl;
+    return 2;
+  }
+
+  nt::trace_ring ring(64*1024);
+  if(!ring){
+    cout << "can't allocate the ring" << endl;
+    return 1;
+  }
+
+  clock_type::time_point start = clock_type::now();
+  writer(ring, records)();
+  cout << "trace_ring, 1 thread:  " << per_record(start, uint64_t(records) * 2) << " ns/record" << endl;
+
+  const unsigned threads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+  vector<std::thread> workers;
+  start = clock_type::now();
+  for(unsigned i = 0; i < threads; i++)
+    workers.push_back(std::thread(writer(ring, records)));
+  for(size_t i = 0; i < workers.size(); i++)
+    workers[i].join();
+  // every thread writes its share concurrently, so the wall time per thread's record is the cost
+  cout << "trace_ring, " << threads << " threads: " << per_record(start, uint64_t(records) * 2) << " ns/record" << endl;
+
+  char buf[256];
+  size_t total = 0;
+  start = clock_type::now();
+  for(uint32_t i = 0; i < records; i++){
+    total += fmt::format_to_n(buf, _countof(buf), NTL_FMT("request {} from {} status {:#010x}"), i, 4242, 0xC0000034u).size;
+    total += fmt::format_to_n(buf, _countof(buf), NTL_FMT("complete {} in {:.3f} ms: {}"), i, i * 0.001, "done").size;
+  }
+  cout << "fmt::format_to_n:      " << per_record(start, uint64_t(records) * 2) << " ns/record, " << total << " chars" << endl;
+
+  // the drained records are the newest ones of every shard, print the first few of them
+  uint32_t left = 8;
+  const print_tail sink = { &left };
+  start = clock_type::now();
+  const size_t drained = ring.drain_text(event_format(), sink);
+  cout << "drained " << drained << " records in " << chrono::duration_cast<chrono::milliseconds>(clock_type::now() - start).count()
+    << " ms, lost " << ring.lost() << ", clock " << static_cast<uint64_t>(ring.frequency() / 1000000) << " MHz" << endl;
+  return 0;
+}
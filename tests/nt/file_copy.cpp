@@ -0,0 +1,231 @@
+// ntl::nt::copy_file: the buffer layouts, the unbuffered copy, the progress and the cancel
+
+#include <ntl-tests-common.hxx>
+#include <nt/file_copy.hxx>
+#include <tr2/files.hxx>
+#include <vector>
+
+STLX_DEFAULT_TESTGROUP_NAME("ntl::nt::copy_file");
+
+namespace
+{
+  using ntl::nt::copy_file;
+  using ntl::nt::copy_file_options;
+  using ntl::nt::const_unicode_string;
+  using ntl::nt::file;
+  namespace files = std::tr2::files;
+  typedef ntl::nt::status status;
+
+  uint8_t byte_at(uint64_t offset)
+  {
+    return static_cast<uint8_t>((offset * 13) ^ (offset >> 12));
+  }
+
+  // the temporary file name, the file is removed by the destructor
+  struct temp_file
+  {
+    files::path path;
+    std::wstring name;
+
+    temp_file()
+      :path(files::temp_directory_path() / files::unique_path("ntl-copy-%%%%-%%%%.tmp")),
+      name(files::native(path))
+    {}
+
+    ~temp_file()
+    {
+      ntl::nt::file_handler f;
+      if(ntl::nt::success(f.open(name, file::read_attributes|ntl::nt::delete_access|ntl::nt::synchronize, file::share_valid_flags)))
+        f.erase();
+    }
+
+    /** Fills the file by byte_at() */
+    void fill(uint64_t size, uint64_t from = 0) const
+    {
+      file f;
+      f.create(name, file::overwrite_if, file::generic_write);
+      std::vector<uint8_t> chunk(64 * 1024);
+      for(uint64_t offset = 0; offset < size; ){
+        const uint32_t n = static_cast<uint32_t>(size - offset < chunk.size() ? size - offset : chunk.size());
+        for(uint32_t i = 0; i < n; i++)
+          chunk[i] = byte_at(from + offset + i);
+        f.write(chunk.data(), n);
+        offset += n;
+      }
+    }
+
+    bool exists() const
+    {
+      ntl::nt::file_handler f;
+      return ntl::nt::success(f.open(name, file::read_attributes|ntl::nt::synchronize, file::share_valid_flags));
+    }
+
+    /** The file holds exactly \p size bytes of byte_at() */
+    bool holds(uint64_t size) const
+    {
+      file f;
+      if(!f.create(name, file::open_existing, file::generic_read, file::share_valid_flags) || f.size() != size)
+        return false;
+      const ntl::raw_data data = f.get_data();
+      if(data.size() != size)
+        return false;
+      for(size_t i = 0; i < data.size(); i++)
+        if(data[i] != byte_at(i))
+          return false;
+      return true;
+    }
+  };
+
+  // the copied amounts passed to the progress, cancels at the call number \c cancel_at
+  struct progress_log
+  {
+    std::vector<uint64_t>* calls;
+    uint64_t* total;
+    size_t cancel_at;
+
+    bool operator()(uint64_t copied, uint64_t size) const
+    {
+      calls->push_back(copied);
+      *total = size;
+      return calls->size() != cancel_at;
+    }
+  };
+
+  /** The progress grows to the size by the whole blocks */
+  bool steady(const std::vector<uint64_t>& calls, uint64_t total, uint64_t size, uint32_t block)
+  {
+    if(total != size || calls.size() != (size + block - 1) / block)
+      return false;
+    for(size_t i = 0; i < calls.size(); i++){
+      const uint64_t expected = (i + 1) * block < size ? (i + 1) * block : size;
+      if(calls[i] != expected)
+        return false;
+    }
+    return true;
+  }
+
+  copy_file_options options(uint32_t buffer_size, uint32_t buffers)
+  {
+    copy_file_options o;
+    o.buffer_size = buffer_size;
+    o.buffers = buffers;
+    return o;
+  }
+
+  const uint32_t block = 64 * 1024;
+}
+
+// the sizes around the block boundaries with the different numbers of the buffers in flight
+template<> template<> void tut::to::test<01>(void)
+{
+  const uint64_t sizes[] = { 1, 4095, block, block + 1, 3 * block + 17, 20 * block };
+  // the buffer size is rounded up to 64 KiB, the number of the buffers is clamped to 1..max_buffers
+  const copy_file_options layouts[] = { options(block, 1), options(block, 3), options(0, 0), options(100000, 100) };
+  const uint32_t block_sizes[] = { block, block, block, 2 * block };
+
+  const temp_file from, to;
+  for(size_t s = 0; s < _countof(sizes); s++){
+    from.fill(sizes[s]);
+    for(size_t l = 0; l < _countof(layouts); l++){
+      std::vector<uint64_t> calls;
+      uint64_t total = 0;
+      const progress_log log = { &calls, &total, 0 };
+      VERIFY( copy_file(const_unicode_string(from.name), const_unicode_string(to.name), layouts[l], log) == status::success );
+      VERIFY( to.holds(sizes[s]) );
+      VERIFY( steady(calls, total, sizes[s], block_sizes[l]) );
+    }
+  }
+
+  // without the reservation and with the default options
+  copy_file_options plain;
+  plain.preallocate = false;
+  VERIFY( copy_file(const_unicode_string(from.name), const_unicode_string(to.name), plain) == status::success );
+  VERIFY( to.holds(20 * block) );
+  from.fill(3 * block + 17);
+  VERIFY( copy_file(const_unicode_string(from.name), const_unicode_string(to.name)) == status::success );
+  VERIFY( to.holds(3 * block + 17) );
+}
+
+// the unbuffered copy writes the whole sectors and trims the end of file back to the size
+template<> template<> void tut::to::test<02>(void)
+{
+  const uint64_t sizes[] = { 1, 4095, 4096, 4097, block + 100, 16 * block + 3 };
+  copy_file_options unbuffered = options(block, 4);
+  unbuffered.unbuffered_threshold = 1;
+
+  const temp_file from, to;
+  for(size_t s = 0; s < _countof(sizes); s++){
+    from.fill(sizes[s]);
+    std::vector<uint64_t> calls;
+    uint64_t total = 0;
+    const progress_log log = { &calls, &total, 0 };
+    VERIFY( copy_file(const_unicode_string(from.name), const_unicode_string(to.name), unbuffered, log) == status::success );
+    VERIFY( to.holds(sizes[s]) );
+    VERIFY( steady(calls, total, sizes[s], block) );
+  }
+
+  // below the threshold the copy is buffered
+  unbuffered.unbuffered_threshold = 17 * block;
+  VERIFY( copy_file(const_unicode_string(from.name), const_unicode_string(to.name), unbuffered) == status::success );
+  VERIFY( to.holds(16 * block + 3) );
+}
+
+// the progress which returns false cancels the copy, no block is written after it
+template<> template<> void tut::to::test<03>(void)
+{
+  const temp_file from, to;
+  from.fill(20 * block);
+  const size_t cancel_at[] = { 1, 3, 20 };
+  for(size_t i = 0; i < _countof(cancel_at); i++){
+    std::vector<uint64_t> calls;
+    uint64_t total = 0;
+    const progress_log log = { &calls, &total, cancel_at[i] };
+    VERIFY( copy_file(const_unicode_string(from.name), const_unicode_string(to.name), options(block, 4), log) == status::cancelled );
+    VERIFY( calls.size() == cancel_at[i] && calls.back() == cancel_at[i] * block && total == 20 * block );
+  }
+
+  // the copy after the cancel starts over
+  VERIFY( copy_file(const_unicode_string(from.name), const_unicode_string(to.name), options(block, 4)) == status::success );
+  VERIFY( to.holds(20 * block) );
+}
+
+// the missing source, the empty source and the larger destination which is overwritten
+template<> template<> void tut::to::test<04>(void)
+{
+  const temp_file from, to;
+  VERIFY( !ntl::nt::success(copy_file(const_unicode_string(from.name), const_unicode_string(to.name))) );
+  VERIFY( !to.exists() );
+
+  // the empty file calls no progress
+  from.fill(0);
+  std::vector<uint64_t> calls;
+  uint64_t total = 0;
+  const progress_log log = { &calls, &total, 0 };
+  VERIFY( copy_file(const_unicode_string(from.name), const_unicode_string(to.name), copy_file_options(), log) == status::success );
+  VERIFY( to.holds(0) && calls.empty() );
+
+  // the longer destination of the other contents
+  to.fill(10 * block + 5, 1);
+  from.fill(block + 7);
+  VERIFY( copy_file(const_unicode_string(from.name), const_unicode_string(to.name), options(block, 2)) == status::success );
+  VERIFY( to.holds(block + 7) );
+
+  from.fill(0);
+  VERIFY( copy_file(const_unicode_string(from.name), const_unicode_string(to.name)) == status::success );
+  VERIFY( to.holds(0) );
+}
+
+// tr2::files::copy_file goes through the pipelined copy
+template<> template<> void tut::to::test<05>(void)
+{
+  const temp_file from, to;
+  from.fill(5 * block + 1234);
+  std::error_code ec;
+  files::copy_file(from.path, to.path, ec);
+  VERIFY( !ec );
+  VERIFY( to.holds(5 * block + 1234) && files::file_size(to.path) == 5 * block + 1234 );
+
+  const temp_file missing;
+  files::copy_file(missing.path, to.path, ec);
+  VERIFY( ec );
+}
@@ -0,0 +1,184 @@
+// ntl::nt::mapped_file, mapped_view and mapped_window
+
+#include <ntl-tests-common.hxx>
+#include <nt/mapped_file.hxx>
+#include <tr2/files.hxx>
+#include <vector>
+
+STLX_DEFAULT_TESTGROUP_NAME("ntl::nt::mapped_file");
+
+namespace
+{
+  using ntl::nt::mapped_file;
+  using ntl::nt::mapped_view;
+  using ntl::nt::mapped_window;
+  namespace files = std::tr2::files;
+
+  // the file spans several granularity blocks and ends in the middle of a page
+  const uint64_t test_size = 3 * mapped_file::granularity + 123;
+
+  char byte_at(uint64_t offset)
+  {
+    return static_cast<char>((offset * 7) ^ (offset >> 16));
+  }
+
+  bool same_bytes(const char* p, uint64_t offset, size_t length)
+  {
+    for(size_t i = 0; i < length; i++)
+      if(p[i] != byte_at(offset + i))
+        return false;
+    return true;
+  }
+
+  // the temporary file filled by byte_at(), removed by the destructor
+  struct temp_file
+  {
+    files::path path;
+    std::wstring name;
+
+    explicit temp_file(uint64_t size)
+      :path(files::temp_directory_path() / files::unique_path("ntl-mapped-%%%%-%%%%.tmp")),
+      name(files::native(path))
+    {
+      ntl::nt::file f;
+      f.create(name, ntl::nt::file::create_new, ntl::nt::file::generic_write);
+      std::vector<char> chunk(64 * 1024);
+      for(uint64_t offset = 0; offset < size; ){
+        const uint32_t n = static_cast<uint32_t>(size - offset < chunk.size() ? size - offset : chunk.size());
+        for(uint32_t i = 0; i < n; i++)
+          chunk[i] = byte_at(offset + i);
+        f.write(chunk.data(), n);
+        offset += n;
+      }
+    }
+
+    ~temp_file()
+    {
+      ntl::nt::file_handler f;
+      if(ntl::nt::success(f.open(name, ntl::nt::file::read_attributes|ntl::nt::delete_access|ntl::nt::synchronize, ntl::nt::file::share_valid_flags)))
+        f.erase();
+    }
+  };
+}
+
+// the views of the whole file and of the unaligned ranges
+template<> template<> void tut::to::test<01>(void)
+{
+  const temp_file t(test_size);
+  const mapped_file f(ntl::nt::const_unicode_string(t.name));
+  VERIFY( f && f.size() == test_size && f.mode() == mapped_file::read_only );
+
+  const mapped_view all(f);
+  VERIFY( all && all.size() == test_size && all.offset() == 0 );
+  VERIFY( same_bytes(all.data(), 0, all.size()) );
+  VERIFY( all.end() - all.begin() == static_cast<ptrdiff_t>(test_size) && all.str().size() == all.size() );
+
+  // the mapping starts at the granularity boundary, data() points to the requested byte
+  const uint64_t offset = mapped_file::granularity + 5;
+  mapped_view v(f, offset, 1000);
+  VERIFY( v && v.size() == 1000 && v.offset() == offset );
+  VERIFY( same_bytes(v.data(), offset, v.size()) );
+
+  // the length is clamped to the end of file, npos maps the rest
+  VERIFY( ntl::nt::success(v.map(f, test_size - 10, 1000)) && v.size() == 10 );
+  VERIFY( same_bytes(v.data(), test_size - 10, 10) );
+  VERIFY( ntl::nt::success(v.map(f, 2 * mapped_file::granularity - 1)) && v.size() == test_size - 2 * mapped_file::granularity + 1 );
+  VERIFY( same_bytes(v.data(), 2 * mapped_file::granularity - 1, v.size()) );
+
+  // remap keeps the length
+  VERIFY( ntl::nt::success(v.map(f, 100, 500)) && ntl::nt::success(v.remap(2 * mapped_file::granularity - 7)) );
+  VERIFY( v.size() == 500 && v.offset() == 2 * mapped_file::granularity - 7 );
+  VERIFY( same_bytes(v.data(), v.offset(), v.size()) );
+  VERIFY( ntl::nt::success(v.remap(test_size - 30)) && v.size() == 30 );
+
+  // the end of file gives the empty view, beyond it is an error
+  VERIFY( ntl::nt::success(v.map(f, test_size)) && v.empty() && v.data() == nullptr );
+  VERIFY( !ntl::nt::success(v.map(f, test_size + 1)) && !v && v.empty() );
+
+  all.advise(mapped_view::will_need);
+  mapped_view w;
+  VERIFY( w && w.empty() );
+  w.swap(v);
+  VERIFY( !w && v );
+}
+
+// the window moves over the file, the requests longer than the window fail
+template<> template<> void tut::to::test<02>(void)
+{
+  const temp_file t(test_size);
+  const mapped_file f(ntl::nt::const_unicode_string(t.name));
+  VERIFY( f && f.size() == test_size );
+
+  mapped_window w(f, mapped_file::granularity);
+  VERIFY( w.size() == mapped_file::granularity && w.view().empty() );
+  const char* p = w.map(10, 100);
+  VERIFY( p && same_bytes(p, 10, 100) );
+  const uint64_t first = w.view().offset();
+
+  // inside the current window: no remapping
+  p = w.map(200, 1000);
+  VERIFY( p && same_bytes(p, 200, 1000) && w.view().offset() == first );
+
+  // crossing the window end and the granularity boundary
+  const uint64_t across = mapped_file::granularity - 50;
+  p = w.map(across, 100);
+  VERIFY( p && same_bytes(p, across, 100) && w.view().offset() == across );
+
+  // walks the whole file by the records which straddle the blocks
+  for(uint64_t offset = 0; offset < test_size; offset += 4093){
+    p = w.map(offset, 4096);
+    VERIFY( p && same_bytes(p, offset, static_cast<size_t>(test_size - offset < 4096 ? test_size - offset : 4096)) );
+  }
+
+  VERIFY( w.map(0, mapped_file::granularity + 1) == nullptr );
+  VERIFY( w.map(test_size, 1) == nullptr );
+  // clamped to the end of file
+  p = w.map(test_size - 3, 100);
+  VERIFY( p && same_bytes(p, test_size - 3, 3) );
+}
+
+// copy_on_write keeps the file intact, the empty and the missing files
+template<> template<> void tut::to::test<03>(void)
+{
+  const temp_file t(test_size);
+  {
+    const mapped_file f(ntl::nt::const_unicode_string(t.name), mapped_file::copy_on_write);
+    VERIFY( f && f.mode() == mapped_file::copy_on_write );
+    const mapped_view v(f, 1, 100);
+    VERIFY( v && v.mutable_data() == v.data() );
+    v.mutable_data()[0] = static_cast<char>(~byte_at(1));
+    VERIFY( v.data()[0] == static_cast<char>(~byte_at(1)) );
+  }
+  const mapped_file f(ntl::nt::const_unicode_string(t.name));
+  const mapped_view v(f, 0, 10);
+  VERIFY( v && same_bytes(v.data(), 0, 10) );
+
+  // the empty file has no section, its views are empty
+  const temp_file e(0);
+  const mapped_file ef(ntl::nt::const_unicode_string(e.name));
+  VERIFY( ef && ef.size() == 0 );
+  const mapped_view ev(ef);
+  VERIFY( ev && ev.empty() );
+
+  mapped_file missing(ntl::nt::const_unicode_string(t.name + L".missing"));
+  VERIFY( !missing && missing.size() == 0 );
+  const mapped_view mv(missing);
+  VERIFY( !mv && mv.empty() );
+  missing.close();
+  VERIFY( !missing );
+}
+
+// the mapping of the opened file reads the same bytes as basic_file::get_data()
+template<> template<> void tut::to::test<04>(void)
+{
+  const temp_file t(test_size);
+  ntl::nt::file file;
+  VERIFY( file.create(t.name, ntl::nt::file::open_existing, ntl::nt::file::generic_read) );
+  const ntl::raw_data data = file.get_data();
+  VERIFY( data.size() == test_size );
+
+  const mapped_file f(file);
+  VERIFY( f && f.size() == test_size );
+  const mapped_view v(f);
+  VERIFY( v.size() == data.size() && std::equal(data.begin(), data.end(), reinterpret_cast<const uint8_t*>(v.data())) );
+}
@@ -0,0 +1,282 @@
+// ntl::nt::basic_trace_ring: the drain after the wrap, the records being written and the lapped reader
+
+#include <ntl-tests-common.hxx>
+#include <nt/trace.hxx>
+#include <thread>
+#include <string>
+#include <vector>
+
+STLX_DEFAULT_TESTGROUP_NAME("ntl::nt::trace_ring");
+
+namespace
+{
+  /** Microsecond ticks, the hook runs inside the next write after its record is marked as being written */
+  struct step_clock
+  {
+    static uint64_t ticks;
+    static void (*hook)();
+
+    static uint64_t now()
+    {
+      if(void (* const h)() = hook){
+        hook = nullptr;
+        h();
+      }
+      return ++ticks;
+    }
+
+    static uint64_t frequency() { return 1000000; }
+  };
+
+  uint64_t step_clock::ticks = 0;
+  void (*step_clock::hook)() = nullptr;
+
+  typedef ntl::nt::basic_trace_ring<step_clock> ring_type;
+  typedef ntl::nt::trace_record trace_record;
+
+  // the events and the first arguments of the visited records
+  struct collect
+  {
+    std::vector<uint32_t>* events;
+    std::vector<uint64_t>* args;
+    void operator()(const trace_record& r) const
+    {
+      events->push_back(r.event);
+      args->push_back(r.argc() ? r.args[0] : ~0ull);
+    }
+  };
+
+  struct drained
+  {
+    std::vector<uint32_t> events;
+    std::vector<uint64_t> args;
+
+    collect visitor() { const collect c = { &events, &args }; return c; }
+    void clear() { events.clear(); args.clear(); }
+  };
+
+  bool sequence(const std::vector<uint32_t>& v, uint32_t first, uint32_t count)
+  {
+    if(v.size() != count)
+      return false;
+    for(uint32_t i = 0; i < count; i++)
+      if(v[i] != first + i)
+        return false;
+    return true;
+  }
+
+  // the ring and the records drained by the clock hook
+  ring_type* hooked_ring;
+  drained hooked;
+
+  void drain_hook()
+  {
+    hooked_ring->drain(hooked.visitor());
+  }
+
+  void write_and_drain_hook()
+  {
+    hooked_ring->write(3, 33);
+    hooked_ring->drain(hooked.visitor());
+  }
+
+  // the visitor which makes the writer lap the reader at the first record
+  struct lapping_visitor
+  {
+    ring_type* ring;
+    drained* out;
+    void operator()(const trace_record& r) const
+    {
+      if(out->events.empty())
+        for(uint32_t i = 0; i < ring->capacity() + 2; i++)
+          ring->write(100 + i, i);
+      out->events.push_back(r.event);
+    }
+  };
+
+  struct text_lines
+  {
+    std::vector<std::string>* lines;
+    void operator()(const char* line, size_t length) const
+    {
+      lines->push_back(std::string(line, length));
+    }
+  };
+
+  const char* event_format(uint32_t event)
+  {
+    switch(event){
+    case 1: return "open {} at {:#x}";
+    case 2: return "{} {:.2f} {} {}";
+    default: return nullptr;
+    }
+  }
+
+  // the message after the "[seconds] thread: " prefix
+  std::string message(const std::string& line)
+  {
+    const size_t colon = line.find(": ");
+    return colon == std::string::npos ? line : line.substr(colon + 2);
+  }
+}
+
+// the drain after the wrap: the newest records of the shard in order, the overwritten ones are lost
+template<> template<> void tut::to::test<01>(void)
+{
+  ring_type ring(5, 1);
+  VERIFY( ring && ring.capacity() == 8 && ring.shards() == 1 );
+  drained d;
+  VERIFY( ring.drain(d.visitor()) == 0 && ring.lost() == 0 );
+
+  for(uint32_t i = 0; i < 20; i++)
+    ring.write(i, i * 3);
+  VERIFY( ring.drain(d.visitor()) == 8 );
+  VERIFY( sequence(d.events, 12, 8) && d.args[0] == 36 && d.args[7] == 57 );
+  VERIFY( ring.lost() == 12 );
+
+  // the drained records are not visited again, the new ones continue the order
+  d.clear();
+  VERIFY( ring.drain(d.visitor()) == 0 );
+  for(uint32_t i = 20; i < 23; i++)
+    ring.write(i);
+  VERIFY( ring.drain(d.visitor()) == 3 && sequence(d.events, 20, 3) && d.args[0] == ~0ull );
+  VERIFY( ring.lost() == 12 );
+
+  // many laps
+  d.clear();
+  for(uint32_t i = 0; i < 8 * 1000 + 3; i++)
+    ring.write(i);
+  VERIFY( ring.drain(d.visitor()) == 8 && sequence(d.events, 7995, 8) );
+  VERIFY( ring.lost() == 12 + 7995 );
+}
+
+// the record being written stops the drain of its shard until it is complete
+template<> template<> void tut::to::test<02>(void)
+{
+  ring_type ring(8, 1);
+  hooked_ring = &ring;
+  hooked.clear();
+  drained d;
+
+  ring.write(1, 11);
+  step_clock::hook = drain_hook;
+  ring.write(2, 22);
+  VERIFY( hooked.events.size() == 1 && hooked.events[0] == 1 );
+  VERIFY( ring.drain(d.visitor()) == 1 && d.events[0] == 2 && d.args[0] == 22 );
+
+  // the complete record after the incomplete one waits as well
+  hooked.clear();
+  d.clear();
+  step_clock::hook = write_and_drain_hook;
+  ring.write(4, 44);
+  VERIFY( hooked.events.empty() );
+  VERIFY( ring.drain(d.visitor()) == 2 && d.events[0] == 4 && d.events[1] == 3 && d.args[0] == 44 && d.args[1] == 33 );
+  VERIFY( ring.lost() == 0 );
+}
+
+// the writer laps the reader during the drain: the overwritten records are counted, not visited
+template<> template<> void tut::to::test<03>(void)
+{
+  ring_type ring(8, 1);
+  for(uint32_t i = 0; i < 8; i++)
+    ring.write(i, i);
+
+  drained d;
+  const lapping_visitor lap = { &ring, &d };
+  VERIFY( ring.drain(lap) == 1 );
+  VERIFY( d.events.size() == 1 && d.events[0] == 0 && ring.lost() == 7 );
+
+  d.clear();
+  VERIFY( ring.drain(d.visitor()) == 8 );
+  VERIFY( sequence(d.events, 102, 8) && d.args[0] == 2 );
+  // every written record is either visited or lost
+  VERIFY( 1 + 8 + ring.lost() == 8 + 10 );
+}
+
+// drain_text formats the records after the wrap and the record completed after the previous drain
+template<> template<> void tut::to::test<04>(void)
+{
+  step_clock::ticks = 0;
+  ring_type ring(4, 1);
+  static const char name[] = "config.sys";
+  ring.write(1, name, 0x1F0u);
+  ring.write(2, -5, 2.5, true, 'z');
+  for(uint32_t i = 0; i < 4; i++)
+    ring.write(7, i);
+
+  std::vector<std::string> lines;
+  const text_lines sink = { &lines };
+  VERIFY( ring.drain_text(event_format, sink) == 4 && ring.lost() == 2 );
+  VERIFY( lines.size() == 4 && message(lines[0]) == "event 0\n" && message(lines[3]) == "event 3\n" );
+  // the ticks are microseconds since the ring was created
+  VERIFY( lines[0].compare(0, 11, "[0.000003] ") == 0 && lines[3].compare(0, 11, "[0.000006] ") == 0 );
+
+  lines.clear();
+  ring.write(1, name, 0x1F0u);
+  hooked_ring = &ring;
+  hooked.clear();
+  step_clock::hook = drain_hook;
+  ring.write(2, -5, 2.5, true, 'z');
+  VERIFY( hooked.events.size() == 1 && hooked.events[0] == 1 );
+  VERIFY( ring.drain_text(event_format, sink) == 1 );
+  VERIFY( lines.size() == 1 && message(lines[0]) == "-5 2.50 true z\n" );
+
+  lines.clear();
+  ring.write(1, name, 0x1F0u);
+  VERIFY( ring.drain_text(event_format, sink) == 1 && message(lines[0]) == "open config.sys at 0x1f0\n" );
+}
+
+namespace
+{
+  const uint32_t writers = 4, records_per_writer = 20000;
+
+  // the arguments are derived from each other, so the mixed record is detected
+  struct writer
+  {
+    ntl::nt::trace_ring* ring;
+    uint32_t id;
+    void operator()() const
+    {
+      for(uint32_t i = 0; i < records_per_writer; i++)
+        ring->write(id, i, (static_cast<uint64_t>(id) << 32) ^ i, i * 7u);
+    }
+  };
+
+  struct checker
+  {
+    std::vector<int64_t>* last;
+    size_t* bad;
+    void operator()(const trace_record& r) const
+    {
+      const uint64_t i = r.args[0];
+      if(r.event >= writers || r.argc() != 3 || r.args[1] != ((static_cast<uint64_t>(r.event) << 32) ^ i) || r.args[2] != i * 7
+        || static_cast<int64_t>(i) <= (*last)[r.event])
+        ++*bad;
+      else
+        (*last)[r.event] = static_cast<int64_t>(i);
+    }
+  };
+}
+
+// the concurrent writers and reader: no mixed records, the records of every thread in order, every record is visited or lost
+template<> template<> void tut::to::test<05>(void)
+{
+  ntl::nt::trace_ring ring(1024, 2);
+  std::vector<int64_t> last(writers, -1);
+  size_t bad = 0, visited = 0;
+  const checker check = { &last, &bad };
+
+  std::vector<std::thread> threads;
+  for(uint32_t k = 0; k < writers; k++){
+    const writer w = { &ring, k };
+    threads.push_back(std::thread(w));
+  }
+  for(int i = 0; i < 2000; i++)
+    visited += ring.drain(check);
+  for(uint32_t k = 0; k < writers; k++)
+    threads[k].join();
+  visited += ring.drain(check);
+
+  VERIFY( bad == 0 );
+  VERIFY( visited + ring.lost() == writers * records_per_writer );
+}
@@ -0,0 +1,176 @@
+// ntl::pe::file_view export tables
+
+#include <ntl-tests-common.hxx>
+#include <pe/file_view.hxx>
+#include <string>
+#include <cstdio>
+#include "pe_fixture.hxx"
+
+STLX_DEFAULT_TESTGROUP_NAME("ntl::pe::file_view");
+
+namespace
+{
+  using ntl::pe::file_view;
+  typedef pe_fixture::builder builder;
+  typedef ntl::pe::image::data_directory data_directory;
+  typedef ntl::pe::image::export_directory export_directory;
+
+  const uint32_t dir_rva = 0x1000, functions_rva = 0x1100, names_rva = 0x1140, ordinals_rva = 0x1160;
+
+  /**
+   *	The exports of base 5: ordinals 5, 7 and 8, the slot 6 is empty and 7 is forwarded.
+   *  The names alpha, beta and gamma refer to 8, 5 and 7.
+   **/
+  builder exporting(bool pe64)
+  {
+    builder b(pe64);
+    export_directory* const dir = b.at<export_directory>(dir_rva);
+    dir->Name = 0x11C0;
+    dir->Base = 5;
+    dir->NumberOfFunctions = 4;
+    dir->NumberOfNames = 3;
+    dir->AddressOfFunctions = functions_rva;
+    dir->AddressOfNames = names_rva;
+    dir->AddressOfNameOrdinals = ordinals_rva;
+    b.set_directory(data_directory::export_table, dir_rva, 0x300);
+
+    const uint32_t functions[] = { 0x1800, 0, 0x1200, 0x1810 };
+    b.put(functions_rva, functions, sizeof(functions));
+    const uint32_t names[] = { 0x1180, 0x1190, 0x11A0 };
+    b.put(names_rva, names, sizeof(names));
+    const uint16_t ordinals[] = { 3, 0, 2 };
+    b.put(ordinals_rva, ordinals, sizeof(ordinals));
+    b.put_string(0x1180, "alpha");
+    b.put_string(0x1190, "beta");
+    b.put_string(0x11A0, "gamma");
+    b.put_string(0x11C0, "test.dll");
+    b.put_string(0x1200, "other.func");
+    return b;
+  }
+
+  // "ordinal:rva:name>forwarder;" of every entry
+  std::string listing(const file_view::sequence<file_view::export_iterator>& s)
+  {
+    std::string r;
+    for(file_view::export_iterator i = s.begin(); i != s.end(); ++i){
+      char buf[64];
+      std::sprintf(buf, "%u:%x:", i->ordinal, i->rva);
+      r.append(buf);
+      if(i->name)
+        r.append(i->name);
+      if(i->forwarder)
+        r.append(">").append(i->forwarder);
+      r.append(";");
+    }
+    return r;
+  }
+
+  size_t count(const file_view::sequence<file_view::export_iterator>& s)
+  {
+    size_t n = 0;
+    for(file_view::export_iterator i = s.begin(); i != s.end(); ++i)
+      n++;
+    return n;
+  }
+}
+
+// the exports by ordinal and by name, in both layouts and both formats
+template<> template<> void tut::to::test<01>(void)
+{
+  for(int pe64 = 0; pe64 < 2; pe64++){
+    const builder b = exporting(pe64 != 0);
+    const std::vector<uint8_t> raw = b.file();
+    const file_view views[] = {
+      file_view(&b.bytes[0], b.bytes.size(), file_view::image_layout),
+      file_view(&raw[0], raw.size(), file_view::file_layout)
+    };
+    for(size_t v = 0; v < _countof(views); v++){
+      const file_view& view = views[v];
+      VERIFY( view.is_valid() && view.is_pe64() == (pe64 != 0) );
+      const export_directory* const dir = view.get_export_directory();
+      VERIFY( dir && std::strcmp(view.string_at(dir->Name), "test.dll") == 0 );
+      VERIFY( listing(view.exports()) == "5:1800:;7:1200:>other.func;8:1810:;" );
+      VERIFY( listing(view.named_exports()) == "8:1810:alpha;5:1800:beta;7:1200:gamma>other.func;" );
+    }
+  }
+}
+
+// the tables at the end of the 32-bit RVA space are not wrapped around to the headers
+template<> template<> void tut::to::test<02>(void)
+{
+  builder b = exporting(false);
+  export_directory* const dir = b.at<export_directory>(dir_rva);
+
+  // the entry 1 would be at RVA 0 which is the DOS header
+  dir->AddressOfFunctions = 0xFFFFFFFC;
+  const uint16_t ordinals[] = { 0, 1, 1 };
+  b.put(ordinals_rva, ordinals, sizeof(ordinals));
+  {
+    const file_view view(&b.bytes[0], b.bytes.size(), file_view::image_layout);
+    VERIFY( view.get_export_directory() != 0 );
+    VERIFY( count(view.exports()) == 0 );
+    VERIFY( count(view.named_exports()) == 0 );
+  }
+
+  dir->AddressOfFunctions = functions_rva;
+  dir->AddressOfNames = 0xFFFFFFFC;
+  dir->NumberOfNames = 0x40000001;
+  {
+    const file_view view(&b.bytes[0], b.bytes.size(), file_view::image_layout);
+    VERIFY( count(view.exports()) == 3 );
+    VERIFY( count(view.named_exports()) == 0 );
+  }
+
+  dir->AddressOfNames = names_rva;
+  dir->AddressOfNameOrdinals = 0xFFFFFFFE;
+  {
+    const file_view view(&b.bytes[0], b.bytes.size(), file_view::image_layout);
+    VERIFY( count(view.named_exports()) == 0 );
+  }
+}
+
+// the truncated and the broken tables end the walk inside the data
+template<> template<> void tut::to::test<03>(void)
+{
+  builder b = exporting(false);
+  export_directory* const dir = b.at<export_directory>(dir_rva);
+
+  // the name table runs past the section: the two names which fit are listed
+  const uint32_t names[] = { 0x1190, 0x1180 };
+  const uint16_t ordinals[] = { 0, 3 };
+  dir->AddressOfNames = 0x2000 - 8;
+  dir->AddressOfNameOrdinals = 0x1F00;
+  b.put(dir->AddressOfNames, names, sizeof(names));
+  b.put(dir->AddressOfNameOrdinals, ordinals, sizeof(ordinals));
+  dir->NumberOfNames = 0xFFFFFFFF;
+  {
+    const file_view view(&b.bytes[0], b.bytes.size(), file_view::image_layout);
+    VERIFY( listing(view.named_exports()) == "5:1800:beta;8:1810:alpha;" );
+    const std::vector<uint8_t> raw = b.file();
+    const file_view file(&raw[0], raw.size(), file_view::file_layout);
+    VERIFY( listing(file.named_exports()) == "5:1800:beta;8:1810:alpha;" );
+  }
+
+  // the ordinal beyond the address table skips the name
+  const uint16_t bad[] = { 9, 3 };
+  b.put(0x1F00, bad, sizeof(bad));
+  dir->NumberOfNames = 2;
+  {
+    const file_view view(&b.bytes[0], b.bytes.size(), file_view::image_layout);
+    VERIFY( listing(view.named_exports()) == "8:1810:alpha;" );
+  }
+
+  // the address table is cut by the view end
+  dir->AddressOfFunctions = 0x2000 - 8;
+  dir->NumberOfFunctions = 100;
+  b.put(0x2000 - 8, "\x00\x18\x00\x00\x10\x18\x00\x00", 8);
+  {
+    const file_view view(&b.bytes[0], b.bytes.size(), file_view::image_layout);
+    VERIFY( listing(view.exports()) == "5:1800:;6:1810:;" );
+  }
+
+  // the directory which is shorter than the export directory is ignored
+  b.set_directory(data_directory::export_table, dir_rva, sizeof(export_directory) - 1);
+  const file_view view(&b.bytes[0], b.bytes.size(), file_view::image_layout);
+  VERIFY( !view.get_export_directory() && count(view.exports()) == 0 && count(view.named_exports()) == 0 );
+}
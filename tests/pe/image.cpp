@@ -0,0 +1,195 @@
+// ntl::pe::image checksum and base relocations
+
+#include <ntl-tests-common.hxx>
+#include <pe/image.hxx>
+#include <vector>
+#include "pe_fixture.hxx"
+
+STLX_DEFAULT_TESTGROUP_NAME("ntl::pe::image");
+
+namespace
+{
+  typedef ntl::pe::image image;
+  typedef pe_fixture::builder builder;
+  typedef image::data_directory data_directory;
+  typedef image::base_relocation base_relocation;
+
+  /** The section is filled by a byte pattern, the stored CheckSum is garbage which must be excluded */
+  builder checksummed(bool pe64)
+  {
+    builder b(pe64);
+    for(uint32_t i = 0; i < b.section_size; i++)
+      b.bytes[b.section_rva + i] = static_cast<uint8_t>(i * 7 + 3 + (i >> 8));
+    b.headers()->OptionalHeader32.CheckSum = 0xDEADBEEF;
+    return b;
+  }
+
+  // CheckSumMappedFile: the 16-bit words with the end-around carry, the stored CheckSum is skipped
+  uint32_t reference_checksum(const std::vector<uint8_t>& file, size_t size)
+  {
+    const size_t skip = builder::nt_offset + 4 + sizeof(image::file_header) + offsetof(image::optional_header32, CheckSum);
+    uint32_t sum = 0;
+    for(size_t i = 0; i < size; i += 2){
+      if(i == skip || i == skip + 2)
+        continue;
+      sum += file[i] + (i + 1 < size ? file[i + 1] << 8 : 0);
+      sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return sum + static_cast<uint32_t>(size);
+  }
+
+  uint16_t fixup(base_relocation::types type, uint16_t offset)
+  {
+    return static_cast<uint16_t>(type << 12 | offset);
+  }
+
+  /** Puts the block for the page at \p page_rva, returns the RVA past it */
+  uint32_t put_block(builder& b, uint32_t rva, uint32_t page_rva, const uint16_t* entries, size_t count)
+  {
+    const uint32_t header[] = { page_rva, static_cast<uint32_t>(8 + count * sizeof(uint16_t)) };
+    return b.put(b.put(rva, header, sizeof(header)), entries, count * sizeof(uint16_t));
+  }
+
+  image* mapped(builder& b)
+  {
+    return reinterpret_cast<image*>(&b.bytes[0]);
+  }
+
+  const uint32_t reloc_rva = 0x1F00;
+  const ptrdiff_t delta = 0x1234F000;
+}
+
+// the file checksum: the fixtures of both formats, the odd size and the stored value
+template<> template<> void tut::to::test<01>(void)
+{
+  const std::vector<uint8_t> file32 = checksummed(false).file(), file64 = checksummed(true).file();
+  VERIFY( file32.size() == 0x1200 && file64.size() == 0x1200 );
+
+  VERIFY( image::checksum(&file32[0], file32.size()) == 0x0000F456 );
+  VERIFY( image::checksum(&file64[0], file64.size()) == 0x0000BA40 );
+  VERIFY( image::checksum(&file32[0], file32.size() - 1) == 0x0000E955 );
+  VERIFY( image::checksum(&file32[0], 0x201) == 0x0000E45A );
+
+  // the stored value does not change the sum
+  std::vector<uint8_t> stored = file32;
+  reinterpret_cast<image::nt_headers*>(&stored[builder::nt_offset])->OptionalHeader32.CheckSum = 0x0000F456;
+  VERIFY( image::checksum(&stored[0], stored.size()) == 0x0000F456 );
+
+  // the sizes around the step of the summing kernel
+  for(size_t size = 0x180; size < 0x1200; size += 0xF3)
+    VERIFY( image::checksum(&file32[0], size) == reference_checksum(file32, size) );
+
+  // not a PE file: everything is summed
+  const uint8_t raw[] = { 0x01, 0x02, 0xFF, 0xFF, 0x03 };
+  VERIFY( image::checksum(raw, sizeof(raw)) == 0x0204 + 5 );
+}
+
+// the partial sums of even parts match the sum of the whole, the mapped image sum
+template<> template<> void tut::to::test<02>(void)
+{
+  const std::vector<uint8_t> file = checksummed(false).file();
+  const uint32_t whole = image::checksum_partial(&file[0], file.size());
+  VERIFY( whole == 0x00007FF4 );
+  for(size_t split = 0; split <= file.size(); split += 0x96){
+    const uint32_t head = image::checksum_partial(&file[0], split);
+    VERIFY( image::checksum_partial(&file[split], file.size() - split, head) == whole );
+  }
+
+  // the image layout is summed up to SizeOfImage
+  builder b = checksummed(false);
+  image* const pe = mapped(b);
+  VERIFY( pe->checksum() == 0x00010256 );
+  VERIFY( pe->checksum(false) == 0x00010256 && b.headers()->OptionalHeader32.CheckSum == 0xDEADBEEF );
+  VERIFY( pe->checksum(true) == 0x00010256 && b.headers()->OptionalHeader32.CheckSum == 0x00010256 );
+  VERIFY( pe->checksum() == 0x00010256 );
+}
+
+// every fixup type of the block applied by its own loop
+template<> template<> void tut::to::test<03>(void)
+{
+  builder b;
+  const uint32_t page = 0x1000;
+  *b.at<uint32_t>(page + 0x800) = 0x00401234;
+  *b.at<uint32_t>(page + 0x804) = 0x00401000;
+  *b.at<uint64_t>(page + 0x810) = 0x0000000140001000ull;
+  *b.at<uint16_t>(page + 0x820) = 0x0040;
+  *b.at<uint16_t>(page + 0x824) = 0x1234;
+  // the high half of 0x003F9000, the low half is the parameter
+  *b.at<uint16_t>(page + 0x830) = 0x0040;
+
+  const uint16_t entries[] = {
+    fixup(base_relocation::highlow, 0x800), fixup(base_relocation::highlow, 0x804),
+    fixup(base_relocation::dir64, 0x810),
+    fixup(base_relocation::high, 0x820), fixup(base_relocation::low, 0x824),
+    fixup(base_relocation::highadj, 0x830), 0x9000,
+    fixup(base_relocation::absolute, 0)
+  };
+  const uint32_t end = put_block(b, reloc_rva, page, entries, _countof(entries));
+  b.set_directory(data_directory::basereloc_table, reloc_rva, end - reloc_rva);
+
+  VERIFY( mapped(b)->relocate(delta) );
+  VERIFY( *b.at<uint32_t>(page + 0x800) == 0x12750234 );
+  VERIFY( *b.at<uint32_t>(page + 0x804) == 0x12750000 );
+  VERIFY( *b.at<uint64_t>(page + 0x810) == 0x0000000152350000ull );
+  VERIFY( *b.at<uint16_t>(page + 0x820) == 0x1274 );
+  VERIFY( *b.at<uint16_t>(page + 0x824) == 0x0234 );
+  // 0x003F9000 + delta = 0x12748000 is rounded to 0x1275
+  VERIFY( *b.at<uint16_t>(page + 0x830) == 0x1275 );
+
+  // the negative delta is sign-extended for dir64, high drops the carry out of the low half
+  VERIFY( mapped(b)->relocate(-delta) );
+  VERIFY( *b.at<uint32_t>(page + 0x800) == 0x00401234 );
+  VERIFY( *b.at<uint64_t>(page + 0x810) == 0x0000000140001000ull );
+  VERIFY( *b.at<uint16_t>(page + 0x820) == 0x003F && *b.at<uint16_t>(page + 0x824) == 0x1234 );
+}
+
+// the unknown type and the highadj without parameter end the block, the parts
+template<> template<> void tut::to::test<04>(void)
+{
+  {
+    builder b;
+    *b.at<uint32_t>(0x1100) = 0x00401000;
+    *b.at<uint32_t>(0x1200) = 0x00402000;
+    const uint16_t entries[] = {
+      fixup(base_relocation::highlow, 0x100),
+      fixup(base_relocation::mips_jmpaddr, 0x180),
+      fixup(base_relocation::highlow, 0x200)
+    };
+    const uint32_t end = put_block(b, reloc_rva, 0x1000, entries, _countof(entries));
+    b.set_directory(data_directory::basereloc_table, reloc_rva, end - reloc_rva);
+    VERIFY( !mapped(b)->relocate(delta) );
+    VERIFY( *b.at<uint32_t>(0x1100) == 0x12750000 && *b.at<uint32_t>(0x1200) == 0x00402000 );
+  }
+  {
+    builder b;
+    *b.at<uint16_t>(0x1100) = 0x0040;
+    const uint16_t entries[] = { fixup(base_relocation::highadj, 0x100) };
+    const uint32_t end = put_block(b, reloc_rva, 0x1000, entries, _countof(entries));
+    b.set_directory(data_directory::basereloc_table, reloc_rva, end - reloc_rva);
+    VERIFY( !mapped(b)->relocate(delta) );
+    VERIFY( *b.at<uint16_t>(0x1100) == 0x0040 );
+  }
+
+  // no relocations
+  builder none;
+  VERIFY( !mapped(none)->relocate(delta) );
+
+  // two pages, the parts apply the disjoint blocks
+  builder whole(false, 0x2000), parted(false, 0x2000);
+  builder* const images[] = { &whole, &parted };
+  for(size_t i = 0; i < _countof(images); i++){
+    builder& b = *images[i];
+    *b.at<uint32_t>(0x1010) = 0x00401010;
+    *b.at<uint32_t>(0x2020) = 0x00402020;
+    const uint16_t first[] = { fixup(base_relocation::highlow, 0x010), 0 }, second[] = { fixup(base_relocation::highlow, 0x020), 0 };
+    const uint32_t end = put_block(b, put_block(b, 0x2F00, 0x1000, first, 2), 0x2000, second, 2);
+    b.set_directory(data_directory::basereloc_table, 0x2F00, end - 0x2F00);
+  }
+  VERIFY( mapped(whole)->relocate(delta) );
+  VERIFY( !mapped(parted)->relocate(delta, 0, 0) );
+  VERIFY( mapped(parted)->relocate(delta, 1, 2) );
+  VERIFY( *parted.at<uint32_t>(0x1010) == 0x00401010 && *parted.at<uint32_t>(0x2020) == 0x12751020 );
+  VERIFY( mapped(parted)->relocate(delta, 0, 2) );
+  VERIFY( parted.bytes == whole.bytes );
+  VERIFY( *whole.at<uint32_t>(0x1010) == 0x12750010 );
+}
@@ -0,0 +1,108 @@
+// the minimal PE images built in memory for the pe tests
+#pragma once
+
+#include <pe/image.hxx>
+#include <vector>
+#include <cstring>
+
+namespace pe_fixture
+{
+  typedef ntl::pe::image image;
+
+  /**
+   *	One section image: the headers take the first page, the section starts at \c section_rva.
+   *  The bytes are kept in the image layout (RVA is the offset), file() gives the on-disk layout
+   *  where the section follows the headers at \c file_alignment.
+   **/
+  struct builder
+  {
+    static const uint32_t section_rva = 0x1000;
+    static const uint32_t file_alignment = 0x200;
+    static const uint32_t nt_offset = sizeof(image::dos_header);
+
+    std::vector<uint8_t> bytes;
+    uint32_t section_size;
+    bool pe64;
+
+    explicit builder(bool pe64 = false, uint32_t section_size = 0x1000)
+      :bytes(section_rva + section_size), section_size(section_size), pe64(pe64)
+    {
+      image::dos_header* const dh = at<image::dos_header>(0);
+      dh->e_magic = image::dos_header::signature;
+      dh->e_lfanew = nt_offset;
+
+      image::nt_headers* const nth = headers();
+      nth->Signature = image::nt_headers::signature;
+      nth->FileHeader.Machine = static_cast<uint16_t>(pe64 ? image::file_header::amd64 : image::file_header::i386);
+      nth->FileHeader.NumberOfSections = 1;
+      nth->FileHeader.SizeOfOptionalHeader = static_cast<uint16_t>(pe64 ? sizeof(image::optional_header64) : sizeof(image::optional_header32));
+      if(pe64){
+        image::optional_header64& oh = nth->OptionalHeader64;
+        oh.Magic = image::optional_header64::signature;
+        oh.ImageBase = 0x140000000ull;
+        oh.SectionAlignment = section_rva, oh.FileAlignment = file_alignment;
+        oh.SizeOfImage = section_rva + section_size, oh.SizeOfHeaders = file_alignment;
+        oh.NumberOfRvaAndSizes = image::data_directory::number_of_directory_entries;
+      }else{
+        image::optional_header32& oh = nth->OptionalHeader32;
+        oh.Magic = image::optional_header32::signature;
+        oh.ImageBase = 0x400000;
+        oh.SectionAlignment = section_rva, oh.FileAlignment = file_alignment;
+        oh.SizeOfImage = section_rva + section_size, oh.SizeOfHeaders = file_alignment;
+        oh.NumberOfRvaAndSizes = image::data_directory::number_of_directory_entries;
+      }
+      image::section_header* const sh = section();
+      std::memcpy(sh->Name, ".data", 6);
+      sh->VirtualSize = sh->SizeOfRawData = section_size;
+      sh->VirtualAddress = section_rva;
+      sh->PointerToRawData = file_alignment;
+    }
+
+    template<class T>
+    T* at(uint32_t rva)
+    {
+      return reinterpret_cast<T*>(&bytes[rva]);
+    }
+
+    image::nt_headers* headers()
+    {
+      return at<image::nt_headers>(nt_offset);
+    }
+
+    image::section_header* section()
+    {
+      return at<image::section_header>(nt_offset + 4 + sizeof(image::file_header) + headers()->FileHeader.SizeOfOptionalHeader);
+    }
+
+    image::data_directory& directory(image::data_directory::entry entry)
+    {
+      return pe64 ? headers()->OptionalHeader64.DataDirectory[entry] : headers()->OptionalHeader32.DataDirectory[entry];
+    }
+
+    void set_directory(image::data_directory::entry entry, uint32_t rva, uint32_t size)
+    {
+      directory(entry).VirtualAddress = rva;
+      directory(entry).Size = size;
+    }
+
+    /** Copies \p size bytes to \p rva, returns the RVA past them */
+    uint32_t put(uint32_t rva, const void* data, size_t size)
+    {
+      std::memcpy(&bytes[rva], data, size);
+      return rva + static_cast<uint32_t>(size);
+    }
+
+    uint32_t put_string(uint32_t rva, const char* s)
+    {
+      return put(rva, s, std::strlen(s) + 1);
+    }
+
+    /** The on-disk layout: the headers are padded to the file alignment and followed by the section */
+    std::vector<uint8_t> file() const
+    {
+      std::vector<uint8_t> f(bytes.begin(), bytes.begin() + file_alignment);
+      f.insert(f.end(), bytes.begin() + section_rva, bytes.end());
+      return f;
+    }
+  };
+}
@@ -0,0 +1,249 @@
+// 20.5 class template bitset and ntl::dynamic_bitset
+
+#include <ntl-tests-common.hxx>
+#include <bitset>
+#include <string>
+#include <vector>
+#include <dynamic_bitset.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::bitset");
+
+namespace
+{
+  // the shifts of the string representation: the bit 0 is the last character
+  std::string shifted_left(const std::string& s, size_t pos)
+  {
+    return pos >= s.size() ? std::string(s.size(), '0') : s.substr(pos) + std::string(pos, '0');
+  }
+
+  std::string shifted_right(const std::string& s, size_t pos)
+  {
+    return pos >= s.size() ? std::string(s.size(), '0') : std::string(pos, '0') + s.substr(0, s.size() - pos);
+  }
+
+  template<size_t N>
+  std::bitset<N> random_bits(unsigned& seed)
+  {
+    std::bitset<N> b;
+    for(size_t i = 0; i < N; i++){
+      seed = seed * 1103515245 + 12345;
+      if((seed >> 16) & 1)
+        b.set(i);
+    }
+    return b;
+  }
+
+  // the set bits by _Find_first() and _Find_next()
+  template<size_t N>
+  std::vector<size_t> set_bits(const std::bitset<N>& b)
+  {
+    std::vector<size_t> v;
+    for(size_t i = b._Find_first(); i < b.size(); i = b._Find_next(i))
+      v.push_back(i);
+    return v;
+  }
+
+  template<class Bitset>
+  std::vector<size_t> set_bits_dynamic(const Bitset& b)
+  {
+    std::vector<size_t> v;
+    for(size_t i = b.find_first(); i != b.npos; i = b.find_next(i))
+      v.push_back(i);
+    return v;
+  }
+}
+
+// the constructor and the compound operators
+template<> template<> void tut::to::test<01>(void)
+{
+  // the value is truncated to N bits and the shift by N >= 64 is not taken
+  VERIFY( std::bitset<16>(0x12345).to_ulong() == 0x2345 );
+  VERIFY( std::bitset<32>(0x100000001ULL).to_ulong() == 1 );
+  VERIFY( std::bitset<64>(~0ULL).all() );
+  VERIFY( std::bitset<64>(~0ULL).to_ullong() == ~0ULL );
+  const std::bitset<128> wide(~0ULL);
+  VERIFY( wide.count() == 64 && wide.test(63) && !wide.test(64) && !wide.test(127) );
+  const std::bitset<200> sparse(0x8000000000000001ULL);
+  VERIFY( sparse.count() == 2 && sparse.test(0) && sparse.test(63) );
+
+  // &= is the conjunction, not the and-not
+  std::bitset<8> a(0xC), b(0xA);
+  a &= b;
+  VERIFY( a.to_ulong() == 0x8 );
+  a = 0xC;
+  a |= b;
+  VERIFY( a.to_ulong() == 0xE );
+  a = 0xC;
+  a ^= b;
+  VERIFY( a.to_ulong() == 0x6 );
+
+  std::bitset<100> x = std::bitset<100>().set(), y;
+  y.set(3).set(64).set(99);
+  x &= y;
+  VERIFY( x == y );
+}
+
+// the bits above 31 are addressed by the word-wide shifts
+template<> template<> void tut::to::test<02>(void)
+{
+  std::bitset<100> b;
+  const size_t bits[] = { 31, 32, 33, 63, 64, 99 };
+  for(size_t i = 0; i < _countof(bits); i++)
+    b.set(bits[i]);
+  VERIFY( b.count() == _countof(bits) );
+  for(size_t i = 0; i < _countof(bits); i++)
+    VERIFY( b.test(bits[i]) && b[bits[i]] );
+  VERIFY( !b.test(0) && !b.test(34) && !b.test(62) && !b.test(65) );
+
+  b.reset(63).flip(40);
+  VERIFY( !b.test(63) && b.test(40) && b.count() == _countof(bits) );
+  b[98] = true;
+  VERIFY( b.test(98) && b.to_string()[1] == '1' );
+
+  std::bitset<64> q;
+  q.set(40);
+  VERIFY( q.to_ullong() == 1ULL << 40 );
+}
+
+// set() and flip() keep the unused bits of the last word clear
+template<> template<> void tut::to::test<03>(void)
+{
+  std::bitset<70> b;
+  b.set();
+  VERIFY( b.count() == 70 && b.all() );
+  VERIFY( b.to_string() == std::string(70, '1') );
+  VERIFY( b == ~std::bitset<70>() );
+
+  // the tail would be shifted in
+  b >>= 69;
+  VERIFY( b.count() == 1 && b.test(0) );
+
+  b.reset().flip();
+  VERIFY( b.count() == 70 && b.all() );
+  b.flip();
+  VERIFY( b.none() && b == std::bitset<70>() );
+
+  std::bitset<33> c;
+  c.flip();
+  VERIFY( c.count() == 33 && (c >> 32).count() == 1 );
+}
+
+// the free operators make a copy, the arguments are unchanged
+template<> template<> void tut::to::test<04>(void)
+{
+  const std::bitset<100> a = std::bitset<100>(0xF0F0).set(80), b = std::bitset<100>(0xFF00).set(90);
+  const std::bitset<100> a0 = a, b0 = b;
+
+  const std::bitset<100> x = a & b, y = a | b, z = a ^ b;
+  VERIFY( a == a0 && b == b0 );
+  VERIFY( x == std::bitset<100>(0xF000) );
+  VERIFY( y == std::bitset<100>(0xFFF0).set(80).set(90) );
+  VERIFY( z == std::bitset<100>(0x0FF0).set(80).set(90) );
+  VERIFY( (~a).count() == 100 - a.count() && a == a0 );
+  VERIFY( (a << 4) != a && a == a0 );
+}
+
+// the shifts, including the shift by N and by more than N
+template<> template<> void tut::to::test<05>(void)
+{
+  std::bitset<64> w(~0ULL);
+  w >>= 64;
+  VERIFY( w.none() );
+  w = ~0ULL;
+  w <<= 64;
+  VERIFY( w.none() );
+  w = ~0ULL;
+  w >>= 63;
+  VERIFY( w.to_ullong() == 1 );
+
+  unsigned seed = 7;
+  for(int n = 0; n < 10; n++){
+    const std::bitset<100> b = random_bits<100>(seed);
+    const std::string s = b.to_string();
+    for(size_t pos = 0; pos <= 110; pos++){
+      VERIFY( (b << pos).to_string() == shifted_left(s, pos) );
+      VERIFY( (b >> pos).to_string() == shifted_right(s, pos) );
+    }
+  }
+
+  std::bitset<70> t;
+  t.set();
+  t >>= 70;
+  VERIFY( t.none() );
+}
+
+// the iteration of the set bits
+template<> template<> void tut::to::test<06>(void)
+{
+  std::bitset<200> b;
+  VERIFY( b._Find_first() == 200 );
+  const size_t bits[] = { 0, 31, 32, 63, 64, 65, 127, 128, 199 };
+  for(size_t i = 0; i < _countof(bits); i++)
+    b.set(bits[i]);
+  const std::vector<size_t> v = set_bits(b);
+  VERIFY( v.size() == _countof(bits) );
+  for(size_t i = 0; i < v.size(); i++)
+    VERIFY( v[i] == bits[i] );
+  VERIFY( b._Find_next(199) == 200 && b._Find_next(500) == 200 );
+  VERIFY( b._Find_next(129) == 199 );
+
+  // the last bit of the partial word
+  std::bitset<70> t;
+  t.set(69);
+  VERIFY( t._Find_first() == 69 && t._Find_next(69) == 70 );
+
+  unsigned seed = 3;
+  const std::bitset<100> r = random_bits<100>(seed);
+  const std::vector<size_t> rv = set_bits(r);
+  VERIFY( rv.size() == r.count() );
+  for(size_t i = 0; i < rv.size(); i++)
+    VERIFY( r.test(rv[i]) );
+}
+
+// ntl::dynamic_bitset
+template<> template<> void tut::to::test<07>(void)
+{
+  typedef ntl::dynamic_bitset<> dynamic_bitset;
+
+  dynamic_bitset e;
+  VERIFY( e.empty() && e.size() == 0 && e.find_first() == e.npos && e.none() );
+
+  dynamic_bitset d(70, 0x5);
+  VERIFY( d.size() == 70 && d.count() == 2 && d.test(0) && d.test(2) );
+  d.set(69);
+  d[64] = true;
+  std::vector<size_t> v = set_bits_dynamic(d);
+  VERIFY( v.size() == 4 && v[0] == 0 && v[1] == 2 && v[2] == 64 && v[3] == 69 );
+  VERIFY( d.find_next(69) == d.npos );
+
+  // the tail stays clear
+  d.set();
+  VERIFY( d.count() == 70 && d.all() );
+  d.flip();
+  VERIFY( d.none() );
+  d.flip();
+  d >>= 69;
+  VERIFY( d.count() == 1 && d.test(0) );
+  d <<= 70;
+  VERIFY( d.none() );
+
+  // the new bits take the value
+  dynamic_bitset r(3, 0x7);
+  r.resize(130, true);
+  VERIFY( r.size() == 130 && r.all() );
+  r.resize(5);
+  VERIFY( r.size() == 5 && r.count() == 5 );
+  r.resize(70);
+  VERIFY( r.count() == 5 && r.find_next(4) == r.npos );
+  r.push_back(true);
+  VERIFY( r.size() == 71 && r.test(70) && r.count() == 6 );
+
+  const dynamic_bitset a(100, 0xF0F0), b(100, 0xFF00);
+  VERIFY( (a & b) == dynamic_bitset(100, 0xF000) );
+  VERIFY( (a | b) == dynamic_bitset(100, 0xFFF0) );
+  VERIFY( (a ^ b) == dynamic_bitset(100, 0x0FF0) );
+  VERIFY( a == dynamic_bitset(100, 0xF0F0) );
+  VERIFY( (a << 40).find_first() == 44 && (a >> 4).find_first() == 0 );
+  VERIFY( (~a).count() == 92 );
+  VERIFY( dynamic_bitset(64, 1) != dynamic_bitset(65, 1) );
+}
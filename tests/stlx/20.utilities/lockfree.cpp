@@ -0,0 +1,133 @@
+// ntl::lockfree stack and queues, single-threaded
+
+#include <ntl-tests-common.hxx>
+#include <lockfree.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("ntl::lockfree");
+
+using namespace ntl::lockfree;
+
+namespace
+{
+  struct node: ntl::nt::slist_entry
+  {
+    int value;
+  };
+
+  // counts the live copies to check the destruction of the elements left in the queue
+  struct counted
+  {
+    static int live;
+    int value;
+    counted(int v = 0): value(v) { ++live; }
+    counted(const counted& c): value(c.value) { ++live; }
+    ~counted() { --live; }
+  };
+  int counted::live = 0;
+}
+
+// the stack: LIFO order, the chain push, flush
+template<> template<> void tut::to::test<01>(void)
+{
+  stack s;
+  VERIFY( s.empty() && s.depth() == 0 && s.pop() == 0 && s.flush() == 0 );
+
+  node n[5];
+  for(int i = 0; i < 5; i++){
+    n[i].value = i;
+    s.push(&n[i]);
+  }
+  VERIFY( !s.empty() && s.depth() == 5 );
+  VERIFY( static_cast<node*>(s.pop())->value == 4 && static_cast<node*>(s.pop())->value == 3 );
+  VERIFY( s.depth() == 3 );
+
+  // the chain n[3] -> n[4] goes on the top as is
+  n[3].Next = &n[4];
+  s.push(&n[3], &n[4], 2);
+  VERIFY( s.depth() == 5 );
+  VERIFY( s.pop() == &n[3] && s.pop() == &n[4] && s.pop() == &n[2] );
+
+  ntl::nt::slist_entry* chain = s.flush();
+  VERIFY( s.empty() && s.depth() == 0 );
+  VERIFY( chain == &n[1] && chain->Next == &n[0] && n[0].Next == 0 );
+}
+
+// the bounded queue: the capacity is rounded up, full and empty
+template<> template<> void tut::to::test<02>(void)
+{
+  VERIFY( bounded_queue<int>(0).capacity() == 2 );
+  VERIFY( bounded_queue<int>(2).capacity() == 2 );
+  VERIFY( bounded_queue<int>(3).capacity() == 4 );
+  VERIFY( bounded_queue<int>(1000).capacity() == 1024 );
+  VERIFY( bounded_queue<int>(4096).capacity() == 4096 );
+  VERIFY( bounded_queue<int>(4097).capacity() == 8192 );
+
+  bounded_queue<int> q(5);
+  int v = -1;
+  VERIFY( q.capacity() == 8 && !q.pop(v) && v == -1 );
+  for(int i = 0; i < 8; i++)
+    VERIFY( q.push(i) );
+  VERIFY( !q.push(8) );
+  for(int i = 0; i < 8; i++)
+    VERIFY( q.pop(v) && v == i );
+  VERIFY( !q.pop(v) );
+  VERIFY( q.push(9) && q.pop(v) && v == 9 );
+}
+
+// the bounded queue: the positions wrap around the ring many times, the elements left are destroyed
+template<> template<> void tut::to::test<03>(void)
+{
+  bounded_queue<int> q(4);
+  int next = 0, expected = 0, v;
+  for(int round = 0; round < 1000; round++){
+    // the fill level varies, so the head and the tail meet at every cell
+    const int n = round % 6;
+    for(int i = 0; i < n; i++){
+      const bool pushed = q.push(next);
+      VERIFY( pushed == (i < 4) );
+      if(pushed)
+        ++next;
+    }
+    while(q.pop(v))
+      VERIFY( v == expected++ );
+  }
+  VERIFY( expected == next );
+
+  {
+    bounded_queue<counted> c(4);
+    VERIFY( counted::live == 0 );
+    for(int i = 0; i < 3; i++)
+      VERIFY( c.push(counted(i)) );
+    counted out;
+    VERIFY( c.pop(out) && out.value == 0 && counted::live == 3 );
+  }
+  VERIFY( counted::live == 0 );
+}
+
+// the mpsc queue: FIFO order, the stub is reused when the queue drains
+template<> template<> void tut::to::test<04>(void)
+{
+  mpsc_queue q;
+  VERIFY( q.empty() && q.pop() == 0 );
+
+  node n[6];
+  for(int i = 0; i < 3; i++){
+    n[i].value = i;
+    q.push(&n[i]);
+  }
+  VERIFY( !q.empty() );
+  VERIFY( q.pop() == &n[0] && q.pop() == &n[1] );
+  // the last entry is returned after the stub is pushed behind it
+  VERIFY( q.pop() == &n[2] && q.pop() == 0 );
+
+  for(int round = 0; round < 3; round++){
+    for(int i = 0; i < 6; i++)
+      q.push(&n[i]);
+    for(int i = 0; i < 6; i++)
+      VERIFY( q.pop() == &n[i] );
+    VERIFY( q.pop() == 0 );
+  }
+
+  q.push(&n[5]);
+  VERIFY( q.pop() == &n[5] && q.pop() == 0 );
+}
@@ -0,0 +1,98 @@
+// std::ext::lookaside_allocator over the user-mode nt::lookaside_list
+
+#include <ntl-tests-common.hxx>
+#include <list>
+#include <map>
+#include <nt/lookaside_list.hxx>
+#include <stlx/ext/allocators.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::ext::lookaside_allocator");
+
+namespace
+{
+  typedef ntl::nt::lookaside_list<> lookaside;
+
+  // the cells are larger than the nodes of list<int> and map<int,int>
+  static const size_t cell_size = 64;
+  static const uint16_t depth = 16;
+}
+
+// list: the freed nodes are reused up to the depth of the list
+template<> template<> void tut::to::test<01>(void)
+{
+  typedef std::ext::lookaside_allocator<int, lookaside> allocator;
+  lookaside cells(cell_size, ntl::nt::process_heap(), depth);
+  {
+    std::list<int, allocator> l((allocator(cells)));
+    for(int i = 0; i < 10; i++)
+      l.push_back(i);
+    // the empty lookaside misses every time
+    VERIFY( cells.TotalAllocates == 10 );
+    VERIFY( cells.AllocateMisses == 10 );
+
+    l.clear();
+    VERIFY( cells.TotalFrees == 10 );
+    VERIFY( cells.FreeMisses == 0 );
+
+    for(int i = 0; i < 10; i++)
+      l.push_back(i);
+    // all of them are hits
+    VERIFY( cells.TotalAllocates == 20 );
+    VERIFY( cells.AllocateMisses == 10 );
+
+    for(int i = 0; i < 20; i++)
+      l.push_back(i);
+    VERIFY( cells.TotalAllocates == 40 );
+    VERIFY( cells.AllocateMisses == 30 );
+  }
+  // 30 nodes freed, the lookaside keeps 16 of them
+  VERIFY( cells.TotalFrees == 40 );
+  VERIFY( cells.FreeMisses == 30 - depth );
+}
+
+// map: the node of a rejected duplicate is not allocated, the erased ones are reused
+template<> template<> void tut::to::test<02>(void)
+{
+  typedef std::pair<const int, int> value_type;
+  typedef std::ext::lookaside_allocator<value_type, lookaside> allocator;
+  lookaside cells(cell_size, ntl::nt::process_heap(), depth);
+  {
+    std::map<int, int, std::less<int>, allocator> m(std::less<int>(), (allocator(cells)));
+    for(int i = 0; i < 8; i++)
+      m[i] = i;
+    VERIFY( cells.TotalAllocates == 8 );
+    VERIFY( cells.AllocateMisses == 8 );
+
+    for(int i = 0; i < 8; i += 2)
+      m.erase(i);
+    VERIFY( cells.TotalFrees == 4 );
+
+    for(int i = 0; i < 8; i++)
+      m[i] = -i;
+    VERIFY( m.size() == 8 );
+    VERIFY( cells.TotalAllocates == 12 );
+    VERIFY( cells.AllocateMisses == 8 );
+  }
+  VERIFY( cells.TotalFrees == 12 );
+  VERIFY( cells.FreeMisses == 0 );
+}
+
+// the arrays and the objects larger than the cell come from the backing heap and are not counted
+template<> template<> void tut::to::test<03>(void)
+{
+  struct big { char data[cell_size * 2]; };
+  lookaside cells(cell_size, ntl::nt::process_heap(), depth);
+  std::ext::lookaside_allocator<int, lookaside> ints(cells);
+  int* const array = ints.allocate(100);
+  VERIFY( array != 0 );
+  ints.deallocate(array, 100);
+
+  std::ext::lookaside_allocator<big, lookaside> bigs(ints);
+  big* const b = bigs.allocate(1);
+  VERIFY( b != 0 );
+  bigs.deallocate(b, 1);
+
+  VERIFY( cells.TotalAllocates == 0 );
+  VERIFY( cells.TotalFrees == 0 );
+  VERIFY( ints == bigs );
+}
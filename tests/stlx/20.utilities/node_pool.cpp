@@ -0,0 +1,128 @@
+// std::ext::node_pool and pool_allocator
+
+#include <ntl-tests-common.hxx>
+#include <list>
+#include <map>
+#include <vector>
+#include <cstring>
+#include <stlx/ext/allocators.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::ext::node_pool");
+
+namespace
+{
+  typedef std::ext::node_pool node_pool;
+
+  struct block
+  {
+    unsigned char* p;
+    size_t size;
+  };
+
+  // fills every block by its own byte, returns false if the blocks overlap or are misaligned
+  bool fill_and_check(std::vector<block>& v)
+  {
+    for(size_t i = 0; i < v.size(); i++){
+      if(reinterpret_cast<uintptr_t>(v[i].p) % node_pool::granularity)
+        return false;
+      std::memset(v[i].p, static_cast<int>(i & 0xFF), v[i].size);
+    }
+    for(size_t i = 0; i < v.size(); i++)
+      for(size_t k = 0; k < v[i].size; k++)
+        if(v[i].p[k] != static_cast<unsigned char>(i & 0xFF))
+          return false;
+    return true;
+  }
+
+  struct less_than_500
+  {
+    bool operator()(int x) const { return x < 500; }
+  };
+
+  // every size of the small blocks and a few of the large ones
+  bool exercise(node_pool& pool)
+  {
+    std::vector<block> v;
+    for(int round = 0; round < 3; round++){
+      for(size_t size = 0; size <= node_pool::max_block_size + 20; size += round + 1){
+        const block b = { static_cast<unsigned char*>(pool.allocate(size)), size };
+        if(!b.p)
+          return false;
+        v.push_back(b);
+      }
+    }
+    if(!fill_and_check(v))
+      return false;
+
+    // the freed blocks are reused by the same size class
+    const block first = v[1];
+    pool.deallocate(first.p, first.size);
+    if(pool.allocate(first.size) != first.p)
+      return false;
+    for(size_t i = 0; i < v.size(); i += 2)
+      pool.deallocate(v[i].p, v[i].size);
+    for(size_t i = 0; i < v.size(); i += 2)
+      v[i].p = static_cast<unsigned char*>(pool.allocate(v[i].size));
+    return fill_and_check(v);
+  }
+}
+
+// the chunk smaller than the largest block (or none at all) is enlarged
+template<> template<> void tut::to::test<01>(void)
+{
+  const size_t sizes[] = { 0, 1, sizeof(void*) - 1, sizeof(void*), node_pool::granularity + 3, node_pool::max_block_size - 1,
+    node_pool::max_block_size, node_pool::max_block_size + 1, node_pool::default_chunk_size };
+  for(size_t i = 0; i < _countof(sizes); i++){
+    node_pool pool(sizes[i]);
+    VERIFY( exercise(pool) );
+    pool.release();
+    VERIFY( exercise(pool) );
+  }
+  node_pool pool;
+  VERIFY( exercise(pool) );
+}
+
+// the largest block fits the enlarged chunk exactly, one block per chunk
+template<> template<> void tut::to::test<02>(void)
+{
+  node_pool pool(0);
+  std::vector<block> v;
+  for(int i = 0; i < 10; i++){
+    const block b = { static_cast<unsigned char*>(pool.allocate(node_pool::max_block_size)), node_pool::max_block_size };
+    v.push_back(b);
+  }
+  VERIFY( fill_and_check(v) );
+
+  // the smaller blocks share the chunk
+  node_pool small(node_pool::max_block_size);
+  unsigned char* const a = static_cast<unsigned char*>(small.allocate(node_pool::granularity));
+  unsigned char* const b = static_cast<unsigned char*>(small.allocate(node_pool::granularity));
+  VERIFY( b == a + node_pool::granularity );
+}
+
+// the containers over the pool
+template<> template<> void tut::to::test<03>(void)
+{
+  typedef std::ext::pool_allocator<int> int_allocator;
+  typedef std::ext::pool_allocator<std::pair<const int, int> > pair_allocator;
+  const size_t chunks[] = { 0, 1, node_pool::default_chunk_size };
+  for(size_t n = 0; n < _countof(chunks); n++){
+    node_pool pool(chunks[n]);
+    std::list<int, int_allocator> l((int_allocator(pool)));
+    const std::less<int> less;
+    std::map<int, int, std::less<int>, pair_allocator> m(less, pair_allocator(pool));
+    for(int i = 0; i < 1000; i++){
+      l.push_back(i);
+      m[i * 7 % 1000] = i;
+    }
+    for(int i = 0; i < 1000; i += 2)
+      m.erase(i);
+    l.remove_if(less_than_500());
+    VERIFY( l.size() == 500 && l.front() == 500 && l.back() == 999 );
+    VERIFY( m.size() == 500 && m.begin()->first == 1 );
+    int sum = 0;
+    for(std::list<int, int_allocator>::const_iterator i = l.begin(); i != l.end(); ++i)
+      sum += *i;
+    VERIFY( sum == (500 + 999) * 250 );
+  }
+}
@@ -0,0 +1,82 @@
+// ntl::fmt type-safe format strings
+
+#include <ntl-tests-common.hxx>
+#include <string>
+#include <format.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("ntl::fmt::format");
+
+using namespace ntl;
+
+// the fixed notation with the precision above 17: the leading zeros of the fraction don't count
+template<> template<> void tut::to::test<01>(void)
+{
+  VERIFY( fmt::format("{:.20f}", 1e-5) == "0.00001000000000000000" );
+  VERIFY( fmt::format("{:.20f}", 1.2345678901234567e-5) == "0.00001234567890123457" );
+  VERIFY( fmt::format("{:.25f}", 1.2345678901234567e-5) == "0.0000123456789012345680000" );
+  VERIFY( fmt::format("{:.30f}", 1.2345678901234567e-10) == "0.000000000123456789012345680000" );
+  VERIFY( fmt::format("{:.18f}", 0.1) == "0.100000000000000010" );
+
+  // the digits available at the precision are less than 17
+  VERIFY( fmt::format("{:.20f}", 6e-21) == "0.00000000000000000001" );
+  VERIFY( fmt::format("{:.20f}", 4e-21) == "0.00000000000000000000" );
+  VERIFY( fmt::format("{:.20f}", 9.99999999999e-10) == "0.00000000100000000000" );
+  VERIFY( fmt::format("{:.25f}", 0.999999999999999999e-20) == "0.0000000000000000000100000" );
+
+  // the integer part: the 17 digits after the point
+  VERIFY( fmt::format("{:.17f}", 1.1) == "1.10000000000000009" );
+  VERIFY( fmt::format("{:.20f}", 1.5) == "1.50000000000000000000" );
+  VERIFY( fmt::format("{:.20f}", 0.0) == "0.00000000000000000000" );
+}
+
+// the general notation with the negative exponents and the exponent notation of the small and large values
+template<> template<> void tut::to::test<02>(void)
+{
+  VERIFY( fmt::format("{:.17g}", 1.2345678901234567e-4) == "0.00012345678901234567" );
+  VERIFY( fmt::format("{:.17g}", 0.1) == "0.10000000000000001" );
+  VERIFY( fmt::format("{:.17g}", 1.2345678901234567e-5) == "1.2345678901234568e-05" );
+  VERIFY( fmt::format("{:.17g}", 1.8170836718002717e-59) == "1.8170836718002717e-59" );
+  VERIFY( fmt::format("{:g}", 1e-4) == "0.0001" );
+  VERIFY( fmt::format("{:g}", 0.000123456789) == "0.000123457" );
+  VERIFY( fmt::format("{:#.3g}", 1e-4) == "0.000100" );
+  VERIFY( fmt::format("{:G}", 1e-5) == "1E-05" );
+  VERIFY( fmt::format("{}", 1e-5) == "1e-05" );
+
+  VERIFY( fmt::format("{:.16e}", 7.1219327774906902e-14) == "7.1219327774906902e-14" );
+  VERIFY( fmt::format("{:.12e}", 2.2353362240815001e+273) == "2.235336224082e+273" );
+  VERIFY( fmt::format("{:.12e}", 4.4356369050644998e-73) == "4.435636905064e-73" );
+  VERIFY( fmt::format("{:e}", 4.9406564584124654e-324) == "4.940656e-324" );
+  VERIFY( fmt::format("{:.16e}", 1.7976931348623157e308) == "1.7976931348623157e+308" );
+}
+
+// the width, fill and alignment
+template<> template<> void tut::to::test<03>(void)
+{
+  VERIFY( fmt::format("[{:6}][{:<6}][{:^6}][{:>6}]", 42, 42, 42, 42) == "[    42][42    ][  42  ][    42]" );
+  VERIFY( fmt::format("[{:6}][{:>6}][{:^7}]", "ab", "ab", "ab") == "[ab    ][    ab][  ab   ]" );
+  VERIFY( fmt::format("[{:*^7}][{:-<5}][{:0>4}]", 42, 'x', 7) == "[**42***][x----][0007]" );
+  VERIFY( fmt::format("[{:06}][{:+06}][{:#06x}]", -42, 42, 255) == "[-00042][+00042][0x00ff]" );
+  VERIFY( fmt::format("[{:8.2f}][{:<8.2f}][{:=^9.1e}]", -2.5, 2.5, 1500.0) == "[   -2.50][2.50    ][=1.5e+03=]" );
+  VERIFY( fmt::format("[{:08.3f}][{:>8}]", -3.14159, 1e-5) == "[-003.142][   1e-05]" );
+  VERIFY( fmt::format("[{:3}][{:.2}][{:>5.3}]", "abcdef", "abcdef", "abcdef") == "[abcdef][ab][  abc]" );
+  VERIFY( fmt::format("[{:2}]", 12345) == "[12345]" );
+
+  const std::wstring w = fmt::format(L"[{:>5}][{:*<4}]", L"ab", 7);
+  VERIFY( w == L"[   ab][7***]" );
+}
+
+// the plain string replaces the type spec not suitable for the argument by its default;
+// NTL_FMT rejects it at compile time
+template<> template<> void tut::to::test<04>(void)
+{
+  VERIFY( fmt::format("{:d}|{:f}|{:s}|{:x}", "abc", 5, 2.5, 1.5) == "abc|5|2.5|1.5" );
+  VERIFY( fmt::format("{:s}|{:e}|{:d}|{:p}", true, 'x', 0.5, 7) == "true|x|0.5|7" );
+  VERIFY( fmt::format("{:c}{:d}|{:x}", 65, 'A', true) == "A65|1" );
+
+  // the invalid fields and the fields without the arguments are written literally
+  VERIFY( fmt::format("{:q} {", 1) == "{:q} {" );
+  VERIFY( fmt::format("{} {}", "a") == "a {}" );
+  VERIFY( fmt::format("x", 1, 2) == "x" );
+
+  VERIFY( fmt::format(NTL_FMT("{:d}|{:.1f}|{:s}"), 5, 2.5, "abc") == "5|2.5|abc" );
+}
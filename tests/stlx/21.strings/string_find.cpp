@@ -21,6 +21,7 @@
 
 #include <ntl-tests-common.hxx>
 #include <string>
+#include <stlx/ext/string_search.hxx>
 
 STLX_DEFAULT_TESTGROUP_NAME("std::string#find");
 
@@ -352,3 +353,217 @@ template<> template<> void tut::to::test<07>()
 
 }
 
+namespace
+{
+  // the plain loops the fast searches are checked against
+  template<class String>
+  typename String::size_type naive_find(const String& hay, const String& needle, typename String::size_type pos = 0)
+  {
+    for(typename String::size_type j = pos; j + needle.size() <= hay.size(); j++)
+      if(hay.compare(j, needle.size(), needle) == 0)
+        return j;
+    return String::npos;
+  }
+
+  template<class String>
+  typename String::size_type naive_first_of(const String& s, const String& set, bool of)
+  {
+    for(typename String::size_type i = 0; i < s.size(); i++)
+      if((set.find(s[i]) != String::npos) == of)
+        return i;
+    return String::npos;
+  }
+
+  template<class String>
+  typename String::size_type naive_last_of(const String& s, const String& set, bool of)
+  {
+    for(typename String::size_type i = s.size(); i--; )
+      if((set.find(s[i]) != String::npos) == of)
+        return i;
+    return String::npos;
+  }
+
+  // the strings of the few letters have the many partial matches
+  struct random_text
+  {
+    unsigned seed;
+    explicit random_text(unsigned seed) : seed(seed) {}
+
+    unsigned next(unsigned n)
+    {
+      seed = seed * 1103515245 + 12345;
+      return (seed >> 16) % n;
+    }
+
+    template<class String>
+    String make(size_t n, unsigned letters)
+    {
+      String s(n, 'a');
+      for(size_t i = 0; i < n; i++)
+        s[i] = static_cast<typename String::value_type>('a' + next(letters));
+      return s;
+    }
+  };
+
+  template<class String>
+  String repeat(const char* s, size_t times)
+  {
+    String r;
+    for(const std::string part(s); times; --times)
+      r.append(part.begin(), part.end());
+    return r;
+  }
+}
+
+// the repetitive needles turn the search to the two-way algorithm
+template<> template<> void tut::to::test<8>()
+{
+  // periodic needle: "abc" repeated, the haystack breaks the period every 48 characters
+  const std::string periodic = repeat<std::string>("abc", 20) + "ab";
+  std::string hay = repeat<std::string>("abcabcabcabcabcabcabcabcabcabcabcabcabcabcabcabd", 50);
+  VERIFY( hay.find(periodic) == std::string::npos );
+  hay += repeat<std::string>("abc", 21);
+  VERIFY( hay.find(periodic) == 50 * 48 );
+  VERIFY( hay.find(periodic) == naive_find(hay, periodic) );
+
+  // not periodic: every position passes the first and the last character filter
+  std::string needle(50, 'a');
+  needle[25] = 'b';
+  std::string as(4000, 'a');
+  VERIFY( as.find(needle) == std::string::npos );
+  as[3025] = 'b';
+  VERIFY( as.find(needle) == 3000 );
+  VERIFY( as.find(needle, 3001) == std::string::npos );
+
+  // the long needles over two letters
+  random_text text(1);
+  for(int i = 0; i < 20; i++){
+    const std::string n = text.make<std::string>(200 + text.next(800), 2);
+    const std::string h = text.make<std::string>(20000, 2) + n + text.make<std::string>(100, 2);
+    VERIFY( h.find(n) == naive_find(h, n) );
+    VERIFY( h.find(n, 100) == naive_find(h, n, 100) );
+  }
+
+  // two_way() alone, the short needles of the small alphabets give all kinds of the periods
+  typedef std::char_traits<char> traits;
+  for(int i = 0; i < 3000; i++){
+    const unsigned letters = 1 + text.next(3);
+    const std::string h = text.make<std::string>(text.next(100), letters), n = text.make<std::string>(1 + text.next(12), letters);
+    if(n.size() > h.size())
+      continue;
+    const char* const r = std::ext::strsearch::two_way<traits>(h.data(), h.size(), n.data(), n.size());
+    VERIFY( (r ? static_cast<std::string::size_type>(r - h.data()) : std::string::npos) == naive_find(h, n) );
+  }
+}
+
+// the word at a time loops: the match at every position, every length and start modulo the word size
+template<> template<> void tut::to::test<9>()
+{
+  const size_t word = sizeof(size_t), npos = std::string::npos;
+  for(size_t len = 0; len < 4 * word; len++){
+    for(size_t pos = 0; pos < len; pos++){
+      std::string s(len, 'x');
+      s[pos] = 'y';
+      std::wstring w(len, L'x');
+      w[pos] = L'y';
+      for(size_t from = 0; from < word && from <= len; from++){
+        const size_t expected = pos >= from ? pos : npos;
+        VERIFY( s.find('y', from) == expected );
+        VERIFY( w.find(L'y', from) == expected );
+        VERIFY( s.find_first_of("yz", from) == expected );
+        VERIFY( s.find_first_of("zyvw", from) == expected );
+        VERIFY( w.find_first_of(L"zy", from) == expected );
+      }
+
+      // the two character needle with the decoys of its first and last character around
+      if(pos + 1 < len){
+        std::string t(len, 'x');
+        for(size_t i = 0; i < len; i++)
+          t[i] = i % 3 ? 'y' : 'x';
+        t[pos] = 'a';
+        t[pos + 1] = 'b';
+        VERIFY( t.find("ab") == pos );
+        VERIFY( t.find("ab", pos + 1) == npos );
+        if(pos + 2 < len){
+          t[pos + 2] = 'c';
+          VERIFY( t.find("abc") == pos );
+        }
+      }
+    }
+    // no match and the match in the lane right after the equal one
+    const std::string none(len, 'x');
+    VERIFY( none.find('y') == npos );
+    VERIFY( none.find("xy") == npos );
+    std::string runs(len, '\x01');
+    if(len){
+      runs[len - 1] = '\0';
+      VERIFY( runs.find('\0') == len - 1 );
+      VERIFY( runs.find(std::string(1, '\0')) == len - 1 );
+    }
+  }
+}
+
+// find_first_not_of and find_last_not_of test the bitmap, the high bytes included
+template<> template<> void tut::to::test<10>()
+{
+  const char set_chars[] = { 'a', 'b', '\0', '\x80', '\xff', 'z' };
+  const std::string set(set_chars, sizeof(set_chars));
+  random_text text(2);
+  for(int i = 0; i < 500; i++){
+    std::string s(text.next(40), 'a');
+    for(size_t k = 0; k < s.size(); k++){
+      const unsigned c = text.next(8);
+      s[k] = c < sizeof(set_chars) ? set_chars[c] : static_cast<char>('c' + c);
+    }
+    for(size_t n = 2; n <= set.size(); n++){
+      const std::string part = set.substr(0, n);
+      VERIFY( s.find_first_not_of(part) == naive_first_of(s, part, false) );
+      VERIFY( s.find_last_not_of(part) == naive_last_of(s, part, false) );
+      VERIFY( s.find_first_of(part) == naive_first_of(s, part, true) );
+      VERIFY( s.find_last_of(part) == naive_last_of(s, part, true) );
+    }
+  }
+
+  VERIFY( set.find_first_not_of(set) == std::string::npos );
+  VERIFY( set.find_last_not_of(set) == std::string::npos );
+  VERIFY( (set + 'q').find_last_not_of(set) == set.size() );
+  VERIFY( ('q' + set).find_first_not_of(set, 1) == std::string::npos );
+  VERIFY( std::string("\x7f\x80").find_first_not_of("\xff\x7f") == 1 );
+}
+
+// the wide characters: the lanes of wchar_t and the sets which do not fit the bitmap
+template<> template<> void tut::to::test<11>()
+{
+  const std::wstring::size_type npos = std::wstring::npos;
+  const std::wstring w = L"ab\x0416\x0436" L"cd\x00ff\x0100";
+  VERIFY( w.find(L'\x0436') == 3 );
+  VERIFY( w.find(L'\x0100') == 7 );
+  VERIFY( w.find(L'\x0116') == npos );
+  VERIFY( w.find(L"\x0436" L"cd") == 3 );
+  VERIFY( w.rfind(L'a') == 0 );
+  VERIFY( w.find_first_of(L"\x0100\x00ff") == 6 );
+  VERIFY( w.find_first_of(L"\x0436\x0416z") == 2 );
+  VERIFY( w.find_last_of(L"\x0416\x0416") == 2 );
+  VERIFY( w.find_first_not_of(L"ab\x0416") == 3 );
+  VERIFY( w.find_last_not_of(L"\x0100\x00ff") == 5 );
+  VERIFY( w.find_first_not_of(w) == npos );
+  VERIFY( w.find_last_not_of(L"abcd\x00ff") == 7 );
+
+  // the code units differing in the high byte only
+  std::wstring hi(40, L'\x0161');
+  hi[33] = L'\x0061';
+  VERIFY( hi.find(L'a') == 33 );
+  VERIFY( hi.find_first_not_of(L'\x0161') == 33 );
+  VERIFY( hi.find_last_not_of(L"\x0161\x0162") == 33 );
+
+  // the two-way search over the wide characters
+  random_text text(3);
+  for(int i = 0; i < 20; i++){
+    const std::wstring n = text.make<std::wstring>(100 + text.next(100), 2);
+    const std::wstring h = text.make<std::wstring>(5000, 2) + n;
+    VERIFY( h.find(n) == naive_find(h, n) );
+  }
+  const std::wstring periodic = repeat<std::wstring>("ab", 30);
+  const std::wstring hay = repeat<std::wstring>("abababababababababac", 30) + periodic;
+  VERIFY( hay.find(periodic) == 600 );
+}
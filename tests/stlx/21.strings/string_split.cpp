@@ -0,0 +1,170 @@
+// [N3593] std::split and [N3594] std::join
+
+#include <ntl-tests-common.hxx>
+#include <string>
+#include <vector>
+#include <list>
+#include <stlx/ext/split.hxx>
+#include <stlx/ext/join.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::split");
+
+namespace
+{
+  // the pieces in the brackets: "[a][][b]"
+  template<class Splitter>
+  std::string pieces(const Splitter& s)
+  {
+    std::string r;
+    for(typename Splitter::const_iterator i = s.begin(); i != s.end(); ++i)
+      r.append(1, '[').append(i->data(), i->length()).append(1, ']');
+    return r;
+  }
+
+  struct reject_all
+  {
+    bool operator()(const std::string_ref&) const { return false; }
+  };
+}
+
+// the edges: the empty text and delimiter, the delimiter at the start and at the end
+template<> template<> void tut::to::test<01>(void)
+{
+  VERIFY( pieces(std::split("a,b,c", ",")) == "[a][b][c]" );
+  VERIFY( pieces(std::split("abc", ",")) == "[abc]" );
+  VERIFY( pieces(std::split("", ",")) == "" );
+
+  // the empty delimiter splits to the characters
+  VERIFY( pieces(std::split("abc", "")) == "[a][b][c]" );
+  VERIFY( pieces(std::split("a", "")) == "[a]" );
+
+  VERIFY( pieces(std::split(",a", ",")) == "[][a]" );
+  VERIFY( pieces(std::split("a,", ",")) == "[a][]" );
+  VERIFY( pieces(std::split(",a,", ",")) == "[][a][]" );
+  VERIFY( pieces(std::split("a,,b", ",")) == "[a][][b]" );
+
+  // the text of the delimiters only
+  VERIFY( pieces(std::split(",", ",")) == "[][]" );
+  VERIFY( pieces(std::split(",,", ",")) == "[][][]" );
+  VERIFY( pieces(std::split("::", "::")) == "[][]" );
+
+  VERIFY( pieces(std::split("a::b::", "::")) == "[a][b][]" );
+  VERIFY( pieces(std::split("a:b", "::")) == "[a:b]" );
+}
+
+// the pieces refer to the text, the filters
+template<> template<> void tut::to::test<02>(void)
+{
+  const std::string text = ",a,,bc,";
+  const std::splitter<std::literal> s = std::split(text, ",");
+  std::splitter<std::literal>::const_iterator i = s.begin();
+  VERIFY( i->empty() && i->data() == text.data() );
+  ++i;
+  VERIFY( i->length() == 1 && i->data() == text.data() + 1 );
+  std::splitter<std::literal>::const_iterator j = i++;
+  VERIFY( j != i && *j->data() == 'a' && i->empty() );
+
+  VERIFY( pieces(std::split(text, ",", std::skip_empty())) == "[a][bc]" );
+  VERIFY( pieces(std::split(",,,", ",", std::skip_empty())) == "" );
+
+  // the filter which rejects everything gives the empty range
+  const std::splitter<std::literal, reject_all> none = std::split("a,b,c", ",", reject_all());
+  VERIFY( none.begin() == none.end() );
+
+  // the conversion to the container copies the pieces
+  const std::vector<std::string> v = std::split("x;yy;;zzz", ";");
+  VERIFY( v.size() == 4 && v[0] == "x" && v[1] == "yy" && v[2].empty() && v[3] == "zzz" );
+}
+
+// split_any: the sets of up to 4 characters are tested by the word, the larger ones by the bitmap
+template<> template<> void tut::to::test<03>(void)
+{
+  const std::string text = "a,b;c d\te|f";
+  VERIFY( pieces(std::split(text, std::split_any(","))) == "[a][b;c d\te|f]" );
+  VERIFY( pieces(std::split(text, std::split_any(",;"))) == "[a][b][c d\te|f]" );
+  VERIFY( pieces(std::split(text, std::split_any(",; "))) == "[a][b][c][d\te|f]" );
+  VERIFY( pieces(std::split(text, std::split_any(",; \t"))) == "[a][b][c][d][e|f]" );
+  VERIFY( pieces(std::split(text, std::split_any(",; \t|"))) == "[a][b][c][d][e][f]" );
+  VERIFY( pieces(std::split(text, std::split_any("|\t ;,\xff"))) == "[a][b][c][d][e][f]" );
+  VERIFY( pieces(std::split(text, std::split_any("xyz"))) == "[a,b;c d\te|f]" );
+  VERIFY( pieces(std::split(",;", std::split_any(",;"))) == "[][][]" );
+
+  // the delimiter at every position of the word
+  const char* const sets[] = { ",", ",;", ",;|", ",;|\t", ",;|\t " };
+  for(size_t n = 0; n < _countof(sets); n++){
+    for(size_t pos = 0; pos < 40; pos++){
+      std::string s(40, 'x');
+      s[pos] = sets[n][n];
+      const std::vector<std::string> v = std::split(s, std::split_any(sets[n]));
+      VERIFY( v.size() == 2 && v[0].size() == pos && v[1].size() == 39 - pos );
+    }
+  }
+}
+
+// sjoin reserves the exact length of the strings once
+template<> template<> void tut::to::test<04>(void)
+{
+  std::vector<std::string> v;
+  v.push_back("alpha");
+  v.push_back("");
+  v.push_back("gamma delta");
+  v.push_back("epsilon");
+
+  const std::string s = std::sjoin(v.begin(), v.end(), ", ", std::join_formatter());
+  VERIFY( s == "alpha, , gamma delta, epsilon" );
+  std::string reserved;
+  reserved.reserve(s.size());
+  VERIFY( s.capacity() == reserved.capacity() );
+
+  const std::string j = std::join(v, "--");
+  VERIFY( j == "alpha----gamma delta--epsilon" );
+  reserved = std::string();
+  reserved.reserve(j.size());
+  VERIFY( j.capacity() == reserved.capacity() );
+
+  std::list<std::string> l(v.begin(), v.end());
+  VERIFY( std::join(l, "") == "alphagamma deltaepsilon" );
+
+  // the empty and the single element ranges have no separator
+  VERIFY( std::sjoin(v.begin(), v.begin(), ", ").empty() );
+  VERIFY( std::sjoin(v.begin(), v.begin() + 1, ", ") == "alpha" );
+
+  // the split pieces are joined back
+  VERIFY( std::join(std::split(",a,,b,", ","), ";") == ";a;;b;" );
+}
+
+// the default formatter overload and the stream fallback
+template<> template<> void tut::to::test<05>(void)
+{
+  std::vector<int> n;
+  for(int i = 1; i <= 3; i++)
+    n.push_back(i * 11);
+
+  VERIFY( std::sjoin(n.begin(), n.end(), ",") == "11,22,33" );
+  VERIFY( std::sjoin(n, " + ", std::number_formatter()) == "11 + 22 + 33" );
+  VERIFY( std::join(n, "/") == "11/22/33" );
+
+  std::vector<char> c;
+  c.push_back('x');
+  c.push_back('y');
+  VERIFY( std::sjoin(c.begin(), c.end(), "") == "xy" );
+
+  const char* const words[] = { "one", "two" };
+  VERIFY( std::sjoin(words, words + 2, " ") == "one two" );
+}
+
+// the pieces refer to the text variable, the container keeps the copies
+template<> template<> void tut::to::test<06>(void)
+{
+  std::string text = "k1=v1;k2=v2";
+  const std::string delim = ";", any = "=;";
+  const std::splitter<std::literal> s = std::split(text, std::literal(delim));
+  std::splitter<std::literal>::const_iterator i = s.begin();
+  VERIFY( i->data() == text.data() && (++i)->data() == text.data() + 6 );
+
+  std::vector<std::string> copies = std::split(text, std::split_any(any));
+  std::fill(text.begin(), text.end(), 'x');
+  VERIFY( copies.size() == 4 && copies[0] == "k1" && copies[3] == "v2" );
+  // the splitter sees the changed text, the copies are unchanged
+  VERIFY( pieces(s) == "[xxxxxxxxxxx]" && copies[1] == "v1" );
+}
@@ -0,0 +1,307 @@
+// vector growth: the block expanded in place, the elements relocated by memcpy and the rollback on exceptions
+
+#include <ntl-tests-common.hxx>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <nt/heap_allocator.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::vector#relocation");
+
+namespace
+{
+  /** The blocks have the room for \c limit elements, expand() grows them up to it */
+  template<class T>
+  struct expanding_allocator:
+    std::allocator<T>
+  {
+    typedef typename std::allocator<T>::size_type size_type;
+    typedef typename std::allocator<T>::pointer   pointer;
+    template<class U> struct rebind { typedef expanding_allocator<U> other; };
+
+    static size_t limit, allocations, expansions, failures;
+    // the next allocation throws
+    static bool fail;
+
+    expanding_allocator() {}
+    template<class U> expanding_allocator(const expanding_allocator<U>&) {}
+
+    pointer allocate(size_type n, std::allocator<void>::const_pointer = 0)
+    {
+      if(fail){
+        fail = false;
+        __ntl_throw(std::bad_alloc());
+      }
+      allocations++;
+      return std::allocator<T>::allocate(n > limit ? n : limit);
+    }
+
+    void deallocate(pointer p, size_type n)
+    {
+      std::allocator<T>::deallocate(p, n > limit ? n : limit);
+    }
+
+    bool expand(pointer, size_type, size_type new_n)
+    {
+      if(new_n > limit){
+        failures++;
+        return false;
+      }
+      expansions++;
+      return true;
+    }
+
+    static void reset(size_t new_limit)
+    {
+      limit = new_limit;
+      allocations = expansions = failures = 0;
+      fail = false;
+    }
+  };
+
+  template<class T> size_t expanding_allocator<T>::limit = 0;
+  template<class T> size_t expanding_allocator<T>::allocations = 0;
+  template<class T> size_t expanding_allocator<T>::expansions = 0;
+  template<class T> size_t expanding_allocator<T>::failures = 0;
+  template<class T> bool expanding_allocator<T>::fail = false;
+
+  // counts the live objects, throws on the copy number \c fail
+  struct fragile
+  {
+    static int live, copies, fail;
+    int value;
+
+    fragile(int v = 0): value(v) { live++; }
+    fragile(const fragile& x): value(x.value)
+    {
+      if(++copies == fail)
+        __ntl_throw(std::runtime_error("fragile"));
+      live++;
+    }
+    ~fragile() { live--; }
+    fragile& operator=(const fragile& x) { value = x.value; return *this; }
+  };
+  int fragile::live = 0, fragile::copies = 0, fragile::fail = 0;
+
+  struct point { int x, y; };
+
+  template<class V>
+  bool ascending(const V& v, int from = 0)
+  {
+    for(size_t i = 0; i < v.size(); i++)
+      if(v[i] != static_cast<int>(i) + from)
+        return false;
+    return true;
+  }
+
+  template<class V>
+  bool values(const V& v, const int* expected, size_t n)
+  {
+    if(v.size() != n)
+      return false;
+    for(size_t i = 0; i < n; i++)
+      if(v[i].value != expected[i])
+        return false;
+    return true;
+  }
+}
+
+// the allocator which can grow the block keeps the elements in place until the block is full
+template<> template<> void tut::to::test<01>(void)
+{
+  typedef expanding_allocator<int> alloc;
+  alloc::reset(2000);
+  std::vector<int, alloc> v;
+  v.push_back(0);
+  const int* const block = v.data();
+  for(int i = 1; i < 500; i++)
+    v.push_back(i);
+  VERIFY( v.data() == block && ascending(v) );
+  VERIFY( alloc::allocations == 1 && alloc::expansions > 0 && alloc::failures == 0 );
+
+  // the insert into the middle shifts the tail within the expanded block
+  const size_t expansions = alloc::expansions;
+  v.insert(v.begin() + 10, 300, -1);
+  VERIFY( v.data() == block && alloc::allocations == 1 && alloc::expansions > expansions );
+  VERIFY( v.size() == 800 && v[9] == 9 && v[10] == -1 && v[309] == -1 && v[310] == 10 && v[799] == 499 );
+  v.erase(v.begin() + 10, v.begin() + 310);
+  VERIFY( ascending(v) );
+
+  // the block is full: the expand() fails and the elements are moved to the new block
+  v.reserve(2001);
+  VERIFY( v.data() != block && alloc::allocations == 2 && alloc::failures == 1 );
+  VERIFY( v.capacity() >= 2001 && ascending(v) );
+
+  // the empty vector has nothing to expand
+  alloc::reset(1000);
+  std::vector<int, alloc> e;
+  e.reserve(10);
+  VERIFY( alloc::allocations == 1 && alloc::expansions == 0 && alloc::failures == 0 );
+}
+
+// the trivially relocatable elements are moved by memcpy: the nested vectors keep their blocks
+template<> template<> void tut::to::test<02>(void)
+{
+  VERIFY( (std::__::is_trivially_relocatable<int>::value) );
+  VERIFY( (std::__::is_trivially_relocatable<point>::value) );
+  VERIFY( (std::__::is_trivially_relocatable<std::vector<int> >::value) );
+  VERIFY( !(std::__::is_trivially_relocatable<fragile>::value) );
+
+  std::vector<std::vector<int> > vv;
+  std::vector<const int*> blocks;
+  for(int i = 0; i < 100; i++){
+    vv.push_back(std::vector<int>(10, i));
+    blocks.push_back(vv.back().data());
+  }
+  // the insert with the reallocation leaves the gap between the moved parts
+  vv.insert(vv.begin() + 50, vv.capacity() - vv.size() + 1, std::vector<int>(1, -1));
+  bool same = true;
+  for(int i = 0; i < 100; i++){
+    const std::vector<int>& v = vv[i < 50 ? i : i + (vv.size() - 100)];
+    same &= v.data() == blocks[i] && v.size() == 10 && v[9] == i;
+  }
+  VERIFY( same );
+  VERIFY( vv[50].size() == 1 && vv[50][0] == -1 && vv[vv.size() - 51].size() == 1 );
+
+  std::vector<point> pv;
+  for(int i = 0; i < 1000; i++){
+    const point p = { i, -i };
+    pv.insert(pv.begin() + pv.size() / 2, p);
+  }
+  int sum = 0;
+  for(size_t i = 0; i < pv.size(); i++)
+    sum += pv[i].x + pv[i].y;
+  VERIFY( pv.size() == 1000 && sum == 0 && pv[0].x == 1 && pv[999].x == 0 );
+}
+
+// the other types are constructed and destroyed one by one, no object is lost or destroyed twice
+template<> template<> void tut::to::test<03>(void)
+{
+  fragile::fail = 0;
+  const int live = fragile::live;
+  {
+    std::vector<fragile> v;
+    for(int i = 0; i < 200; i++)
+      v.push_back(fragile(i));
+    v.insert(v.begin() + 100, 300, fragile(-1));
+    v.insert(v.begin(), fragile(-2));
+    VERIFY( v.size() == 501 && fragile::live == live + 501 );
+    VERIFY( v[0].value == -2 && v[1].value == 0 && v[101].value == -1 && v[401].value == 100 && v[500].value == 199 );
+  }
+  VERIFY( fragile::live == live );
+}
+
+// the element copy which throws while the vector grows leaves the vector unchanged
+template<> template<> void tut::to::test<04>(void)
+{
+  const int live = fragile::live;
+  {
+    std::vector<fragile> v;
+    v.reserve(8);
+    for(int i = 0; i < 8; i++)
+      v.push_back(fragile(i));
+    const int expected[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    const fragile* const block = v.data();
+    const size_t capacity = v.capacity();
+    const fragile x(100);
+
+    // every copy of the relocation
+    for(int n = 1; n <= 8; n++){
+      fragile::copies = 0;
+      fragile::fail = n;
+      bool thrown = false;
+      __ntl_try{
+        v.push_back(x);
+      }
+      __ntl_catch(const std::runtime_error&){
+        thrown = true;
+      }
+      fragile::fail = 0;
+      VERIFY( thrown && v.data() == block && v.capacity() == capacity && values(v, expected, 8) );
+      VERIFY( fragile::live == live + 9 );
+    }
+
+    for(int n = 1; n <= 8; n++){
+      fragile::copies = 0;
+      fragile::fail = n;
+      bool thrown = false;
+      __ntl_try{
+        v.insert(v.begin() + 3, static_cast<size_t>(capacity), x);
+      }
+      __ntl_catch(const std::runtime_error&){
+        thrown = true;
+      }
+      fragile::fail = 0;
+      VERIFY( thrown && v.data() == block && v.capacity() == capacity && values(v, expected, 8) );
+      VERIFY( fragile::live == live + 9 );
+    }
+
+    // the copy of the new element itself comes after the relocation
+    fragile::copies = 0;
+    fragile::fail = 9;
+    bool thrown = false;
+    __ntl_try{
+      v.push_back(x);
+    }
+    __ntl_catch(const std::runtime_error&){
+      thrown = true;
+    }
+    fragile::fail = 0;
+    VERIFY( thrown && values(v, expected, 8) && fragile::live == live + 9 );
+
+    v.push_back(x);
+    VERIFY( v.size() == 9 && v[8].value == 100 && v[7].value == 7 );
+  }
+  VERIFY( fragile::live == live );
+
+  // the failed allocation keeps the capacity
+  typedef expanding_allocator<int> alloc;
+  alloc::reset(0);
+  std::vector<int, alloc> v;
+  for(int i = 0; i < 8; i++)
+    v.push_back(i);
+  const size_t capacity = v.capacity();
+  const int* const block = v.data();
+  const int x = 8;
+  for(int k = 0; k < 2; k++){
+    alloc::fail = true;
+    bool thrown = false;
+    __ntl_try{
+      if(k)
+        v.push_back(x);
+      else
+        v.insert(v.begin() + 1, x);
+    }
+    __ntl_catch(const std::bad_alloc&){
+      thrown = true;
+    }
+    VERIFY( thrown && v.data() == block && v.capacity() == capacity && v.size() == capacity );
+  }
+  v.push_back(100);
+  VERIFY( v.size() == capacity + 1 && v[7] == 7 && v.back() == 100 );
+}
+
+// nt::heap_allocator grows the block in place or fails quietly, even with heap::generate_exceptions
+template<> template<> void tut::to::test<05>(void)
+{
+  using namespace ntl::nt;
+  heap h(heap::growable);
+  heap_allocator<int> a(h, heap::generate_exceptions);
+  int* const p = a.allocate(16);
+  int* const q = a.allocate(16);
+  for(int i = 0; i < 16; i++)
+    p[i] = i;
+  VERIFY( a.expand(p, 16, 16) );
+  VERIFY( !a.expand(p, 16, 64 * 1024 * 1024) );
+  VERIFY( !a.expand(p, 16, a.max_size() + 1) );
+  VERIFY( p[0] == 0 && p[15] == 15 );
+  a.deallocate(q, 16);
+  a.deallocate(p, 16);
+
+  std::vector<int, heap_allocator<int> > v((heap_allocator<int>(h, heap::generate_exceptions)));
+  for(int i = 0; i < 10000; i++)
+    v.push_back(i);
+  v.insert(v.begin(), 100, -1);
+  v.erase(v.begin(), v.begin() + 100);
+  VERIFY( v.size() == 10000 && ascending(v) );
+}
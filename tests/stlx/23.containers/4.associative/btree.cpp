@@ -0,0 +1,252 @@
+// ntl::btree_map and ntl::btree_set
+
+#include <ntl-tests-common.hxx>
+#include <map>
+#include <set>
+#include <vector>
+#include <btree.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("ntl::btree_map");
+
+namespace
+{
+  // the small nodes: 10 keys in the leaf of the set, 4 keys in the inner node
+  typedef ntl::btree_set<int, std::less<int>, std::allocator<int>, 64> small_set;
+  typedef ntl::btree_map<int, int, std::less<int>, std::allocator<std::pair<const int, int> >, 64> small_map;
+  typedef ntl::btree_map<int, int> map_type;
+
+  unsigned next_random(unsigned& seed)
+  {
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+  }
+
+  // the elements in both directions and the lookup of every one
+  template<class Tree>
+  bool same(const Tree& t, const std::set<int>& ref)
+  {
+    if(t.size() != ref.size() || t.empty() != ref.empty())
+      return false;
+    typename Tree::const_iterator i = t.begin();
+    for(std::set<int>::const_iterator j = ref.begin(); j != ref.end(); ++i, ++j)
+      if(i == t.end() || *i != *j || t.find(*j) == t.end())
+        return false;
+    if(i != t.end())
+      return false;
+    std::set<int>::const_reverse_iterator rj = ref.rbegin();
+    for(typename Tree::const_reverse_iterator ri = t.rbegin(); ri != t.rend(); ++ri, ++rj)
+      if(*ri != *rj)
+        return false;
+    return true;
+  }
+
+  bool same(const map_type& t, const std::map<int, int>& ref)
+  {
+    if(t.size() != ref.size())
+      return false;
+    map_type::const_iterator i = t.begin();
+    for(std::map<int, int>::const_iterator j = ref.begin(); j != ref.end(); ++i, ++j)
+      if(i == t.end() || (*i).first != j->first || (*i).second != j->second)
+        return false;
+    return i == t.end();
+  }
+
+  // the number of the levels of the tree loaded by the sorted range of n keys
+  size_t bulk_height(size_t n, size_t leaf, size_t inner)
+  {
+    size_t nodes = (n + leaf - 1) / leaf, h = 1;
+    for(; nodes > 1; h++)
+      nodes = (nodes + inner) / (inner + 1);
+    return h;
+  }
+}
+
+// the leaf split and the root split
+template<> template<> void tut::to::test<01>(void)
+{
+  VERIFY( small_set::leaf_capacity == 10 && small_set::inner_capacity == 4 );
+
+  small_set s;
+  std::set<int> ref;
+  VERIFY( s.height() == 0 && s.memory_footprint() == 0 && s.begin() == s.end() );
+  s.insert(50);
+  ref.insert(50);
+  const size_t leaf = s.memory_footprint();
+  VERIFY( s.height() == 1 && leaf > 0 );
+
+  // the leaf is filled up and split by the next key
+  const int keys[] = { 10, 90, 30, 70, 20, 80, 40, 60, 0 };
+  for(size_t i = 0; i < _countof(keys); i++){
+    VERIFY( s.insert(keys[i]).second );
+    ref.insert(keys[i]);
+  }
+  VERIFY( s.size() == 10 && s.height() == 1 && s.memory_footprint() == leaf );
+  VERIFY( !s.insert(30).second && s.size() == 10 );
+  VERIFY( s.insert(55).second );
+  ref.insert(55);
+  VERIFY( s.height() == 2 && same(s, ref) );
+  const size_t inner = s.memory_footprint() - 2 * leaf;
+  VERIFY( inner > 0 );
+
+  // the root holding 4 keys is split on the way down by the next leaf split
+  unsigned seed = 1;
+  while(s.height() == 2){
+    const int k = static_cast<int>(next_random(seed) % 10000);
+    VERIFY( s.insert(k).second == ref.insert(k).second );
+  }
+  VERIFY( s.height() == 3 && same(s, ref) );
+  for(int i = 0; i < 2000; i++){
+    const int k = static_cast<int>(next_random(seed) % 10000);
+    VERIFY( s.insert(k).second == ref.insert(k).second );
+  }
+  VERIFY( s.height() >= 4 && same(s, ref) );
+  for(std::set<int>::const_iterator i = ref.begin(); i != ref.end(); ++i){
+    VERIFY( *s.lower_bound(*i) == *i && s.count(*i) == 1 );
+    VERIFY( s.upper_bound(*i) == ++s.find(*i) );
+  }
+  VERIFY( s.find(-1) == s.end() && s.lower_bound(10000) == s.end() );
+}
+
+// the erasure removes the emptied leaves and the inner nodes up to the root, down to the empty tree
+template<> template<> void tut::to::test<02>(void)
+{
+  for(int order = 0; order < 3; order++){
+    small_set s;
+    std::set<int> ref;
+    for(int i = 0; i < 1000; i++){
+      s.insert(i * 3);
+      ref.insert(i * 3);
+    }
+    const size_t height = s.height();
+    VERIFY( height >= 3 );
+
+    std::vector<int> keys(ref.begin(), ref.end());
+    if(order == 1){
+      for(size_t i = 0; i < keys.size() / 2; i++)
+        std::swap(keys[i], keys[keys.size() - 1 - i]);
+    }else if(order == 2){
+      unsigned seed = 7;
+      for(size_t i = keys.size() - 1; i > 0; i--)
+        std::swap(keys[i], keys[next_random(seed) % (i + 1)]);
+    }
+    for(size_t i = 0; i < keys.size(); i++){
+      VERIFY( s.erase(keys[i]) == 1 && s.erase(keys[i]) == 0 );
+      ref.erase(keys[i]);
+      VERIFY( s.height() <= height );
+      if(i % 97 == 0 || ref.size() < 30)
+        VERIFY( same(s, ref) );
+    }
+    VERIFY( s.empty() && s.height() == 0 && s.memory_footprint() == 0 );
+    VERIFY( s.begin() == s.end() );
+
+    // the emptied tree is used again
+    VERIFY( s.insert(5).second && s.size() == 1 && *s.begin() == 5 );
+  }
+
+  // the erasure by the iterators returns the next element
+  small_set s;
+  for(int i = 0; i < 100; i++)
+    s.insert(i);
+  small_set::iterator i = s.erase(s.find(10));
+  VERIFY( *i == 11 && s.size() == 99 );
+  i = s.erase(s.find(20), s.find(80));
+  VERIFY( *i == 80 && s.size() == 39 );
+  i = s.erase(s.begin(), s.end());
+  VERIFY( i == s.end() && s.empty() && s.height() == 0 );
+}
+
+// the sorted range is loaded into the empty tree with the full leaves
+template<> template<> void tut::to::test<03>(void)
+{
+  const size_t sizes[] = { 1, 10, 11, 50, 51, 55, 56, 1000, 12345 };
+  for(size_t n = 0; n < _countof(sizes); n++){
+    std::vector<int> keys;
+    std::set<int> ref;
+    for(size_t i = 0; i < sizes[n]; i++){
+      keys.push_back(static_cast<int>(i * 2));
+      ref.insert(static_cast<int>(i * 2));
+    }
+    const small_set s(keys.begin(), keys.end());
+    VERIFY( same(s, ref) );
+    VERIFY( s.height() == bulk_height(sizes[n], small_set::leaf_capacity, small_set::inner_capacity) );
+
+    // the tree built one by one from the shuffled keys takes more nodes
+    if(sizes[n] >= 100){
+      std::vector<int> shuffled(keys);
+      unsigned seed = 3;
+      for(size_t i = shuffled.size() - 1; i > 0; i--)
+        std::swap(shuffled[i], shuffled[next_random(seed) % (i + 1)]);
+      small_set r;
+      for(size_t i = 0; i < shuffled.size(); i++)
+        r.insert(shuffled[i]);
+      VERIFY( r == s && r.memory_footprint() > s.memory_footprint() );
+    }
+
+    // the loaded tree is modified as usual
+    small_set t(s);
+    VERIFY( t == s && t.memory_footprint() == s.memory_footprint() );
+    VERIFY( t.insert(1).second && t.erase(0) == 1 && t.size() == s.size() );
+    ref.insert(1);
+    ref.erase(0);
+    VERIFY( same(t, ref) );
+  }
+
+  // the unsorted range and the range with the duplicates are inserted one by one
+  const int unsorted[] = { 5, 3, 9, 3, 1 };
+  const small_set u(unsorted, unsorted + 5);
+  VERIFY( u.size() == 4 && *u.begin() == 1 );
+  small_set v;
+  v.insert(100);
+  const int sorted[] = { 1, 2, 3 };
+  v.insert(sorted, sorted + 3);
+  VERIFY( v.size() == 4 && *v.begin() == 1 && *--v.end() == 100 );
+
+  const std::pair<int, int> pairs[] = { std::make_pair(1, 10), std::make_pair(2, 20), std::make_pair(3, 30) };
+  const small_map m(pairs, pairs + 3);
+  VERIFY( m.size() == 3 && m.at(2) == 20 && (*m.begin()).second == 10 );
+}
+
+// the random insertion and erasure against std::map
+template<> template<> void tut::to::test<04>(void)
+{
+  map_type m;
+  std::map<int, int> ref;
+  unsigned seed = 11;
+  for(int round = 0; round < 20000; round++){
+    const int k = static_cast<int>(next_random(seed) % 3000);
+    switch(next_random(seed) % 4){
+    case 0:
+    case 1:
+      VERIFY( m.insert(std::make_pair(k, round)).second == ref.insert(std::make_pair(k, round)).second );
+      break;
+    case 2:
+      VERIFY( m.erase(k) == ref.erase(k) );
+      break;
+    default:
+      m[k] = -round;
+      ref[k] = -round;
+    }
+    if(round % 1000 == 0)
+      VERIFY( same(m, ref) );
+  }
+  VERIFY( same(m, ref) );
+
+  // the erasure of the ranges
+  while(!ref.empty()){
+    const int k = static_cast<int>(next_random(seed) % 3000);
+    map_type::iterator first = m.lower_bound(k), last = first;
+    std::map<int, int>::iterator rfirst = ref.lower_bound(k), rlast = rfirst;
+    for(int n = 0; n < 50 && last != m.end(); n++, ++last, ++rlast)
+      ;
+    const map_type::iterator next = m.erase(first, last);
+    VERIFY( next == m.lower_bound(k) );
+    ref.erase(rfirst, rlast);
+    if(ref.lower_bound(k) == ref.end() && !ref.empty()){
+      // wrap around to the smallest keys
+      m.erase(m.begin());
+      ref.erase(ref.begin());
+    }
+    VERIFY( same(m, ref) );
+  }
+  VERIFY( m.empty() && m.height() == 0 && m.memory_footprint() == 0 );
+}
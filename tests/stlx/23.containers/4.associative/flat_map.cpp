@@ -0,0 +1,214 @@
+// flat_map, flat_multimap, flat_set and flat_multiset
+
+#include <ntl-tests-common.hxx>
+#include <string>
+#include <vector>
+#include <stlx/flat_map.hxx>
+#include <stlx/flat_set.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::flat_map");
+
+namespace
+{
+  typedef std::flat_map<int, std::string> map_type;
+  typedef std::flat_set<int> set_type;
+
+  // the key type which throws on the copy number \c fail
+  struct fragile
+  {
+    static int copies, fail;
+    int key;
+    fragile(int k = 0): key(k) {}
+    fragile(const fragile& x): key(x.key)
+    {
+      if(++copies == fail)
+        __ntl_throw(std::runtime_error("fragile"));
+    }
+    fragile& operator=(const fragile& x) { key = x.key; return *this; }
+    friend bool operator<(const fragile& x, const fragile& y) { return x.key < y.key; }
+  };
+  int fragile::copies = 0, fragile::fail = 0;
+
+  template<class Map>
+  bool consistent(const Map& m)
+  {
+    if(m.keys().size() != m.values().size())
+      return false;
+    for(size_t i = 1; i < m.keys().size(); i++)
+      if(!(m.keys()[i-1] < m.keys()[i]))
+        return false;
+    return true;
+  }
+}
+
+// the sorted_unique construction takes the containers as they are, the unsorted ones are sorted
+template<> template<> void tut::to::test<01>(void)
+{
+  std::vector<int> keys;
+  std::vector<std::string> values;
+  for(int i = 0; i < 5; i++){
+    keys.push_back(i * 2);
+    values.push_back(std::string(1, static_cast<char>('a' + i)));
+  }
+  const map_type m(std::sorted_unique, keys, values);
+  VERIFY( m.size() == 5 && m.keys() == keys && m.values() == values );
+  VERIFY( m.begin()->first == 0 && m.begin()->second == "a" );
+  VERIFY( (m.end() - 1)->first == 8 && m.rbegin()->second == "e" );
+
+  const std::pair<int, std::string> sorted[] = { std::make_pair(1, "x"), std::make_pair(3, "y"), std::make_pair(7, "z") };
+  const map_type r(std::sorted_unique, sorted, sorted + 3);
+  VERIFY( r.size() == 3 && r.find(3)->second == "y" );
+
+  // the duplicates of the unsorted range are dropped, the first one stays
+  const std::pair<int, std::string> unsorted[] = { std::make_pair(5, "p"), std::make_pair(1, "q"), std::make_pair(5, "r"), std::make_pair(3, "s") };
+  map_type u(unsorted, unsorted + 4);
+  VERIFY( u.size() == 3 && u.find(5)->second == "p" && consistent(u) );
+
+  const int skeys[] = { 1, 2, 4, 8 };
+  const set_type s(std::sorted_unique, skeys, skeys + 4);
+  VERIFY( s.size() == 4 && *s.begin() == 1 && *(s.end() - 1) == 8 );
+  const int uskeys[] = { 9, 3, 3, 1, 9 };
+  const set_type us(uskeys, uskeys + 5);
+  VERIFY( us.size() == 3 && us.count(3) == 1 && *us.begin() == 1 );
+}
+
+// the lookup
+template<> template<> void tut::to::test<02>(void)
+{
+  map_type m;
+  for(int i = 0; i < 100; i++)
+    m.insert(std::make_pair((i * 37) % 100 * 2, std::string(1, static_cast<char>('0' + i % 10))));
+  VERIFY( m.size() == 100 && consistent(m) );
+
+  for(int k = -1; k <= 200; k++){
+    const bool present = k >= 0 && k < 200 && k % 2 == 0;
+    VERIFY( (m.find(k) != m.end()) == present );
+    VERIFY( m.count(k) == (present ? 1u : 0u) && m.contains(k) == present );
+    const map_type::iterator lb = m.lower_bound(k), ub = m.upper_bound(k);
+    VERIFY( lb == m.end() || lb->first >= k );
+    VERIFY( lb == m.begin() || (lb - 1)->first < k );
+    VERIFY( ub - lb == (present ? 1 : 0) );
+    VERIFY( m.equal_range(k).first == lb && m.equal_range(k).second == ub );
+  }
+  VERIFY( m.at(10) == m.find(10)->second );
+  m[11] = "new";
+  VERIFY( m.size() == 101 && m.find(11)->second == "new" && consistent(m) );
+
+  std::flat_multimap<int, int> mm;
+  for(int i = 0; i < 30; i++)
+    mm.insert(std::make_pair(i % 3, i));
+  VERIFY( mm.count(1) == 10 && mm.equal_range(2).second - mm.equal_range(2).first == 10 );
+  // the equivalent keys keep the insertion order
+  VERIFY( mm.lower_bound(1)->second == 1 && (mm.upper_bound(1) - 1)->second == 28 );
+
+  set_type s;
+  for(int i = 0; i < 50; i++)
+    s.insert(i * 3);
+  VERIFY( s.find(9) != s.end() && s.find(10) == s.end() && *s.lower_bound(10) == 12 );
+}
+
+// the range insertion merges in one pass: appended, interleaved, duplicates
+template<> template<> void tut::to::test<03>(void)
+{
+  map_type m;
+  const std::pair<int, std::string> tail[] = { std::make_pair(1, "a"), std::make_pair(2, "b") };
+  m.insert(tail, tail + 2);
+  const std::pair<int, std::string> after[] = { std::make_pair(4, "d"), std::make_pair(3, "c") };
+  m.insert(after, after + 2);
+  VERIFY( m.size() == 4 && consistent(m) && m.find(3)->second == "c" );
+
+  // the existing elements win over the inserted equivalent ones
+  const std::pair<int, std::string> mixed[] = { std::make_pair(0, "z"), std::make_pair(2, "X"), std::make_pair(5, "e"), std::make_pair(0, "Y") };
+  m.insert(mixed, mixed + 4);
+  VERIFY( m.size() == 6 && consistent(m) );
+  VERIFY( m.find(0)->second == "z" && m.find(2)->second == "b" && m.find(5)->second == "e" );
+
+  std::flat_multiset<int> ms;
+  const int a[] = { 5, 1, 3 }, b[] = { 3, 0, 5, 5 };
+  ms.insert(a, a + 3);
+  ms.insert(b, b + 4);
+  VERIFY( ms.size() == 7 && ms.count(5) == 3 && ms.count(3) == 2 && *ms.begin() == 0 );
+
+  set_type s;
+  s.insert(b, b + 4);
+  s.insert(a, a + 3);
+  VERIFY( s.size() == 4 && s.count(5) == 1 );
+}
+
+// the erasure
+template<> template<> void tut::to::test<04>(void)
+{
+  map_type m;
+  for(int i = 0; i < 10; i++)
+    m.insert(std::make_pair(i, std::string(1, static_cast<char>('a' + i))));
+  VERIFY( m.erase(3) == 1 && m.erase(3) == 0 && m.size() == 9 );
+  map_type::iterator i = m.erase(m.begin());
+  VERIFY( i == m.begin() && i->first == 1 && m.size() == 8 );
+  i = m.erase(m.find(5), m.find(8));
+  VERIFY( i->first == 8 && m.size() == 5 && consistent(m) );
+  VERIFY( m.find(6) == m.end() && m.find(4)->second == "e" && m.find(9)->second == "j" );
+  m.erase(m.begin(), m.end());
+  VERIFY( m.empty() && m.keys().empty() && m.values().empty() );
+
+  std::flat_multimap<int, int> mm;
+  for(int i = 0; i < 12; i++)
+    mm.insert(std::make_pair(i % 4, i));
+  VERIFY( mm.erase(2) == 3 && mm.size() == 9 && mm.count(2) == 0 );
+
+  set_type s;
+  for(int i = 0; i < 10; i++)
+    s.insert(i);
+  VERIFY( s.erase(0) == 1 && s.erase(100) == 0 );
+  s.erase(s.begin() + 2, s.begin() + 5);
+  VERIFY( s.size() == 6 && *(s.begin() + 2) == 6 );
+}
+
+// the merge which throws leaves the keys and the values of the same size
+template<> template<> void tut::to::test<05>(void)
+{
+  typedef std::flat_map<fragile, int> fragile_map;
+  std::vector<std::pair<fragile, int> > v;
+  for(int i = 0; i < 8; i++)
+    v.push_back(std::make_pair(fragile(i * 2), i));
+
+  // the append in place restores the map
+  for(int n = 1; n < 6; n++){
+    fragile_map m;
+    fragile::fail = 0;
+    m.insert(v.begin(), v.begin() + 4);
+    fragile::copies = 0;
+    fragile::fail = n;
+    bool thrown = false;
+    __ntl_try{
+      m.insert(v.begin() + 4, v.end());
+    }
+    __ntl_catch(const std::runtime_error&){
+      thrown = true;
+    }
+    VERIFY( thrown && m.size() == 4 && consistent(m) );
+  }
+
+  // the interleaving merge leaves the map empty, the copy of the range before it leaves the map unchanged
+  int emptied = 0;
+  for(int n = 1; n < 20; n++){
+    fragile_map m;
+    fragile::fail = 0;
+    for(int i = 0; i < 8; i += 2)
+      m.insert(v[i]);
+    fragile::copies = 0;
+    fragile::fail = n;
+    bool thrown = false;
+    __ntl_try{
+      m.insert(v.begin(), v.end());
+    }
+    __ntl_catch(const std::runtime_error&){
+      thrown = true;
+    }
+    VERIFY( consistent(m) );
+    VERIFY( thrown ? m.empty() || m.size() == 4 : m.size() == 8 );
+    if(thrown && m.empty())
+      ++emptied;
+  }
+  VERIFY( emptied > 0 );
+  fragile::fail = 0;
+}
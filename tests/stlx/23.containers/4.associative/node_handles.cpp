@@ -0,0 +1,217 @@
+// 23.4 associative containers: extract, insert(node_type&&) and merge
+
+#include <ntl-tests-common.hxx>
+#include <map>
+#include <set>
+#include <vector>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::map#node_handles");
+
+namespace
+{
+  typedef std::map<int, int> map_type;
+  typedef std::set<int> set_type;
+
+  // the keys 0..n-1 in the shuffled order, so the tree has the nodes with two children
+  void fill(map_type& m, int n)
+  {
+    for(int i = 0; i < n; i++){
+      const int k = (i * 7) % n;
+      m.insert(std::make_pair(k, k * 10));
+    }
+  }
+
+  void fill(set_type& s, int n)
+  {
+    for(int i = 0; i < n; i++)
+      s.insert((i * 7) % n);
+  }
+
+  int key_of(const map_type::value_type& x) { return x.first; }
+  int key_of(int x) { return x; }
+
+  // the address of every element, indexed by the key
+  template<class Container>
+  std::vector<const void*> addresses(const Container& c, int n)
+  {
+    std::vector<const void*> v(n);
+    for(typename Container::const_iterator i = c.begin(); i != c.end(); ++i)
+      v[key_of(*i)] = &*i;
+    return v;
+  }
+
+  // the keys are increasing and the iterators run through all of them both ways
+  template<class Container>
+  bool ordered(const Container& c)
+  {
+    size_t n = 0;
+    typename Container::const_iterator i = c.begin(), prev;
+    for(; i != c.end(); prev = i, ++i, n++)
+      if(n && !(key_of(*prev) < key_of(*i)))
+        return false;
+    if(n != c.size())
+      return false;
+    for(i = c.end(); i != c.begin(); n--)
+      --i;
+    return n == 0;
+  }
+}
+
+// extract by the position and by the key, the node owns the very element
+template<> template<> void tut::to::test<01>(void)
+{
+  const int n = 31;
+  map_type m;
+  fill(m, n);
+  const std::vector<const void*> before = addresses(m, n);
+
+  // the middle key sits in the node with two children
+  map_type::iterator i = m.find(15), next = i;
+  ++next;
+  map_type::node_type nh = m.extract(i);
+  VERIFY( !nh.empty() );
+  VERIFY( nh.key() == 15 && nh.mapped() == 150 );
+  VERIFY( &nh.key() == &static_cast<const map_type::value_type*>(before[15])->first );
+  VERIFY( m.size() == n - 1 );
+  VERIFY( m.find(15) == m.end() );
+  // the successor is neither moved nor invalidated
+  VERIFY( next->first == 16 && &*next == before[16] );
+  VERIFY( ordered(m) );
+
+  map_type::node_type nk = m.extract(16);
+  VERIFY( nk.key() == 16 && &nk.mapped() == &static_cast<const map_type::value_type*>(before[16])->second );
+  VERIFY( m.extract(16).empty() );
+  VERIFY( m.size() == n - 2 );
+
+  for(int k = 0; k < n; k++)
+    if(k != 15 && k != 16)
+      VERIFY( &*m.find(k) == before[k] );
+}
+
+// insert(node_type&&) relinks the node, the element stays at its address
+template<> template<> void tut::to::test<02>(void)
+{
+  const int n = 31;
+  map_type m;
+  fill(m, n);
+  const std::vector<const void*> before = addresses(m, n);
+
+  map_type::node_type nh = m.extract(10);
+  nh.key() = 100;
+  nh.mapped() = 1;
+  map_type::insert_return_type r = m.insert(std::move(nh));
+  VERIFY( r.inserted );
+  VERIFY( r.node.empty() && nh.empty() );
+  VERIFY( r.position->first == 100 && r.position->second == 1 );
+  VERIFY( &*r.position == before[10] );
+  VERIFY( m.size() == n );
+  VERIFY( ordered(m) );
+
+  // the duplicate is rejected, the node comes back in the result
+  map_type::node_type dup = m.extract(20);
+  dup.key() = 21;
+  map_type::insert_return_type rd = m.insert(std::move(dup));
+  VERIFY( !rd.inserted );
+  VERIFY( !rd.node.empty() && rd.node.key() == 21 && rd.node.mapped() == 200 );
+  VERIFY( rd.position == m.find(21) );
+  VERIFY( m.size() == n - 1 );
+
+  // the empty handle inserts nothing
+  map_type::insert_return_type re = m.insert(map_type::node_type());
+  VERIFY( !re.inserted && re.position == m.end() && re.node.empty() );
+
+  // the hinted insertion
+  rd.node.key() = 20;
+  const map_type::iterator h = m.insert(m.find(21), std::move(rd.node));
+  VERIFY( h->first == 20 && &*h == before[20] );
+  VERIFY( m.size() == n );
+  VERIFY( ordered(m) );
+}
+
+// merge moves the nodes of the absent keys only
+template<> template<> void tut::to::test<03>(void)
+{
+  const int n = 40;
+  map_type a, b;
+  for(int k = 0; k < n; k += 2)
+    a.insert(std::make_pair(k, k));
+  for(int k = 0; k < n; k += 3)
+    b.insert(std::make_pair(k, -k));
+  const std::vector<const void*> from = addresses(b, n);
+
+  a.merge(b);
+  VERIFY( ordered(a) && ordered(b) );
+  for(int k = 0; k < n; k++){
+    const bool in_a = k % 2 == 0, in_b = k % 3 == 0;
+    if(in_a){
+      VERIFY( a.find(k)->second == k );
+      VERIFY( (b.find(k) != b.end()) == in_b );
+      if(in_b)
+        VERIFY( &*b.find(k) == from[k] );
+    }else if(in_b){
+      // moved over, not copied
+      VERIFY( &*a.find(k) == from[k] && a.find(k)->second == -k );
+      VERIFY( b.find(k) == b.end() );
+    }
+  }
+  VERIFY( a.size() + b.size() == n / 2 + (n + 2) / 3 );
+
+  map_type c;
+  c.merge(a);
+  VERIFY( a.empty() && c.size() == n / 2 + (n + 2) / 3 - b.size() );
+  VERIFY( ordered(c) );
+}
+
+// set: the same for the keys only
+template<> template<> void tut::to::test<04>(void)
+{
+  const int n = 64;
+  set_type s;
+  fill(s, n);
+  const std::vector<const void*> before = addresses(s, n);
+
+  set_type::node_type nh = s.extract(s.find(31));
+  VERIFY( nh.value() == 31 && &nh.value() == before[31] );
+  nh.value() = 64;
+  set_type::insert_return_type r = s.insert(std::move(nh));
+  VERIFY( r.inserted && *r.position == 64 && &*r.position == before[31] );
+  VERIFY( ordered(s) );
+
+  // 32..63 and 64 are absent in t
+  set_type t;
+  fill(t, 31);
+  t.merge(s);
+  VERIFY( t.size() == n && s.size() == 31 );
+  VERIFY( s.find(64) == s.end() && &*t.find(64) == before[31] );
+  VERIFY( ordered(s) && ordered(t) );
+}
+
+// extract and erase everything in the random order
+template<> template<> void tut::to::test<05>(void)
+{
+  const int n = 200;
+  set_type s;
+  fill(s, n);
+  const std::vector<const void*> before = addresses(s, n);
+  unsigned seed = 1;
+  while(!s.empty()){
+    seed = seed * 1103515245 + 12345;
+    const int k = static_cast<int>((seed >> 16) % n);
+    const set_type::iterator i = s.find(k);
+    if(i == s.end())
+      continue;
+    set_type::iterator next = i;
+    ++next;
+    if(k & 1){
+      set_type::node_type nh = s.extract(i);
+      VERIFY( &nh.value() == before[k] );
+    }else{
+      VERIFY( s.erase(i) == next );
+    }
+    if(next != s.end())
+      VERIFY( &*next == before[*next] );
+    VERIFY( ordered(s) );
+    for(set_type::const_iterator j = s.begin(); j != s.end(); ++j)
+      VERIFY( &*j == before[*j] );
+  }
+}
@@ -0,0 +1,349 @@
+// the red-black tree of the associative containers: the hinted insertion, the sorted build and the clone
+
+#include <ntl-tests-common.hxx>
+#include <map>
+#include <set>
+#include <vector>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::ext::tree::rb_tree");
+
+namespace
+{
+  // the comparisons made by the tree
+  size_t comparisons = 0;
+
+  struct counting_less
+  {
+    bool operator()(int x, int y) const
+    {
+      comparisons++;
+      return x < y;
+    }
+  };
+
+  // the element which copy throws once the budget is spent
+  int live = 0, budget = -1;
+
+  struct fragile
+  {
+    int v;
+    fragile(int v): v(v) { live++; }
+    fragile(const fragile& x): v(x.v)
+    {
+      if(budget == 0)
+        throw 1;
+      if(budget > 0)
+        budget--;
+      live++;
+    }
+    ~fragile() { live--; }
+    bool operator<(const fragile& x) const { return v < x.v; }
+  private:
+    fragile& operator=(const fragile&);
+  };
+
+  // the access to the nodes of the tree
+  template<class T, class Compare = std::less<T> >
+  struct inspector:
+    std::ext::tree::rb_tree<T, Compare>
+  {
+    typedef std::ext::tree::rb_tree<T, Compare> base;
+    typedef typename base::node node;
+
+    inspector()
+      :base(Compare())
+    {}
+
+    template<class ForwardIterator>
+    inspector(ForwardIterator first, ForwardIterator last)
+      :base(first, last)
+    {}
+
+    inspector(const inspector& x)
+      :base(x)
+    {}
+
+    // the root is black, no red node has a red child, every path has the same number of the black nodes,
+    // the parent links, the order, the size and the limits agree
+    bool valid() const
+    {
+      if(!this->root_)
+        return this->count_ == 0 && !this->first_ && !this->last_;
+      if(this->root_->color() != node::black || this->root_->parent())
+        return false;
+      const node* prev = nullptr;
+      size_t n = 0;
+      if(black_height(this->root_, prev, n) < 0 || n != this->count_)
+        return false;
+      const node* first = this->root_, *last = this->root_;
+      while(first->child[base::left])
+        first = first->child[base::left];
+      while(last->child[base::right])
+        last = last->child[base::right];
+      return first == this->first_ && last == this->last_ && prev == last;
+    }
+
+    // the clone has the same shape and colors in the other nodes
+    bool same_shape(const inspector& x) const
+    {
+      return same_shape(this->root_, x.root_);
+    }
+
+    size_t height() const
+    {
+      return height(this->root_);
+    }
+
+  private:
+    int black_height(const node* p, const node*& prev, size_t& n) const
+    {
+      if(!p)
+        return 1;
+      for(int d = base::left; d <= base::right; d++){
+        const node* c = p->child[d];
+        if(c && (c->parent() != p || (p->color() == node::red && c->color() == node::red)))
+          return -1;
+      }
+      const int l = black_height(p->child[base::left], prev, n);
+      if(prev && !this->comparator_(prev->elem, p->elem))
+        return -1;
+      prev = p;
+      n++;
+      const int r = black_height(p->child[base::right], prev, n);
+      if(l < 0 || l != r)
+        return -1;
+      return l + (p->color() == node::black ? 1 : 0);
+    }
+
+    static bool same_shape(const node* x, const node* y)
+    {
+      if(!x || !y)
+        return x == y;
+      return x != y && x->color() == y->color() && !(x->elem < y->elem) && !(y->elem < x->elem)
+        && same_shape(x->child[base::left], y->child[base::left])
+        && same_shape(x->child[base::right], y->child[base::right]);
+    }
+
+    static size_t height(const node* p)
+    {
+      return p ? 1 + std::max(height(p->child[base::left]), height(p->child[base::right])) : 0;
+    }
+  };
+
+  typedef inspector<int> int_tree;
+
+  std::vector<int> sorted(size_t n)
+  {
+    std::vector<int> v;
+    for(size_t i = 0; i < n; i++)
+      v.push_back(static_cast<int>(i * 2));
+    return v;
+  }
+}
+
+// the sorted range is built as the valid tree of the minimal height
+template<> template<> void tut::to::test<01>(void)
+{
+  std::vector<size_t> sizes;
+  sizes.push_back(0);
+  sizes.push_back(1);
+  sizes.push_back(2);
+  for(size_t k = 2; k <= 10; k++){
+    sizes.push_back((size_t(1) << k) - 1);
+    sizes.push_back(size_t(1) << k);
+    sizes.push_back((size_t(1) << k) + 1);
+  }
+  for(size_t i = 0; i < sizes.size(); i++){
+    const size_t n = sizes[i];
+    const std::vector<int> v = sorted(n);
+    const int_tree t(v.begin(), v.end());
+    VERIFY( t.valid() && t.size() == n );
+    size_t min_height = 0;
+    while((size_t(1) << min_height) - 1 < n)
+      min_height++;
+    VERIFY( t.height() == min_height );
+    VERIFY( std::equal(v.begin(), v.end(), t.begin()) );
+
+    // the built tree is modified as usual
+    int_tree u(t);
+    VERIFY( u.insert(-1).second && u.insert(static_cast<int>(n * 2 + 1)).second && u.valid() );
+    for(size_t j = 0; j < n; j += 3)
+      VERIFY( u.erase(v[j]) == 1 );
+    VERIFY( u.valid() && u.size() == n + 2 - (n + 2) / 3 );
+  }
+
+  // the range with the duplicates or out of order is inserted element by element
+  const int unsorted[] = { 4, 2, 2, 9, 0 };
+  const int_tree t(unsorted, unsorted + _countof(unsorted));
+  VERIFY( t.valid() && t.size() == 4 && *t.begin() == 0 );
+  int_tree u;
+  u.insert(5);
+  const int more[] = { 1, 2, 3 };
+  u.insert(more, more + 3);
+  VERIFY( u.valid() && u.size() == 4 && *u.begin() == 1 );
+
+  // std::set and std::map take the same path
+  const std::vector<int> v = sorted(100);
+  const std::set<int> s(v.begin(), v.end());
+  VERIFY( s.size() == 100 && std::equal(v.begin(), v.end(), s.begin()) );
+}
+
+// the hint right before or right after the place takes a couple of comparisons, the wrong hint still works
+template<> template<> void tut::to::test<02>(void)
+{
+  typedef inspector<int, counting_less> counted_tree;
+  counted_tree t;
+
+  // appended at the end
+  for(int i = 0; i < 1000; i++){
+    comparisons = 0;
+    const counted_tree::iterator it = t.insert(t.cend(), i * 4);
+    VERIFY( *it == i * 4 && comparisons <= 2 );
+  }
+  VERIFY( t.valid() && t.size() == 1000 );
+
+  // prepended at the begin
+  for(int i = 1; i <= 100; i++){
+    comparisons = 0;
+    t.insert(t.cbegin(), -i * 4);
+    VERIFY( comparisons <= 2 );
+  }
+  VERIFY( t.valid() && t.size() == 1100 );
+
+  // right before and right after the hint in the middle
+  for(int i = 0; i < 500; i++){
+    counted_tree::iterator hint = t.find(i * 4);
+    comparisons = 0;
+    counted_tree::iterator it = t.insert(hint, i * 4 - 1);
+    VERIFY( *it == i * 4 - 1 && ++it == hint && comparisons <= 3 );
+    hint = t.find(i * 4);
+    comparisons = 0;
+    it = t.insert(hint, i * 4 + 1);
+    VERIFY( *it == i * 4 + 1 && --it == hint && comparisons <= 3 );
+  }
+  VERIFY( t.valid() && t.size() == 2100 );
+
+  // the existing element is found at the hint and near it
+  comparisons = 0;
+  const counted_tree::const_iterator at = t.find(40);
+  VERIFY( t.insert(at, 40) == at && t.size() == 2100 );
+  VERIFY( *t.insert(at, 41) == 41 && t.size() == 2100 );
+
+  // the wrong hints fall back to the search from the root
+  unsigned seed = 5;
+  std::set<int> ref(t.begin(), t.end());
+  for(int i = 0; i < 3000; i++){
+    seed = seed * 1103515245 + 12345;
+    const int k = static_cast<int>((seed >> 8) % 8000) - 500;
+    counted_tree::const_iterator hint = (seed >> 4) & 1 ? t.cend() : t.cbegin();
+    if((seed >> 5) & 1)
+      hint = t.find(*ref.begin());
+    const counted_tree::iterator it = t.insert(hint, k);
+    ref.insert(k);
+    VERIFY( *it == k );
+  }
+  VERIFY( t.valid() && t.size() == ref.size() && std::equal(ref.begin(), ref.end(), t.begin()) );
+
+  // the containers forward the hint
+  std::map<int, int> m;
+  for(int i = 0; i < 100; i++)
+    m.insert(m.end(), std::make_pair(i, i));
+  std::map<int, int>::iterator mi = m.insert(m.find(50), std::make_pair(-1, -1));
+  VERIFY( mi->first == -1 && m.begin() == mi && m.size() == 101 );
+  std::set<int> s;
+  for(int i = 0; i < 100; i++)
+    s.insert(s.begin(), -i);
+  VERIFY( s.size() == 100 && *s.begin() == -99 && *--s.end() == 0 );
+}
+
+// the copy clones the shape and the colors, the failed copy frees the cloned part
+template<> template<> void tut::to::test<03>(void)
+{
+  unsigned seed = 9;
+  int_tree t;
+  for(size_t n = 0; n < 300; n++){
+    const int_tree c(t);
+    VERIFY( c.valid() && c.same_shape(t) && c == t );
+    int_tree a;
+    a.insert(-5);
+    a = t;
+    VERIFY( a.valid() && a.same_shape(t) && a == t );
+    a = a;
+    VERIFY( a.valid() && a == t );
+
+    seed = seed * 1103515245 + 12345;
+    t.insert(static_cast<int>((seed >> 8) % 1000));
+    if(n % 5 == 0 && !t.empty())
+      t.erase(t.begin());
+  }
+  VERIFY( t.valid() && t.size() > 100 );
+
+  typedef inspector<fragile> fragile_tree;
+  for(int n = 1; n < 70; n += 9){
+    fragile_tree f;
+    for(int i = 0; i < n; i++)
+      f.insert(fragile((i * 13) % n));
+    VERIFY( f.size() == static_cast<size_t>(n) );
+    std::vector<fragile> v;
+    for(int i = 0; i < n; i++)
+      v.push_back(fragile(i));
+
+    for(int k = 0; k <= n; k++){
+      const int before = live;
+      budget = k;
+      try {
+        const fragile_tree c(f);
+        VERIFY( k >= n && c.valid() && c.same_shape(f) );
+      }
+      catch(int){
+        VERIFY( k < n );
+      }
+      budget = -1;
+      VERIFY( live == before );
+
+      // the sorted build which fails part way
+      budget = k;
+      try {
+        const fragile_tree b(v.begin(), v.end());
+        VERIFY( k >= n && b.valid() && b.size() == static_cast<size_t>(n) );
+      }
+      catch(int){
+        VERIFY( k < n );
+      }
+      budget = -1;
+      VERIFY( live == before );
+    }
+  }
+  VERIFY( live == 0 );
+}
+
+// the erasure keeps the invariants, including the removal of the black leaf
+template<> template<> void tut::to::test<04>(void)
+{
+  int_tree t;
+  std::set<int> ref;
+  unsigned seed = 13;
+  for(int round = 0; round < 20000; round++){
+    seed = seed * 1103515245 + 12345;
+    const int k = static_cast<int>((seed >> 8) % 500);
+    if((seed >> 4) % 3)
+      VERIFY( t.insert(k).second == ref.insert(k).second );
+    else
+      VERIFY( t.erase(k) == ref.erase(k) );
+    if(round % 16 == 0)
+      VERIFY( t.valid() );
+  }
+  VERIFY( t.valid() && std::equal(ref.begin(), ref.end(), t.begin()) );
+
+  // from the both ends and through the iterators
+  while(!t.empty()){
+    int_tree::iterator i = t.erase(t.begin());
+    VERIFY( i == t.begin() && t.valid() );
+    if(!t.empty()){
+      int_tree::iterator last = t.end();
+      --last;
+      VERIFY( t.erase(last) == t.end() && t.valid() );
+    }
+  }
+  VERIFY( t.size() == 0 && t.begin() == t.end() );
+}
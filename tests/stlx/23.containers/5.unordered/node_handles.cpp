@@ -0,0 +1,187 @@
+// 23.5 unordered containers: the bucket relinking, extract, insert(node_type&&) and merge
+
+#include <ntl-tests-common.hxx>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::unordered_map#node_handles");
+
+namespace
+{
+  // the keys of the same tens share the hash
+  struct tens_hash
+  {
+    size_t operator()(int k) const { return static_cast<size_t>(k / 10); }
+  };
+
+  typedef std::unordered_set<int, tens_hash> tens_set;
+  typedef std::unordered_map<int, int> map_type;
+  typedef std::unordered_set<int> set_type;
+
+  // every element is reached once by the iteration and by find()
+  template<class Container>
+  bool consistent(const Container& c)
+  {
+    size_t n = 0;
+    for(typename Container::const_iterator i = c.begin(); i != c.end(); ++i, n++)
+      if(c.find(*i) != i)
+        return false;
+    return n == c.size();
+  }
+
+  template<class Container>
+  bool consistent_map(const Container& c)
+  {
+    size_t n = 0;
+    for(typename Container::const_iterator i = c.begin(); i != c.end(); ++i, n++)
+      if(c.find(i->first) != i)
+        return false;
+    return n == c.size();
+  }
+
+  // the keys different from k in the bucket of k
+  std::vector<int> bucket_mates(const set_type& s, int k, size_t count)
+  {
+    std::vector<int> v;
+    for(int x = k + 1; v.size() < count; x++)
+      if(s.bucket(x) == s.bucket(k))
+        v.push_back(x);
+    return v;
+  }
+}
+
+// the equal hashes are linked at the head of the bucket
+template<> template<> void tut::to::test<01>(void)
+{
+  tens_set s;
+  for(int k = 0; k < 30; k++)
+    VERIFY( s.insert(k).second );
+  VERIFY( s.size() == 30 );
+  for(int k = 0; k < 30; k++)
+    VERIFY( s.find(k) != s.end() && *s.find(k) == k );
+  VERIFY( !s.insert(15).second );
+  VERIFY( consistent(s) );
+
+  for(int k = 0; k < 30; k += 3)
+    VERIFY( s.erase(k) == 1 );
+  VERIFY( s.size() == 20 );
+  VERIFY( consistent(s) );
+}
+
+// the different hashes of one bucket: the node linked after the head gets its back link
+template<> template<> void tut::to::test<02>(void)
+{
+  set_type s;
+  const std::vector<int> mates = bucket_mates(s, 0, 4);
+  s.insert(0);
+  for(size_t i = 0; i < mates.size(); i++)
+    s.insert(mates[i]);
+  VERIFY( s.size() == 5 );
+  VERIFY( consistent(s) );
+
+  // unlinking the middle nodes uses the back links
+  VERIFY( s.erase(mates[1]) == 1 );
+  VERIFY( s.erase(mates[2]) == 1 );
+  VERIFY( s.size() == 3 );
+  VERIFY( consistent(s) );
+  VERIFY( s.find(mates[0]) != s.end() && s.find(mates[3]) != s.end() );
+  VERIFY( s.erase(0) == 1 );
+  VERIFY( consistent(s) );
+}
+
+// erase returns the next element in the iteration order
+template<> template<> void tut::to::test<03>(void)
+{
+  set_type s;
+  for(int k = 0; k < 100; k++)
+    s.insert(k * 37);
+  size_t n = 0;
+  for(set_type::iterator i = s.begin(); i != s.end(); n++){
+    set_type::iterator next = i;
+    ++next;
+    if(n & 1){
+      i = s.erase(i);
+      VERIFY( i == next );
+    }else{
+      i = next;
+    }
+  }
+  VERIFY( n == 100 && s.size() == 50 );
+  VERIFY( consistent(s) );
+
+  // erase everything by the returned iterators
+  for(set_type::iterator i = s.begin(); i != s.end(); n++)
+    i = s.erase(i);
+  VERIFY( n == 150 && s.empty() && s.begin() == s.end() );
+}
+
+// rehash relinks the nodes, the elements stay in place
+template<> template<> void tut::to::test<04>(void)
+{
+  map_type m;
+  std::vector<const int*> before;
+  for(int k = 0; k < 100; k++)
+    m.insert(std::make_pair(k, k * 2));
+  for(int k = 0; k < 100; k++)
+    before.push_back(&m.find(k)->second);
+
+  const size_t buckets = m.bucket_count();
+  m.rehash(buckets * 8);
+  VERIFY( m.bucket_count() > buckets );
+  VERIFY( m.size() == 100 );
+  for(int k = 0; k < 100; k++)
+    VERIFY( &m.find(k)->second == before[k] && m.find(k)->second == k * 2 );
+  VERIFY( consistent_map(m) );
+}
+
+// extract and insert(node_type&&) keep the element address
+template<> template<> void tut::to::test<05>(void)
+{
+  map_type m;
+  for(int k = 0; k < 50; k++)
+    m.insert(std::make_pair(k, k));
+  const int* const p = &m.find(7)->second;
+
+  map_type::node_type nh = m.extract(7);
+  VERIFY( !nh.empty() && nh.key() == 7 && &nh.mapped() == p );
+  VERIFY( m.size() == 49 && m.find(7) == m.end() );
+  VERIFY( m.extract(7).empty() );
+  VERIFY( consistent_map(m) );
+
+  // the changed key is rehashed
+  nh.key() = 1000;
+  map_type::insert_return_type r = m.insert(std::move(nh));
+  VERIFY( r.inserted && r.node.empty() );
+  VERIFY( r.position->first == 1000 && &r.position->second == p );
+  VERIFY( m.find(1000) == r.position );
+
+  // the duplicate comes back
+  map_type::node_type dup = m.extract(m.find(8));
+  dup.key() = 9;
+  map_type::insert_return_type rd = m.insert(std::move(dup));
+  VERIFY( !rd.inserted && !rd.node.empty() && rd.position == m.find(9) );
+  VERIFY( m.size() == 49 );
+  VERIFY( consistent_map(m) );
+}
+
+// merge moves the nodes of the absent keys only
+template<> template<> void tut::to::test<06>(void)
+{
+  set_type a, b;
+  std::vector<const int*> from(60);
+  for(int k = 0; k < 60; k += 2)
+    a.insert(k);
+  for(int k = 0; k < 60; k += 3)
+    from[k] = &*b.insert(k).first;
+
+  a.merge(b);
+  VERIFY( a.size() == 40 && b.size() == 10 );
+  for(int k = 0; k < 60; k += 3){
+    if(k % 2)
+      VERIFY( &*a.find(k) == from[k] && b.find(k) == b.end() );
+    else
+      VERIFY( &*b.find(k) == from[k] );
+  }
+  VERIFY( consistent(a) && consistent(b) );
+}
@@ -0,0 +1,217 @@
+// 26.5.6 Class random_device and its sources
+
+#include <ntl-tests-common.hxx>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::random_device");
+
+namespace
+{
+  namespace entropy = std::ext::entropy;
+
+  // all the statistics are about N(0,1) or chi-square(255) for the good source, the bounds fail once in 10^5 runs
+  bool sane(const std::vector<uint32_t>& v)
+  {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(v.data());
+    const size_t n = v.size() * sizeof(uint32_t);
+    double ones = 0, counts[256] = {};
+    for(size_t i = 0; i < n; i++){
+      ones += std::ext::bitops::popcount(p[i]);
+      counts[p[i]]++;
+    }
+    const double bits = n * 8.0, monobit = (ones - bits / 2) / std::sqrt(bits / 4);
+
+    double chi2 = 0;
+    const double expected = n / 256.0;
+    for(size_t i = 0; i < 256; i++)
+      chi2 += (counts[i] - expected) * (counts[i] - expected) / expected;
+
+    double runs = 1;
+    unsigned prev = p[0] & 1;
+    for(size_t i = 0; i < n; i++)
+      for(unsigned b = 0; b < 8; b++){
+        const unsigned x = (p[i] >> b) & 1;
+        if(x != prev)
+          runs++, prev = x;
+      }
+    const double pi = ones / bits, runs_z = (runs - 2 * bits * pi * (1 - pi) - 1) / (2 * std::sqrt(2 * bits) * pi * (1 - pi));
+
+    double sxy = 0, sx = 0, sxx = 0;
+    for(size_t i = 0; i < n; i++){
+      const double x = p[i], y = p[(i + 1) % n];
+      sxy += x * y, sx += x, sxx += x * x;
+    }
+    const double serial = (n * sxy - sx * sx) / (n * sxx - sx * sx);
+
+    return std::fabs(monobit) < 4.5 && chi2 > 160 && chi2 < 370 && std::fabs(runs_z) < 4.5 && std::fabs(serial) < 4.5 / std::sqrt(double(n));
+  }
+
+  // the replacements of the system source
+  unsigned os_calls;
+
+  bool counting_source(void* buf, size_t size)
+  {
+    os_calls++;
+    uint8_t* p = static_cast<uint8_t*>(buf);
+    for(size_t i = 0; i < size; i++)
+      p[i] = static_cast<uint8_t>(i * 37 + os_calls);
+    return true;
+  }
+
+  bool failing_source(void*, size_t)
+  {
+    os_calls++;
+    return false;
+  }
+}
+
+// the ChaCha20 block of RFC 7539 2.3.2, every lane is the next block
+template<> template<> void tut::to::test<01>(void)
+{
+  uint32_t key[8];
+  for(uint32_t i = 0; i < 8; i++)
+    key[i] = (i * 4) | (i * 4 + 1) << 8 | (i * 4 + 2) << 16 | (i * 4 + 3) << 24;
+  // the block counter 1 and the 96-bit nonce 00:00:00:09:00:00:00:4a:00:00:00:00
+  const uint64_t counter = 1 | uint64_t(0x09000000) << 32, nonce = 0x4a000000;
+  static const uint32_t expected[16] = {
+    0xe4e7f110, 0x15593bd1, 0x1fdd0f50, 0xc47120a3,
+    0xc7f4d1c7, 0x0368c033, 0x9aaa2204, 0x4e6cd4c3,
+    0x466482d2, 0x09aa9f07, 0x05d7c214, 0xa2028bd9,
+    0xd19c12b5, 0xb94e16de, 0xe883d0cb, 0x4e3c50a2
+  };
+  uint32_t one[16], four[64];
+  entropy::__::chacha20_blocks<1>(key, counter, nonce, one);
+  VERIFY( std::equal(one, one + 16, expected) );
+
+  entropy::__::chacha20_blocks<4>(key, counter - 1, nonce, four);
+  VERIFY( std::equal(four + 16, four + 32, expected) );
+  entropy::__::chacha20_blocks<1>(key, counter + 2, nonce, one);
+  VERIFY( std::equal(four + 48, four + 64, one) && !std::equal(four, four + 16, four + 16) );
+}
+
+// the default source by the calls and by generate(), more than the reseed interval
+template<> template<> void tut::to::test<02>(void)
+{
+  std::random_device rd;
+  VERIFY( rd.entropy() == 32 );
+  std::vector<uint32_t> v(entropy::chacha20_random::reseed_interval / sizeof(uint32_t) + 1000);
+  for(size_t i = 0; i < v.size(); i++)
+    v[i] = rd();
+  VERIFY( sane(v) );
+
+  const std::vector<uint32_t> calls = v;
+  rd.generate(v.begin(), v.end());
+  VERIFY( sane(v) );
+  VERIFY( v != calls );
+
+  // the other device of the thread continues the stream
+  std::random_device other;
+  std::vector<uint32_t> w(v.size());
+  other.generate(w.begin(), w.end());
+  VERIFY( sane(w) && w != v );
+}
+
+// the tokens
+template<> template<> void tut::to::test<03>(void)
+{
+  // the number is the seed of mt19937
+  std::random_device a("12345"), b("12345");
+  std::mt19937 e(12345);
+  VERIFY( a.entropy() == 0 );
+  for(int i = 0; i < 1000; i++){
+    const std::random_device::result_type x = a();
+    VERIFY( x == b() && x == e() );
+  }
+  std::vector<uint32_t> v(100);
+  a.generate(v.begin(), v.end());
+  for(size_t i = 0; i < v.size(); i++)
+    VERIFY( v[i] == e() );
+
+  VERIFY( std::random_device("default").entropy() == 32 && std::random_device("").entropy() == 32 );
+
+  bool thrown = false;
+  try { std::random_device bad("/dev/urandom"); }
+  catch(std::runtime_error&) { thrown = true; }
+  VERIFY( thrown );
+
+  // the absent instruction is not taken
+  const entropy::processor& cpu = entropy::processor::features();
+  const char* const tokens[] = { "rdrand", "rdseed" };
+  const bool present[] = { cpu.rdrand, cpu.rdseed };
+  for(size_t t = 0; t < _countof(tokens); t++){
+    thrown = false;
+    try { std::random_device rd(tokens[t]); }
+    catch(std::runtime_error&) { thrown = true; }
+    VERIFY( thrown != present[t] );
+  }
+}
+
+// the sources per value
+template<> template<> void tut::to::test<04>(void)
+{
+  const entropy::processor& cpu = entropy::processor::features();
+  const char* const tokens[] = { "os", "rdrand", "rdseed" };
+  const bool present[] = { true, cpu.rdrand, cpu.rdseed };
+  std::vector<uint32_t> v(16 * 1024);
+  for(size_t t = 0; t < _countof(tokens); t++){
+    if(!present[t])
+      continue;
+    std::random_device rd(tokens[t]);
+    for(size_t i = 0; i < v.size(); i++)
+      v[i] = rd();
+    VERIFY( sane(v) );
+  }
+}
+
+// the generator is seeded at the first refill and reseeded every reseed_interval bytes
+template<> template<> void tut::to::test<05>(void)
+{
+  // a refill gives 1 KB less the next key
+  const size_t per_refill = (1024 - 32) / sizeof(uint32_t), refills = entropy::chacha20_random::reseed_interval / 1024;
+  entropy::os_source_t* const prev = entropy::set_os_source(counting_source);
+  os_calls = 0;
+  {
+    entropy::chacha20_random g;
+    VERIFY( os_calls == 0 );
+    std::vector<uint32_t> v(per_refill * refills);
+    g.generate(v.begin(), v.end());
+    VERIFY( os_calls == 1 );
+    VERIFY( sane(v) );
+    g();
+    VERIFY( os_calls == 2 );
+    g.generate(v.begin(), v.end() - 1);
+    VERIFY( os_calls == 2 );
+    g();
+    VERIFY( os_calls == 3 );
+  }
+
+  // no source: the first value throws if the processor has none either
+  const entropy::processor& cpu = entropy::processor::features();
+  entropy::set_os_source(failing_source);
+  os_calls = 0;
+  {
+    entropy::chacha20_random g;
+    bool thrown = false;
+    try { g(); }
+    catch(std::runtime_error&) { thrown = true; }
+    VERIFY( os_calls == 1 );
+    VERIFY( thrown == !(cpu.rdrand || cpu.rdseed) );
+  }
+
+  // the failed reseed keeps the seeded key
+  os_calls = 0;
+  entropy::set_os_source(counting_source);
+  {
+    entropy::chacha20_random g;
+    g();
+    entropy::set_os_source(failing_source);
+    std::vector<uint32_t> v(per_refill * refills);
+    g.generate(v.begin(), v.end());
+    VERIFY( os_calls == 2 );
+    VERIFY( sane(v) );
+  }
+  entropy::set_os_source(prev);
+}
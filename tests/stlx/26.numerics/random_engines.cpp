@@ -0,0 +1,199 @@
+// std::ext::xoshiro256starstar, pcg64 and philox4x32
+
+#include <ntl-tests-common.hxx>
+#include <random>
+#include <sstream>
+#include <vector>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::ext random engines");
+
+namespace
+{
+  using std::ext::xoshiro256starstar;
+  using std::ext::pcg64;
+  using std::ext::philox4x32;
+
+  // the engine of the state written as by operator<<
+  template<class Engine>
+  Engine load(const char* state)
+  {
+    Engine e;
+    std::istringstream is(state);
+    is >> e;
+    return e;
+  }
+
+  // discard(z) is the same as z calls, after any number of the calls
+  template<class Engine>
+  bool discard_matches(const Engine& seeded)
+  {
+    const unsigned long long steps[] = { 0, 1, 2, 3, 4, 5, 7, 8, 31, 32, 33, 63, 64, 65, 1000 };
+    for(unsigned skip = 0; skip < 6; skip++){
+      for(size_t i = 0; i < _countof(steps); i++){
+        Engine a = seeded, b = seeded;
+        for(unsigned n = 0; n < skip; n++)
+          a(), b();
+        a.discard(steps[i]);
+        for(unsigned long long n = 0; n < steps[i]; n++)
+          b();
+        if(a != b)
+          return false;
+        for(int n = 0; n < 10; n++)
+          if(a() != b())
+            return false;
+      }
+    }
+    return true;
+  }
+
+  // the large discards add up
+  template<class Engine>
+  bool discard_adds(const Engine& seeded, unsigned long long x, unsigned long long y)
+  {
+    Engine a = seeded, b = seeded;
+    a.discard(x);
+    a.discard(y);
+    b.discard(x + y);
+    return a == b && a() == b();
+  }
+
+  // generate() gives the values of the calls and leaves the engine where the calls do
+  template<class Engine>
+  bool generate_matches(const Engine& seeded)
+  {
+    typedef typename Engine::result_type result_type;
+    for(unsigned skip = 0; skip < 6; skip++){
+      for(size_t length = 0; length <= 100; length++){
+        Engine a = seeded, b = seeded;
+        for(unsigned n = 0; n < skip; n++)
+          a(), b();
+        std::vector<result_type> v(length);
+        a.generate(v.begin(), v.end());
+        for(size_t n = 0; n < length; n++)
+          if(v[n] != b())
+            return false;
+        if(a != b)
+          return false;
+        // the rest of the partial block
+        for(int n = 0; n < 5; n++)
+          if(a() != b())
+            return false;
+        a.generate(v.begin(), v.begin() + length / 2);
+        for(size_t n = 0; n < length / 2; n++)
+          if(v[n] != b())
+            return false;
+        if(a != b)
+          return false;
+      }
+    }
+    return true;
+  }
+}
+
+// xoshiro256**: the reference output of the state {1, 2, 3, 4}
+template<> template<> void tut::to::test<01>(void)
+{
+  static const uint64_t expected[] = {
+    11520ull, 0ull, 1509978240ull, 1215971899390074240ull, 1216172134540287360ull,
+    607988272756665600ull, 16172922978634559625ull, 8476171486693032832ull,
+    10595114339597558777ull, 2904607092377533576ull
+  };
+  xoshiro256starstar e = load<xoshiro256starstar>("1 2 3 4");
+  for(size_t i = 0; i < _countof(expected); i++)
+    VERIFY( e() == expected[i] );
+
+  uint64_t v[_countof(expected)];
+  e = load<xoshiro256starstar>("1 2 3 4");
+  e.generate(v, v + _countof(v));
+  VERIFY( std::equal(v, v + _countof(v), expected) );
+
+  // the value seed is expanded by splitmix64
+  xoshiro256starstar d;
+  VERIFY( d() == 0x29E60CEC1609C414ull && d() == 0x0399F3D9F7B6106Bull && d() == 0xAE39CA6A197B5E36ull );
+  VERIFY( d != xoshiro256starstar() && xoshiro256starstar(1) != xoshiro256starstar(2) );
+}
+
+// PCG64: the reference output of pcg64(42, 54) and of the default seed
+template<> template<> void tut::to::test<02>(void)
+{
+  static const uint64_t expected[] = {
+    0x86B1DA1D72062B68ull, 0x1304AA46C9853D39ull, 0xA3670E9E0DD50358ull,
+    0xF9090E529A7DAE00ull, 0xC85B9FD837996F2Cull, 0x606121F8E3919196ull
+  };
+  pcg64 e(42, 54);
+  for(size_t i = 0; i < _countof(expected); i++)
+    VERIFY( e() == expected[i] );
+
+  uint64_t v[_countof(expected)];
+  e.seed(42, 54);
+  e.generate(v, v + _countof(v));
+  VERIFY( std::equal(v, v + _countof(v), expected) );
+
+  pcg64 d;
+  VERIFY( d() == 0x20DDE53745841AB1ull && d() == 0x6B1CE42CFC6E9DD4ull && d() == 0xAAF621967212D0A0ull );
+
+  // the streams of the same seed differ
+  pcg64 s1(42, 1), s2(42, 2);
+  VERIFY( s1 != s2 && s1() != s2() );
+}
+
+// Philox4x32-10: the known answers of Random123, the counter is key0 key1 ctr0..ctr3 in the stream
+template<> template<> void tut::to::test<03>(void)
+{
+  philox4x32 zero(0, 0);
+  VERIFY( zero() == 0x6627E8D5u && zero() == 0xE169C58Du && zero() == 0xBC57AC4Cu && zero() == 0x9B00DBD8u );
+
+  philox4x32 ones = load<philox4x32>("4294967295 4294967295 4294967295 4294967295 4294967295 4294967295 4");
+  VERIFY( ones() == 0x408F276Du && ones() == 0x41C83B0Eu && ones() == 0xA20BC7C6u && ones() == 0x6D5451FDu );
+  // the counter wraps to zero
+  philox4x32 wrapped = load<philox4x32>("4294967295 4294967295 0 0 0 0 4");
+  VERIFY( ones() == wrapped() );
+
+  // 0x243F6A88 0x85A308D3 0x13198A2E 0x03707344 and the key 0xA4093822 0x299F31D0
+  philox4x32 pi = load<philox4x32>("2752067618 698298832 608135816 2242054355 320440878 57701188 4");
+  uint32_t v[4];
+  pi.generate(v, v + 4);
+  VERIFY( v[0] == 0xD16CFE09u && v[1] == 0x94FDCCEBu && v[2] == 0x5001E420u && v[3] == 0x24126EA1u );
+
+  // the stream is the upper half of the counter
+  pi = philox4x32(0x299F31D0A4093822ull, 0x0370734413198A2Eull);
+  // 0x85A308D3243F6A88 blocks are four times as many values
+  for(int i = 0; i < 4; i++)
+    pi.discard(0x85A308D3243F6A88ull);
+  VERIFY( pi() == 0xD16CFE09u && pi() == 0x94FDCCEBu );
+
+  // the state in the middle of the block is restored
+  std::ostringstream os;
+  os << pi;
+  philox4x32 restored = load<philox4x32>(os.str().c_str());
+  VERIFY( restored == pi && restored() == 0x5001E420u && restored() == 0x24126EA1u );
+}
+
+// discard() equals the calls
+template<> template<> void tut::to::test<04>(void)
+{
+  VERIFY( discard_matches(xoshiro256starstar(7)) );
+  VERIFY( discard_matches(pcg64(42, 54)) );
+  VERIFY( discard_matches(philox4x32(7, 3)) );
+
+  VERIFY( discard_adds(pcg64(42, 54), 0x123456789ull, 0xFEDCBA987654321ull) );
+  VERIFY( discard_adds(pcg64(), ~0ull / 2, ~0ull / 2) );
+  VERIFY( discard_adds(philox4x32(7, 3), 0x123456789ull, 0xFEDCBA987654321ull) );
+  VERIFY( discard_adds(philox4x32(7, 3), ~0ull / 2 - 1, 3) );
+  philox4x32 skipped(7, 3);
+  skipped();
+  VERIFY( discard_adds(skipped, 5, ~0ull / 2) );
+  VERIFY( discard_adds(xoshiro256starstar(7), 1000, 2345) );
+}
+
+// generate() equals the calls, including the partial blocks of philox4x32 and its lanes
+template<> template<> void tut::to::test<05>(void)
+{
+  VERIFY( generate_matches(xoshiro256starstar(7)) );
+  VERIFY( generate_matches(pcg64(42, 54)) );
+  VERIFY( generate_matches(philox4x32(7, 3)) );
+
+  // the lanes carry to the stream half of the counter
+  const philox4x32 edge = load<philox4x32>("7 0 4294967290 4294967295 3 0 4");
+  VERIFY( generate_matches(edge) );
+}
@@ -0,0 +1,173 @@
+// 27.9.1 basic_filebuf: the unbuffered mode and the block transfers
+
+#include <ntl-tests-common.hxx>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <tr2/files.hxx>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::filebuf");
+
+namespace
+{
+  const std::ios_base::openmode write_mode = std::ios_base::out|std::ios_base::binary|std::ios_base::trunc,
+    read_mode = std::ios_base::in|std::ios_base::binary;
+
+  std::string pattern(size_t from, size_t n)
+  {
+    std::string s(n, '\0');
+    for(size_t i = 0; i < n; i++)
+      s[i] = static_cast<char>('A' + (from + i) % 51);
+    return s;
+  }
+
+  // the file contents read by the separate filebuf
+  std::string contents(const char* name)
+  {
+    std::filebuf fb;
+    if(!fb.open(name, read_mode))
+      return "<not opened>";
+    std::string s(100000, '\0');
+    s.resize(static_cast<size_t>(fb.sgetn(&s[0], static_cast<std::streamsize>(s.size()))));
+    return s;
+  }
+
+  void create(const char* name, const std::string& data)
+  {
+    std::filebuf fb;
+    fb.open(name, write_mode);
+    fb.sputn(data.data(), static_cast<std::streamsize>(data.size()));
+  }
+
+  // removes the file on the scope exit
+  struct temp_file
+  {
+    const char* name;
+    explicit temp_file(const char* name): name(name) {}
+    ~temp_file()
+    {
+      std::error_code ec;
+      std::tr2::files::remove(std::tr2::files::path(name), ec);
+    }
+  };
+}
+
+// setbuf(0, 0): every character goes to the file at once, the input is read by single characters
+template<> template<> void tut::to::test<01>(void)
+{
+  const temp_file file("filebuf-unbuffered.bin");
+  {
+    std::filebuf fb;
+    VERIFY( fb.open(file.name, write_mode) );
+    VERIFY( fb.pubsetbuf(0, 0) == &fb );
+    VERIFY( fb.sputc('a') == 'a' );
+    VERIFY( contents(file.name) == "a" );
+    VERIFY( fb.sputc('b') == 'b' );
+    VERIFY( contents(file.name) == "ab" );
+    VERIFY( fb.sputn("cde", 3) == 3 );
+    VERIFY( contents(file.name) == "abcde" );
+    std::ostream os(&fb);
+    os << "fg" << 'h';
+    VERIFY( os.good() && contents(file.name) == "abcdefgh" );
+  }
+  VERIFY( contents(file.name) == "abcdefgh" );
+
+  // the buffer set before open()
+  {
+    std::filebuf fb;
+    fb.pubsetbuf(0, 0);
+    VERIFY( fb.open(file.name, write_mode) );
+    VERIFY( fb.sputc('x') == 'x' && contents(file.name) == "x" );
+  }
+
+  create(file.name, pattern(0, 300));
+  std::filebuf in;
+  in.pubsetbuf(0, 0);
+  VERIFY( in.open(file.name, read_mode) );
+  std::string s;
+  for(int i = 0; i < 5; i++)
+    s += static_cast<char>(in.sbumpc());
+  VERIFY( s == pattern(0, 5) && in.sgetc() == 'A' + 5 );
+  std::string rest(400, '\0');
+  rest.resize(static_cast<size_t>(in.sgetn(&rest[0], 400)));
+  VERIFY( rest == pattern(5, 295) );
+  VERIFY( in.sgetc() == std::char_traits<char>::eof() );
+}
+
+// the writes of any size keep the order: the small ones are buffered, the large ones go directly
+template<> template<> void tut::to::test<02>(void)
+{
+  const temp_file file("filebuf-bulk-write.bin");
+  const size_t sizes[] = { 1, 100, 127, 128, 300, 5, 1000, 3, 256, 0, 129, 70000 };
+  std::filebuf fb;
+  VERIFY( fb.buffer_size(256) && fb.buffer_size() == 256 );
+  VERIFY( fb.open(file.name, write_mode) );
+  size_t written = 0;
+  for(size_t i = 0; i < _countof(sizes); i++){
+    const std::string chunk = pattern(written, sizes[i]);
+    VERIFY( fb.sputn(chunk.data(), static_cast<std::streamsize>(chunk.size())) == static_cast<std::streamsize>(chunk.size()) );
+    written += chunk.size();
+    // the direct write puts the pending characters first
+    if(sizes[i] >= 128)
+      VERIFY( contents(file.name) == pattern(0, written) );
+    VERIFY( fb.sputc(pattern(written, 1)[0]) != std::char_traits<char>::eof() );
+    written++;
+  }
+  VERIFY( fb.pubsync() != -1 );
+  VERIFY( contents(file.name) == pattern(0, written) );
+  VERIFY( fb.close() == &fb );
+  VERIFY( contents(file.name) == pattern(0, written) );
+}
+
+// the reads of any size: the buffered characters first, the large requests bypass the buffer
+template<> template<> void tut::to::test<03>(void)
+{
+  const temp_file file("filebuf-bulk-read.bin");
+  const std::string data = pattern(0, 5000);
+  create(file.name, data);
+
+  std::filebuf fb;
+  VERIFY( fb.buffer_size(256) );
+  VERIFY( fb.open(file.name, read_mode) );
+  VERIFY( fb.sgetc() == data[0] );
+  VERIFY( fb.sbumpc() == data[0] && fb.sbumpc() == data[1] );
+
+  size_t pos = 2;
+  const size_t sizes[] = { 1000, 10, 127, 128, 3, 300, 1 };
+  for(size_t i = 0; i < _countof(sizes); i++){
+    std::string s(sizes[i], '\0');
+    VERIFY( fb.sgetn(&s[0], static_cast<std::streamsize>(s.size())) == static_cast<std::streamsize>(s.size()) );
+    VERIFY( s == data.substr(pos, sizes[i]) );
+    pos += sizes[i];
+    VERIFY( fb.sgetc() == data[pos] );
+  }
+
+  // the request beyond the end returns the rest
+  std::string rest(10000, '\0');
+  rest.resize(static_cast<size_t>(fb.sgetn(&rest[0], static_cast<std::streamsize>(rest.size()))));
+  VERIFY( rest == data.substr(pos) );
+  VERIFY( fb.sgetc() == std::char_traits<char>::eof() && fb.sgetn(&rest[0], 1) == 0 );
+}
+
+// the stream copies move the whole get area to the destination
+template<> template<> void tut::to::test<04>(void)
+{
+  const temp_file from("filebuf-copy-from.bin"), to("filebuf-copy-to.bin");
+  const std::string data = pattern(7, 100000);
+  create(from.name, data);
+  {
+    std::filebuf in, out;
+    VERIFY( in.buffer_size(4096) && in.open(from.name, read_mode) );
+    VERIFY( out.buffer_size(1000) && out.open(to.name, write_mode) );
+    std::ostream os(&out);
+    VERIFY( (os << &in).good() );
+  }
+  VERIFY( contents(to.name) == data );
+
+  std::filebuf in;
+  VERIFY( in.open(from.name, read_mode) );
+  std::istream is(&in);
+  std::stringbuf sb;
+  VERIFY( !(is >> &sb).fail() && is.eof() );
+  VERIFY( sb.str() == data );
+}
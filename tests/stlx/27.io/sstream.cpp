@@ -0,0 +1,130 @@
+// 27.8 string streams: view(), str() &&, reset() and the external buffer
+
+#include <ntl-tests-common.hxx>
+#include <sstream>
+#include <string>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::stringstream");
+
+namespace
+{
+  template<class Ref>
+  std::string copy(const Ref& r)
+  {
+    return std::string(r.data(), r.size());
+  }
+}
+
+// view() refers to the stream storage and follows the output
+template<> template<> void tut::to::test<01>(void)
+{
+  std::ostringstream os;
+  VERIFY( os.view().empty() );
+  os << "abc" << 123;
+  VERIFY( copy(os.view()) == "abc123" && os.view().data() == os.rdbuf()->view().data() );
+  os << 'd';
+  VERIFY( copy(os.view()) == "abc123d" && os.str() == "abc123d" );
+
+  // the whole sequence, not the unread part
+  std::stringstream ss("one two");
+  std::string word;
+  ss >> word;
+  VERIFY( word == "one" && copy(ss.view()) == "one two" );
+
+  std::istringstream is("xyz");
+  VERIFY( is.get() == 'x' && copy(is.view()) == "xyz" );
+}
+
+// str() && moves the storage out and leaves the stream empty
+template<> template<> void tut::to::test<02>(void)
+{
+  std::ostringstream os;
+  os << std::string(1000, 'x') << "end";
+  const char* const storage = os.view().data();
+  const std::string s = std::move(os).str();
+  VERIFY( s.size() == 1003 && s.compare(1000, 3, "end") == 0 );
+  VERIFY( s.data() == storage );
+  VERIFY( os.str().empty() && os.view().empty() );
+  os << "new";
+  VERIFY( os.str() == "new" );
+
+  std::istringstream is("input text");
+  std::string word;
+  is >> word;
+  VERIFY( std::move(is).str() == "input text" );
+  VERIFY( is.str().empty() );
+
+  // the lvalue overload copies
+  std::stringstream ss("kept");
+  VERIFY( ss.str() == "kept" && ss.str() == "kept" );
+}
+
+// reset() empties the sequence and keeps the storage
+template<> template<> void tut::to::test<03>(void)
+{
+  std::ostringstream os;
+  os << std::string(1000, 'y');
+  const char* const storage = os.view().data();
+  os.reset();
+  VERIFY( os.view().empty() && os.str().empty() );
+  os << "abc";
+  VERIFY( os.str() == "abc" && os.view().data() == storage );
+  for(int i = 0; i < 10; i++){
+    os.reset();
+    os << std::string(900, 'z') << i;
+  }
+  VERIFY( os.view().data() == storage && os.view().size() == 901 );
+
+  std::istringstream is("1 2 3");
+  int n = 0;
+  VERIFY( (is >> n) && n == 1 );
+  is.reset();
+  VERIFY( is.view().empty() && is.str().empty() );
+  VERIFY( !(is >> n) && n == 1 );
+  is.clear();
+  is.str("42");
+  VERIFY( (is >> n) && n == 42 );
+
+  std::stringstream ss;
+  ss << "first";
+  ss.reset();
+  ss << "second";
+  std::string word;
+  VERIFY( (ss >> word) && word == "second" );
+}
+
+// setbuf(s, n) uses the fixed buffer, setbuf(0, 0) returns to the own storage
+template<> template<> void tut::to::test<04>(void)
+{
+  char buf[8] = {};
+  std::ostringstream os;
+  VERIFY( os.rdbuf()->pubsetbuf(buf, sizeof(buf)) == os.rdbuf() );
+  os << "1234" << 5678;
+  VERIFY( os.good() && copy(os.view()) == "12345678" && os.view().data() == buf );
+  os << '9';
+  VERIFY( os.bad() && os.str() == "12345678" );
+
+  os.clear();
+  os.reset();
+  os << "ab";
+  VERIFY( os.good() && os.str() == "ab" && buf[0] == 'a' && buf[1] == 'b' );
+  // the external buffer is copied, not given away
+  VERIFY( std::move(os).str() == "ab" && os.view().empty() && os.view().data() == buf );
+
+  os.rdbuf()->pubsetbuf(0, 0);
+  os << std::string(100, 'c');
+  VERIFY( os.good() && os.str() == std::string(100, 'c') && os.view().data() != buf );
+
+  // the input only stream reads the buffer contents
+  char in[] = "42 7 rest";
+  std::istringstream is;
+  is.rdbuf()->pubsetbuf(in, 4);
+  int a = 0, b = 0;
+  VERIFY( (is >> a >> b) && a == 42 && b == 7 );
+  VERIFY( is.eof() && copy(is.view()) == "42 7" );
+
+  // str(s) copies to the own storage
+  is.clear();
+  is.str("5");
+  VERIFY( (is >> a) && a == 5 && is.view().data() != in );
+}
@@ -0,0 +1,181 @@
+// tr2 deadline_timer over the io_service timer wheel
+
+#include <ntl-tests-common.hxx>
+#include <tr2/network.hxx>
+#include <tr2/timer.hxx>
+#include <stlx/ext/tr2/network/iocp/timer_wheel.hxx>
+#include <vector>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::tr2::sys::deadline_timer");
+
+namespace
+{
+  typedef std::tr2::sys::io_service io_service;
+  typedef std::tr2::sys::deadline_timer deadline_timer;
+  typedef std::tr2::sys::__::timer_wheel timer_wheel;
+  typedef std::chrono::system_clock clock_type;
+
+  // the result of the wait
+  struct wait_result
+  {
+    std::error_code ec;
+    int calls;
+    wait_result(): calls() {}
+  };
+
+  struct on_wait
+  {
+    wait_result* r;
+    explicit on_wait(wait_result& r): r(&r) {}
+    void operator()(const std::error_code& ec) const
+    {
+      r->ec = ec;
+      r->calls++;
+    }
+  };
+
+  bool aborted(const wait_result& r)
+  {
+    return r.calls == 1 && r.ec == std::make_error_code(std::tr2::network::error::operation_aborted);
+  }
+
+  bool expired(const wait_result& r)
+  {
+    return r.calls == 1 && !r.ec;
+  }
+
+  struct fired_node: timer_wheel::node
+  {
+    int fired;
+    timer_wheel::tick_type at;
+    fired_node(): fired(), at() {}
+  };
+
+  struct on_fire
+  {
+    timer_wheel* wheel;
+    void operator()(timer_wheel::node& n) const
+    {
+      fired_node& f = static_cast<fired_node&>(n);
+      f.fired++;
+      f.at = wheel->current();
+    }
+  };
+}
+
+// the wait completes after the expiry time
+template<> template<> void tut::to::test<01>(void)
+{
+  io_service ios;
+  const clock_type::time_point start = clock_type::now();
+  deadline_timer t(ios, std::chrono::milliseconds(30));
+  wait_result r;
+  t.async_wait(on_wait(r));
+  VERIFY( ios.run() == 1 );
+  VERIFY( expired(r) );
+  // the clock granularity is about a tick of the system timer
+  VERIFY( clock_type::now() - start >= std::chrono::milliseconds(15) );
+}
+
+// cancel aborts the pending wait, run() returns
+template<> template<> void tut::to::test<02>(void)
+{
+  io_service ios;
+  const clock_type::time_point start = clock_type::now();
+  deadline_timer t(ios, std::chrono::seconds(30));
+  wait_result r;
+  t.async_wait(on_wait(r));
+  VERIFY( t.cancel() == 1 );
+  VERIFY( t.cancel() == 0 );
+  VERIFY( ios.run() == 1 );
+  VERIFY( aborted(r) );
+  VERIFY( clock_type::now() - start < std::chrono::seconds(10) );
+
+  // expires_from_now cancels as well
+  ios.reset();
+  wait_result r2, r3;
+  t.expires_from_now(std::chrono::seconds(30));
+  t.async_wait(on_wait(r2));
+  VERIFY( t.expires_from_now(std::chrono::milliseconds(10)) == 1 );
+  t.async_wait(on_wait(r3));
+  VERIFY( ios.run() == 2 );
+  VERIFY( aborted(r2) && expired(r3) );
+}
+
+// the wait on the armed timer aborts the previous one, every operation completes once
+template<> template<> void tut::to::test<03>(void)
+{
+  io_service ios;
+  deadline_timer t(ios, std::chrono::milliseconds(20));
+  wait_result first, second, third;
+  t.async_wait(on_wait(first));
+  t.async_wait(on_wait(second));
+  t.async_wait(on_wait(third));
+  VERIFY( ios.run() == 3 );
+  VERIFY( aborted(first) && aborted(second) );
+  VERIFY( expired(third) );
+
+  // the expired timer is armed again
+  ios.reset();
+  wait_result again;
+  t.expires_from_now(std::chrono::milliseconds(10));
+  t.async_wait(on_wait(again));
+  VERIFY( ios.run() == 1 );
+  VERIFY( expired(again) && third.calls == 1 );
+}
+
+// the wheel: re-arming relinks the node, cancel unlinks it
+template<> template<> void tut::to::test<04>(void)
+{
+  timer_wheel wheel(1000);
+  const on_fire fire = { &wheel };
+  fired_node a, b;
+  wheel.schedule(a, 1010);
+  wheel.schedule(a, 1500);
+  VERIFY( wheel.size() == 1 && a.linked() );
+  wheel.schedule(b, 1020);
+  VERIFY( wheel.size() == 2 );
+
+  timer_wheel::tick_type next;
+  VERIFY( wheel.next_expiry(next) && next <= 1020 );
+  VERIFY( wheel.advance(1100, fire) == 1 );
+  VERIFY( a.fired == 0 && b.fired == 1 && b.at == 1020 );
+
+  VERIFY( wheel.cancel(a) && !a.linked() );
+  VERIFY( !wheel.cancel(a) );
+  VERIFY( wheel.empty() && !wheel.next_expiry(next) );
+  VERIFY( wheel.advance(5000, fire) == 0 && a.fired == 0 );
+
+  // the overdue timer fires on the next tick
+  wheel.schedule(a, 10);
+  VERIFY( wheel.advance(5001, fire) == 1 && a.fired == 1 && a.at == 5001 );
+}
+
+// the wheel: the timers of every level fire at their tick, in order
+template<> template<> void tut::to::test<05>(void)
+{
+  const timer_wheel::tick_type start = 123456;
+  timer_wheel wheel(start);
+  const on_fire fire = { &wheel };
+  std::vector<fired_node> nodes(200);
+  std::vector<timer_wheel::tick_type> due(nodes.size());
+  unsigned seed = 1;
+  for(size_t i = 0; i < nodes.size(); i++){
+    seed = seed * 1103515245 + 12345;
+    // every level and beyond the wheel range
+    const unsigned shift = static_cast<unsigned>(i % 6) * 6;
+    due[i] = start + 1 + ((static_cast<timer_wheel::tick_type>(seed >> 8) << 8) % (timer_wheel::tick_type(1) << (shift + 6)));
+    wheel.schedule(nodes[i], due[i]);
+  }
+  VERIFY( wheel.size() == nodes.size() );
+
+  size_t fired = 0;
+  while(!wheel.empty()){
+    timer_wheel::tick_type next;
+    VERIFY( wheel.next_expiry(next) && next > wheel.current() );
+    fired += wheel.advance(next, fire);
+  }
+  VERIFY( fired == nodes.size() );
+  for(size_t i = 0; i < nodes.size(); i++)
+    VERIFY( nodes[i].fired == 1 && nodes[i].at == due[i] );
+}
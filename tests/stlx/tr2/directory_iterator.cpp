@@ -0,0 +1,171 @@
+// tr2 files: the directory iteration and the entry information cached by it
+
+#include <ntl-tests-common.hxx>
+#include <tr2/files.hxx>
+#include <nt/file.hxx>
+#include <string>
+#include <vector>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::tr2::files::directory_iterator");
+
+namespace
+{
+  namespace files = std::tr2::files;
+
+  const uintmax_t sizes[] = { 0, 1, 123, 4096, 70000 };
+
+  std::string file_name(size_t i)
+  {
+    std::string s = "file-";
+    s += static_cast<char>('a' + i % 26);
+    s += static_cast<char>('a' + i / 26 % 26);
+    s += static_cast<char>('a' + i / 676);
+    return s;
+  }
+
+  // the temporary directory with the files of the known sizes and a subdirectory, removed by the destructor
+  struct temp_tree
+  {
+    files::path dir;
+    size_t count;
+
+    explicit temp_tree(size_t count = _countof(sizes))
+      :dir(files::temp_directory_path() / files::unique_path("ntl-dir-%%%%-%%%%")), count(count)
+    {
+      files::create_directory(dir);
+      files::create_directory(dir / "sub");
+      for(size_t i = 0; i < count; i++){
+        ntl::nt::file f;
+        f.create(files::native(dir / file_name(i)), ntl::nt::file::create_new, ntl::nt::file::generic_write);
+        f.size(static_cast<ntl::nt::file::size_type>(sizes[i % _countof(sizes)]));
+      }
+    }
+
+    ~temp_tree()
+    {
+      std::vector<files::path> entries;
+      std::error_code ec;
+      for(files::directory_iterator i(dir, ec), end; i != end; i.increment(ec))
+        entries.push_back(i->path());
+      for(size_t i = 0; i < entries.size(); i++)
+        remove_entry(entries[i]);
+      remove_entry(dir);
+    }
+
+    static void remove_entry(const files::path& p)
+    {
+      ntl::nt::file_handler f;
+      if(ntl::nt::success(f.open(files::native(p), ntl::nt::file::read_attributes|ntl::nt::delete_access|ntl::nt::synchronize,
+        ntl::nt::file::share_valid_flags, ntl::nt::file::open_for_backup_intent)))
+        f.erase();
+    }
+  };
+
+  bool is_dir_error(const std::error_code& ec)
+  {
+    return ec == std::make_error_code(ntl::nt::status::file_is_a_directory);
+  }
+}
+
+// every entry is visited once, the cached information agrees with the queries
+template<> template<> void tut::to::test<01>(void)
+{
+  const temp_tree t;
+  std::vector<int> seen(t.count);
+  size_t dirs = 0;
+  std::error_code ec;
+  for(files::directory_iterator i(t.dir, ec), end; i != end; i.increment(ec)){
+    VERIFY( !ec );
+    const files::directory_entry& e = *i;
+    VERIFY( e.has_info() );
+    if(files::is_directory(e.status())){
+      VERIFY( e.path() == t.dir / "sub" );
+      dirs++;
+      continue;
+    }
+    size_t n = 0;
+    while(n < t.count && !(e.path() == t.dir / file_name(n)))
+      n++;
+    VERIFY( n < t.count && seen[n]++ == 0 );
+    VERIFY( e.file_size() == sizes[n] && e.file_size() == files::file_size(e.path()) );
+    VERIFY( e.info().EndOfFile == static_cast<int64_t>(sizes[n]) );
+    VERIFY( e.last_write_time() == files::last_write_time(e.path()) );
+  }
+  VERIFY( !ec && dirs == 1 );
+  for(size_t n = 0; n < t.count; n++)
+    VERIFY( seen[n] == 1 );
+
+  // the copies share the position and compare equal
+  files::directory_iterator a(t.dir), b(a);
+  VERIFY( a == b && a != files::directory_iterator() );
+  ++a;
+  VERIFY( a == b );
+}
+
+// the size of the directory is an error, cached or not
+template<> template<> void tut::to::test<02>(void)
+{
+  const temp_tree t;
+  files::directory_iterator i(t.dir);
+  while(i != files::directory_iterator() && !files::is_directory(i->status()))
+    ++i;
+  VERIFY( i != files::directory_iterator() );
+  const files::directory_entry sub = *i;
+  VERIFY( sub.has_info() );
+
+  std::error_code ec;
+  VERIFY( sub.file_size(ec) == 0 && is_dir_error(ec) );
+  VERIFY( files::file_size(sub.path(), ec) == 0 && is_dir_error(ec) );
+  bool thrown = false;
+  try {
+    sub.file_size();
+  }
+  catch(const files::filesystem_error& e){
+    thrown = is_dir_error(e.code());
+  }
+  VERIFY( thrown );
+
+  // the entry which is not obtained from the iterator queries the file
+  const files::directory_entry plain(t.dir / file_name(3));
+  VERIFY( !plain.has_info() && plain.file_size(ec) == sizes[3] && !ec );
+  VERIFY( files::file_size(t.dir / file_name(4), ec) == sizes[4] && !ec );
+}
+
+// the failures are reported: the missing directory, the file instead of the directory, the failed query
+template<> template<> void tut::to::test<03>(void)
+{
+  const temp_tree t;
+  std::error_code ec;
+  files::directory_iterator missing(t.dir / "missing", ec);
+  VERIFY( ec && missing == files::directory_iterator() );
+  files::directory_iterator file(t.dir / file_name(0), ec);
+  VERIFY( ec && file == files::directory_iterator() );
+
+  // the query into the buffer which can't hold an entry fails, the iterator reports this status
+  ntl::nt::directory_reader small(16);
+  const ntl::nt::ntstatus st = small.open(ntl::nt::const_unicode_string(files::native(t.dir)));
+  VERIFY( ntl::nt::status::is_error(st) && !small.get() && small.last_status() == st );
+}
+
+// the directory larger than the reader chunk is read by several queries, each entry once
+template<> template<> void tut::to::test<04>(void)
+{
+  const temp_tree t(600);
+  ntl::nt::directory_reader r(1024);
+  VERIFY( ntl::nt::success(r.open(ntl::nt::const_unicode_string(files::native(t.dir)))) );
+  size_t entries = 0;
+  for(const ntl::nt::directory_reader::entry_type* e = r.get(); e; e = r.next())
+    entries++;
+  // the files, the subdirectory, '.' and '..'
+  VERIFY( entries == t.count + 3 && r.last_status() == ntl::nt::status::no_more_files );
+
+  std::vector<int> seen(t.count);
+  std::error_code ec;
+  size_t files_seen = 0;
+  for(files::directory_iterator i(t.dir, ec), end; i != end; i.increment(ec)){
+    VERIFY( !ec );
+    if(!files::is_directory(i->status()))
+      files_seen++;
+  }
+  VERIFY( !ec && files_seen == t.count );
+}
@@ -0,0 +1,155 @@
+// tr2 basic_segmented_fifobuf and basic_block_pool
+
+#include <ntl-tests-common.hxx>
+#include <tr2/buffer.hxx>
+#include <string>
+
+STLX_DEFAULT_TESTGROUP_NAME("std::tr2::sys::segmented_fifobuf");
+
+namespace
+{
+  // counts the live allocator objects and the allocated blocks
+  struct counting_allocator:
+    std::allocator<char>
+  {
+    static int live;
+    static int blocks;
+
+    counting_allocator() { live++; }
+    counting_allocator(const counting_allocator&): std::allocator<char>() { live++; }
+    ~counting_allocator() { live--; }
+
+    char* allocate(size_t n)
+    {
+      blocks++;
+      return std::allocator<char>::allocate(n);
+    }
+
+    void deallocate(char* p, size_t n)
+    {
+      blocks--;
+      std::allocator<char>::deallocate(p, n);
+    }
+  };
+
+  int counting_allocator::live = 0;
+  int counting_allocator::blocks = 0;
+
+  typedef std::tr2::sys::basic_block_pool<counting_allocator> pool_type;
+  typedef std::tr2::sys::basic_segmented_fifobuf<counting_allocator> fifobuf;
+
+  char pattern(size_t i)
+  {
+    return static_cast<char>('a' + i % 23);
+  }
+
+  /** Writes \p n bytes of the pattern through prepare() and commit() */
+  void write(fifobuf& buf, size_t from, size_t n)
+  {
+    const fifobuf::mutable_buffers_type bufs = buf.prepare(n);
+    size_t i = from;
+    for(fifobuf::mutable_buffers_type::const_iterator b = bufs.begin(); b != bufs.end(); ++b){
+      char* const p = std::tr2::sys::buffer_cast<char*>(*b);
+      for(size_t k = 0; k < std::tr2::sys::buffer_size(*b); k++)
+        p[k] = pattern(i++);
+    }
+    buf.commit(n);
+  }
+
+  // the input sequence by data(), one piece per block
+  std::string contents(const fifobuf& buf, size_t& pieces)
+  {
+    std::string s;
+    pieces = 0;
+    const fifobuf::const_buffers_type bufs = buf.data();
+    for(fifobuf::const_buffers_type::const_iterator b = bufs.begin(); b != bufs.end(); ++b, ++pieces)
+      s.append(std::tr2::sys::buffer_cast<const char*>(*b), std::tr2::sys::buffer_size(*b));
+    return s;
+  }
+
+  std::string expected(size_t from, size_t n)
+  {
+    std::string s;
+    for(size_t i = from; i < from + n; i++)
+      s += pattern(i);
+    return s;
+  }
+}
+
+// the own pool: the data spans the blocks, the consumed blocks are reused, everything is freed
+template<> template<> void tut::to::test<01>(void)
+{
+  const int live = counting_allocator::live;
+  {
+    fifobuf buf;
+    const size_t bs = buf.block_size();
+    VERIFY( buf.size() == 0 && buf.data().size() == 0 );
+
+    write(buf, 0, 2 * bs + 100);
+    size_t pieces;
+    VERIFY( buf.size() == 2 * bs + 100 );
+    VERIFY( contents(buf, pieces) == expected(0, 2 * bs + 100) && pieces == 3 );
+    VERIFY( counting_allocator::blocks == 3 );
+
+    buf.consume(bs + 10);
+    VERIFY( contents(buf, pieces) == expected(bs + 10, bs + 90) && pieces == 2 );
+
+    // the released block is taken back from the cache
+    write(buf, 2 * bs + 100, bs);
+    VERIFY( counting_allocator::blocks == 3 );
+    VERIFY( contents(buf, pieces) == expected(bs + 10, 2 * bs + 90) && pieces == 3 );
+
+    // the streambuf interface crosses the blocks as well
+    std::string s(bs + 1, '\0');
+    VERIFY( buf.sgetn(&s[0], static_cast<std::streamsize>(s.size())) == static_cast<std::streamsize>(s.size()) );
+    VERIFY( s == expected(bs + 10, bs + 1) );
+    const std::string tail = expected(0, bs + 5);
+    VERIFY( buf.sputn(tail.data(), static_cast<std::streamsize>(tail.size())) == static_cast<std::streamsize>(tail.size()) );
+    VERIFY( buf.size() == bs + 89 + tail.size() );
+    VERIFY( contents(buf, pieces) == expected(2 * bs + 11, bs - 11 + 100) + tail );
+
+    buf.consume(buf.size());
+    VERIFY( buf.size() == 0 && buf.sgetc() == std::char_traits<char>::eof() );
+  }
+  VERIFY( counting_allocator::blocks == 0 && counting_allocator::live == live );
+}
+
+// the shared pool: no own pool is constructed, the blocks go back to the shared one
+template<> template<> void tut::to::test<02>(void)
+{
+  const int live = counting_allocator::live;
+  {
+    pool_type pool(64, 8);
+    const int with_pool = counting_allocator::live;
+    VERIFY( with_pool == live + 1 );
+    {
+      fifobuf buf(pool);
+      VERIFY( counting_allocator::live == with_pool );
+      VERIFY( buf.block_size() == 64 && counting_allocator::blocks == 0 );
+      write(buf, 0, 200);
+      VERIFY( counting_allocator::blocks == 4 );
+      size_t pieces;
+      VERIFY( contents(buf, pieces) == expected(0, 200) && pieces == 4 );
+    }
+    // the blocks are cached by the pool and reused by the next buffer
+    VERIFY( counting_allocator::blocks == 4 && counting_allocator::live == with_pool );
+    {
+      fifobuf a(pool), b(pool, 100);
+      write(a, 0, 128);
+      write(b, 0, 100);
+      VERIFY( counting_allocator::blocks == 4 );
+      try {
+        b.prepare(1);
+        VERIFY( !"the max_size is exceeded" );
+      }
+      catch(std::length_error&){}
+      a.consume(64);
+      write(a, 128, 64);
+      VERIFY( counting_allocator::blocks == 4 );
+      size_t pieces;
+      VERIFY( contents(a, pieces) == expected(64, 128) && pieces == 2 );
+    }
+    VERIFY( counting_allocator::blocks == 4 );
+  }
+  VERIFY( counting_allocator::blocks == 0 && counting_allocator::live == live );
+}